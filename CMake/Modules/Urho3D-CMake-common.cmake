@@ -181,6 +181,8 @@ cmake_dependent_option (URHO3D_OPENGL "Use OpenGL instead of Direct3D (Windows p
 # On Windows platform Direct3D11 can be optionally chosen
 # Using Direct3D11 on non-MSVC compiler may require copying and renaming Microsoft official libraries (.lib to .a), else link failures or non-functioning graphics may result
 cmake_dependent_option (URHO3D_D3D11 "Use Direct3D11 instead of Direct3D9 (Windows platform only); overrides URHO3D_OPENGL option" FALSE "WIN32" FALSE)
+# The null graphics backend runs the CPU side of the rendering pipeline without a window or GPU device, e.g. for headless benchmarking
+option (URHO3D_NULL_GRAPHICS "Use the null graphics backend which does not require a GPU device; overrides URHO3D_OPENGL and URHO3D_D3D11 options")
 if (CMAKE_HOST_WIN32)
     if (NOT DEFINED URHO3D_MKLINK)
         # Test whether the host system is capable of setting up symbolic link
@@ -380,6 +382,13 @@ if (EMSCRIPTEN)
     add_definitions (-DNO_POPEN)
 endif ()
 
+# Add definition for the null graphics backend
+if (URHO3D_NULL_GRAPHICS)
+    set (URHO3D_OPENGL 0)
+    set (URHO3D_D3D11 0)
+    add_definitions (-DURHO3D_NULL_GRAPHICS)
+endif ()
+
 # Add definition for Direct3D11
 if (URHO3D_D3D11)
     set (URHO3D_OPENGL 0)
@@ -462,7 +471,7 @@ if (URHO3D_DATABASE_SQLITE)
 endif ()
 
 # Find Direct3D include & library directories in MS Windows SDK or DirectX SDK when not using OpenGL.
-if (WIN32 AND NOT URHO3D_OPENGL)
+if (WIN32 AND NOT URHO3D_OPENGL AND NOT URHO3D_NULL_GRAPHICS)
     find_package (Direct3D REQUIRED)
     if (DIRECT3D_INCLUDE_DIRS)
         include_directories (${DIRECT3D_INCLUDE_DIRS})
@@ -185,8 +185,8 @@
 /* #undef SDL_POWER_DISABLED */
 
 /* Enable various audio drivers */
-#define SDL_AUDIO_DRIVER_ALSA 1
-#define SDL_AUDIO_DRIVER_ALSA_DYNAMIC "libasound.so.2"
+/* #define SDL_AUDIO_DRIVER_ALSA 1 */
+
 /* #undef SDL_AUDIO_DRIVER_ARTS */
 /* #undef SDL_AUDIO_DRIVER_ARTS_DYNAMIC */
 /* #undef SDL_AUDIO_DRIVER_PULSEAUDIO */
@@ -254,25 +254,25 @@
 /* #undef SDL_VIDEO_DRIVER_DIRECTFB_DYNAMIC */
 #define SDL_VIDEO_DRIVER_DUMMY 1
 /* #undef SDL_VIDEO_DRIVER_WINDOWS */
-#define SDL_VIDEO_DRIVER_X11 1
-#define SDL_VIDEO_DRIVER_X11_DYNAMIC "libX11.so.6"
-#define SDL_VIDEO_DRIVER_X11_DYNAMIC_XEXT "libXext.so.6"
+/* #define SDL_VIDEO_DRIVER_X11 1 */
+/* #define SDL_VIDEO_DRIVER_X11_DYNAMIC "libX11.so.6" */
+/* #define SDL_VIDEO_DRIVER_X11_DYNAMIC_XEXT "libXext.so.6" */
 /* #undef SDL_VIDEO_DRIVER_X11_DYNAMIC_XCURSOR */
 /* #undef SDL_VIDEO_DRIVER_X11_DYNAMIC_XINERAMA */
 /* #undef SDL_VIDEO_DRIVER_X11_DYNAMIC_XINPUT2 */
-#define SDL_VIDEO_DRIVER_X11_DYNAMIC_XRANDR "libXrandr.so.2"
+/* #define SDL_VIDEO_DRIVER_X11_DYNAMIC_XRANDR "libXrandr.so.2" */
 /* #undef SDL_VIDEO_DRIVER_X11_DYNAMIC_XSS */
 /* #undef SDL_VIDEO_DRIVER_X11_DYNAMIC_XVIDMODE */
 /* #undef SDL_VIDEO_DRIVER_X11_XCURSOR */
 /* #undef SDL_VIDEO_DRIVER_X11_XINERAMA */
 /* #undef SDL_VIDEO_DRIVER_X11_XINPUT2 */
 /* #undef SDL_VIDEO_DRIVER_X11_XINPUT2_SUPPORTS_MULTITOUCH */
-#define SDL_VIDEO_DRIVER_X11_XRANDR 1
+/* #define SDL_VIDEO_DRIVER_X11_XRANDR 1 */
 /* #undef SDL_VIDEO_DRIVER_X11_XSCRNSAVER */
-#define SDL_VIDEO_DRIVER_X11_XSHAPE 1
+/* #define SDL_VIDEO_DRIVER_X11_XSHAPE 1 */
 /* #undef SDL_VIDEO_DRIVER_X11_XVIDMODE */
-#define SDL_VIDEO_DRIVER_X11_SUPPORTS_GENERIC_EVENTS 1
-#define SDL_VIDEO_DRIVER_X11_HAS_XKBKEYCODETOKEYSYM 1
+/* #define SDL_VIDEO_DRIVER_X11_SUPPORTS_GENERIC_EVENTS 1 */
+/* #define SDL_VIDEO_DRIVER_X11_HAS_XKBKEYCODETOKEYSYM 1 */
 
 // Urho3D: Use OpenGL ES 2 implementation from Broadcom VideoCore for Raspberry Pi
 #ifdef RPI
@@ -303,7 +303,7 @@
 /* #undef SDL_VIDEO_OPENGL_ES */
 /* #undef SDL_VIDEO_OPENGL_BGL */
 /* #undef SDL_VIDEO_OPENGL_CGL */
-#define SDL_VIDEO_OPENGL_GLX 1
+/* #define SDL_VIDEO_OPENGL_GLX 1 */
 /* #undef SDL_VIDEO_OPENGL_WGL */
 /* #undef SDL_VIDEO_OPENGL_OSMESA */
 /* #undef SDL_VIDEO_OPENGL_OSMESA_DYNAMIC */
@@ -114,6 +114,9 @@ bool noOverwriteTexture_ = false;
 bool noOverwriteNewerTexture_ = false;
 bool checkUniqueModel_ = true;
 bool moveToBindPose_ = false;
+bool compressAnimations_ = false;
+float animationSampleRate_ = 0.0f;
+bool compressLoopedAnimations_ = false;
 unsigned maxBones_ = 64;
 Vector<String> nonSkinningBoneIncludes_;
 Vector<String> nonSkinningBoneExcludes_;
@@ -243,6 +246,10 @@ void Run(const Vector<String>& arguments)
             "-ctn        Check and do not overwrite if texture has newer timestamp\n"
             "-am         Export all meshes even if identical (scene mode only)\n"
             "-bp         Move bones to bind pose before saving model\n"
+            "-ca [rate]  Save animations in the compressed format with quantized keyframes,\n"
+            "            resampled at the given rate per second. Default is the average\n"
+            "            keyframe rate of each animation track\n"
+            "-cl         Resample compressed animations for looped playback\n"
         );
     }
 
@@ -386,6 +393,17 @@ void Run(const Vector<String>& arguments)
                 checkUniqueModel_ = false;
             else if (argument == "bp")
                 moveToBindPose_ = true;
+            else if (argument == "cl")
+                compressLoopedAnimations_ = true;
+            else if (argument == "ca")
+            {
+                compressAnimations_ = true;
+                if (value.Length() && IsDigit((unsigned)value[0]))
+                {
+                    animationSampleRate_ = ToFloat(value);
+                    ++i;
+                }
+            }
         }
     }
 
@@ -1224,6 +1242,22 @@ void BuildAndSaveAnimations(OutModel* model)
             }
         }
 
+        if (compressAnimations_)
+        {
+            unsigned memoryUse = 0;
+            unsigned compressedMemoryUse = 0;
+            const HashMap<StringHash, AnimationTrack>& tracks = outAnim->GetTracks();
+            for (HashMap<StringHash, AnimationTrack>::ConstIterator j = tracks.Begin(); j != tracks.End(); ++j)
+                memoryUse += j->second_.GetKeyFrameMemoryUse();
+
+            outAnim->Compress(animationSampleRate_, compressLoopedAnimations_);
+            for (HashMap<StringHash, AnimationTrack>::ConstIterator j = tracks.Begin(); j != tracks.End(); ++j)
+                compressedMemoryUse += j->second_.GetKeyFrameMemoryUse();
+
+            PrintLine("Compressed animation keyframes from " + String(memoryUse) + " to " + String(compressedMemoryUse) +
+                " bytes");
+        }
+
         File outFile(context_);
         if (!outFile.Open(animOutName, FILE_WRITE))
             ErrorExit("Could not open output file " + animOutName);
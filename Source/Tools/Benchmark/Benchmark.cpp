@@ -0,0 +1,1193 @@
+//
+// Copyright (c) 2008-2015 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Container/FlatHashMap.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/AnimatedModel.h>
+#include <Urho3D/Graphics/Animation.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Geometry.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Graphics/IndexBuffer.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/OcclusionBuffer.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/VertexBuffer.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Math/Random.h>
+#ifdef URHO3D_PHYSICS
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#endif
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Node.h>
+#include <Urho3D/Scene/Prefab.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <SDL/SDL_atomic.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+SharedPtr<Context> context_(new Context());
+unsigned iterations_ = 0;
+SDL_atomic_t workQueueSum_;
+
+int main(int argc, char** argv);
+void Run(const Vector<String>& arguments);
+void BenchmarkOcclusion();
+void BenchmarkMorph();
+void BenchmarkSceneLoad();
+void BenchmarkPrefab();
+void BenchmarkWorkQueue();
+void BenchmarkHashMap();
+void BenchmarkMath();
+void BenchmarkAnimation();
+void BenchmarkOctree();
+void CreateTestScene(Scene* scene, unsigned numGroups, unsigned numChildren, bool physics);
+SharedPtr<Animation> CreateTestAnimation(unsigned numBones, float length, float keyRate);
+SharedPtr<Model> CreateBoxModel();
+void CreateBoxGrid(Scene* scene, int size, Model* model, Vector<SharedPtr<Node> >& boxNodes);
+void PrintResult(const String& name, long long usec, unsigned iterations, unsigned items, const String& itemName);
+
+int main(int argc, char** argv)
+{
+    Vector<String> arguments;
+
+    #ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+    #else
+    arguments = ParseArguments(argc, argv);
+    #endif
+
+    Run(arguments);
+    return 0;
+}
+
+void Run(const Vector<String>& arguments)
+{
+    if (arguments.Size() < 1)
+    {
+        ErrorExit(
+            "Usage: Benchmark <command> [options]\n\n"
+            "Commands:\n"
+            "occlusion  Rasterize a fixed occluder set at different triangle budgets\n"
+            "morph      Apply vertex morphs to a set of animated models\n"
+            "sceneload  Load the same scene from columnar binary, binary and XML files\n"
+            "prefab     Instantiate the same object from a prefab, binary and XML data\n"
+            "workqueue  Run small work items, added from the main thread or split recursively\n"
+            "hashmap    Insert, find, iterate and erase keys in HashMap and FlatHashMap\n"
+            "math       Multiply matrices and quaternions and transform bounding boxes\n"
+            "animation  Sample keyframed and compressed animations, compare their memory use\n"
+            "octree     Move and rotate a grid of boxes, reinserting them to the octree\n"
+            "\n"
+            "Options:\n"
+            "-i <num>    Number of iterations. Default depends on the command\n"
+            "-t <num>    Number of worker threads. Default is number of physical CPU cores\n"
+            "            minus one\n"
+        );
+    }
+
+    // The Time subsystem initializes the high-resolution timer frequency
+    context_->RegisterSubsystem(new Time(context_));
+    context_->RegisterSubsystem(new FileSystem(context_));
+    context_->RegisterSubsystem(new ResourceCache(context_));
+    context_->RegisterSubsystem(new WorkQueue(context_));
+    RegisterSceneLibrary(context_);
+    RegisterGraphicsLibrary(context_);
+#ifdef URHO3D_PHYSICS
+    RegisterPhysicsLibrary(context_);
+#endif
+#ifdef URHO3D_NULL_GRAPHICS
+    // The null backend has no window or device, so the Graphics subsystem can exist headless for code paths that expect it
+    context_->RegisterSubsystem(new Graphics(context_));
+#endif
+
+    String command = arguments[0].ToLower();
+    unsigned numThreads = GetNumPhysicalCPUs() - 1;
+
+    for (unsigned i = 1; i < arguments.Size(); ++i)
+    {
+        if (arguments[i].Length() > 1 && arguments[i][0] == '-')
+        {
+            String argument = arguments[i].Substring(1).ToLower();
+            String value = i + 1 < arguments.Size() ? arguments[i + 1] : String::EMPTY;
+
+            if (argument == "i" && !value.Empty())
+            {
+                iterations_ = ToUInt(value);
+                ++i;
+            }
+            else if (argument == "t" && !value.Empty())
+            {
+                numThreads = ToUInt(value);
+                ++i;
+            }
+        }
+    }
+
+    if (numThreads)
+        context_->GetSubsystem<WorkQueue>()->CreateThreads(numThreads);
+    PrintLine("Worker threads: " + String(context_->GetSubsystem<WorkQueue>()->GetNumThreads()));
+
+    if (command == "occlusion")
+        BenchmarkOcclusion();
+    else if (command == "morph")
+        BenchmarkMorph();
+    else if (command == "sceneload")
+        BenchmarkSceneLoad();
+    else if (command == "prefab")
+        BenchmarkPrefab();
+    else if (command == "workqueue")
+        BenchmarkWorkQueue();
+    else if (command == "hashmap")
+        BenchmarkHashMap();
+    else if (command == "math")
+        BenchmarkMath();
+    else if (command == "animation")
+        BenchmarkAnimation();
+    else if (command == "octree")
+        BenchmarkOctree();
+    else
+        ErrorExit("Unrecognized command " + command);
+}
+
+void PrintResult(const String& name, long long usec, unsigned iterations, unsigned items, const String& itemName)
+{
+    float msec = (float)usec / 1000.0f;
+    String line = name + ": " + String(msec / (float)iterations) + " ms per iteration";
+    if (items && msec > 0.0f)
+        line += ", " + String((float)items * (float)iterations / msec) + " " + itemName + "/ms";
+    PrintLine(line);
+}
+
+void BenchmarkOcclusion()
+{
+    static const unsigned short boxIndices[] = {
+        0, 1, 2, 2, 1, 3,
+        4, 6, 5, 5, 6, 7,
+        0, 2, 4, 4, 2, 6,
+        1, 5, 3, 3, 5, 7,
+        0, 4, 1, 1, 4, 5,
+        2, 3, 6, 6, 3, 7
+    };
+
+    unsigned iterations = iterations_ ? iterations_ : 200;
+
+    // Unit box vertices shared by all occluders
+    PODVector<Vector3> boxVertices;
+    for (unsigned i = 0; i < 8; ++i)
+        boxVertices.Push(Vector3(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f));
+
+    // Fixed set of box occluders in front of the camera, generated from a constant seed
+    PODVector<Matrix3x4> occluders;
+    SetRandomSeed(1);
+    for (unsigned i = 0; i < 2000; ++i)
+    {
+        Vector3 position(Random(-80.0f, 80.0f), Random(-10.0f, 10.0f), Random(5.0f, 150.0f));
+        Vector3 scale(Random(1.0f, 8.0f), Random(1.0f, 8.0f), Random(1.0f, 8.0f));
+        occluders.Push(Matrix3x4(position, Quaternion(Random(360.0f), Vector3::UP), scale));
+    }
+
+    // Test boxes are checked against the finished depth hierarchy, as the view does for drawables
+    PODVector<BoundingBox> testBoxes;
+    for (unsigned i = 0; i < 2000; ++i)
+    {
+        Vector3 center(Random(-80.0f, 80.0f), Random(-10.0f, 10.0f), Random(5.0f, 150.0f));
+        testBoxes.Push(BoundingBox(center - Vector3::ONE, center + Vector3::ONE));
+    }
+
+    SharedPtr<Node> cameraNode(new Node(context_));
+    Camera* camera = cameraNode->CreateComponent<Camera>();
+    camera->SetFarClip(300.0f);
+    camera->SetAspectRatio(16.0f / 9.0f);
+
+    static const unsigned maxTriangles[] = { 1000, 5000, 20000 };
+
+    for (unsigned threaded = 0; threaded < 2; ++threaded)
+    {
+        SharedPtr<OcclusionBuffer> buffer(new OcclusionBuffer(context_));
+        buffer->SetSize(256, 144, threaded != 0);
+        buffer->SetView(camera);
+
+        for (unsigned j = 0; j < sizeof maxTriangles / sizeof maxTriangles[0]; ++j)
+        {
+            unsigned triangles = 0;
+            unsigned visible = 0;
+
+            HiresTimer timer;
+            for (unsigned k = 0; k < iterations; ++k)
+            {
+                buffer->SetMaxTriangles(maxTriangles[j]);
+                buffer->Clear();
+                // Like the view, draw each occluder immediately when not threaded, otherwise submit all first
+                for (unsigned i = 0; i < occluders.Size(); ++i)
+                {
+                    bool success = buffer->AddTriangles(occluders[i], &boxVertices[0], sizeof(Vector3), boxIndices, sizeof(unsigned short),
+                        0, 36);
+                    if (!threaded)
+                        buffer->DrawTriangles();
+                    if (!success)
+                        break;
+                }
+                if (threaded)
+                    buffer->DrawTriangles();
+                buffer->BuildDepthHierarchy();
+
+                for (unsigned i = 0; i < testBoxes.Size(); ++i)
+                {
+                    if (buffer->IsVisible(testBoxes[i]))
+                        ++visible;
+                }
+                triangles = buffer->GetNumTriangles();
+            }
+            long long usec = timer.GetUSec(false);
+
+            PrintResult("Occlusion " + String(threaded ? "threaded" : "serial") + " max " + String(maxTriangles[j]) + " triangles", usec,
+                iterations, triangles, "triangles");
+            PrintLine("  " + String(visible / iterations) + "/" + String(testBoxes.Size()) + " test boxes visible");
+        }
+    }
+}
+
+void BenchmarkMorph()
+{
+    const unsigned numModels = 16;
+    const unsigned numVertices = 20000;
+    const unsigned numMorphs = 8;
+    const unsigned elementMask = MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT;
+
+    unsigned iterations = iterations_ ? iterations_ : 100;
+
+    SetRandomSeed(1);
+
+    SharedPtr<VertexBuffer> vertexBuffer(new VertexBuffer(context_));
+    vertexBuffer->SetShadowed(true);
+    vertexBuffer->SetSize(numVertices, elementMask);
+    PODVector<float> vertexData(numVertices * vertexBuffer->GetVertexSize() / sizeof(float));
+    for (unsigned i = 0; i < vertexData.Size(); ++i)
+        vertexData[i] = Random(-1.0f, 1.0f);
+    vertexBuffer->SetData(&vertexData[0]);
+
+    SharedPtr<IndexBuffer> indexBuffer(new IndexBuffer(context_));
+    indexBuffer->SetShadowed(true);
+    indexBuffer->SetSize(numVertices, true);
+    PODVector<unsigned> indexData(numVertices);
+    for (unsigned i = 0; i < numVertices; ++i)
+        indexData[i] = i;
+    indexBuffer->SetData(&indexData[0]);
+
+    SharedPtr<Geometry> geometry(new Geometry(context_));
+    geometry->SetVertexBuffer(0, vertexBuffer);
+    geometry->SetIndexBuffer(indexBuffer);
+    geometry->SetDrawRange(TRIANGLE_LIST, 0, numVertices - numVertices % 3);
+
+    // Each morph moves the position, normal and tangent of every other vertex, at a different starting vertex
+    Vector<ModelMorph> morphs;
+    unsigned morphedVertices = 0;
+    for (unsigned i = 0; i < numMorphs; ++i)
+    {
+        VertexBufferMorph bufferMorph;
+        bufferMorph.elementMask_ = MASK_POSITION | MASK_NORMAL | MASK_TANGENT;
+        bufferMorph.vertexCount_ = numVertices / 2;
+        bufferMorph.dataSize_ = bufferMorph.vertexCount_ * (sizeof(unsigned) + 9 * sizeof(float));
+        bufferMorph.morphData_ = new unsigned char[bufferMorph.dataSize_];
+
+        unsigned char* dest = bufferMorph.morphData_.Get();
+        for (unsigned j = 0; j < bufferMorph.vertexCount_; ++j)
+        {
+            *((unsigned*)dest) = j * 2 + (i & 1);
+            dest += sizeof(unsigned);
+            for (unsigned k = 0; k < 9; ++k)
+            {
+                *((float*)dest) = Random(-0.1f, 0.1f);
+                dest += sizeof(float);
+            }
+        }
+
+        ModelMorph morph;
+        morph.name_ = "Morph" + String(i);
+        morph.nameHash_ = morph.name_;
+        morph.weight_ = 0.0f;
+        morph.buffers_[0] = bufferMorph;
+        morphs.Push(morph);
+        morphedVertices += bufferMorph.vertexCount_;
+    }
+
+    SharedPtr<Model> model(new Model(context_));
+    Vector<SharedPtr<VertexBuffer> > vertexBuffers;
+    vertexBuffers.Push(vertexBuffer);
+    Vector<SharedPtr<IndexBuffer> > indexBuffers;
+    indexBuffers.Push(indexBuffer);
+    PODVector<unsigned> morphRangeStarts;
+    morphRangeStarts.Push(0);
+    PODVector<unsigned> morphRangeCounts;
+    morphRangeCounts.Push(numVertices);
+    model->SetVertexBuffers(vertexBuffers, morphRangeStarts, morphRangeCounts);
+    model->SetIndexBuffers(indexBuffers);
+    model->SetNumGeometries(1);
+    model->SetGeometry(0, 0, geometry);
+    model->SetMorphs(morphs);
+    model->SetBoundingBox(BoundingBox(-Vector3::ONE, Vector3::ONE));
+
+    Vector<SharedPtr<Node> > nodes;
+    PODVector<AnimatedModel*> animatedModels;
+    for (unsigned i = 0; i < numModels; ++i)
+    {
+        SharedPtr<Node> node(new Node(context_));
+        AnimatedModel* animatedModel = node->CreateComponent<AnimatedModel>();
+        animatedModel->SetModel(model);
+        nodes.Push(node);
+        animatedModels.Push(animatedModel);
+    }
+
+    FrameInfo frame;
+    frame.timeStep_ = 1.0f / 60.0f;
+    frame.viewSize_ = IntVector2(1024, 768);
+    frame.camera_ = 0;
+
+    HiresTimer timer;
+    for (unsigned k = 0; k < iterations; ++k)
+    {
+        frame.frameNumber_ = k + 1;
+        // Change all weights every frame so that the morphs are reapplied
+        for (unsigned i = 0; i < numModels; ++i)
+        {
+            for (unsigned j = 0; j < numMorphs; ++j)
+                animatedModels[i]->SetMorphWeight(j, 0.1f + 0.8f * (float)((k + i + j) % 8) / 7.0f);
+            animatedModels[i]->UpdateGeometry(frame);
+        }
+    }
+    long long usec = timer.GetUSec(false);
+
+    PrintResult("Morph " + String(numModels) + " models, " + String(numVertices) + " vertices, " + String(numMorphs) + " morphs", usec,
+        iterations, numModels * morphedVertices, "morphed vertices");
+
+    // Sum of the morphed vertex data, to compare the results between builds
+    VertexBuffer* morphBuffer = animatedModels[0]->GetMorphVertexBuffers()[0];
+    const float* morphData = (const float*)morphBuffer->GetShadowData();
+    double checksum = 0.0;
+    for (unsigned i = 0; i < numVertices * morphBuffer->GetVertexSize() / sizeof(float); ++i)
+        checksum += morphData[i];
+    PrintLine("  Checksum " + String(checksum));
+}
+
+void CreateTestScene(Scene* scene, unsigned numGroups, unsigned numChildren, bool physics)
+{
+    SetRandomSeed(1);
+
+    scene->CreateComponent<Octree>();
+
+    for (unsigned i = 0; i < numGroups; ++i)
+    {
+        Node* groupNode = scene->CreateChild("Group" + String(i));
+        groupNode->SetPosition(Vector3(Random(-500.0f, 500.0f), 0.0f, Random(-500.0f, 500.0f)));
+        groupNode->SetVar("Index", i);
+
+        for (unsigned j = 0; j < numChildren; ++j)
+        {
+            Node* node = groupNode->CreateChild("Object" + String(j));
+            node->SetPosition(Vector3(Random(-20.0f, 20.0f), Random(0.0f, 10.0f), Random(-20.0f, 20.0f)));
+            node->SetRotation(Quaternion(Random(360.0f), Vector3::UP));
+            node->SetScale(Random(0.5f, 2.0f));
+
+            StaticModel* staticModel = node->CreateComponent<StaticModel>();
+            staticModel->SetCastShadows(true);
+            if (j % 10 == 0)
+            {
+                Light* light = node->CreateComponent<Light>();
+                light->SetLightType(LIGHT_POINT);
+                light->SetRange(Random(5.0f, 20.0f));
+                light->SetColor(Color(Random(), Random(), Random()));
+            }
+#ifdef URHO3D_PHYSICS
+            if (physics)
+            {
+                RigidBody* body = node->CreateComponent<RigidBody>();
+                body->SetMass(Random(1.0f, 10.0f));
+                CollisionShape* shape = node->CreateComponent<CollisionShape>();
+                shape->SetBox(Vector3(Random(0.5f, 2.0f), Random(0.5f, 2.0f), Random(0.5f, 2.0f)));
+            }
+#endif
+        }
+    }
+}
+
+void BenchmarkSceneLoad()
+{
+    unsigned iterations = iterations_ ? iterations_ : 10;
+
+    FileSystem* fileSystem = context_->GetSubsystem<FileSystem>();
+    String path = fileSystem->GetCurrentDir();
+    const String fileNames[] = { path + "BenchmarkSceneColumnar.bin", path + "BenchmarkScene.bin", path + "BenchmarkScene.xml" };
+    const String formatNames[] = { "columnar", "binary", "XML" };
+
+    // Save the same scene in all formats
+    unsigned numNodes;
+    unsigned numComponents;
+    {
+        SharedPtr<Scene> scene(new Scene(context_));
+        CreateTestScene(scene, 100, 100, true);
+        PODVector<Node*> nodes;
+        scene->GetChildren(nodes, true);
+        numNodes = nodes.Size();
+        numComponents = scene->GetNumComponents();
+        for (unsigned i = 0; i < nodes.Size(); ++i)
+            numComponents += nodes[i]->GetNumComponents();
+
+        File columnarFile(context_, fileNames[0], FILE_WRITE);
+        File binaryFile(context_, fileNames[1], FILE_WRITE);
+        File xmlFile(context_, fileNames[2], FILE_WRITE);
+        if (!scene->SaveColumnar(columnarFile) || !scene->Save(binaryFile) || !scene->SaveXML(xmlFile))
+            ErrorExit("Could not save the test scene");
+    }
+
+    PrintLine("Scene with " + String(numNodes) + " nodes and " + String(numComponents) + " components");
+
+    // Load into a new scene each time so that nothing is retained from the previous load
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        long long usec = 0;
+        unsigned fileSize = 0;
+        for (unsigned k = 0; k < iterations; ++k)
+        {
+            SharedPtr<Scene> scene(new Scene(context_));
+            HiresTimer timer;
+            File file(context_, fileNames[i]);
+            fileSize = file.GetSize();
+            bool success = i < 2 ? scene->Load(file) : scene->LoadXML(file);
+            usec += timer.GetUSec(false);
+            if (!success || scene->GetNumChildren(true) != numNodes)
+                ErrorExit("Could not load the test scene from " + fileNames[i]);
+        }
+
+        PrintResult("Load " + formatNames[i] + ", " + String(fileSize) + " bytes", usec, iterations, numNodes, "nodes");
+    }
+
+    for (unsigned i = 0; i < 3; ++i)
+        fileSystem->Delete(fileNames[i]);
+}
+
+void BenchmarkPrefab()
+{
+    unsigned iterations = iterations_ ? iterations_ : 1000;
+
+    // Use one group of the test scene as the object to instantiate. Leave out physics: as the physics world is not stepped,
+    // the broadphase would keep all rigid bodies where they were added before the instance transform was set, and their
+    // overlap would dominate the spawn time
+    VectorBuffer binaryData;
+    VectorBuffer xmlData;
+    unsigned numNodes;
+    {
+        SharedPtr<Scene> scene(new Scene(context_));
+        CreateTestScene(scene, 1, 20, false);
+        Node* groupNode = scene->GetChild("Group0");
+        numNodes = groupNode->GetNumChildren(true) + 1;
+        groupNode->Save(binaryData);
+        groupNode->SaveXML(xmlData);
+    }
+
+    SharedPtr<Prefab> prefab(new Prefab(context_));
+    MemoryBuffer prefabSource(binaryData.GetData(), binaryData.GetSize());
+    if (!prefab->LoadNode(prefabSource))
+        ErrorExit("Could not load the prefab");
+
+    PrintLine("Object with " + String(numNodes) + " nodes and " + String(prefab->GetNumComponents()) + " components");
+
+    PODVector<Vector3> positions;
+    for (unsigned i = 0; i < iterations; ++i)
+        positions.Push(Vector3(Random(-500.0f, 500.0f), 0.0f, Random(-500.0f, 500.0f)));
+
+    const char* methodNames[] = { "prefab", "prefab batch", "binary", "XML" };
+
+    // Spawn into a new scene with each method, so that all start from the same scene size. The first round is not printed,
+    // as it only grows the heap to its steady state size
+    for (unsigned round = 0; round < 5; ++round)
+    {
+        unsigned i = round ? round - 1 : 0;
+        SharedPtr<Scene> scene(new Scene(context_));
+        scene->CreateComponent<Octree>();
+
+        HiresTimer timer;
+        if (i == 1)
+        {
+            PODVector<Node*> instances;
+            scene->Instantiate(prefab, positions, PODVector<Quaternion>(), instances);
+        }
+        else
+        {
+            for (unsigned k = 0; k < iterations; ++k)
+            {
+                if (i == 0)
+                    scene->Instantiate(prefab, positions[k], Quaternion::IDENTITY);
+                else
+                {
+                    MemoryBuffer source(i == 2 ? binaryData.GetData() : xmlData.GetData(), i == 2 ? binaryData.GetSize() :
+                        xmlData.GetSize());
+                    if (i == 2)
+                        scene->Instantiate(source, positions[k], Quaternion::IDENTITY);
+                    else
+                        scene->InstantiateXML(source, positions[k], Quaternion::IDENTITY);
+                }
+            }
+        }
+        long long usec = timer.GetUSec(false);
+
+        if (scene->GetNumChildren(true) != iterations * numNodes)
+            ErrorExit("Could not instantiate the object using " + String(methodNames[i]));
+        if (round)
+            PrintResult("Instantiate " + String(methodNames[i]), usec, iterations, numNodes, "nodes");
+    }
+}
+
+void SumWork(const WorkItem* item, unsigned threadIndex)
+{
+    int sum = 0;
+    for (const int* i = reinterpret_cast<const int*>(item->start_); i != reinterpret_cast<const int*>(item->end_); ++i)
+        sum += *i;
+    SDL_AtomicAdd(&workQueueSum_, sum);
+}
+
+void SplitSumWork(const WorkItem* item, unsigned threadIndex)
+{
+    int* start = reinterpret_cast<int*>(item->start_);
+    int* end = reinterpret_cast<int*>(item->end_);
+
+    // Split in halves until the ranges are as small as the items added from the main thread
+    if (end - start > 256)
+    {
+        WorkQueue* queue = reinterpret_cast<WorkQueue*>(item->aux_);
+        int* middle = start + (end - start) / 2;
+        queue->AddChildWorkItem(const_cast<WorkItem*>(item), threadIndex, SplitSumWork, start, middle, queue);
+        queue->AddChildWorkItem(const_cast<WorkItem*>(item), threadIndex, SplitSumWork, middle, end, queue);
+    }
+    else
+        SumWork(item, threadIndex);
+}
+
+void BenchmarkWorkQueue()
+{
+    const unsigned numValues = 1024 * 1024;
+    const unsigned valuesPerItem = 256;
+    const unsigned numItems = numValues / valuesPerItem;
+
+    unsigned iterations = iterations_ ? iterations_ : 100;
+    WorkQueue* queue = context_->GetSubsystem<WorkQueue>();
+
+    PODVector<int> values(numValues);
+    for (unsigned i = 0; i < numValues; ++i)
+        values[i] = 1;
+
+    // Add all items from the main thread
+    {
+        HiresTimer timer;
+        for (unsigned k = 0; k < iterations; ++k)
+        {
+            SDL_AtomicSet(&workQueueSum_, 0);
+            for (unsigned i = 0; i < numItems; ++i)
+            {
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = SumWork;
+                item->start_ = &values[i * valuesPerItem];
+                item->end_ = &values[i * valuesPerItem] + valuesPerItem;
+                queue->AddWorkItem(item);
+            }
+            queue->Complete(M_MAX_UNSIGNED);
+        }
+        long long usec = timer.GetUSec(false);
+
+        if (SDL_AtomicGet(&workQueueSum_) != (int)numValues)
+            ErrorExit("Wrong result from work items");
+        PrintResult("Work items added from main thread", usec, iterations, numItems, "items");
+    }
+
+    // Add one item, which splits its range recursively into child items
+    {
+        HiresTimer timer;
+        for (unsigned k = 0; k < iterations; ++k)
+        {
+            SDL_AtomicSet(&workQueueSum_, 0);
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = SplitSumWork;
+            item->start_ = &values[0];
+            item->end_ = &values[0] + numValues;
+            item->aux_ = queue;
+            queue->AddWorkItem(item);
+            queue->Complete(M_MAX_UNSIGNED);
+        }
+        long long usec = timer.GetUSec(false);
+
+        if (SDL_AtomicGet(&workQueueSum_) != (int)numValues)
+            ErrorExit("Wrong result from child work items");
+        PrintResult("Work items split into child items", usec, iterations, numItems, "leaf items");
+    }
+}
+
+template <class T> void BenchmarkMap(const String& name, const PODVector<StringHash>& keys, const PODVector<StringHash>& missingKeys,
+    unsigned iterations)
+{
+    // Process enough maps at a time to have each phase take well over the timer resolution
+    unsigned numMaps = Max(16384 / (int)keys.Size(), 1);
+
+    long long insertUsec = 0;
+    long long findUsec = 0;
+    long long iterateUsec = 0;
+    long long eraseUsec = 0;
+    unsigned found = 0;
+    unsigned sum = 0;
+
+    for (unsigned k = 0; k < iterations; ++k)
+    {
+        Vector<T> maps(numMaps);
+
+        HiresTimer timer;
+        for (unsigned j = 0; j < numMaps; ++j)
+        {
+            for (unsigned i = 0; i < keys.Size(); ++i)
+                maps[j][keys[i]] = i;
+        }
+        insertUsec += timer.GetUSec(true);
+
+        // Look up each key once, and as many keys that are not in the map
+        for (unsigned j = 0; j < numMaps; ++j)
+        {
+            for (unsigned i = 0; i < keys.Size(); ++i)
+            {
+                if (maps[j].Find(keys[i]) != maps[j].End())
+                    ++found;
+                if (maps[j].Find(missingKeys[i]) != maps[j].End())
+                    ++found;
+            }
+        }
+        findUsec += timer.GetUSec(true);
+
+        for (unsigned j = 0; j < numMaps; ++j)
+        {
+            for (typename T::ConstIterator i = maps[j].Begin(); i != maps[j].End(); ++i)
+                sum += i->second_;
+        }
+        iterateUsec += timer.GetUSec(true);
+
+        for (unsigned j = 0; j < numMaps; ++j)
+        {
+            for (unsigned i = 0; i < keys.Size(); ++i)
+                maps[j].Erase(keys[i]);
+        }
+        eraseUsec += timer.GetUSec(true);
+    }
+
+    if (found != iterations * numMaps * keys.Size() || sum != iterations * numMaps * (keys.Size() * (keys.Size() - 1) / 2))
+        ErrorExit("Wrong result from " + name);
+
+    iterations *= numMaps;
+    PrintResult(name + " insert", insertUsec, iterations, keys.Size(), "keys");
+    PrintResult(name + " find", findUsec, iterations, keys.Size() * 2, "keys");
+    PrintResult(name + " iterate", iterateUsec, iterations, keys.Size(), "keys");
+    PrintResult(name + " erase", eraseUsec, iterations, keys.Size(), "keys");
+}
+
+void BenchmarkHashMap()
+{
+    static const unsigned sizes[] = { 16, 256, 16384 };
+    unsigned iterations = iterations_ ? iterations_ : 20;
+
+    for (unsigned j = 0; j < sizeof sizes / sizeof sizes[0]; ++j)
+    {
+        // Random unique keys, and the same amount of keys that are not in the map
+        SetRandomSeed(1);
+        HashSet<StringHash> usedKeys;
+        PODVector<StringHash> keys;
+        PODVector<StringHash> missingKeys;
+        while (missingKeys.Size() < sizes[j])
+        {
+            StringHash key((unsigned)Rand() << 16 | (unsigned)Rand());
+            if (usedKeys.Contains(key))
+                continue;
+            usedKeys.Insert(key);
+            if (keys.Size() < sizes[j])
+                keys.Push(key);
+            else
+                missingKeys.Push(key);
+        }
+
+        PrintLine(String(sizes[j]) + " keys:");
+        BenchmarkMap<HashMap<StringHash, unsigned> >("  HashMap", keys, missingKeys, iterations);
+        BenchmarkMap<FlatHashMap<StringHash, unsigned> >("  FlatHashMap", keys, missingKeys, iterations);
+    }
+}
+
+float MatrixSum(const float* data, unsigned count)
+{
+    float sum = 0.0f;
+    for (unsigned i = 0; i < count; ++i)
+        sum += data[i];
+    return sum;
+}
+
+void BenchmarkMath()
+{
+    static const unsigned numItems = 4096;
+
+    unsigned iterations = iterations_ ? iterations_ : 500;
+
+    #ifdef URHO3D_SSE
+    PrintLine("Math implementation: SSE");
+    #elif defined(URHO3D_NEON)
+    PrintLine("Math implementation: NEON");
+    #else
+    PrintLine("Math implementation: scalar");
+    #endif
+
+    // Random transforms, rotations and boxes, generated from a constant seed
+    SetRandomSeed(1);
+    PODVector<Matrix3x4> transforms(numItems);
+    PODVector<Matrix4> projections(numItems);
+    PODVector<Quaternion> rotations(numItems);
+    PODVector<Vector3> points(numItems);
+    PODVector<BoundingBox> boxes(numItems);
+    for (unsigned i = 0; i < numItems; ++i)
+    {
+        Vector3 position(Random(-100.0f, 100.0f), Random(-100.0f, 100.0f), Random(-100.0f, 100.0f));
+        rotations[i] = Quaternion(Random(-180.0f, 180.0f), Random(-180.0f, 180.0f), Random(-180.0f, 180.0f));
+        transforms[i] = Matrix3x4(position, rotations[i], Random(0.5f, 2.0f));
+        projections[i] = transforms[i].ToMatrix4();
+        points[i] = Vector3(Random(-10.0f, 10.0f), Random(-10.0f, 10.0f), Random(-10.0f, 10.0f));
+        boxes[i] = BoundingBox(points[i], points[i] + Vector3(Random(0.1f, 5.0f), Random(0.1f, 5.0f), Random(0.1f, 5.0f)));
+    }
+
+    // Each operation combines item i with item i + 1 so that the inputs differ. The checksums of the results show whether
+    // different implementations agree
+    {
+        PODVector<Matrix3x4> results(numItems);
+        HiresTimer timer;
+        for (unsigned k = 0; k < iterations; ++k)
+        {
+            for (unsigned i = 0; i < numItems; ++i)
+                results[i] = transforms[i] * transforms[(i + 1) & (numItems - 1)];
+        }
+        long long usec = timer.GetUSec(false);
+
+        float checksum = 0.0f;
+        for (unsigned i = 0; i < numItems; ++i)
+            checksum += MatrixSum(results[i].Data(), 12);
+        PrintResult("Matrix3x4 * Matrix3x4 (checksum " + String(checksum) + ")", usec, iterations, numItems, "ops");
+    }
+
+    {
+        PODVector<Vector3> results(numItems);
+        HiresTimer timer;
+        for (unsigned k = 0; k < iterations; ++k)
+        {
+            for (unsigned i = 0; i < numItems; ++i)
+                results[i] = transforms[i] * points[(i + 1) & (numItems - 1)];
+        }
+        long long usec = timer.GetUSec(false);
+
+        float checksum = 0.0f;
+        for (unsigned i = 0; i < numItems; ++i)
+            checksum += results[i].x_ + results[i].y_ + results[i].z_;
+        PrintResult("Matrix3x4 * Vector3 (checksum " + String(checksum) + ")", usec, iterations, numItems, "ops");
+    }
+
+    {
+        PODVector<Matrix4> results(numItems);
+        HiresTimer timer;
+        for (unsigned k = 0; k < iterations; ++k)
+        {
+            for (unsigned i = 0; i < numItems; ++i)
+                results[i] = projections[i] * projections[(i + 1) & (numItems - 1)];
+        }
+        long long usec = timer.GetUSec(false);
+
+        float checksum = 0.0f;
+        for (unsigned i = 0; i < numItems; ++i)
+            checksum += MatrixSum(results[i].Data(), 16);
+        PrintResult("Matrix4 * Matrix4 (checksum " + String(checksum) + ")", usec, iterations, numItems, "ops");
+    }
+
+    {
+        PODVector<Vector4> results(numItems);
+        HiresTimer timer;
+        for (unsigned k = 0; k < iterations; ++k)
+        {
+            for (unsigned i = 0; i < numItems; ++i)
+                results[i] = projections[i] * Vector4(points[(i + 1) & (numItems - 1)], 1.0f);
+        }
+        long long usec = timer.GetUSec(false);
+
+        float checksum = 0.0f;
+        for (unsigned i = 0; i < numItems; ++i)
+            checksum += results[i].x_ + results[i].y_ + results[i].z_ + results[i].w_;
+        PrintResult("Matrix4 * Vector4 (checksum " + String(checksum) + ")", usec, iterations, numItems, "ops");
+    }
+
+    {
+        PODVector<Quaternion> results(numItems);
+        HiresTimer timer;
+        for (unsigned k = 0; k < iterations; ++k)
+        {
+            for (unsigned i = 0; i < numItems; ++i)
+                results[i] = rotations[i] * rotations[(i + 1) & (numItems - 1)];
+        }
+        long long usec = timer.GetUSec(false);
+
+        float checksum = 0.0f;
+        for (unsigned i = 0; i < numItems; ++i)
+            checksum += results[i].w_ + results[i].x_ + results[i].y_ + results[i].z_;
+        PrintResult("Quaternion * Quaternion (checksum " + String(checksum) + ")", usec, iterations, numItems, "ops");
+    }
+
+    {
+        PODVector<Quaternion> results(numItems);
+        HiresTimer timer;
+        for (unsigned k = 0; k < iterations; ++k)
+        {
+            for (unsigned i = 0; i < numItems; ++i)
+                results[i] = rotations[i].Slerp(rotations[(i + 1) & (numItems - 1)], 0.25f);
+        }
+        long long usec = timer.GetUSec(false);
+
+        float checksum = 0.0f;
+        for (unsigned i = 0; i < numItems; ++i)
+            checksum += results[i].w_ + results[i].x_ + results[i].y_ + results[i].z_;
+        PrintResult("Quaternion::Slerp (checksum " + String(checksum) + ")", usec, iterations, numItems, "ops");
+    }
+
+    {
+        PODVector<BoundingBox> results(numItems);
+        HiresTimer timer;
+        for (unsigned k = 0; k < iterations; ++k)
+        {
+            for (unsigned i = 0; i < numItems; ++i)
+                results[i] = boxes[i].Transformed(transforms[(i + 1) & (numItems - 1)]);
+        }
+        long long usec = timer.GetUSec(false);
+
+        float checksum = 0.0f;
+        for (unsigned i = 0; i < numItems; ++i)
+            checksum += results[i].Size().x_ + results[i].Size().y_ + results[i].Size().z_;
+        PrintResult("BoundingBox::Transformed (checksum " + String(checksum) + ")", usec, iterations, numItems, "ops");
+    }
+}
+
+SharedPtr<Animation> CreateTestAnimation(unsigned numBones, float length, float keyRate)
+{
+    // Motion capture style animation: every channel of every bone is keyed, but only the root moves and no bone scales
+    SetRandomSeed(1);
+    SharedPtr<Animation> animation(new Animation(context_));
+    animation->SetLength(length);
+    unsigned numKeyFrames = (unsigned)(length * keyRate) + 1;
+
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        AnimationTrack* track = animation->CreateTrack("Bone" + String(i));
+        track->channelMask_ = CHANNEL_POSITION | CHANNEL_ROTATION | CHANNEL_SCALE;
+
+        Vector3 offset(Random(-0.5f, 0.5f), Random(0.1f, 0.5f), Random(-0.5f, 0.5f));
+        Vector3 frequency(Random(20.0f, 120.0f), Random(20.0f, 120.0f), Random(20.0f, 120.0f));
+        Vector3 amplitude(Random(5.0f, 60.0f), Random(5.0f, 60.0f), Random(5.0f, 60.0f));
+
+        for (unsigned j = 0; j < numKeyFrames; ++j)
+        {
+            AnimationKeyFrame keyFrame;
+            keyFrame.time_ = (float)j / keyRate;
+            keyFrame.position_ = i ? offset : Vector3(Sin(keyFrame.time_ * 36.0f), 1.0f, keyFrame.time_);
+            keyFrame.rotation_ = Quaternion(amplitude.x_ * Sin(keyFrame.time_ * frequency.x_), amplitude.y_ *
+                Sin(keyFrame.time_ * frequency.y_), amplitude.z_ * Sin(keyFrame.time_ * frequency.z_));
+            track->AddKeyFrame(keyFrame);
+        }
+    }
+
+    return animation;
+}
+
+void BenchmarkAnimation()
+{
+    static const unsigned numBones = 60;
+    static const float length = 10.0f;
+    static const float keyRate = 30.0f;
+    static const float frameRate = 60.0f;
+
+    unsigned iterations = iterations_ ? iterations_ : 20;
+
+    SharedPtr<Animation> animations[2];
+    animations[0] = CreateTestAnimation(numBones, length, keyRate);
+    animations[1] = CreateTestAnimation(numBones, length, keyRate);
+    animations[1]->Compress();
+    const char* names[] = { "Keyframes", "Compressed" };
+
+    for (unsigned j = 0; j < 2; ++j)
+    {
+        const HashMap<StringHash, AnimationTrack>& tracks = animations[j]->GetTracks();
+        unsigned memoryUse = 0;
+        for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks.Begin(); i != tracks.End(); ++i)
+            memoryUse += i->second_.GetKeyFrameMemoryUse();
+        VectorBuffer file;
+        animations[j]->Save(file);
+        PrintLine(String(names[j]) + ": " + String(memoryUse) + " bytes of keyframes, " + String(file.GetSize()) + " bytes saved");
+    }
+
+    // Accuracy of the compressed animation against the keyframes
+    {
+        const HashMap<StringHash, AnimationTrack>& tracks = animations[0]->GetTracks();
+        float maxPositionError = 0.0f;
+        float maxRotationError = 0.0f;
+        for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks.Begin(); i != tracks.End(); ++i)
+        {
+            const AnimationTrack* compressedTrack = animations[1]->GetTrack(i->first_);
+            unsigned index = 0;
+            unsigned compressedIndex = 0;
+            for (float time = 0.0f; time <= length; time += 1.0f / frameRate)
+            {
+                AnimationKeyFrame original;
+                AnimationKeyFrame compressed;
+                i->second_.Sample(time, length, false, index, original);
+                compressedTrack->Sample(time, length, false, compressedIndex, compressed);
+                maxPositionError = Max(maxPositionError, (compressed.position_ - original.position_).Length());
+                maxRotationError = Max(maxRotationError, 2.0f * Acos(Abs(compressed.rotation_.DotProduct(original.rotation_))));
+            }
+        }
+        PrintLine("Compressed maximum error: " + String(maxPositionError) + " units, " + String(maxRotationError) + " degrees");
+    }
+
+    // Sample every track like an animation state would, first during playback and then at random times
+    unsigned numFrames = (unsigned)(length * frameRate);
+    PODVector<float> randomTimes(numFrames);
+    for (unsigned i = 0; i < numFrames; ++i)
+        randomTimes[i] = Random(length);
+
+    for (unsigned j = 0; j < 2; ++j)
+    {
+        const HashMap<StringHash, AnimationTrack>& tracks = animations[j]->GetTracks();
+        PODVector<const AnimationTrack*> trackPtrs;
+        for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks.Begin(); i != tracks.End(); ++i)
+            trackPtrs.Push(&i->second_);
+        PODVector<unsigned> indices(trackPtrs.Size());
+
+        for (unsigned mode = 0; mode < 2; ++mode)
+        {
+            for (unsigned i = 0; i < indices.Size(); ++i)
+                indices[i] = 0;
+            float checksum = 0.0f;
+
+            HiresTimer timer;
+            for (unsigned k = 0; k < iterations; ++k)
+            {
+                for (unsigned f = 0; f < numFrames; ++f)
+                {
+                    float time = mode ? randomTimes[f] : (float)f / frameRate;
+                    for (unsigned i = 0; i < trackPtrs.Size(); ++i)
+                    {
+                        AnimationKeyFrame keyFrame;
+                        trackPtrs[i]->Sample(time, length, true, indices[i], keyFrame);
+                        checksum += keyFrame.rotation_.w_;
+                    }
+                }
+            }
+            long long usec = timer.GetUSec(false);
+
+            PrintResult(String(names[j]) + (mode ? " random" : " playback") + " (checksum " + String(checksum) + ")", usec,
+                iterations, numFrames * trackPtrs.Size(), "samples");
+        }
+    }
+}
+
+SharedPtr<Model> CreateBoxModel()
+{
+    // Unit box with positions and normals, the same size as Models/Box.mdl
+    static const unsigned short boxIndices[] = {
+        0, 1, 2, 0, 2, 3,
+        4, 5, 6, 4, 6, 7,
+        8, 9, 10, 8, 10, 11,
+        12, 13, 14, 12, 14, 15,
+        16, 17, 18, 16, 18, 19,
+        20, 21, 22, 20, 22, 23
+    };
+
+    static const Vector3 normals[] = {
+        Vector3::LEFT, Vector3::RIGHT, Vector3::DOWN, Vector3::UP, Vector3::BACK, Vector3::FORWARD
+    };
+
+    // Four corners around each face
+    PODVector<float> vertexData;
+    for (unsigned i = 0; i < 6; ++i)
+    {
+        const Vector3& normal = normals[i];
+        Vector3 tangent = 0.5f * Vector3(normal.z_, normal.x_, normal.y_);
+        Vector3 bitangent = normal.CrossProduct(tangent);
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            Vector3 position = 0.5f * normal + (j == 1 || j == 2 ? tangent : -tangent) + (j >= 2 ? bitangent : -bitangent);
+            vertexData.Push(position.x_);
+            vertexData.Push(position.y_);
+            vertexData.Push(position.z_);
+            vertexData.Push(normal.x_);
+            vertexData.Push(normal.y_);
+            vertexData.Push(normal.z_);
+        }
+    }
+
+    SharedPtr<VertexBuffer> vertexBuffer(new VertexBuffer(context_));
+    vertexBuffer->SetShadowed(true);
+    vertexBuffer->SetSize(24, MASK_POSITION | MASK_NORMAL);
+    vertexBuffer->SetData(&vertexData[0]);
+
+    SharedPtr<IndexBuffer> indexBuffer(new IndexBuffer(context_));
+    indexBuffer->SetShadowed(true);
+    indexBuffer->SetSize(36, false);
+    indexBuffer->SetData(boxIndices);
+
+    SharedPtr<Geometry> geometry(new Geometry(context_));
+    geometry->SetVertexBuffer(0, vertexBuffer);
+    geometry->SetIndexBuffer(indexBuffer);
+    geometry->SetDrawRange(TRIANGLE_LIST, 0, 36);
+
+    SharedPtr<Model> model(new Model(context_));
+    Vector<SharedPtr<VertexBuffer> > vertexBuffers;
+    vertexBuffers.Push(vertexBuffer);
+    Vector<SharedPtr<IndexBuffer> > indexBuffers;
+    indexBuffers.Push(indexBuffer);
+    PODVector<unsigned> morphRangeStarts;
+    morphRangeStarts.Push(0);
+    PODVector<unsigned> morphRangeCounts;
+    morphRangeCounts.Push(0);
+    model->SetVertexBuffers(vertexBuffers, morphRangeStarts, morphRangeCounts);
+    model->SetIndexBuffers(indexBuffers);
+    model->SetNumGeometries(1);
+    model->SetGeometry(0, 0, geometry);
+    model->SetBoundingBox(BoundingBox(-0.5f, 0.5f));
+    return model;
+}
+
+void CreateBoxGrid(Scene* scene, int size, Model* model, Vector<SharedPtr<Node> >& boxNodes)
+{
+    // Same layout as in the HugeObjectCount sample
+    for (int y = -size / 2; y < size / 2; ++y)
+    {
+        for (int x = -size / 2; x < size / 2; ++x)
+        {
+            Node* boxNode = scene->CreateChild("Box");
+            boxNode->SetPosition(Vector3(x * 0.3f, 0.0f, y * 0.3f));
+            boxNode->SetScale(0.25f);
+            StaticModel* boxObject = boxNode->CreateComponent<StaticModel>();
+            boxObject->SetModel(model);
+            boxNodes.Push(SharedPtr<Node>(boxNode));
+        }
+    }
+}
+
+void BenchmarkOctree()
+{
+    static const int gridSize = 250;
+
+    unsigned iterations = iterations_ ? iterations_ : 100;
+
+    SharedPtr<Model> model = CreateBoxModel();
+
+    for (unsigned mode = 0; mode < 2; ++mode)
+    {
+        SetRandomSeed(1);
+        SharedPtr<Scene> scene(new Scene(context_));
+        Octree* octree = scene->CreateComponent<Octree>();
+        Vector<SharedPtr<Node> > boxNodes;
+        CreateBoxGrid(scene, gridSize, model, boxNodes);
+
+        // In move mode each box moves in its own direction, crossing octant boundaries, and bounces back from the grid edge
+        PODVector<Vector3> velocities(boxNodes.Size());
+        for (unsigned i = 0; i < velocities.Size(); ++i)
+            velocities[i] = Vector3(Random(-20.0f, 20.0f), Random(-5.0f, 5.0f), Random(-20.0f, 20.0f));
+
+        FrameInfo frame;
+        frame.timeStep_ = 1.0f / 60.0f;
+        frame.viewSize_ = IntVector2(1024, 768);
+        frame.camera_ = 0;
+
+        // Insert the boxes to their octants before the measurement
+        frame.frameNumber_ = 1;
+        octree->Update(frame);
+
+        Quaternion rotateQuat(15.0f * frame.timeStep_, Vector3::FORWARD);
+        long long animateUsec = 0;
+        long long updateUsec = 0;
+
+        HiresTimer timer;
+        for (unsigned k = 0; k < iterations; ++k)
+        {
+            frame.frameNumber_ = k + 2;
+
+            timer.Reset();
+            if (!mode)
+            {
+                for (unsigned i = 0; i < boxNodes.Size(); ++i)
+                    boxNodes[i]->Rotate(rotateQuat);
+            }
+            else
+            {
+                for (unsigned i = 0; i < boxNodes.Size(); ++i)
+                {
+                    Vector3 position = boxNodes[i]->GetPosition() + velocities[i] * frame.timeStep_;
+                    Vector3& velocity = velocities[i];
+                    if (Abs(position.x_) > 100.0f)
+                        velocity.x_ = -velocity.x_;
+                    if (Abs(position.y_) > 100.0f)
+                        velocity.y_ = -velocity.y_;
+                    if (Abs(position.z_) > 100.0f)
+                        velocity.z_ = -velocity.z_;
+                    boxNodes[i]->SetPosition(position);
+                }
+            }
+            animateUsec += timer.GetUSec(true);
+
+            octree->Update(frame);
+            updateUsec += timer.GetUSec(false);
+        }
+
+        // Sum of the octant centers, to compare the drawable placement between builds
+        double checksum = 0.0;
+        for (unsigned i = 0; i < boxNodes.Size(); ++i)
+        {
+            Vector3 center = boxNodes[i]->GetComponent<StaticModel>()->GetOctant()->GetWorldBoundingBox().Center();
+            checksum += center.x_ + 2.0 * center.y_ + 4.0 * center.z_;
+        }
+
+        String name = mode ? "Move " : "Rotate ";
+        PrintResult(name + String(boxNodes.Size()) + " boxes", animateUsec, iterations, boxNodes.Size(), "boxes");
+        PrintResult("  Octree update (checksum " + String(checksum) + ")", updateUsec, iterations, boxNodes.Size(), "boxes");
+    }
+}
@@ -45,6 +45,7 @@ struct FileEntry
     unsigned offset_;
     unsigned size_;
     unsigned checksum_;
+    PODVector<unsigned> blockOffsets_;
 };
 
 SharedPtr<Context> context_(new Context());
@@ -53,6 +54,7 @@ String basePath_;
 Vector<FileEntry> entries_;
 unsigned checksum_ = 0;
 bool compress_ = false;
+bool writeIndex_ = false;
 bool quiet_ = false;
 unsigned blockSize_ = COMPRESSED_BLOCK_SIZE;
 
@@ -90,6 +92,7 @@ void Run(const Vector<String>& arguments)
             "\n"
             "Options:\n"
             "-c      Enable package file LZ4 compression\n"
+            "-i      Enable package file LZ4 compression and write a block index for random access\n"
             "-q      Enable quiet mode\n"
         );
 
@@ -110,6 +113,10 @@ void Run(const Vector<String>& arguments)
                     case 'c':
                         compress_ = true;
                         break;
+                    case 'i':
+                        compress_ = true;
+                        writeIndex_ = true;
+                        break;
                     case 'q':
                         quiet_ = true;
                         break;
@@ -235,6 +242,7 @@ void WritePackageFile(const String& fileName, const String& rootDir)
                 if (!packedSize)
                     ErrorExit("LZ4 compression failed for file " + entries_[i].name_ + " at offset " + pos);
 
+                entries_[i].blockOffsets_.Push(dest.GetSize() - entries_[i].offset_);
                 dest.WriteUShort(unpackedSize);
                 dest.WriteUShort(packedSize);
                 dest.Write(compressBuffer.Get(), packedSize);
@@ -248,6 +256,21 @@ void WritePackageFile(const String& fileName, const String& rootDir)
         }
     }
 
+    // Write block index of all files followed by its ID, block size and offset, so that the package size stays last
+    if (writeIndex_)
+    {
+        unsigned indexOffset = dest.GetSize();
+        for (unsigned i = 0; i < entries_.Size(); ++i)
+        {
+            for (unsigned j = 0; j < entries_[i].blockOffsets_.Size(); ++j)
+                dest.WriteUInt(entries_[i].blockOffsets_[j]);
+        }
+
+        dest.WriteFileID("UBIX");
+        dest.WriteUInt(blockSize_);
+        dest.WriteUInt(indexOffset);
+    }
+
     // Write package size to the end of file to allow finding it linked to an executable file
     unsigned currentSize = dest.GetSize();
     dest.WriteUInt(currentSize + sizeof(unsigned));
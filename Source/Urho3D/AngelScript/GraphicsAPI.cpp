@@ -24,6 +24,7 @@
 
 #include "../AngelScript/APITemplates.h"
 #include "../Graphics/AnimatedModel.h"
+#include "../Graphics/AnimationScheduler.h"
 #include "../Graphics/Animation.h"
 #include "../Graphics/AnimationController.h"
 #include "../Graphics/AnimationState.h"
@@ -983,6 +984,7 @@ static void RegisterAnimation(asIScriptEngine* engine)
     engine->RegisterObjectMethod("AnimationTrack", "void set_keyFrames(uint, const AnimationKeyFrame&in)", asMETHOD(AnimationTrack, SetKeyFrame), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimationTrack", "const AnimationKeyFrame& get_keyFrames(uint) const", asMETHOD(AnimationTrack, GetKeyFrame), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimationTrack", "uint get_numKeyFrames() const", asMETHOD(AnimationTrack, GetNumKeyFrames), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationTrack", "bool get_compressed() const", asMETHOD(AnimationTrack, IsCompressed), asCALL_THISCALL);
     engine->RegisterObjectProperty("AnimationTrack", "uint8 channelMask", offsetof(AnimationTrack, channelMask_));
     engine->RegisterObjectProperty("AnimationTrack", "const String name", offsetof(AnimationTrack, name_));
     engine->RegisterObjectProperty("AnimationTrack", "const StringHash nameHash", offsetof(AnimationTrack, nameHash_));
@@ -1002,12 +1004,15 @@ static void RegisterAnimation(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Animation", "void AddTrigger(float, bool, const Variant&in)", asMETHODPR(Animation, AddTrigger, (float, bool, const Variant&), void), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "void RemoveTrigger(uint)", asMETHOD(Animation, RemoveTrigger), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "void RemoveAllTriggers()", asMETHOD(Animation, RemoveAllTriggers), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Animation", "void Compress(float sampleRate = 0.0f, bool looped = false)", asMETHOD(Animation, Compress), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Animation", "void Decompress()", asMETHOD(Animation, Decompress), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "void set_animationName(const String&in) const", asMETHOD(Animation, SetAnimationName), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "const String& get_animationName() const", asMETHOD(Animation, GetAnimationName), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "void set_length(float)", asMETHOD(Animation, SetLength), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "float get_length() const", asMETHOD(Animation, GetLength), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "AnimationTrack@+ get_tracks(const String&in)", asMETHODPR(Animation, GetTrack, (const String&), AnimationTrack*), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "uint get_numTracks() const", asMETHOD(Animation, GetNumTracks), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Animation", "bool get_compressed() const", asMETHOD(Animation, IsCompressed), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "void set_numTriggers(uint)", asMETHOD(Animation, SetNumTriggers), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "uint get_numTriggers() const", asMETHOD(Animation, GetNumTriggers), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "void set_triggers(uint, const AnimationTriggerPoint&in)", asMETHOD(Animation, SetTrigger), asCALL_THISCALL);
@@ -1722,6 +1727,8 @@ static void RegisterRenderer(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Renderer", "int get_minInstances() const", asMETHOD(Renderer, GetMinInstances), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_maxSortedInstances(int)", asMETHOD(Renderer, SetMaxSortedInstances), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "int get_maxSortedInstances() const", asMETHOD(Renderer, GetMaxSortedInstances), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_retainBatchGroups(bool)", asMETHOD(Renderer, SetRetainBatchGroups), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "bool get_retainBatchGroups() const", asMETHOD(Renderer, GetRetainBatchGroups), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_maxOccluderTriangles(int)", asMETHOD(Renderer, SetMaxOccluderTriangles), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "int get_maxOccluderTriangles() const", asMETHOD(Renderer, GetMaxOccluderTriangles), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_occlusionBufferSize(int)", asMETHOD(Renderer, SetOcclusionBufferSize), asCALL_THISCALL);
@@ -1730,6 +1737,10 @@ static void RegisterRenderer(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Renderer", "float get_occluderSizeThreshold() const", asMETHOD(Renderer, GetOccluderSizeThreshold), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_threadedOcclusion(bool)", asMETHOD(Renderer, SetThreadedOcclusion), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "bool get_threadedOcclusion() const", asMETHOD(Renderer, GetThreadedOcclusion), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_temporalOcclusion(bool)", asMETHOD(Renderer, SetTemporalOcclusion), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "bool get_temporalOcclusion() const", asMETHOD(Renderer, GetTemporalOcclusion), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_occlusionRetestFrames(int)", asMETHOD(Renderer, SetOcclusionRetestFrames), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "int get_occlusionRetestFrames() const", asMETHOD(Renderer, GetOcclusionRetestFrames), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_mobileShadowBiasMul(float)", asMETHOD(Renderer, SetMobileShadowBiasMul), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "float get_mobileShadowBiasMul() const", asMETHOD(Renderer, GetMobileShadowBiasMul), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_mobileShadowBiasAdd(float)", asMETHOD(Renderer, SetMobileShadowBiasAdd), asCALL_THISCALL);
@@ -1744,6 +1755,26 @@ static void RegisterRenderer(asIScriptEngine* engine)
     engine->RegisterGlobalFunction("Renderer@+ get_renderer()", asFUNCTION(GetRenderer), asCALL_CDECL);
 }
 
+static AnimationScheduler* GetAnimationScheduler()
+{
+    return GetScriptContext()->GetSubsystem<AnimationScheduler>();
+}
+
+static void RegisterAnimationScheduler(asIScriptEngine* engine)
+{
+    RegisterObject<AnimationScheduler>(engine, "AnimationScheduler");
+    engine->RegisterObjectMethod("AnimationScheduler", "void set_boneBudget(uint)", asMETHOD(AnimationScheduler, SetBoneBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationScheduler", "uint get_boneBudget() const", asMETHOD(AnimationScheduler, GetBoneBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationScheduler", "void set_interpolation(bool)", asMETHOD(AnimationScheduler, SetInterpolation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationScheduler", "bool get_interpolation() const", asMETHOD(AnimationScheduler, GetInterpolation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationScheduler", "uint get_numModels() const", asMETHOD(AnimationScheduler, GetNumModels), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationScheduler", "uint get_numUpdatedModels() const", asMETHOD(AnimationScheduler, GetNumUpdatedModels), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationScheduler", "uint get_numDeferredModels() const", asMETHOD(AnimationScheduler, GetNumDeferredModels), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationScheduler", "uint get_numInterpolatedModels() const", asMETHOD(AnimationScheduler, GetNumInterpolatedModels), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationScheduler", "uint get_numUpdatedBones() const", asMETHOD(AnimationScheduler, GetNumUpdatedBones), asCALL_THISCALL);
+    engine->RegisterGlobalFunction("AnimationScheduler@+ get_animationScheduler()", asFUNCTION(GetAnimationScheduler), asCALL_CDECL);
+}
+
 static DebugRenderer* GetDebugRenderer()
 {
     Scene* scene = GetScriptContextScene();
@@ -1946,6 +1977,7 @@ void RegisterGraphicsAPI(asIScriptEngine* engine)
     RegisterOctree(engine);
     RegisterGraphics(engine);
     RegisterRenderer(engine);
+    RegisterAnimationScheduler(engine);
     RegisterOBJExport(engine);
 }
 
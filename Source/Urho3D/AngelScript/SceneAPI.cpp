@@ -26,6 +26,7 @@
 #include "../Graphics/DebugRenderer.h"
 #include "../IO/PackageFile.h"
 #include "../Scene/ObjectAnimation.h"
+#include "../Scene/Prefab.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SmoothedTransform.h"
 #include "../Scene/SplinePath.h"
@@ -163,6 +164,23 @@ static bool SceneSaveXMLVectorBuffer(VectorBuffer& buffer, const String& indenta
     return ptr->SaveXML(buffer, indentation);
 }
 
+static bool SceneSaveColumnar(File* file, Scene* ptr)
+{
+    return file && ptr->SaveColumnar(*file);
+}
+
+static bool SceneSaveColumnarVectorBuffer(VectorBuffer& buffer, Scene* ptr)
+{
+    return ptr->SaveColumnar(buffer);
+}
+
+static CScriptArray* SceneInstantiatePrefabs(Prefab* prefab, CScriptArray* positions, CScriptArray* rotations, CreateMode mode, Scene* ptr)
+{
+    PODVector<Node*> nodes;
+    ptr->Instantiate(prefab, ArrayToPODVector<Vector3>(positions), ArrayToPODVector<Quaternion>(rotations), nodes, mode);
+    return VectorToHandleArray<Node>(nodes, "Array<Node@>");
+}
+
 static Node* SceneInstantiate(File* file, const Vector3& position, const Quaternion& rotation, CreateMode mode, Scene* ptr)
 {
     return file ? ptr->Instantiate(*file, position, rotation, mode) : 0;
@@ -279,6 +297,8 @@ static void RegisterScene(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Scene", "bool LoadXML(VectorBuffer&)", asFUNCTION(SceneLoadXMLVectorBuffer), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Scene", "bool SaveXML(File@+, const String&in indentation = \"\t\")", asFUNCTION(SceneSaveXML), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Scene", "bool SaveXML(VectorBuffer&, const String&in indentation = \"\t\")", asFUNCTION(SceneSaveXMLVectorBuffer), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Scene", "bool SaveColumnar(File@+)", asFUNCTION(SceneSaveColumnar), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Scene", "bool SaveColumnar(VectorBuffer&)", asFUNCTION(SceneSaveColumnarVectorBuffer), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Scene", "bool LoadAsync(File@+, LoadMode mode = LOAD_SCENE_AND_RESOURCES)", asMETHOD(Scene, LoadAsync), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "bool LoadAsyncXML(File@+, LoadMode mode = LOAD_SCENE_AND_RESOURCES)", asMETHOD(Scene, LoadAsyncXML), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "void StopAsyncLoading()", asMETHOD(Scene, StopAsyncLoading), asCALL_THISCALL);
@@ -288,6 +308,8 @@ static void RegisterScene(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Scene", "Node@+ InstantiateXML(VectorBuffer&, const Vector3&in, const Quaternion&in, CreateMode mode = REPLICATED)", asFUNCTION(SceneInstantiateXMLVectorBuffer), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Scene", "Node@+ InstantiateXML(XMLFile@+, const Vector3&in, const Quaternion&in, CreateMode mode = REPLICATED)", asFUNCTION(SceneInstantiateXMLFile), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Scene", "Node@+ InstantiateXML(const XMLElement&in, const Vector3&in, const Quaternion&in, CreateMode mode = REPLICATED)", asMETHODPR(Scene, InstantiateXML, (const XMLElement&, const Vector3&, const Quaternion&, CreateMode), Node*), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Scene", "Node@+ Instantiate(Prefab@+, const Vector3&in, const Quaternion&in, CreateMode mode = REPLICATED)", asMETHODPR(Scene, Instantiate, (Prefab*, const Vector3&, const Quaternion&, CreateMode), Node*), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Scene", "Array<Node@>@ Instantiate(Prefab@+, Array<Vector3>@+, Array<Quaternion>@+, CreateMode mode = REPLICATED)", asFUNCTION(SceneInstantiatePrefabs), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Scene", "void Clear(bool clearReplicated = true, bool clearLocal = true)", asMETHOD(Scene, Clear), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "void AddRequiredPackageFile(PackageFile@+)", asMETHOD(Scene, AddRequiredPackageFile), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "void ClearRequiredPackageFiles()", asMETHOD(Scene, ClearRequiredPackageFiles), asCALL_THISCALL);
@@ -323,11 +345,19 @@ static void RegisterScene(asIScriptEngine* engine)
     engine->RegisterGlobalFunction("Array<String>@ GetObjectsByCategory(const String&in)", asFUNCTION(GetObjectsByCategory), asCALL_CDECL);
 }
 
+static void RegisterPrefab(asIScriptEngine* engine)
+{
+    RegisterResource<Prefab>(engine, "Prefab");
+    engine->RegisterObjectMethod("Prefab", "uint get_numNodes() const", asMETHOD(Prefab, GetNumNodes), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Prefab", "uint get_numComponents() const", asMETHOD(Prefab, GetNumComponents), asCALL_THISCALL);
+}
+
 void RegisterSceneAPI(asIScriptEngine* engine)
 {
     RegisterSerializable(engine);
     RegisterValueAnimation(engine);
     RegisterObjectAnimation(engine);
+    RegisterPrefab(engine);
     RegisterAnimatable(engine);
     RegisterNode(engine);
     RegisterSmoothedTransform(engine);
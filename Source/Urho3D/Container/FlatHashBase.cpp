@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2008-2015 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/FlatHashBase.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+void FlatHashBase::AllocateSlots(unsigned numSlots)
+{
+    FlatHashSlot* oldSlots = slots_;
+    unsigned oldNumSlots = numSlots_;
+
+    slots_ = new FlatHashSlot[numSlots];
+    numSlots_ = numSlots;
+    shift_ = 32;
+    while (numSlots > 1)
+    {
+        numSlots >>= 1;
+        --shift_;
+    }
+
+    ResetSlots();
+
+    if (oldSlots)
+    {
+        for (unsigned i = 0; i < oldNumSlots; ++i)
+        {
+            if (oldSlots[i].index_ != FREE_SLOT)
+                InsertSlot(oldSlots[i].hash_, oldSlots[i].index_);
+        }
+
+        delete[] oldSlots;
+    }
+}
+
+void FlatHashBase::ResetSlots()
+{
+    for (unsigned i = 0; i < numSlots_; ++i)
+        slots_[i].index_ = FREE_SLOT;
+}
+
+void FlatHashBase::EraseSlot(unsigned slot)
+{
+    unsigned mask = numSlots_ - 1;
+    unsigned next = slot;
+
+    for (;;)
+    {
+        next = (next + 1) & mask;
+        if (slots_[next].index_ == FREE_SLOT)
+            break;
+
+        // A slot can be moved to the hole only if its home slot is not cyclically between the hole and itself
+        unsigned home = HomeSlot(slots_[next].hash_);
+        if (slot <= next ? (slot < home && home <= next) : (slot < home || home <= next))
+            continue;
+
+        slots_[slot] = slots_[next];
+        slot = next;
+    }
+
+    slots_[slot].index_ = FREE_SLOT;
+}
+
+unsigned FlatHashBase::FindSlotByIndex(unsigned hash, unsigned index) const
+{
+    if (!slots_)
+        return FREE_SLOT;
+
+    unsigned mask = numSlots_ - 1;
+    for (unsigned slot = HomeSlot(hash); slots_[slot].index_ != FREE_SLOT; slot = (slot + 1) & mask)
+    {
+        if (slots_[slot].index_ == index)
+            return slot;
+    }
+
+    return FREE_SLOT;
+}
+
+}
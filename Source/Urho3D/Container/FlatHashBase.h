@@ -0,0 +1,129 @@
+//
+// Copyright (c) 2008-2015 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef URHO3D_IS_BUILDING
+#include "Urho3D.h"
+#else
+#include <Urho3D/Urho3D.h>
+#endif
+
+#include "../Container/Hash.h"
+#include "../Container/Swap.h"
+
+namespace Urho3D
+{
+
+/// Open addressing hash set/map slot. Refers to an element in the contiguous element storage.
+struct FlatHashSlot
+{
+    /// Full hash of the element's key.
+    unsigned hash_;
+    /// Index of the element, or FlatHashBase::FREE_SLOT if not in use.
+    unsigned index_;
+};
+
+/// Open addressing hash set/map base class. Keeps a linear probing slot table which refers to the elements stored contiguously by the subclass.
+/** Note that to prevent extra memory use due to vtable pointer, %FlatHashBase intentionally does not declare a virtual destructor
+    and therefore %FlatHashBase pointers should never be used.
+  */
+class URHO3D_API FlatHashBase
+{
+public:
+    /// Initial amount of slots.
+    static const unsigned MIN_SLOTS = 16;
+    /// Element index of a free slot, also returned when a slot is not found.
+    static const unsigned FREE_SLOT = 0xffffffff;
+
+    /// Construct.
+    FlatHashBase() :
+        slots_(0),
+        numSlots_(0),
+        shift_(32)
+    {
+    }
+
+    /// Destruct.
+    ~FlatHashBase()
+    {
+        delete[] slots_;
+    }
+
+    /// Swap with another hash set or map.
+    void Swap(FlatHashBase& rhs)
+    {
+        Urho3D::Swap(slots_, rhs.slots_);
+        Urho3D::Swap(numSlots_, rhs.numSlots_);
+        Urho3D::Swap(shift_, rhs.shift_);
+    }
+
+    /// Return number of slots.
+    unsigned NumSlots() const { return numSlots_; }
+
+protected:
+    /// Reallocate the slot table to a power of two size, rehashing the existing slots.
+    void AllocateSlots(unsigned numSlots);
+    /// Mark all slots free.
+    void ResetSlots();
+    /// Ensure there are enough slots to keep the load factor at most 3/4 with the specified number of elements. Return true if the slot table grew.
+    bool ReserveSlots(unsigned size)
+    {
+        if (size * 4 <= numSlots_ * 3)
+            return false;
+
+        unsigned numSlots = numSlots_ ? numSlots_ : MIN_SLOTS;
+        while (size * 4 > numSlots * 3)
+            numSlots <<= 1;
+        AllocateSlots(numSlots);
+        return true;
+    }
+    /// Return how many elements fit in the slot table before it must grow.
+    unsigned SlotCapacity() const { return numSlots_ / 4 * 3; }
+    /// Insert a slot for an element which is known not to exist yet. There must be a free slot.
+    void InsertSlot(unsigned hash, unsigned index)
+    {
+        unsigned mask = numSlots_ - 1;
+        unsigned slot = HomeSlot(hash);
+        while (slots_[slot].index_ != FREE_SLOT)
+            slot = (slot + 1) & mask;
+
+        slots_[slot].hash_ = hash;
+        slots_[slot].index_ = index;
+    }
+    /// Free a slot, shifting the following slots of the probe sequence back so that lookups do not need tombstones.
+    void EraseSlot(unsigned slot);
+    /// Return the slot referring to an element index, or FREE_SLOT if not found.
+    unsigned FindSlotByIndex(unsigned hash, unsigned index) const;
+
+    /// Return the preferred slot of a hash. Fibonacci hashing spreads out also sequential and aligned pointer hashes.
+    unsigned HomeSlot(unsigned hash) const { return (hash * 2654435769U) >> shift_; }
+
+    /// Slot table.
+    FlatHashSlot* slots_;
+    /// Number of slots, zero or a power of two.
+    unsigned numSlots_;
+    /// Right shift of the multiplied hash to obtain the home slot.
+    unsigned shift_;
+};
+
+}
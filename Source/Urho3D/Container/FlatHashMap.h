@@ -0,0 +1,319 @@
+//
+// Copyright (c) 2008-2015 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+#include "../Container/Pair.h"
+#include "../Container/Vector.h"
+
+namespace Urho3D
+{
+
+/// Open addressing hash map template class. Stores the key-value pairs contiguously without per-node allocation, which makes
+/// lookup and iteration cache-friendly. Unlike HashMap, erasing moves the last pair into the erased position, so iteration
+/// order is not insertion order, and inserting or erasing invalidates pointers to the pairs.
+template <class T, class U> class FlatHashMap : public FlatHashBase
+{
+public:
+    typedef T KeyType;
+    typedef U ValueType;
+    /// Key-value pair. The key must not be modified through an iterator.
+    typedef Pair<T, U> KeyValue;
+    /// Pair iterator.
+    typedef typename Vector<KeyValue>::Iterator Iterator;
+    /// Pair const iterator.
+    typedef typename Vector<KeyValue>::ConstIterator ConstIterator;
+
+    /// Construct empty.
+    FlatHashMap()
+    {
+    }
+
+    /// Construct from another hash map.
+    FlatHashMap(const FlatHashMap<T, U>& map)
+    {
+        *this = map;
+    }
+
+    /// Assign a hash map.
+    FlatHashMap& operator =(const FlatHashMap<T, U>& rhs)
+    {
+        if (&rhs != this)
+        {
+            pairs_ = rhs.pairs_;
+            delete[] slots_;
+            slots_ = 0;
+            numSlots_ = 0;
+            if (rhs.slots_)
+            {
+                slots_ = new FlatHashSlot[rhs.numSlots_];
+                numSlots_ = rhs.numSlots_;
+                shift_ = rhs.shift_;
+                for (unsigned i = 0; i < numSlots_; ++i)
+                    slots_[i] = rhs.slots_[i];
+            }
+        }
+        return *this;
+    }
+
+    /// Add-assign a pair.
+    FlatHashMap& operator +=(const Pair<T, U>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Add-assign a hash map.
+    FlatHashMap& operator +=(const FlatHashMap<T, U>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Test for equality with another hash map.
+    bool operator ==(const FlatHashMap<T, U>& rhs) const
+    {
+        if (rhs.Size() != Size())
+            return false;
+
+        for (ConstIterator i = Begin(); i != End(); ++i)
+        {
+            ConstIterator j = rhs.Find(i->first_);
+            if (j == rhs.End() || j->second_ != i->second_)
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another hash map.
+    bool operator !=(const FlatHashMap<T, U>& rhs) const { return !(*this == rhs); }
+
+    /// Index the map. Create a new pair if key not found.
+    U& operator [](const T& key)
+    {
+        unsigned hash = MakeHash(key);
+        unsigned slot = FindSlot(key, hash);
+        return slot != FREE_SLOT ? pairs_[slots_[slot].index_].second_ : pairs_[InsertPair(key, U(), hash)].second_;
+    }
+
+    /// Index the map. Return null if key is not found, does not create a new pair.
+    U* operator [](const T& key) const
+    {
+        unsigned slot = FindSlot(key, MakeHash(key));
+        return slot != FREE_SLOT ? const_cast<U*>(&pairs_[slots_[slot].index_].second_) : 0;
+    }
+
+    /// Insert a pair. Return an iterator to it.
+    Iterator Insert(const Pair<T, U>& pair)
+    {
+        unsigned hash = MakeHash(pair.first_);
+        unsigned slot = FindSlot(pair.first_, hash);
+        if (slot != FREE_SLOT)
+        {
+            // If exists, just change the value
+            unsigned index = slots_[slot].index_;
+            pairs_[index].second_ = pair.second_;
+            return pairs_.Begin() + index;
+        }
+        else
+            return pairs_.Begin() + InsertPair(pair.first_, pair.second_, hash);
+    }
+
+    /// Insert a map.
+    void Insert(const FlatHashMap<T, U>& map)
+    {
+        for (ConstIterator i = map.Begin(); i != map.End(); ++i)
+            Insert(*i);
+    }
+
+    /// Erase a pair by key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        unsigned slot = FindSlot(key, MakeHash(key));
+        if (slot == FREE_SLOT)
+            return false;
+
+        EraseAt(slot);
+        return true;
+    }
+
+    /// Erase a pair by iterator. Return iterator to the next pair, which is the previously last pair moved into the erased position.
+    Iterator Erase(const Iterator& it)
+    {
+        unsigned index = (unsigned)(it - pairs_.Begin());
+        if (index >= pairs_.Size())
+            return End();
+
+        EraseAt(FindSlotByIndex(MakeHash(it->first_), index));
+        return pairs_.Begin() + index;
+    }
+
+    /// Clear the map.
+    void Clear()
+    {
+        pairs_.Clear();
+        ResetSlots();
+    }
+
+    /// Reserve room for a number of pairs to avoid reallocation and rehashing while inserting.
+    void Reserve(unsigned size)
+    {
+        pairs_.Reserve(size);
+        ReserveSlots(size);
+    }
+
+    /// Swap with another hash map.
+    void Swap(FlatHashMap<T, U>& rhs)
+    {
+        FlatHashBase::Swap(rhs);
+        pairs_.Swap(rhs.pairs_);
+    }
+
+    /// Return iterator to the pair with key, or end iterator if not found.
+    Iterator Find(const T& key)
+    {
+        unsigned slot = FindSlot(key, MakeHash(key));
+        return slot != FREE_SLOT ? pairs_.Begin() + slots_[slot].index_ : End();
+    }
+
+    /// Return const iterator to the pair with key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        unsigned slot = FindSlot(key, MakeHash(key));
+        return slot != FREE_SLOT ? pairs_.Begin() + slots_[slot].index_ : End();
+    }
+
+    /// Return whether contains a pair with key.
+    bool Contains(const T& key) const { return FindSlot(key, MakeHash(key)) != FREE_SLOT; }
+
+    /// Return all the keys.
+    Vector<T> Keys() const
+    {
+        Vector<T> result;
+        result.Reserve(Size());
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->first_);
+        return result;
+    }
+
+    /// Return all the values.
+    Vector<U> Values() const
+    {
+        Vector<U> result;
+        result.Reserve(Size());
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->second_);
+        return result;
+    }
+
+    /// Return iterator to the beginning.
+    Iterator Begin() { return pairs_.Begin(); }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return pairs_.Begin(); }
+
+    /// Return iterator to the end.
+    Iterator End() { return pairs_.End(); }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return pairs_.End(); }
+
+    /// Return first pair.
+    const KeyValue& Front() const { return pairs_.Front(); }
+
+    /// Return last pair.
+    const KeyValue& Back() const { return pairs_.Back(); }
+
+    /// Return number of elements.
+    unsigned Size() const { return pairs_.Size(); }
+
+    /// Return whether has no elements.
+    bool Empty() const { return pairs_.Empty(); }
+
+private:
+    /// Return the slot of a key, or FREE_SLOT if not found.
+    unsigned FindSlot(const T& key, unsigned hash) const
+    {
+        if (!slots_)
+            return FREE_SLOT;
+
+        unsigned mask = numSlots_ - 1;
+        for (unsigned slot = HomeSlot(hash); slots_[slot].index_ != FREE_SLOT; slot = (slot + 1) & mask)
+        {
+            if (slots_[slot].hash_ == hash && pairs_[slots_[slot].index_].first_ == key)
+                return slot;
+        }
+
+        return FREE_SLOT;
+    }
+
+    /// Append a pair whose key is known not to exist. Return its index.
+    unsigned InsertPair(const T& key, const U& value, unsigned hash)
+    {
+        unsigned index = pairs_.Size();
+        // Grow the pair storage in step with the slot table instead of reallocating it many times in between
+        if (ReserveSlots(index + 1) && pairs_.Capacity() < SlotCapacity())
+            pairs_.Reserve(SlotCapacity());
+        InsertSlot(hash, index);
+        pairs_.Push(KeyValue(key, value));
+        return index;
+    }
+
+    /// Erase the pair referred to by a slot. Move the last pair into its place.
+    void EraseAt(unsigned slot)
+    {
+        unsigned index = slots_[slot].index_;
+        unsigned last = pairs_.Size() - 1;
+        EraseSlot(slot);
+
+        if (index != last)
+        {
+            slots_[FindSlotByIndex(MakeHash(pairs_[last].first_), last)].index_ = index;
+            pairs_[index] = pairs_[last];
+        }
+
+        pairs_.Pop();
+    }
+
+    /// Key-value pairs.
+    Vector<KeyValue> pairs_;
+};
+
+}
+
+namespace std
+{
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::ConstIterator begin(const Urho3D::FlatHashMap<T, U>& v)
+{
+    return v.Begin();
+}
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::ConstIterator end(const Urho3D::FlatHashMap<T, U>& v) { return v.End(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::Iterator begin(Urho3D::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::Iterator end(Urho3D::FlatHashMap<T, U>& v) { return v.End(); }
+
+}
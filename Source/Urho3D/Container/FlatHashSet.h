@@ -0,0 +1,256 @@
+//
+// Copyright (c) 2008-2015 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+#include "../Container/Vector.h"
+
+namespace Urho3D
+{
+
+/// Open addressing hash set template class. Stores the keys contiguously without per-node allocation, which makes lookup and
+/// iteration cache-friendly. Unlike HashSet, erasing moves the last key into the erased position, so iteration order is not
+/// insertion order.
+template <class T> class FlatHashSet : public FlatHashBase
+{
+public:
+    typedef T KeyType;
+    /// Key iterator. Keys can not be modified through it.
+    typedef typename Vector<T>::ConstIterator Iterator;
+    /// Key const iterator.
+    typedef typename Vector<T>::ConstIterator ConstIterator;
+
+    /// Construct empty.
+    FlatHashSet()
+    {
+    }
+
+    /// Construct from another hash set.
+    FlatHashSet(const FlatHashSet<T>& set)
+    {
+        *this = set;
+    }
+
+    /// Assign a hash set.
+    FlatHashSet& operator =(const FlatHashSet<T>& rhs)
+    {
+        if (&rhs != this)
+        {
+            keys_ = rhs.keys_;
+            delete[] slots_;
+            slots_ = 0;
+            numSlots_ = 0;
+            if (rhs.slots_)
+            {
+                slots_ = new FlatHashSlot[rhs.numSlots_];
+                numSlots_ = rhs.numSlots_;
+                shift_ = rhs.shift_;
+                for (unsigned i = 0; i < numSlots_; ++i)
+                    slots_[i] = rhs.slots_[i];
+            }
+        }
+        return *this;
+    }
+
+    /// Add-assign a value.
+    FlatHashSet& operator +=(const T& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Add-assign a hash set.
+    FlatHashSet& operator +=(const FlatHashSet<T>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Test for equality with another hash set.
+    bool operator ==(const FlatHashSet<T>& rhs) const
+    {
+        if (rhs.Size() != Size())
+            return false;
+
+        for (ConstIterator i = Begin(); i != End(); ++i)
+        {
+            if (!rhs.Contains(*i))
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another hash set.
+    bool operator !=(const FlatHashSet<T>& rhs) const { return !(*this == rhs); }
+
+    /// Insert a key. Return an iterator to it.
+    Iterator Insert(const T& key)
+    {
+        bool exists;
+        return Insert(key, exists);
+    }
+
+    /// Insert a key. Return an iterator and set exists flag according to whether the key already existed.
+    Iterator Insert(const T& key, bool& exists)
+    {
+        unsigned hash = MakeHash(key);
+        unsigned slot = FindSlot(key, hash);
+        exists = slot != FREE_SLOT;
+        if (exists)
+            return keys_.Begin() + slots_[slot].index_;
+
+        unsigned index = keys_.Size();
+        // Grow the key storage in step with the slot table instead of reallocating it many times in between
+        if (ReserveSlots(index + 1) && keys_.Capacity() < SlotCapacity())
+            keys_.Reserve(SlotCapacity());
+        InsertSlot(hash, index);
+        keys_.Push(key);
+        return keys_.Begin() + index;
+    }
+
+    /// Insert a set.
+    void Insert(const FlatHashSet<T>& set)
+    {
+        for (ConstIterator i = set.Begin(); i != set.End(); ++i)
+            Insert(*i);
+    }
+
+    /// Erase a key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        unsigned slot = FindSlot(key, MakeHash(key));
+        if (slot == FREE_SLOT)
+            return false;
+
+        EraseAt(slot);
+        return true;
+    }
+
+    /// Erase a key by iterator. Return iterator to the next key, which is the previously last key moved into the erased position.
+    Iterator Erase(const Iterator& it)
+    {
+        unsigned index = (unsigned)(it - keys_.Begin());
+        if (index >= keys_.Size())
+            return End();
+
+        EraseAt(FindSlotByIndex(MakeHash(*it), index));
+        return keys_.Begin() + index;
+    }
+
+    /// Clear the set.
+    void Clear()
+    {
+        keys_.Clear();
+        ResetSlots();
+    }
+
+    /// Reserve room for a number of keys to avoid reallocation and rehashing while inserting.
+    void Reserve(unsigned size)
+    {
+        keys_.Reserve(size);
+        ReserveSlots(size);
+    }
+
+    /// Swap with another hash set.
+    void Swap(FlatHashSet<T>& rhs)
+    {
+        FlatHashBase::Swap(rhs);
+        keys_.Swap(rhs.keys_);
+    }
+
+    /// Return iterator to the key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        unsigned slot = FindSlot(key, MakeHash(key));
+        return slot != FREE_SLOT ? keys_.Begin() + slots_[slot].index_ : End();
+    }
+
+    /// Return whether contains a key.
+    bool Contains(const T& key) const { return FindSlot(key, MakeHash(key)) != FREE_SLOT; }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return keys_.Begin(); }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return keys_.End(); }
+
+    /// Return first key.
+    const T& Front() const { return keys_.Front(); }
+
+    /// Return last key.
+    const T& Back() const { return keys_.Back(); }
+
+    /// Return number of keys.
+    unsigned Size() const { return keys_.Size(); }
+
+    /// Return whether has no keys.
+    bool Empty() const { return keys_.Empty(); }
+
+private:
+    /// Return the slot of a key, or FREE_SLOT if not found.
+    unsigned FindSlot(const T& key, unsigned hash) const
+    {
+        if (!slots_)
+            return FREE_SLOT;
+
+        unsigned mask = numSlots_ - 1;
+        for (unsigned slot = HomeSlot(hash); slots_[slot].index_ != FREE_SLOT; slot = (slot + 1) & mask)
+        {
+            if (slots_[slot].hash_ == hash && keys_[slots_[slot].index_] == key)
+                return slot;
+        }
+
+        return FREE_SLOT;
+    }
+
+    /// Erase the key referred to by a slot. Move the last key into its place.
+    void EraseAt(unsigned slot)
+    {
+        unsigned index = slots_[slot].index_;
+        unsigned last = keys_.Size() - 1;
+        EraseSlot(slot);
+
+        if (index != last)
+        {
+            slots_[FindSlotByIndex(MakeHash(keys_[last]), last)].index_ = index;
+            keys_[index] = keys_[last];
+        }
+
+        keys_.Pop();
+    }
+
+    /// Keys.
+    Vector<T> keys_;
+};
+
+}
+
+namespace std
+{
+
+template <class T> typename Urho3D::FlatHashSet<T>::ConstIterator begin(const Urho3D::FlatHashSet<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::FlatHashSet<T>::ConstIterator end(const Urho3D::FlatHashSet<T>& v) { return v.End(); }
+
+}
@@ -47,7 +47,9 @@ static const unsigned AM_COMPONENTID = 0x20;
 /// Attribute is a node ID vector where first element is the amount of nodes.
 static const unsigned AM_NODEIDVECTOR = 0x40;
 
+class Deserializer;
 class Serializable;
+class Serializer;
 
 /// Abstract base class for invoking attribute accessors.
 class URHO3D_API AttributeAccessor : public RefCounted
@@ -57,6 +59,10 @@ public:
     virtual void Get(const Serializable* ptr, Variant& dest) const = 0;
     /// Set the attribute.
     virtual void Set(Serializable* ptr, const Variant& src) = 0;
+    /// Set the attribute directly from binary data without an intermediate Variant. Return false if not supported, in which case nothing is read.
+    virtual bool Read(Serializable* ptr, Deserializer& source) { return false; }
+    /// Write the attribute directly as binary data without an intermediate Variant. Return false if not supported or if writing failed.
+    virtual bool Write(const Serializable* ptr, Serializer& dest) const { return false; }
 };
 
 /// Description of an automatically serializable variable.
@@ -53,6 +53,59 @@ void RemoveNamedAttribute(HashMap<StringHash, Vector<AttributeInfo> >& attribute
         attributes.Erase(i);
 }
 
+void EventReceiverGroup::EndSendEvent()
+{
+    assert(inSend_ > 0);
+    --inSend_;
+    Compact();
+}
+
+void EventReceiverGroup::Add(Object* receiver)
+{
+    if (!receiver || indices_.Contains(receiver))
+        return;
+
+    indices_[receiver] = receivers_.Size();
+    receivers_.Push(receiver);
+}
+
+void EventReceiverGroup::Remove(Object* receiver)
+{
+    FlatHashMap<Object*, unsigned>::Iterator i = indices_.Find(receiver);
+    if (i == indices_.End())
+        return;
+
+    // Leave a hole to keep both an ongoing send and the subscription order intact
+    receivers_[i->second_] = 0;
+    ++numHoles_;
+    indices_.Erase(i);
+    Compact();
+}
+
+void EventReceiverGroup::Compact()
+{
+    if (inSend_ || numHoles_ * 2 <= receivers_.Size())
+        return;
+
+    unsigned dest = 0;
+    for (unsigned i = 0; i < receivers_.Size(); ++i)
+    {
+        Object* receiver = receivers_[i];
+        if (receiver)
+        {
+            if (dest != i)
+            {
+                receivers_[dest] = receiver;
+                indices_[receiver] = dest;
+            }
+            ++dest;
+        }
+    }
+
+    receivers_.Resize(dest);
+    numHoles_ = 0;
+}
+
 Context::Context() :
     eventHandler_(0)
 {
@@ -82,6 +135,9 @@ Context::~Context()
     for (PODVector<VariantMap*>::Iterator i = eventDataMaps_.Begin(); i != eventDataMaps_.End(); ++i)
         delete *i;
     eventDataMaps_.Clear();
+    for (PODVector<VariantMap*>::Iterator i = noEventDataMaps_.Begin(); i != noEventDataMaps_.End(); ++i)
+        delete *i;
+    noEventDataMaps_.Clear();
 }
 
 SharedPtr<Object> Context::CreateObject(StringHash objectType)
@@ -166,6 +222,17 @@ VariantMap& Context::GetEventDataMap()
     return ret;
 }
 
+VariantMap& Context::GetNoEventDataMap()
+{
+    unsigned nestingLevel = eventSenders_.Size();
+    while (noEventDataMaps_.Size() < nestingLevel + 1)
+        noEventDataMaps_.Push(new VariantMap());
+
+    VariantMap& ret = *noEventDataMaps_[nestingLevel];
+    ret.Clear();
+    return ret;
+}
+
 
 void Context::CopyBaseAttributes(StringHash baseType, StringHash derivedType)
 {
@@ -232,23 +299,33 @@ AttributeInfo* Context::GetAttribute(StringHash objectType, const char* name)
 
 void Context::AddEventReceiver(Object* receiver, StringHash eventType)
 {
-    eventReceivers_[eventType].Insert(receiver);
+    SharedPtr<EventReceiverGroup>& group = eventReceivers_[eventType];
+    if (!group)
+        group = new EventReceiverGroup();
+    group->Add(receiver);
 }
 
 void Context::AddEventReceiver(Object* receiver, Object* sender, StringHash eventType)
 {
-    specificEventReceivers_[sender][eventType].Insert(receiver);
+    SharedPtr<EventReceiverGroup>& group = specificEventReceivers_[sender][eventType];
+    if (!group)
+        group = new EventReceiverGroup();
+    group->Add(receiver);
 }
 
 void Context::RemoveEventSender(Object* sender)
 {
-    HashMap<Object*, HashMap<StringHash, HashSet<Object*> > >::Iterator i = specificEventReceivers_.Find(sender);
+    HashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
     if (i != specificEventReceivers_.End())
     {
-        for (HashMap<StringHash, HashSet<Object*> >::Iterator j = i->second_.Begin(); j != i->second_.End(); ++j)
+        for (HashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator j = i->second_.Begin(); j != i->second_.End(); ++j)
         {
-            for (HashSet<Object*>::Iterator k = j->second_.Begin(); k != j->second_.End(); ++k)
-                (*k)->RemoveEventSender(sender);
+            const PODVector<Object*>& receivers = j->second_->GetReceivers();
+            for (PODVector<Object*>::ConstIterator k = receivers.Begin(); k != receivers.End(); ++k)
+            {
+                if (*k)
+                    (*k)->RemoveEventSender(sender);
+            }
         }
         specificEventReceivers_.Erase(i);
     }
@@ -256,16 +333,16 @@ void Context::RemoveEventSender(Object* sender)
 
 void Context::RemoveEventReceiver(Object* receiver, StringHash eventType)
 {
-    HashSet<Object*>* group = GetEventReceivers(eventType);
+    EventReceiverGroup* group = GetEventReceivers(eventType);
     if (group)
-        group->Erase(receiver);
+        group->Remove(receiver);
 }
 
 void Context::RemoveEventReceiver(Object* receiver, Object* sender, StringHash eventType)
 {
-    HashSet<Object*>* group = GetEventReceivers(sender, eventType);
+    EventReceiverGroup* group = GetEventReceivers(sender, eventType);
     if (group)
-        group->Erase(receiver);
+        group->Remove(receiver);
 }
 
 }
@@ -24,11 +24,53 @@
 
 #include "../Core/Attribute.h"
 #include "../Core/Object.h"
+#include "../Container/FlatHashMap.h"
 #include "../Container/HashSet.h"
 
 namespace Urho3D
 {
 
+/// Receivers of an event type, stored contiguously for fast dispatch. Receivers may be added and removed also during sending.
+class URHO3D_API EventReceiverGroup : public RefCounted
+{
+public:
+    /// Construct.
+    EventReceiverGroup() :
+        inSend_(0),
+        numHoles_(0)
+    {
+    }
+
+    /// Begin event send. Receivers removed during the send leave null holes instead of moving the others.
+    void BeginSendEvent() { ++inSend_; }
+    /// End event send. Remove the holes if necessary.
+    void EndSendEvent();
+    /// Add a receiver if not added yet.
+    void Add(Object* receiver);
+    /// Remove a receiver.
+    void Remove(Object* receiver);
+
+    /// Return the receivers. May contain null holes.
+    const PODVector<Object*>& GetReceivers() const { return receivers_; }
+    /// Return number of receivers.
+    unsigned Size() const { return receivers_.Size() - numHoles_; }
+    /// Return whether has no receivers.
+    bool Empty() const { return Size() == 0; }
+
+private:
+    /// Remove the holes if there are many and no send is in progress.
+    void Compact();
+
+    /// Receivers in subscription order. May contain null holes.
+    PODVector<Object*> receivers_;
+    /// Receiver indices.
+    FlatHashMap<Object*, unsigned> indices_;
+    /// Send nesting level.
+    unsigned inSend_;
+    /// Number of null holes.
+    unsigned numHoles_;
+};
+
 /// Urho3D execution context. Provides access to subsystems, object factories and attributes, and event receivers.
 class URHO3D_API Context : public RefCounted
 {
@@ -121,23 +163,23 @@ public:
     const HashMap<StringHash, Vector<AttributeInfo> >& GetAllAttributes() const { return attributes_; }
 
     /// Return event receivers for a sender and event type, or null if they do not exist.
-    HashSet<Object*>* GetEventReceivers(Object* sender, StringHash eventType)
+    EventReceiverGroup* GetEventReceivers(Object* sender, StringHash eventType)
     {
-        HashMap<Object*, HashMap<StringHash, HashSet<Object*> > >::Iterator i = specificEventReceivers_.Find(sender);
+        HashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
         if (i != specificEventReceivers_.End())
         {
-            HashMap<StringHash, HashSet<Object*> >::Iterator j = i->second_.Find(eventType);
-            return j != i->second_.End() ? &j->second_ : 0;
+            HashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator j = i->second_.Find(eventType);
+            return j != i->second_.End() ? j->second_.Get() : 0;
         }
         else
             return 0;
     }
 
     /// Return event receivers for an event type, or null if they do not exist.
-    HashSet<Object*>* GetEventReceivers(StringHash eventType)
+    EventReceiverGroup* GetEventReceivers(StringHash eventType)
     {
-        HashMap<StringHash, HashSet<Object*> >::Iterator i = eventReceivers_.Find(eventType);
-        return i != eventReceivers_.End() ? &i->second_ : 0;
+        HashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator i = eventReceivers_.Find(eventType);
+        return i != eventReceivers_.End() ? i->second_.Get() : 0;
     }
 
 private:
@@ -152,13 +194,15 @@ private:
     /// Remove event receiver from non-specific events.
     void RemoveEventReceiver(Object* receiver, StringHash eventType);
 
+    /// Return a preallocated empty map for sending an event without parameters. Separate from the event data maps, which the caller may be filling.
+    VariantMap& GetNoEventDataMap();
     /// Set current event handler. Called by Object.
     void SetEventHandler(EventHandler* handler) { eventHandler_ = handler; }
 
     /// Begin event send.
     void BeginSendEvent(Object* sender) { eventSenders_.Push(sender); }
 
-    /// End event send. Clean up event receivers removed in the meanwhile.
+    /// End event send.
     void EndSendEvent() { eventSenders_.Pop(); }
 
     /// Object factories.
@@ -170,13 +214,17 @@ private:
     /// Network replication attribute descriptions per object type.
     HashMap<StringHash, Vector<AttributeInfo> > networkAttributes_;
     /// Event receivers for non-specific events.
-    HashMap<StringHash, HashSet<Object*> > eventReceivers_;
+    HashMap<StringHash, SharedPtr<EventReceiverGroup> > eventReceivers_;
     /// Event receivers for specific senders' events.
-    HashMap<Object*, HashMap<StringHash, HashSet<Object*> > > specificEventReceivers_;
+    HashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > > specificEventReceivers_;
     /// Event sender stack.
     PODVector<Object*> eventSenders_;
+    /// Receivers that have already received the specific event being sent, stacked by nesting level.
+    PODVector<Object*> processedReceivers_;
     /// Event data stack.
     PODVector<VariantMap*> eventDataMaps_;
+    /// Empty event data stack for events sent without parameters.
+    PODVector<VariantMap*> noEventDataMaps_;
     /// Active event handler. Not stored in a stack for performance reasons; is needed only in esoteric cases.
     EventHandler* eventHandler_;
     /// Object categories.
@@ -25,6 +25,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Thread.h"
+#include "../Container/Sort.h"
 #include "../IO/Log.h"
 
 #include "../DebugNew.h"
@@ -32,6 +33,23 @@
 namespace Urho3D
 {
 
+/// Return whether a receiver is found in a sorted range of the processed receivers.
+static bool IsProcessed(const PODVector<Object*>& processed, unsigned start, unsigned end, Object* receiver)
+{
+    while (start < end)
+    {
+        unsigned middle = (start + end) / 2;
+        if (processed[middle] < receiver)
+            start = middle + 1;
+        else if (receiver < processed[middle])
+            end = middle;
+        else
+            return true;
+    }
+
+    return false;
+}
+
 TypeInfo::TypeInfo(const char* typeName, const TypeInfo* baseTypeInfo) :
     type_(typeName),
     typeName_(typeName),
@@ -87,24 +105,7 @@ void Object::OnEvent(Object* sender, StringHash eventType, VariantMap& eventData
 {
     // Make a copy of the context pointer in case the object is destroyed during event handler invocation
     Context* context = context_;
-    EventHandler* specific = 0;
-    EventHandler* nonSpecific = 0;
-
-    EventHandler* handler = eventHandlers_.First();
-    while (handler)
-    {
-        if (handler->GetEventType() == eventType)
-        {
-            if (!handler->GetSender())
-                nonSpecific = handler;
-            else if (handler->GetSender() == sender)
-            {
-                specific = handler;
-                break;
-            }
-        }
-        handler = eventHandlers_.Next(handler);
-    }
+    EventHandler* specific = sender ? FindSpecificEventHandler(sender, eventType) : 0;
 
     // Specific event handlers have priority, so if found, invoke first
     if (specific)
@@ -115,6 +116,7 @@ void Object::OnEvent(Object* sender, StringHash eventType, VariantMap& eventData
         return;
     }
 
+    EventHandler* nonSpecific = FindSpecificEventHandler(0, eventType);
     if (nonSpecific)
     {
         context->SetEventHandler(nonSpecific);
@@ -149,13 +151,7 @@ void Object::SubscribeToEvent(StringHash eventType, EventHandler* handler)
         return;
 
     handler->SetSenderAndEventType(0, eventType);
-    // Remove old event handler first
-    EventHandler* previous;
-    EventHandler* oldHandler = FindSpecificEventHandler(0, eventType, &previous);
-    if (oldHandler)
-        eventHandlers_.Erase(oldHandler, previous);
-
-    eventHandlers_.InsertFront(handler);
+    AddEventHandler(handler);
 
     context_->AddEventReceiver(this, eventType);
 }
@@ -170,13 +166,7 @@ void Object::SubscribeToEvent(Object* sender, StringHash eventType, EventHandler
     }
 
     handler->SetSenderAndEventType(sender, eventType);
-    // Remove old event handler first
-    EventHandler* previous;
-    EventHandler* oldHandler = FindSpecificEventHandler(sender, eventType, &previous);
-    if (oldHandler)
-        eventHandlers_.Erase(oldHandler, previous);
-
-    eventHandlers_.InsertFront(handler);
+    AddEventHandler(handler);
 
     context_->AddEventReceiver(this, sender, eventType);
 }
@@ -193,7 +183,7 @@ void Object::UnsubscribeFromEvent(StringHash eventType)
                 context_->RemoveEventReceiver(this, handler->GetSender(), eventType);
             else
                 context_->RemoveEventReceiver(this, eventType);
-            eventHandlers_.Erase(handler, previous);
+            RemoveEventHandler(handler, previous);
         }
         else
             break;
@@ -210,7 +200,7 @@ void Object::UnsubscribeFromEvent(Object* sender, StringHash eventType)
     if (handler)
     {
         context_->RemoveEventReceiver(this, handler->GetSender(), eventType);
-        eventHandlers_.Erase(handler, previous);
+        RemoveEventHandler(handler, previous);
     }
 }
 
@@ -226,7 +216,7 @@ void Object::UnsubscribeFromEvents(Object* sender)
         if (handler)
         {
             context_->RemoveEventReceiver(this, handler->GetSender(), handler->GetEventType());
-            eventHandlers_.Erase(handler, previous);
+            RemoveEventHandler(handler, previous);
         }
         else
             break;
@@ -244,7 +234,7 @@ void Object::UnsubscribeFromAllEvents()
                 context_->RemoveEventReceiver(this, handler->GetSender(), handler->GetEventType());
             else
                 context_->RemoveEventReceiver(this, handler->GetEventType());
-            eventHandlers_.Erase(handler);
+            RemoveEventHandler(handler, 0);
         }
         else
             break;
@@ -267,7 +257,7 @@ void Object::UnsubscribeFromAllEventsExcept(const PODVector<StringHash>& excepti
             else
                 context_->RemoveEventReceiver(this, handler->GetEventType());
 
-            eventHandlers_.Erase(handler, previous);
+            RemoveEventHandler(handler, previous);
         }
         else
             previous = handler;
@@ -278,9 +268,7 @@ void Object::UnsubscribeFromAllEventsExcept(const PODVector<StringHash>& excepti
 
 void Object::SendEvent(StringHash eventType)
 {
-    VariantMap noEventData;
-
-    SendEvent(eventType, noEventData);
+    SendEvent(eventType, context_->GetNoEventDataMap());
 }
 
 void Object::SendEvent(StringHash eventType, VariantMap& eventData)
@@ -294,97 +282,75 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
     // Make a weak pointer to self to check for destruction during event handling
     WeakPtr<Object> self(this);
     Context* context = context_;
-    HashSet<Object*> processed;
+    // The receivers of the specific event are stacked in the context, so that no allocation is needed after warmup
+    PODVector<Object*>& processed = context->processedReceivers_;
+    unsigned processedStart = processed.Size();
 
     context->BeginSendEvent(this);
 
-    // Check first the specific event receivers
-    const HashSet<Object*>* group = context->GetEventReceivers(this, eventType);
+    // Check first the specific event receivers. Hold a reference to the group, as it is removed if self is destroyed
+    SharedPtr<EventReceiverGroup> group(context->GetEventReceivers(this, eventType));
     if (group)
     {
-        for (HashSet<Object*>::ConstIterator i = group->Begin(); i != group->End();)
+        group->BeginSendEvent();
+
+        // Receivers added during the send are not included. Removed receivers leave holes until the send ends
+        unsigned numReceivers = group->GetReceivers().Size();
+        for (unsigned i = 0; i < numReceivers; ++i)
         {
-            HashSet<Object*>::ConstIterator current = i++;
-            Object* receiver = *current;
-            Object* next = 0;
-            if (i != group->End())
-                next = *i;
+            Object* receiver = group->GetReceivers()[i];
+            if (!receiver)
+                continue;
 
-            unsigned oldSize = group->Size();
             receiver->OnEvent(this, eventType, eventData);
 
             // If self has been destroyed as a result of event handling, exit
             if (self.Expired())
             {
+                group->EndSendEvent();
+                processed.Resize(processedStart);
                 context->EndSendEvent();
                 return;
             }
 
-            // If group has changed size during iteration (removed/added subscribers) try to recover
-            /// \todo This is not entirely foolproof, as a subscriber could have been added to make up for the removed one
-            if (group->Size() != oldSize)
-                i = group->Find(next);
-
-            processed.Insert(receiver);
+            processed.Push(receiver);
         }
+
+        group->EndSendEvent();
     }
 
-    // Then the non-specific receivers
+    // Then the non-specific receivers. If there were specific receivers, check that the event is not sent doubly to them
+    unsigned processedEnd = processed.Size();
+    if (processedEnd > processedStart)
+        Sort(processed.Begin() + processedStart, processed.Begin() + processedEnd);
+
     group = context->GetEventReceivers(eventType);
     if (group)
     {
-        if (processed.Empty())
-        {
-            for (HashSet<Object*>::ConstIterator i = group->Begin(); i != group->End();)
-            {
-                HashSet<Object*>::ConstIterator current = i++;
-                Object* receiver = *current;
-                Object* next = 0;
-                if (i != group->End())
-                    next = *i;
-
-                unsigned oldSize = group->Size();
-                receiver->OnEvent(this, eventType, eventData);
-
-                if (self.Expired())
-                {
-                    context->EndSendEvent();
-                    return;
-                }
-
-                if (group->Size() != oldSize)
-                    i = group->Find(next);
-            }
-        }
-        else
+        group->BeginSendEvent();
+
+        unsigned numReceivers = group->GetReceivers().Size();
+        for (unsigned i = 0; i < numReceivers; ++i)
         {
-            // If there were specific receivers, check that the event is not sent doubly to them
-            for (HashSet<Object*>::ConstIterator i = group->Begin(); i != group->End();)
+            Object* receiver = group->GetReceivers()[i];
+            if (!receiver || (processedEnd > processedStart && IsProcessed(processed, processedStart, processedEnd, receiver)))
+                continue;
+
+            receiver->OnEvent(this, eventType, eventData);
+
+            if (self.Expired())
             {
-                HashSet<Object*>::ConstIterator current = i++;
-                Object* receiver = *current;
-                Object* next = 0;
-                if (i != group->End())
-                    next = *i;
-
-                if (!processed.Contains(receiver))
-                {
-                    unsigned oldSize = group->Size();
-                    receiver->OnEvent(this, eventType, eventData);
-
-                    if (self.Expired())
-                    {
-                        context->EndSendEvent();
-                        return;
-                    }
-
-                    if (group->Size() != oldSize)
-                        i = group->Find(next);
-                }
+                group->EndSendEvent();
+                processed.Resize(processedStart);
+                context->EndSendEvent();
+                return;
             }
         }
+
+        group->EndSendEvent();
     }
 
+    processed.Resize(processedStart);
     context->EndSendEvent();
 }
 
@@ -410,7 +376,7 @@ EventHandler* Object::GetEventHandler() const
 
 bool Object::HasSubscribedToEvent(StringHash eventType) const
 {
-    return FindEventHandler(eventType) != 0;
+    return FindSpecificEventHandler(0, eventType) != 0 || FindEventHandler(eventType) != 0;
 }
 
 bool Object::HasSubscribedToEvent(Object* sender, StringHash eventType) const
@@ -471,6 +437,13 @@ EventHandler* Object::FindSpecificEventHandler(Object* sender, EventHandler** pr
 
 EventHandler* Object::FindSpecificEventHandler(Object* sender, StringHash eventType, EventHandler** previous) const
 {
+    if (!previous)
+    {
+        FlatHashMap<Pair<Object*, StringHash>, EventHandler*>::ConstIterator i =
+            eventHandlerIndex_.Find(MakePair(sender, eventType));
+        return i != eventHandlerIndex_.End() ? i->second_ : (EventHandler*)0;
+    }
+
     EventHandler* handler = eventHandlers_.First();
     if (previous)
         *previous = 0;
@@ -487,6 +460,31 @@ EventHandler* Object::FindSpecificEventHandler(Object* sender, StringHash eventT
     return 0;
 }
 
+void Object::AddEventHandler(EventHandler* handler)
+{
+    // Remove old event handler first
+    Pair<Object*, StringHash> key(handler->GetSender(), handler->GetEventType());
+    FlatHashMap<Pair<Object*, StringHash>, EventHandler*>::Iterator i = eventHandlerIndex_.Find(key);
+    if (i != eventHandlerIndex_.End())
+    {
+        eventHandlers_.Erase(i->second_);
+        i->second_ = handler;
+    }
+    else
+        eventHandlerIndex_.Insert(MakePair(key, handler));
+
+    eventHandlers_.InsertFront(handler);
+}
+
+void Object::RemoveEventHandler(EventHandler* handler, EventHandler* previous)
+{
+    eventHandlerIndex_.Erase(MakePair(handler->GetSender(), handler->GetEventType()));
+    if (previous)
+        eventHandlers_.Erase(handler, previous);
+    else
+        eventHandlers_.Erase(handler);
+}
+
 void Object::RemoveEventSender(Object* sender)
 {
     EventHandler* handler = eventHandlers_.First();
@@ -497,7 +495,7 @@ void Object::RemoveEventSender(Object* sender)
         if (handler->GetSender() == sender)
         {
             EventHandler* next = eventHandlers_.Next(handler);
-            eventHandlers_.Erase(handler, previous);
+            RemoveEventHandler(handler, previous);
             handler = next;
         }
         else
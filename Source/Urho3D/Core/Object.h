@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/FlatHashMap.h"
 #include "../Container/LinkedList.h"
 #include "../Core/Variant.h"
 
@@ -161,13 +162,19 @@ private:
     EventHandler* FindEventHandler(StringHash eventType, EventHandler** previous = 0) const;
     /// Find the first event handler with specific sender.
     EventHandler* FindSpecificEventHandler(Object* sender, EventHandler** previous = 0) const;
-    /// Find the first event handler with specific sender and event type.
+    /// Find the event handler with specific sender and event type. Sender is null for the non-specific handler. Uses the handler index unless the previous handler is requested.
     EventHandler* FindSpecificEventHandler(Object* sender, StringHash eventType, EventHandler** previous = 0) const;
+    /// Add an event handler to the handler list and index, replacing an existing handler for the same sender and event type.
+    void AddEventHandler(EventHandler* handler);
+    /// Remove an event handler from the handler list and index and delete it.
+    void RemoveEventHandler(EventHandler* handler, EventHandler* previous);
     /// Remove event handlers related to a specific sender.
     void RemoveEventSender(Object* sender);
 
     /// Event handlers. Sender is null for non-specific handlers.
     LinkedList<EventHandler> eventHandlers_;
+    /// Event handlers by sender and event type, for finding the handler to invoke without walking the list.
+    FlatHashMap<Pair<Object*, StringHash>, EventHandler*> eventHandlerIndex_;
 };
 
 template <class T> T* Object::GetSubsystem() const { return static_cast<T*>(GetSubsystem(T::GetTypeStatic())); }
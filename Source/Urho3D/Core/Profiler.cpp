@@ -24,6 +24,10 @@
 
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../IO/Serializer.h"
+
+#include <SDL/SDL_atomic.h>
+#include <SDL/SDL_thread.h>
 
 #include <cstdio>
 
@@ -40,7 +44,11 @@ Profiler::Profiler(Context* context) :
     current_(0),
     root_(0),
     intervalFrames_(0),
-    totalFrames_(0)
+    totalFrames_(0),
+    numTimelineThreads_(0),
+    timelineTLS_(SDL_TLSCreate()),
+    timelineGeneration_(0),
+    timelineEnabled_(false)
 {
     root_ = new ProfilerBlock(0, "Root");
     current_ = root_;
@@ -80,6 +88,163 @@ void Profiler::BeginInterval()
     intervalFrames_ = 0;
 }
 
+void Profiler::SetTimelineEnabled(bool enable)
+{
+    if (enable == timelineEnabled_)
+        return;
+
+    // Blocks that were begun while recording was disabled must not be recorded when they end. Each thread discards its
+    // open blocks itself on its next timeline call, as other threads may be profiling right now
+    if (enable)
+        ++timelineGeneration_;
+
+    timelineEnabled_ = enable;
+}
+
+static void AppendTimelineName(String& dest, const char* name)
+{
+    for (const char* c = name; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            dest += '\\';
+        dest += *c;
+    }
+}
+
+bool Profiler::SaveTimeline(Serializer& dest, unsigned firstFrame, unsigned lastFrame) const
+{
+    char line[LINE_MAX_LENGTH];
+    String output("{\"traceEvents\":[\n");
+    bool first = true;
+    bool success = true;
+
+    PODVector<ProfilerTimelineEvent> events;
+    unsigned numThreads = numTimelineThreads_;
+    SDL_MemoryBarrierAcquire();
+
+    for (unsigned i = 0; i < numThreads; ++i)
+    {
+        const ProfilerTimelineThread& thread = timelineThreads_[i];
+        if (!thread.events_)
+            continue;
+
+        // Copy the events first, then discard those that may have been overwritten by the owning thread during the copy
+        unsigned endIndex = thread.writeIndex_;
+        SDL_MemoryBarrierAcquire();
+        unsigned startIndex = endIndex > PROFILER_TIMELINE_EVENTS ? endIndex - PROFILER_TIMELINE_EVENTS : 0;
+        events.Resize(endIndex - startIndex);
+        for (unsigned j = startIndex; j < endIndex; ++j)
+            events[j - startIndex] = thread.events_[j & (PROFILER_TIMELINE_EVENTS - 1)];
+        SDL_MemoryBarrierAcquire();
+        unsigned newEndIndex = thread.writeIndex_;
+        unsigned validIndex = newEndIndex > PROFILER_TIMELINE_EVENTS ? newEndIndex - PROFILER_TIMELINE_EVENTS : 0;
+        if (validIndex < startIndex)
+            validIndex = startIndex;
+
+        if (!first)
+            output += ",\n";
+        first = false;
+        output.AppendWithFormat("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", i,
+            (thread.mainThread_ ? String("Main thread") : "Thread " + String(i)).CString());
+
+        for (unsigned j = validIndex; j < endIndex; ++j)
+        {
+            const ProfilerTimelineEvent& event = events[j - startIndex];
+            if (event.frame_ < firstFrame || event.frame_ > lastFrame)
+                continue;
+
+            output += ",\n{\"name\":\"";
+            AppendTimelineName(output, event.name_);
+            sprintf(line, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%lld,\"dur\":%lld,\"args\":{\"frame\":%u}}", i,
+                event.startTime_, event.duration_, event.frame_);
+            output += String(line);
+        }
+
+        // Flush to the destination periodically to limit memory use
+        if (output.Length() > 65536)
+        {
+            success &= dest.Write(output.CString(), output.Length()) == output.Length();
+            output.Clear();
+        }
+    }
+
+    output += "\n]}\n";
+    success &= dest.Write(output.CString(), output.Length()) == output.Length();
+    return success;
+}
+
+void Profiler::BeginTimelineBlock(const char* name)
+{
+    ProfilerTimelineThread* thread = GetTimelineThread();
+    if (!thread)
+        return;
+
+    // Blocks nested deeper than the maximum are not recorded, but are still counted for matching the end calls
+    if (thread->depth_ < MAX_PROFILER_TIMELINE_DEPTH)
+    {
+        thread->openNames_[thread->depth_] = name;
+        thread->openStartTimes_[thread->depth_] = timelineTimer_.GetUSec(false);
+        thread->openFrames_[thread->depth_] = totalFrames_;
+    }
+    ++thread->depth_;
+}
+
+void Profiler::EndTimelineBlock()
+{
+    ProfilerTimelineThread* thread = GetTimelineThread();
+    if (!thread || !thread->depth_)
+        return;
+
+    --thread->depth_;
+    if (thread->depth_ >= MAX_PROFILER_TIMELINE_DEPTH)
+        return;
+
+    unsigned index = thread->writeIndex_;
+    ProfilerTimelineEvent& event = thread->events_[index & (PROFILER_TIMELINE_EVENTS - 1)];
+    event.name_ = thread->openNames_[thread->depth_];
+    event.startTime_ = thread->openStartTimes_[thread->depth_];
+    event.duration_ = timelineTimer_.GetUSec(false) - event.startTime_;
+    event.frame_ = thread->openFrames_[thread->depth_];
+
+    // Publish the event only after it has been fully written
+    SDL_MemoryBarrierRelease();
+    thread->writeIndex_ = index + 1;
+}
+
+ProfilerTimelineThread* Profiler::GetTimelineThread()
+{
+    // Threads are never unregistered, so the state found through thread-local storage stays valid
+    ProfilerTimelineThread* thread = static_cast<ProfilerTimelineThread*>(SDL_TLSGet(timelineTLS_));
+    if (!thread)
+    {
+        MutexLock lock(timelineMutex_);
+
+        if (numTimelineThreads_ >= MAX_PROFILER_THREADS)
+            return 0;
+
+        thread = &timelineThreads_[numTimelineThreads_];
+        thread->threadID_ = Thread::GetCurrentThreadID();
+        thread->mainThread_ = Thread::IsMainThread();
+        thread->events_ = new ProfilerTimelineEvent[PROFILER_TIMELINE_EVENTS];
+        thread->writeIndex_ = 0;
+        thread->depth_ = 0;
+        thread->generation_ = timelineGeneration_;
+
+        SDL_MemoryBarrierRelease();
+        ++numTimelineThreads_;
+        SDL_TLSSet(timelineTLS_, thread, 0);
+    }
+
+    unsigned generation = timelineGeneration_;
+    if (thread->generation_ != generation)
+    {
+        thread->depth_ = 0;
+        thread->generation_ = generation;
+    }
+
+    return thread;
+}
+
 String Profiler::PrintData(bool showUnused, bool showTotal, unsigned maxDepth) const
 {
     String output;
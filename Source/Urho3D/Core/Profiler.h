@@ -23,12 +23,75 @@
 #pragma once
 
 #include "../Container/Str.h"
+#include "../Core/Mutex.h"
 #include "../Core/Thread.h"
 #include "../Core/Timer.h"
 
 namespace Urho3D
 {
 
+class Serializer;
+
+/// Maximum number of threads that can record profiler timeline events.
+static const unsigned MAX_PROFILER_THREADS = 64;
+/// Maximum nesting depth of profiler blocks recorded to the timeline.
+static const unsigned MAX_PROFILER_TIMELINE_DEPTH = 64;
+/// Number of timeline events kept per thread. Must be a power of two.
+static const unsigned PROFILER_TIMELINE_EVENTS = 16384;
+
+/// Completed profiling block in a thread's timeline.
+struct ProfilerTimelineEvent
+{
+    /// Block name.
+    const char* name_;
+    /// Start time in microseconds since the profiler was created.
+    long long startTime_;
+    /// Duration in microseconds.
+    long long duration_;
+    /// Profiler frame number on which the block was started.
+    unsigned frame_;
+};
+
+/// Timeline recording state of one thread. Events are written only by the owning thread into a ring buffer.
+struct ProfilerTimelineThread
+{
+    /// Construct.
+    ProfilerTimelineThread() :
+        threadID_(0),
+        mainThread_(false),
+        events_(0),
+        writeIndex_(0),
+        depth_(0),
+        generation_(0)
+    {
+    }
+
+    /// Destruct.
+    ~ProfilerTimelineThread()
+    {
+        delete [] events_;
+    }
+
+    /// Thread ID.
+    ThreadID threadID_;
+    /// Whether is the main thread.
+    bool mainThread_;
+    /// Event ring buffer.
+    ProfilerTimelineEvent* events_;
+    /// Total number of events written. The write position in the ring buffer is this value modulo its size.
+    volatile unsigned writeIndex_;
+    /// Number of currently open blocks.
+    unsigned depth_;
+    /// Recording generation the open blocks belong to. When it differs from the profiler's, the open blocks are discarded.
+    unsigned generation_;
+    /// Names of the currently open blocks.
+    const char* openNames_[MAX_PROFILER_TIMELINE_DEPTH];
+    /// Start times of the currently open blocks.
+    long long openStartTimes_[MAX_PROFILER_TIMELINE_DEPTH];
+    /// Frame numbers of the currently open blocks.
+    unsigned openFrames_[MAX_PROFILER_TIMELINE_DEPTH];
+};
+
 /// Profiling data for one block in the profiling tree.
 class URHO3D_API ProfilerBlock
 {
@@ -179,27 +242,39 @@ public:
     /// Destruct.
     virtual ~Profiler();
     
-    /// Begin timing a profiling block.
+    /// Begin timing a profiling block. Worker threads only record to the timeline, and their block names must stay valid for the profiler's lifetime, for example string literals.
     void BeginBlock(const char* name)
     {
-        // Profiler supports only the main thread currently
+        // The hierarchical block tree is collected only in the main thread
         if (!Thread::IsMainThread())
+        {
+            if (timelineEnabled_)
+                BeginTimelineBlock(name);
             return;
+        }
         
         current_ = current_->GetChild(name);
         current_->Begin();
+        if (timelineEnabled_)
+            BeginTimelineBlock(current_->name_);
     }
     
     /// End timing the current profiling block.
     void EndBlock()
     {
         if (!Thread::IsMainThread())
+        {
+            if (timelineEnabled_)
+                EndTimelineBlock();
             return;
+        }
         
         if (current_ != root_)
         {
             current_->End();
             current_ = current_->parent_;
+            if (timelineEnabled_)
+                EndTimelineBlock();
         }
     }
     
@@ -209,6 +284,10 @@ public:
     void EndFrame();
     /// Begin a new interval.
     void BeginInterval();
+    /// Enable or disable recording profiling blocks of all threads to per-thread timelines. Default false.
+    void SetTimelineEnabled(bool enable);
+    /// Write the recorded timeline events of a frame range as a Chrome trace event JSON file. Return true if successful. Should be called between frames, when no worker threads are profiling.
+    bool SaveTimeline(Serializer& dest, unsigned firstFrame = 0, unsigned lastFrame = M_MAX_UNSIGNED) const;
     
     /// Return profiling data as text output.
     String PrintData(bool showUnused = false, bool showTotal = false, unsigned maxDepth = M_MAX_UNSIGNED) const;
@@ -217,7 +296,20 @@ public:
     /// Return the root profiling block.
     const ProfilerBlock* GetRootBlock() { return root_; }
     
+    /// Return whether timeline recording is enabled.
+    bool GetTimelineEnabled() const { return timelineEnabled_; }
+    
+    /// Return number of the current profiling frame, as recorded in timeline events.
+    unsigned GetFrameNumber() const { return totalFrames_; }
+    
 private:
+    /// Record the start of a block to the calling thread's timeline.
+    void BeginTimelineBlock(const char* name);
+    /// Record the end of the innermost open block to the calling thread's timeline.
+    void EndTimelineBlock();
+    /// Return the calling thread's timeline state, registering the thread if necessary. Discard blocks left open from an earlier recording. Return null if too many threads.
+    ProfilerTimelineThread* GetTimelineThread();
+
     /// Return profiling data as text output for a specified profiling block.
     void PrintData(ProfilerBlock* block, String& output, unsigned depth, unsigned maxDepth, bool showUnused, bool showTotal) const;
     
@@ -228,7 +320,21 @@ private:
     /// Frames in the current interval.
     unsigned intervalFrames_;
     /// Total frames.
-    unsigned totalFrames_;
+    volatile unsigned totalFrames_;
+    /// Timer for timeline event timestamps.
+    HiresTimer timelineTimer_;
+    /// Timeline states of threads that have recorded events.
+    ProfilerTimelineThread timelineThreads_[MAX_PROFILER_THREADS];
+    /// Number of registered timeline threads.
+    volatile unsigned numTimelineThreads_;
+    /// Mutex for registering timeline threads.
+    Mutex timelineMutex_;
+    /// Thread-local storage ID for finding the calling thread's timeline state.
+    unsigned timelineTLS_;
+    /// Timeline recording generation, incremented each time recording is enabled.
+    volatile unsigned timelineGeneration_;
+    /// Timeline recording flag.
+    volatile bool timelineEnabled_;
 };
 
 /// Helper class for automatically beginning and ending a profiling block
@@ -60,8 +60,49 @@ private:
     unsigned index_;
 };
 
+/// Prioritized work item queue owned by one worker thread. Other threads steal from it when they run out of work.
+class WorkItemQueue : public RefCounted
+{
+public:
+    /// Insert an item in priority order. Must be called with the mutex held.
+    void Insert(WorkItem* item)
+    {
+        for (List<WorkItem*>::Iterator i = items_.Begin(); i != items_.End(); ++i)
+        {
+            if ((*i)->priority_ <= item->priority_)
+            {
+                items_.Insert(i, item);
+                return;
+            }
+        }
+
+        items_.Push(item);
+    }
+
+    /// Remove an item if it has not been taken for execution yet. Return true if removed.
+    bool Remove(WorkItem* item)
+    {
+        MutexLock lock(mutex_);
+
+        List<WorkItem*>::Iterator i = items_.Find(item);
+        if (i != items_.End())
+        {
+            items_.Erase(i);
+            return true;
+        }
+        else
+            return false;
+    }
+
+    /// Queued items, highest priority first.
+    List<WorkItem*> items_;
+    /// Queue mutex.
+    Mutex mutex_;
+};
+
 WorkQueue::WorkQueue(Context* context) :
     Object(context),
+    nextQueue_(0),
     shutDown_(false),
     pausing_(false),
     paused_(false),
@@ -70,6 +111,9 @@ WorkQueue::WorkQueue(Context* context) :
     lastSize_(0),
     maxNonThreadedWorkMs_(5)
 {
+    // Without worker threads there is a single queue processed by the main thread
+    queues_.Push(SharedPtr<WorkItemQueue>(new WorkItemQueue()));
+
     SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(WorkQueue, HandleBeginFrame));
 }
 
@@ -81,6 +125,9 @@ WorkQueue::~WorkQueue()
 
     for (unsigned i = 0; i < threads_.Size(); ++i)
         threads_[i]->Stop();
+
+    for (unsigned i = 0; i < childItems_.Size(); ++i)
+        delete childItems_[i];
 }
 
 void WorkQueue::CreateThreads(unsigned numThreads)
@@ -94,6 +141,10 @@ void WorkQueue::CreateThreads(unsigned numThreads)
     // Start threads in paused mode
     Pause();
 
+    // Create all queues before starting the threads, as the threads access the queue vector without locking
+    while (queues_.Size() < numThreads)
+        queues_.Push(SharedPtr<WorkItemQueue>(new WorkItemQueue()));
+
     for (unsigned i = 0; i < numThreads; ++i)
     {
         SharedPtr<WorkerThread> thread(new WorkerThread(this, i + 1));
@@ -122,7 +173,7 @@ SharedPtr<WorkItem> WorkQueue::GetFreeItem()
     }
 }
 
-void WorkQueue::AddWorkItem(SharedPtr<WorkItem> item)
+void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
 {
     if (!item)
     {
@@ -136,51 +187,109 @@ void WorkQueue::AddWorkItem(SharedPtr<WorkItem> item)
     // Push to the main thread list to keep item alive
     // Clear completed flag in case item is reused
     workItems_.Push(item);
-    item->completed_ = false;
-
-    // Make sure worker threads' list is safe to modify
-    if (threads_.Size() && !paused_)
-        queueMutex_.Acquire();
+    if (item->completed_)
+    {
+        item->completed_ = false;
+        SDL_AtomicSet(&item->pendingJobs_, 1);
+    }
 
-    // Find position for new item
-    if (queue_.Empty())
-        queue_.Push(item);
-    else
+    // Add a pending job to the parent. It has not been queued yet, so it can not complete meanwhile
+    WorkItem* parent = item->parent_;
+    if (parent)
     {
-        for (List<WorkItem*>::Iterator i = queue_.Begin(); i != queue_.End(); ++i)
+        if (parent->completed_)
         {
-            if ((*i)->priority_ <= item->priority_)
-            {
-                queue_.Insert(i, item);
-                break;
-            }
+            parent->completed_ = false;
+            SDL_AtomicSet(&parent->pendingJobs_, 1);
         }
+        SDL_AtomicIncRef(&parent->pendingJobs_);
     }
 
+    // Distribute items to the worker threads' queues in turn. Only the chosen queue is locked, and only if there are
+    // worker threads
+    WorkItemQueue* queue = queues_[nextQueue_];
+    nextQueue_ = (nextQueue_ + 1) % queues_.Size();
+
     if (threads_.Size())
     {
-        queueMutex_.Release();
-        paused_ = false;
+        queue->mutex_.Acquire();
+        queue->Insert(item);
+        queue->mutex_.Release();
+        Resume();
     }
+    else
+        queue->Insert(item);
 }
 
-bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
+void WorkQueue::AddChildWorkItem(WorkItem* parent, unsigned threadIndex, void (*workFunction)(const WorkItem*, unsigned),
+    void* start, void* end, void* aux)
+{
+    if (!parent)
+    {
+        URHO3D_LOGERROR("Null parent for child work item");
+        return;
+    }
+
+    // Without worker threads only the main thread executes work, so the pool and the queues need no locking
+    bool threaded = !threads_.Empty();
+
+    WorkItem* item;
+    if (threaded)
+        childItemMutex_.Acquire();
+    if (freeChildItems_.Size())
+    {
+        item = freeChildItems_.Back();
+        freeChildItems_.Pop();
+    }
+    else
+    {
+        item = new WorkItem();
+        item->childItem_ = true;
+        childItems_.Push(item);
+    }
+    if (threaded)
+        childItemMutex_.Release();
+
+    item->workFunction_ = workFunction;
+    item->start_ = start;
+    item->end_ = end;
+    item->aux_ = aux;
+    item->parent_ = parent;
+    item->priority_ = parent->priority_;
+    item->completed_ = false;
+    SDL_AtomicSet(&item->pendingJobs_, 1);
+
+    // The parent is executing or waiting for a child that is, so it can not complete meanwhile
+    SDL_AtomicIncRef(&parent->pendingJobs_);
+
+    // Queue to the calling thread's own queue, from which the other threads steal when they run out of work
+    WorkItemQueue* queue = queues_[(threadIndex ? threadIndex - 1 : 0) % queues_.Size()];
+    if (threaded)
+        queue->mutex_.Acquire();
+    queue->Insert(item);
+    if (threaded)
+        queue->mutex_.Release();
+}
+
+bool WorkQueue::RemoveWorkItem(const SharedPtr<WorkItem>& item)
 {
     if (!item)
         return false;
 
-    MutexLock lock(queueMutex_);
+    List<SharedPtr<WorkItem> >::Iterator i = workItems_.Find(item);
+    if (i == workItems_.End())
+        return false;
 
     // Can only remove successfully if the item was not yet taken by threads for execution
-    List<WorkItem*>::Iterator i = queue_.Find(item.Get());
-    if (i != queue_.End())
+    for (unsigned j = 0; j < queues_.Size(); ++j)
     {
-        List<SharedPtr<WorkItem> >::Iterator j = workItems_.Find(item);
-        if (j != workItems_.End())
+        if (queues_[j]->Remove(item))
         {
-            queue_.Erase(i);
-            ReturnToPool(item);
-            workItems_.Erase(j);
+            // The parent no longer waits for the removed item
+            if (item->parent_)
+                FinishItem(item->parent_);
+            ReturnToPool(*i);
+            workItems_.Erase(i);
             return true;
         }
     }
@@ -190,23 +299,12 @@ bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
 
 unsigned WorkQueue::RemoveWorkItems(const Vector<SharedPtr<WorkItem> >& items)
 {
-    MutexLock lock(queueMutex_);
     unsigned removed = 0;
 
     for (Vector<SharedPtr<WorkItem> >::ConstIterator i = items.Begin(); i != items.End(); ++i)
     {
-        List<WorkItem*>::Iterator j = queue_.Find(i->Get());
-        if (j != queue_.End())
-        {
-            List<SharedPtr<WorkItem> >::Iterator k = workItems_.Find(*i);
-            if (k != workItems_.End())
-            {
-                queue_.Erase(j);
-                ReturnToPool(*k);
-                workItems_.Erase(k);
-                ++removed;
-            }
-        }
+        if (RemoveWorkItem(*i))
+            ++removed;
     }
 
     return removed;
@@ -218,7 +316,7 @@ void WorkQueue::Pause()
     {
         pausing_ = true;
 
-        queueMutex_.Acquire();
+        pauseMutex_.Acquire();
         paused_ = true;
 
         pausing_ = false;
@@ -229,7 +327,7 @@ void WorkQueue::Resume()
 {
     if (paused_)
     {
-        queueMutex_.Release();
+        pauseMutex_.Release();
         paused_ = false;
     }
 }
@@ -243,23 +341,13 @@ void WorkQueue::Complete(unsigned priority)
     {
         Resume();
 
-        // Take work items also in the main thread until queue empty or no high-priority items anymore
-        while (!queue_.Empty())
+        // Take work items also in the main thread until queues empty or no high-priority items anymore
+        for (;;)
         {
-            queueMutex_.Acquire();
-            if (!queue_.Empty() && queue_.Front()->priority_ >= priority)
-            {
-                WorkItem* item = queue_.Front();
-                queue_.PopFront();
-                queueMutex_.Release();
-                item->workFunction_(item, 0);
-                item->completed_ = true;
-            }
-            else
-            {
-                queueMutex_.Release();
+            WorkItem* item = TakeItem(0, priority);
+            if (!item)
                 break;
-            }
+            ExecuteItem(item, 0);
         }
 
         // Wait for threaded work to complete
@@ -268,18 +356,18 @@ void WorkQueue::Complete(unsigned priority)
         }
 
         // If no work at all remaining, pause worker threads by leaving the mutex locked
-        if (queue_.Empty())
+        if (!HasQueuedItems())
             Pause();
     }
     else
     {
         // No worker threads: ensure all high-priority items are completed in the main thread
-        while (!queue_.Empty() && queue_.Front()->priority_ >= priority)
+        for (;;)
         {
-            WorkItem* item = queue_.Front();
-            queue_.PopFront();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
+            WorkItem* item = TakeItem(0, priority);
+            if (!item)
+                break;
+            ExecuteItem(item, 0);
         }
     }
 
@@ -287,6 +375,35 @@ void WorkQueue::Complete(unsigned priority)
     completing_ = false;
 }
 
+void WorkQueue::CompleteItem(WorkItem* item)
+{
+    if (!item)
+        return;
+
+    completing_ = true;
+
+    if (threads_.Size())
+        Resume();
+
+    // Execute any queued work in the main thread until the item and its children have completed
+    while (!item->completed_)
+    {
+        WorkItem* next = TakeItem(0, 0);
+        if (next)
+            ExecuteItem(next, 0);
+        else if (threads_.Empty())
+        {
+            URHO3D_LOGERROR("Work item can not complete as it was not added to the work queue");
+            break;
+        }
+    }
+
+    if (threads_.Size() && !HasQueuedItems())
+        Pause();
+
+    completing_ = false;
+}
+
 bool WorkQueue::IsCompleted(unsigned priority) const
 {
     for (List<SharedPtr<WorkItem> >::ConstIterator i = workItems_.Begin(); i != workItems_.End(); ++i)
@@ -298,6 +415,17 @@ bool WorkQueue::IsCompleted(unsigned priority) const
     return true;
 }
 
+bool WorkQueue::HasQueuedItems() const
+{
+    for (unsigned i = 0; i < queues_.Size(); ++i)
+    {
+        if (!queues_[i]->items_.Empty())
+            return true;
+    }
+
+    return false;
+}
+
 void WorkQueue::ProcessItems(unsigned threadIndex)
 {
     bool wasActive = false;
@@ -311,28 +439,82 @@ void WorkQueue::ProcessItems(unsigned threadIndex)
             Time::Sleep(0);
         else
         {
-            queueMutex_.Acquire();
-            if (!queue_.Empty())
+            // Start from the thread's own queue, and steal from the others when it is empty
+            WorkItem* item = TakeItem(threadIndex - 1, 0);
+            if (item)
             {
                 wasActive = true;
-
-                WorkItem* item = queue_.Front();
-                queue_.PopFront();
-                queueMutex_.Release();
-                item->workFunction_(item, threadIndex);
-                item->completed_ = true;
+                ExecuteItem(item, threadIndex);
             }
             else
             {
                 wasActive = false;
 
-                queueMutex_.Release();
+                // Block here while paused
+                pauseMutex_.Acquire();
+                pauseMutex_.Release();
                 Time::Sleep(0);
             }
         }
     }
 }
 
+WorkItem* WorkQueue::TakeItem(unsigned startIndex, unsigned priority)
+{
+    unsigned numQueues = queues_.Size();
+
+    for (unsigned i = 0; i < numQueues; ++i)
+    {
+        WorkItemQueue* queue = queues_[(startIndex + i) % numQueues];
+
+        // Check for an empty queue without locking to avoid contending for idle queues
+        if (queue->items_.Empty())
+            continue;
+
+        WorkItem* item = 0;
+        if (threads_.Size())
+            queue->mutex_.Acquire();
+        if (!queue->items_.Empty() && queue->items_.Front()->priority_ >= priority)
+        {
+            item = queue->items_.Front();
+            queue->items_.PopFront();
+        }
+        if (threads_.Size())
+            queue->mutex_.Release();
+
+        if (item)
+            return item;
+    }
+
+    return 0;
+}
+
+void WorkQueue::ExecuteItem(WorkItem* item, unsigned threadIndex)
+{
+    // An item without a work function only groups its children
+    if (item->workFunction_)
+    {
+        URHO3D_PROFILE(ExecuteWorkItem);
+        item->workFunction_(item, threadIndex);
+    }
+
+    FinishItem(item);
+}
+
+void WorkQueue::FinishItem(WorkItem* item)
+{
+    // Mark the item completed when its last pending job finishes, then notify the parent likewise. Read the parent first,
+    // as the main thread may return the item to the pool as soon as it is completed
+    while (item && SDL_AtomicDecRef(&item->pendingJobs_))
+    {
+        WorkItem* parent = item->parent_;
+        item->completed_ = true;
+        if (item->childItem_)
+            ReturnChildItem(item);
+        item = parent;
+    }
+}
+
 void WorkQueue::PurgeCompleted(unsigned priority)
 {
     // Purge completed work items and send completion events. Do not signal items lower than priority threshold,
@@ -383,30 +565,43 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
         item->start_ = 0;
         item->end_ = 0;
         item->aux_ = 0;
+        item->parent_ = 0;
         item->workFunction_ = 0;
         item->priority_ = M_MAX_UNSIGNED;
         item->sendEvent_ = false;
         item->completed_ = false;
+        SDL_AtomicSet(&item->pendingJobs_, 1);
 
         poolItems_.Push(item);
     }
 }
 
+void WorkQueue::ReturnChildItem(WorkItem* item)
+{
+    if (threads_.Size())
+    {
+        MutexLock lock(childItemMutex_);
+        freeChildItems_.Push(item);
+    }
+    else
+        freeChildItems_.Push(item);
+}
+
 void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
     // If no worker threads, complete low-priority work here
-    if (threads_.Empty() && !queue_.Empty())
+    if (threads_.Empty() && HasQueuedItems())
     {
         URHO3D_PROFILE(CompleteWorkNonthreaded);
 
         HiresTimer timer;
 
-        while (!queue_.Empty() && timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000)
+        while (timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000)
         {
-            WorkItem* item = queue_.Front();
-            queue_.PopFront();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
+            WorkItem* item = TakeItem(0, 0);
+            if (!item)
+                break;
+            ExecuteItem(item, 0);
         }
     }
 
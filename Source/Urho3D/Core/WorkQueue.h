@@ -26,6 +26,8 @@
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 
+#include <SDL/SDL_atomic.h>
+
 namespace Urho3D
 {
 
@@ -36,6 +38,7 @@ URHO3D_EVENT(E_WORKITEMCOMPLETED, WorkItemCompleted)
 }
 
 class WorkerThread;
+class WorkItemQueue;
 
 /// Work queue item.
 struct WorkItem : public RefCounted
@@ -45,11 +48,14 @@ struct WorkItem : public RefCounted
 public:
     // Construct
     WorkItem() :
+        parent_(0),
         priority_(0),
         sendEvent_(false),
         completed_(false),
-        pooled_(false)
+        pooled_(false),
+        childItem_(false)
     {
+        SDL_AtomicSet(&pendingJobs_, 1);
     }
 
     /// Work function. Called with the work item and thread index (0 = main thread) as parameters.
@@ -60,6 +66,8 @@ public:
     void* end_;
     /// Auxiliary data pointer.
     void* aux_;
+    /// Parent item, which is not considered completed until this item has completed. Must be set before adding either item to the queue.
+    WorkItem* parent_;
     /// Priority. Higher value = will be completed first.
     unsigned priority_;
     /// Whether to send event on completion.
@@ -69,6 +77,10 @@ public:
 
 private:
     bool pooled_;
+    /// Whether was added by AddChildWorkItem() and is recycled by the work queue once completed.
+    bool childItem_;
+    /// Number of unfinished jobs: the item itself and its children.
+    SDL_atomic_t pendingJobs_;
 };
 
 /// Work queue subsystem for multithreading.
@@ -88,10 +100,13 @@ public:
     void CreateThreads(unsigned numThreads);
     /// Get pointer to an usable WorkItem from the item pool. Allocate one if no more free items.
     SharedPtr<WorkItem> GetFreeItem();
-    /// Add a work item and resume worker threads.
-    void AddWorkItem(SharedPtr<WorkItem> item);
+    /// Add a work item and resume worker threads. If the item has a parent, the parent must be added after its children. Must be called from the main thread.
+    void AddWorkItem(const SharedPtr<WorkItem>& item);
+    /// Add a child item to a work item that is executing, from its work function or from one of its children. Is thread-safe. The child inherits the parent's priority and goes to the calling thread's queue. It is owned by the work queue and reused once completed, so it must not be referenced after its work function returns.
+    void AddChildWorkItem(WorkItem* parent, unsigned threadIndex, void (*workFunction)(const WorkItem*, unsigned), void* start,
+        void* end = 0, void* aux = 0);
     /// Remove a work item before it has started executing. Return true if successfully removed.
-    bool RemoveWorkItem(SharedPtr<WorkItem> item);
+    bool RemoveWorkItem(const SharedPtr<WorkItem>& item);
     /// Remove a number of work items before they have started executing. Return the number of items successfully removed.
     unsigned RemoveWorkItems(const Vector<SharedPtr<WorkItem> >& items);
     /// Pause worker threads.
@@ -100,6 +115,8 @@ public:
     void Resume();
     /// Finish all queued work which has at least the specified priority. Main thread will also execute priority work. Pause worker threads if no more work remains.
     void Complete(unsigned priority);
+    /// Finish a work item and all of its children regardless of priority, for waiting on a job group. Main thread will also execute work while waiting.
+    void CompleteItem(WorkItem* item);
 
     /// Set the pool telerance before it starts deleting pool items.
     void SetTolerance(int tolerance) { tolerance_ = tolerance; }
@@ -124,12 +141,22 @@ public:
 private:
     /// Process work items until shut down. Called by the worker threads.
     void ProcessItems(unsigned threadIndex);
+    /// Take the highest priority item from the queue at the start index, or steal from the other queues. Return null if no item with at least the specified priority.
+    WorkItem* TakeItem(unsigned startIndex, unsigned priority);
+    /// Execute a work item and finish it.
+    void ExecuteItem(WorkItem* item, unsigned threadIndex);
+    /// Finish one pending job of a work item. Mark it completed, and likewise its parents, as their last pending jobs finish.
+    void FinishItem(WorkItem* item);
+    /// Return whether any queue has items waiting for execution.
+    bool HasQueuedItems() const;
     /// Purge completed work items which have at least the specified priority, and send completion events as necessary.
     void PurgeCompleted(unsigned priority);
     /// Purge the pool to reduce allocation where its unneeded.
     void PurgePool();
     /// Return a work item to the pool.
     void ReturnToPool(SharedPtr<WorkItem>& item);
+    /// Return a completed child item to the child item pool. Is thread-safe.
+    void ReturnChildItem(WorkItem* item);
     /// Handle frame start event. Purge completed work from the main thread queue, and perform work if no threads at all.
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
 
@@ -137,17 +164,25 @@ private:
     Vector<SharedPtr<WorkerThread> > threads_;
     /// Work item pool for reuse to cut down on allocation. The bool is a flag for item pooling and whether it is available or not.
     List<SharedPtr<WorkItem> > poolItems_;
+    /// All child items created by AddChildWorkItem(). They are not reference counted, as they are passed between threads.
+    PODVector<WorkItem*> childItems_;
+    /// Child items available for reuse.
+    PODVector<WorkItem*> freeChildItems_;
+    /// Child item pool mutex.
+    Mutex childItemMutex_;
     /// Work item collection. Accessed only by the main thread.
     List<SharedPtr<WorkItem> > workItems_;
-    /// Work item prioritized queue for worker threads. Pointers are guaranteed to be valid (point to workItems.)
-    List<WorkItem*> queue_;
-    /// Worker queue mutex.
-    Mutex queueMutex_;
+    /// Prioritized work item queues, one per worker thread. Pointers are guaranteed to be valid (point to workItems.)
+    Vector<SharedPtr<WorkItemQueue> > queues_;
+    /// Pause mutex. Worker threads that run out of work block on it while paused.
+    Mutex pauseMutex_;
+    /// Queue to receive the next added work item.
+    unsigned nextQueue_;
     /// Shutting down flag.
     volatile bool shutDown_;
-    /// Pausing flag. Indicates the worker threads should not contend for the queue mutex.
+    /// Pausing flag. Indicates the worker threads should not contend for the pause mutex.
     volatile bool pausing_;
-    /// Paused flag. Indicates the queue mutex being locked to prevent worker threads using up CPU time.
+    /// Paused flag. Indicates the pause mutex being locked to prevent worker threads using up CPU time.
     bool paused_;
     /// Completing work in the main thread flag.
     bool completing_;
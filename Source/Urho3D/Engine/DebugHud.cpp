@@ -26,6 +26,7 @@
 #include "../Core/Profiler.h"
 #include "../Engine/DebugHud.h"
 #include "../Engine/Engine.h"
+#include "../Graphics/AnimationScheduler.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Renderer.h"
 #include "../Resource/ResourceCache.h"
@@ -139,6 +140,25 @@ void DebugHud::Update()
             renderer->GetNumShadowMaps(true),
             renderer->GetNumOccluders(true));
 
+        AnimationScheduler* animationScheduler = GetSubsystem<AnimationScheduler>();
+        if (animationScheduler && animationScheduler->GetNumModels())
+        {
+            stats.AppendWithFormat("\nAnimations %u/%u\nDeferred animations %u\nInterpolated animations %u\nBones %u",
+                animationScheduler->GetNumUpdatedModels(),
+                animationScheduler->GetNumModels(),
+                animationScheduler->GetNumDeferredModels(),
+                animationScheduler->GetNumInterpolatedModels(),
+                animationScheduler->GetNumUpdatedBones());
+        }
+
+        ResourceCache* cache = GetSubsystem<ResourceCache>();
+        if (cache && cache->GetNumBackgroundLoadResources())
+        {
+            stats.AppendWithFormat("\nBackground loads %u\nBackground load latency %.1f ms",
+                cache->GetNumBackgroundLoadResources(),
+                cache->GetBackgroundLoadLatency());
+        }
+
         if (!appStats_.Empty())
         {
             stats.Append("\n");
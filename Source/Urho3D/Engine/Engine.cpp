@@ -31,6 +31,7 @@
 #include "../Engine/Console.h"
 #include "../Engine/DebugHud.h"
 #include "../Engine/Engine.h"
+#include "../Graphics/AnimationScheduler.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Renderer.h"
 #include "../IO/FileSystem.h"
@@ -167,6 +168,7 @@ bool Engine::Initialize(const VariantMap& parameters)
     {
         context_->RegisterSubsystem(new Graphics(context_));
         context_->RegisterSubsystem(new Renderer(context_));
+        context_->RegisterSubsystem(new AnimationScheduler(context_));
     }
     else
     {
@@ -24,8 +24,10 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Animation.h"
+#include "../Graphics/AnimationScheduler.h"
 #include "../Graphics/AnimationState.h"
 #include "../Graphics/Batch.h"
 #include "../Graphics/Camera.h"
@@ -42,6 +44,12 @@
 #include "../Resource/ResourceEvents.h"
 #include "../Scene/Scene.h"
 
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#elif defined(URHO3D_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -60,19 +68,27 @@ AnimatedModel::AnimatedModel(Context* context) :
     StaticModel(context),
     animationLodFrameNumber_(0),
     morphElementMask_(0),
+    scheduleFrameNumber_(M_MAX_UNSIGNED),
+    schedulerIndex_(M_MAX_UNSIGNED),
     animationLodBias_(1.0f),
     animationLodTimer_(-1.0f),
     animationLodDistance_(0.0f),
+    skinningInterpolation_(1.0f),
     updateInvisible_(false),
     animationDirty_(false),
     animationOrderDirty_(false),
     morphsDirty_(false),
+    morphsUploadPending_(false),
     skinningDirty_(true),
     boneBoundingBoxDirty_(true),
     isMaster_(true),
     loading_(false),
     assignBonesPending_(false),
-    forceAnimationUpdate_(false)
+    forceAnimationUpdate_(false),
+    usePoseBuffer_(false),
+    poseValid_(false),
+    scheduledUpdate_(false),
+    interpolateSkinning_(false)
 {
 }
 
@@ -86,6 +102,10 @@ AnimatedModel::~AnimatedModel()
         if (parent && !parent->GetComponent<AnimatedModel>())
             RemoveRootBone();
     }
+
+    AnimationScheduler* scheduler = GetSubsystem<AnimationScheduler>();
+    if (scheduler)
+        scheduler->RemoveModel(this);
 }
 
 void AnimatedModel::RegisterObject(Context* context)
@@ -100,6 +120,7 @@ void AnimatedModel::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Can Be Occluded", IsOccludee, SetOccludee, bool, true, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Cast Shadows", bool, castShadows_, false, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Update When Invisible", GetUpdateInvisible, SetUpdateInvisible, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Use Pose Buffer", GetUsePoseBuffer, SetUsePoseBuffer, bool, false, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Draw Distance", GetDrawDistance, SetDrawDistance, float, 0.0f, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Shadow Distance", GetShadowDistance, SetShadowDistance, float, 0.0f, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("LOD Bias", GetLodBias, SetLodBias, float, 1.0f, AM_DEFAULT);
@@ -167,7 +188,8 @@ void AnimatedModel::ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQu
         {
             // Do an initial crude test using the bone's AABB
             const BoundingBox& box = bone.boundingBox_;
-            const Matrix3x4& transform = bone.node_->GetWorldTransform();
+            Matrix3x4 transform = IsPoseValid() ? node_->GetWorldTransform() * boneModelTransforms_[i] :
+                bone.node_->GetWorldTransform();
             distance = query.ray_.HitDistance(box.Transformed(transform));
             if (distance >= query.maxDistance_)
                 continue;
@@ -183,7 +205,8 @@ void AnimatedModel::ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQu
         }
         else if (bone.collisionMask_ & BONECOLLISION_SPHERE)
         {
-            boneSphere.center_ = bone.node_->GetWorldPosition();
+            boneSphere.center_ = IsPoseValid() ? node_->GetWorldTransform() * boneModelTransforms_[i].Translation() :
+                bone.node_->GetWorldPosition();
             boneSphere.radius_ = bone.radius_;
             distance = query.ray_.HitDistance(boneSphere);
             if (distance >= query.maxDistance_)
@@ -283,17 +306,31 @@ void AnimatedModel::UpdateGeometry(const FrameInfo& frame)
     }
 
     if (morphsDirty_)
+    {
         UpdateMorphs();
 
+        // Vertex buffers can only be uploaded in the main thread, so defer the upload if updating in a worker thread
+        if (Thread::IsMainThread())
+            UploadMorphs();
+        else
+            morphsUploadPending_ = true;
+    }
+
     if (skinningDirty_)
         UpdateSkinning();
 }
 
+void AnimatedModel::FinishUpdateGeometry()
+{
+    if (morphsUploadPending_)
+        UploadMorphs();
+}
+
 UpdateGeometryType AnimatedModel::GetUpdateGeometryType()
 {
-    if (morphsDirty_ || forceAnimationUpdate_)
+    if (forceAnimationUpdate_)
         return UPDATE_MAIN_THREAD;
-    else if (skinningDirty_)
+    else if (morphsDirty_ || skinningDirty_)
         return UPDATE_WORKER_THREAD;
     else
         return UPDATE_NONE;
@@ -304,6 +341,9 @@ void AnimatedModel::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
     if (debug && IsEnabledEffective())
     {
         debug->AddBoundingBox(GetWorldBoundingBox(), Color::GREEN, depthTest);
+        // The skeleton is drawn from the bone nodes, so bring them up to date with the pose buffer
+        if (IsPoseValid())
+            WriteBoneNodes(true);
         debug->AddSkeleton(skeleton_, Color(0.75f, 0.75f, 0.75f), depthTest);
     }
 }
@@ -313,6 +353,8 @@ void AnimatedModel::SetModel(Model* model, bool createBones)
     if (model == model_)
         return;
 
+    MarkOcclusionDirty();
+
     // Unsubscribe from the reload event of previous model (if any), then subscribe to the new
     if (model_)
         UnsubscribeFromEvent(model_, E_RELOADFINISHED);
@@ -518,6 +560,27 @@ void AnimatedModel::SetUpdateInvisible(bool enable)
 }
 
 
+void AnimatedModel::SetUsePoseBuffer(bool enable)
+{
+    if (enable == usePoseBuffer_)
+        return;
+
+    // When switching back to animating the bone nodes, leave them in the last calculated pose
+    if (!enable && IsPoseValid())
+        WriteBoneNodes(true);
+
+    usePoseBuffer_ = enable;
+    poseValid_ = false;
+    MarkAnimationDirty();
+    MarkNetworkUpdate();
+}
+
+void AnimatedModel::ApplyPoseToBoneNodes()
+{
+    if (IsPoseValid())
+        WriteBoneNodes(true);
+}
+
 void AnimatedModel::SetMorphWeight(unsigned index, float weight)
 {
     if (index >= morphs_.Size())
@@ -764,8 +827,10 @@ void AnimatedModel::SetSkeleton(const Skeleton& skeleton, bool createBones)
         }
     }
 
-    // Reserve space for skinning matrices
+    // Reserve space for skinning matrices. The pose buffer will be recalculated for the new skeleton
     skinMatrices_.Resize(skeleton_.GetNumBones());
+    poseBoneOrder_.Clear();
+    poseValid_ = false;
     SetGeometryBoneMappings();
 
     assignBonesPending_ = !createBones;
@@ -889,6 +954,20 @@ void AnimatedModel::OnNodeSet(Node* node)
     }
 }
 
+void AnimatedModel::OnSceneSet(Scene* scene)
+{
+    Drawable::OnSceneSet(scene);
+
+    AnimationScheduler* scheduler = GetSubsystem<AnimationScheduler>();
+    if (scheduler)
+    {
+        if (scene)
+            scheduler->AddModel(this);
+        else
+            scheduler->RemoveModel(this);
+    }
+}
+
 void AnimatedModel::OnMarkedDirty(Node* node)
 {
     Drawable::OnMarkedDirty(node);
@@ -1140,8 +1219,15 @@ void AnimatedModel::UpdateAnimation(const FrameInfo& frame)
     // If using animation LOD, accumulate time and see if it is time to update
     if (animationLodBias_ > 0.0f && animationLodDistance_ > 0.0f)
     {
+        // If the animation scheduler has already advanced the LOD timer on this frame, follow its decision
+        if (scheduleFrameNumber_ == frame.frameNumber_ && animationLodTimer_ >= 0.0f)
+        {
+            if (!scheduledUpdate_)
+                return;
+            scheduledUpdate_ = false;
+        }
         // Perform the first update always regardless of LOD timer
-        if (animationLodTimer_ >= 0.0f)
+        else if (animationLodTimer_ >= 0.0f)
         {
             animationLodTimer_ += animationLodBias_ * frame.timeStep_ * ANIMATION_LOD_BASESCALE;
             if (animationLodTimer_ >= animationLodDistance_)
@@ -1164,12 +1250,20 @@ void AnimatedModel::UpdateAnimation(const FrameInfo& frame)
     // (first AnimatedModel in a node)
     if (isMaster_)
     {
-        skeleton_.ResetSilent();
-        for (Vector<SharedPtr<AnimationState> >::Iterator i = animationStates_.Begin(); i != animationStates_.End(); ++i)
-            (*i)->Apply();
+        if (usePoseBuffer_)
+            UpdatePose();
+        else
+        {
+            skeleton_.ResetSilent();
+            for (Vector<SharedPtr<AnimationState> >::Iterator i = animationStates_.Begin(); i != animationStates_.End(); ++i)
+                (*i)->Apply();
+
+            // Skeleton reset and animations apply the node transforms "silently" to avoid repeated marking dirty. Mark dirty now
+            node_->MarkDirty();
+        }
 
-        // Skeleton reset and animations apply the node transforms "silently" to avoid repeated marking dirty. Mark dirty now
-        node_->MarkDirty();
+        if (interpolateSkinning_)
+            StoreBoneTransforms();
 
         // Calculate new bone bounding box
         UpdateBoneBoundingBox();
@@ -1178,9 +1272,216 @@ void AnimatedModel::UpdateAnimation(const FrameInfo& frame)
     animationDirty_ = false;
 }
 
+void AnimatedModel::StoreBoneTransforms()
+{
+    const Vector<Bone>& bones = skeleton_.GetBones();
+    unsigned numBones = bones.Size();
+    bool first = currentBoneTransforms_.Size() != numBones || previousBoneTransforms_.Size() != numBones;
+    if (!first)
+        previousBoneTransforms_.Swap(currentBoneTransforms_);
+    currentBoneTransforms_.Resize(numBones);
+
+    bool poseValid = IsPoseValid();
+    Matrix3x4 worldTransformInverse = node_->GetWorldTransform().Inverse();
+
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        AnimationKeyFrame& keyFrame = currentBoneTransforms_[i];
+        if (poseValid)
+            boneModelTransforms_[i].Decompose(keyFrame.position_, keyFrame.rotation_, keyFrame.scale_);
+        else if (bones[i].node_)
+            (worldTransformInverse * bones[i].node_->GetWorldTransform()).Decompose(keyFrame.position_, keyFrame.rotation_,
+                keyFrame.scale_);
+        else
+        {
+            keyFrame.position_ = Vector3::ZERO;
+            keyFrame.rotation_ = Quaternion::IDENTITY;
+            keyFrame.scale_ = Vector3::ONE;
+        }
+        keyFrame.time_ = 0.0f;
+    }
+
+    if (first)
+        previousBoneTransforms_ = currentBoneTransforms_;
+}
+
+void AnimatedModel::UpdatePose()
+{
+    const Vector<Bone>& bones = skeleton_.GetBones();
+    unsigned numBones = bones.Size();
+    if (poseBoneOrder_.Size() != numBones)
+        UpdatePoseHierarchy();
+
+    // Reset the pose. Bones with animation disabled are controlled from outside, so take their transforms from the nodes
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        const Bone& bone = bones[i];
+        if (bone.animated_ || !bone.node_)
+        {
+            posePositions_[i] = bone.initialPosition_;
+            poseRotations_[i] = bone.initialRotation_;
+            poseScales_[i] = bone.initialScale_;
+        }
+        else
+        {
+            posePositions_[i] = bone.node_->GetPosition();
+            poseRotations_[i] = bone.node_->GetRotation();
+            poseScales_[i] = bone.node_->GetScale();
+        }
+    }
+
+    for (Vector<SharedPtr<AnimationState> >::Iterator i = animationStates_.Begin(); i != animationStates_.End(); ++i)
+        (*i)->Apply();
+
+    // Concatenate the bone transforms in parent-first order
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        unsigned index = poseBoneOrder_[i];
+        unsigned parentIndex = bones[index].parentIndex_;
+        Matrix3x4 localTransform(posePositions_[index], poseRotations_[index], poseScales_[index]);
+        if (parentIndex != index && parentIndex < numBones)
+            boneModelTransforms_[index] = boneModelTransforms_[parentIndex] * localTransform;
+        else
+            boneModelTransforms_[index] = localTransform;
+    }
+
+    poseValid_ = true;
+    skinningDirty_ = true;
+
+    WriteBoneNodes(false);
+}
+
+void AnimatedModel::UpdatePoseHierarchy()
+{
+    const Vector<Bone>& bones = skeleton_.GetBones();
+    unsigned numBones = bones.Size();
+
+    posePositions_.Resize(numBones);
+    poseRotations_.Resize(numBones);
+    poseScales_.Resize(numBones);
+    boneModelTransforms_.Resize(numBones);
+    poseWriteNodes_.Resize(numBones);
+    poseChildBones_.Resize(numBones);
+    poseBoneOrder_.Clear();
+    poseBoneOrder_.Reserve(numBones);
+
+    for (unsigned i = 0; i < numBones; ++i)
+        poseChildBones_[i] = 0;
+
+    // Start from the root bones, then append the children of each already ordered bone
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        unsigned parentIndex = bones[i].parentIndex_;
+        if (parentIndex == i || parentIndex >= numBones)
+            poseBoneOrder_.Push(i);
+        else
+            ++poseChildBones_[parentIndex];
+    }
+
+    for (unsigned i = 0; i < poseBoneOrder_.Size(); ++i)
+    {
+        unsigned parentIndex = poseBoneOrder_[i];
+        for (unsigned j = 0; j < numBones; ++j)
+        {
+            if (j != parentIndex && bones[j].parentIndex_ == parentIndex)
+                poseBoneOrder_.Push(j);
+        }
+    }
+
+    // Bones in a parent loop can not be ordered; leave them at the end so that every bone is still calculated
+    if (poseBoneOrder_.Size() < numBones)
+    {
+        URHO3D_LOGWARNING("Skeleton has cyclic bone parenting, pose buffer transforms will be incorrect");
+        for (unsigned i = 0; i < numBones; ++i)
+        {
+            if (!poseBoneOrder_.Contains(i))
+                poseBoneOrder_.Push(i);
+        }
+    }
+}
+
+void AnimatedModel::WriteBoneNodes(bool all)
+{
+    const Vector<Bone>& bones = skeleton_.GetBones();
+    unsigned numBones = bones.Size();
+    if (!numBones || poseBoneOrder_.Size() != numBones)
+        return;
+
+    // Other animated models in the node skin with the bone nodes, so they need to be written in full
+    if (!all)
+    {
+        const Vector<SharedPtr<Component> >& components = node_->GetComponents();
+        for (Vector<SharedPtr<Component> >::ConstIterator i = components.Begin(); i != components.End(); ++i)
+        {
+            if (*i != this && (*i)->GetType() == GetTypeStatic())
+            {
+                all = true;
+                break;
+            }
+        }
+    }
+
+    if (all)
+    {
+        for (unsigned i = 0; i < numBones; ++i)
+            poseWriteNodes_[i] = 1;
+    }
+    else
+    {
+        // A bone node is needed if it has components or other child nodes than bones. Its parent bones are then needed too
+        for (unsigned i = 0; i < numBones; ++i)
+        {
+            Node* boneNode = bones[i].node_;
+            poseWriteNodes_[i] = boneNode && (boneNode->GetNumComponents() || boneNode->GetNumChildren() != poseChildBones_[i]);
+        }
+
+        for (int i = (int)numBones - 1; i >= 0; --i)
+        {
+            unsigned index = poseBoneOrder_[i];
+            unsigned parentIndex = bones[index].parentIndex_;
+            if (poseWriteNodes_[index] && parentIndex != index && parentIndex < numBones)
+                poseWriteNodes_[parentIndex] = 1;
+        }
+    }
+
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        const Bone& bone = bones[i];
+        if (poseWriteNodes_[i] && bone.animated_ && bone.node_)
+            bone.node_->SetTransformSilent(posePositions_[i], poseRotations_[i], poseScales_[i]);
+    }
+
+    // Mark dirty in parent-first order; marking stops at nodes that are already dirty along with their children
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        unsigned index = poseBoneOrder_[i];
+        const Bone& bone = bones[index];
+        if (poseWriteNodes_[index] && bone.animated_ && bone.node_)
+            bone.node_->MarkDirty();
+    }
+}
+
 void AnimatedModel::UpdateBoneBoundingBox()
 {
-    if (skeleton_.GetNumBones())
+    if (IsPoseValid())
+    {
+        // The pose buffer transforms are already relative to the model's node
+        boneBoundingBox_.Clear();
+
+        const Vector<Bone>& bones = skeleton_.GetBones();
+        for (unsigned i = 0; i < bones.Size(); ++i)
+        {
+            const Bone& bone = bones[i];
+            if (!bone.node_)
+                continue;
+
+            if (bone.collisionMask_ & BONECOLLISION_BOX)
+                boneBoundingBox_.Merge(bone.boundingBox_.Transformed(boneModelTransforms_[i]));
+            else if (bone.collisionMask_ & BONECOLLISION_SPHERE)
+                boneBoundingBox_.Merge(Sphere(boneModelTransforms_[i].Translation(), bone.radius_ * 0.5f));
+        }
+    }
+    else if (skeleton_.GetNumBones())
     {
         // The bone bounding box is in local space, so need the node's inverse transform
         boneBoundingBox_.Clear();
@@ -1202,6 +1503,25 @@ void AnimatedModel::UpdateBoneBoundingBox()
         }
     }
 
+    // The interpolated skin lags behind the bone nodes, so the bone bounding box must also cover the previous pose
+    const Vector<Bone>& bones = skeleton_.GetBones();
+    if (interpolateSkinning_ && previousBoneTransforms_.Size() == bones.Size())
+    {
+        for (unsigned i = 0; i < bones.Size(); ++i)
+        {
+            const Bone& bone = bones[i];
+            if (!bone.node_)
+                continue;
+
+            const AnimationKeyFrame& keyFrame = previousBoneTransforms_[i];
+            if (bone.collisionMask_ & BONECOLLISION_BOX)
+                boneBoundingBox_.Merge(bone.boundingBox_.Transformed(Matrix3x4(keyFrame.position_, keyFrame.rotation_,
+                    keyFrame.scale_)));
+            else if (bone.collisionMask_ & BONECOLLISION_SPHERE)
+                boneBoundingBox_.Merge(Sphere(keyFrame.position_, bone.radius_ * 0.5f));
+        }
+    }
+
     boneBoundingBoxDirty_ = false;
     worldBoundingBoxDirty_ = true;
 }
@@ -1213,8 +1533,50 @@ void AnimatedModel::UpdateSkinning()
     // Use model's world transform in case a bone is missing
     const Matrix3x4& worldTransform = node_->GetWorldTransform();
 
+    // Skinning interpolated between the two latest animation updates
+    if (interpolateSkinning_ && skinningInterpolation_ < 1.0f && currentBoneTransforms_.Size() == bones.Size() &&
+        previousBoneTransforms_.Size() == bones.Size())
+    {
+        bool poseValid = IsPoseValid();
+        float t = skinningInterpolation_;
+
+        for (unsigned i = 0; i < bones.Size(); ++i)
+        {
+            const Bone& bone = bones[i];
+            if (poseValid || bone.node_)
+            {
+                const AnimationKeyFrame& previous = previousBoneTransforms_[i];
+                const AnimationKeyFrame& current = currentBoneTransforms_[i];
+                Matrix3x4 boneTransform(previous.position_.Lerp(current.position_, t),
+                    previous.rotation_.Nlerp(current.rotation_, t, true), previous.scale_.Lerp(current.scale_, t));
+                skinMatrices_[i] = worldTransform * boneTransform * bone.offsetMatrix_;
+            }
+            else
+                skinMatrices_[i] = worldTransform;
+
+            if (geometrySkinMatrices_.Size())
+            {
+                for (unsigned j = 0; j < geometrySkinMatrixPtrs_[i].Size(); ++j)
+                    *geometrySkinMatrixPtrs_[i][j] = skinMatrices_[i];
+            }
+        }
+    }
+    // Skinning from the pose buffer
+    else if (IsPoseValid())
+    {
+        for (unsigned i = 0; i < bones.Size(); ++i)
+        {
+            skinMatrices_[i] = worldTransform * boneModelTransforms_[i] * bones[i].offsetMatrix_;
+
+            if (geometrySkinMatrices_.Size())
+            {
+                for (unsigned j = 0; j < geometrySkinMatrixPtrs_[i].Size(); ++j)
+                    *geometrySkinMatrixPtrs_[i][j] = skinMatrices_[i];
+            }
+        }
+    }
     // Skinning with global matrices only
-    if (!geometrySkinMatrices_.Size())
+    else if (!geometrySkinMatrices_.Size())
     {
         for (unsigned i = 0; i < bones.Size(); ++i)
         {
@@ -1247,40 +1609,32 @@ void AnimatedModel::UpdateSkinning()
 
 void AnimatedModel::UpdateMorphs()
 {
-    Graphics* graphics = GetSubsystem<Graphics>();
-    if (!graphics)
-        return;
-
     if (morphs_.Size())
     {
-        // Reset the morph data range from all morphable vertex buffers, then apply morphs
+        // Reset the morph data range from all morphable vertex buffers, then apply morphs. The morph vertex buffers are
+        // shadowed, so apply directly to the shadow data, which can be done without locking
         for (unsigned i = 0; i < morphVertexBuffers_.Size(); ++i)
         {
             VertexBuffer* buffer = morphVertexBuffers_[i];
-            if (buffer)
+            if (buffer && buffer->GetShadowData())
             {
                 VertexBuffer* originalBuffer = model_->GetVertexBuffers()[i];
                 unsigned morphStart = model_->GetMorphRangeStart(i);
                 unsigned morphCount = model_->GetMorphRangeCount(i);
+                void* dest = buffer->GetShadowData() + morphStart * buffer->GetVertexSize();
 
-                void* dest = buffer->Lock(morphStart, morphCount);
-                if (dest)
-                {
-                    // Reset morph range by copying data from the original vertex buffer
-                    CopyMorphVertices(dest, originalBuffer->GetShadowData() + morphStart * originalBuffer->GetVertexSize(),
-                        morphCount, buffer, originalBuffer);
+                // Reset morph range by copying data from the original vertex buffer
+                CopyMorphVertices(dest, originalBuffer->GetShadowData() + morphStart * originalBuffer->GetVertexSize(),
+                    morphCount, buffer, originalBuffer);
 
-                    for (unsigned j = 0; j < morphs_.Size(); ++j)
+                for (unsigned j = 0; j < morphs_.Size(); ++j)
+                {
+                    if (morphs_[j].weight_ > 0.0f)
                     {
-                        if (morphs_[j].weight_ > 0.0f)
-                        {
-                            HashMap<unsigned, VertexBufferMorph>::Iterator k = morphs_[j].buffers_.Find(i);
-                            if (k != morphs_[j].buffers_.End())
-                                ApplyMorph(buffer, dest, morphStart, k->second_, morphs_[j].weight_);
-                        }
+                        HashMap<unsigned, VertexBufferMorph>::Iterator k = morphs_[j].buffers_.Find(i);
+                        if (k != morphs_[j].buffers_.End())
+                            ApplyMorph(buffer, dest, morphStart, k->second_, morphs_[j].weight_);
                     }
-
-                    buffer->Unlock();
                 }
             }
         }
@@ -1289,6 +1643,50 @@ void AnimatedModel::UpdateMorphs()
     morphsDirty_ = false;
 }
 
+void AnimatedModel::UploadMorphs()
+{
+    if (morphs_.Size())
+    {
+        for (unsigned i = 0; i < morphVertexBuffers_.Size(); ++i)
+        {
+            VertexBuffer* buffer = morphVertexBuffers_[i];
+            if (buffer && buffer->GetShadowData())
+            {
+                // Setting the data from the shadow data itself only uploads it
+                unsigned morphStart = model_->GetMorphRangeStart(i);
+                unsigned morphCount = model_->GetMorphRangeCount(i);
+                buffer->SetDataRange(buffer->GetShadowData() + morphStart * buffer->GetVertexSize(), morphStart, morphCount);
+            }
+        }
+    }
+
+    morphsUploadPending_ = false;
+}
+
+/// Add weighted morph deltas to a run of consecutive vertex floats.
+static inline void AccumulateMorph(float* dest, const float* src, unsigned count, float weight)
+{
+#ifdef URHO3D_SSE
+    __m128 weights = _mm_set1_ps(weight);
+    for (; count >= 4; count -= 4)
+    {
+        _mm_storeu_ps(dest, _mm_add_ps(_mm_loadu_ps(dest), _mm_mul_ps(_mm_loadu_ps(src), weights)));
+        dest += 4;
+        src += 4;
+    }
+#elif defined(URHO3D_NEON)
+    for (; count >= 4; count -= 4)
+    {
+        vst1q_f32(dest, vaddq_f32(vld1q_f32(dest), vmulq_n_f32(vld1q_f32(src), weight)));
+        dest += 4;
+        src += 4;
+    }
+#endif
+
+    while (count--)
+        *dest++ += *src++ * weight;
+}
+
 void AnimatedModel::ApplyMorph(VertexBuffer* buffer, void* destVertexData, unsigned morphRangeStart, const VertexBufferMorph& morph,
     float weight)
 {
@@ -1301,38 +1699,44 @@ void AnimatedModel::ApplyMorph(VertexBuffer* buffer, void* destVertexData, unsig
     unsigned char* srcData = morph.morphData_;
     unsigned char* destData = (unsigned char*)destVertexData;
 
-    while (vertexCount--)
+    // The morph data has 3 floats per element for each vertex. Combine elements that are also adjacent in the vertex into
+    // runs, so that the weighted deltas can be accumulated several floats at a time
+    unsigned runOffsets[3];
+    unsigned runSizes[3];
+    unsigned numRuns = 0;
+    unsigned srcSize = 0;
+
+    const unsigned elementMasks[] = { MASK_POSITION, MASK_NORMAL, MASK_TANGENT };
+    const unsigned elementOffsets[] = { 0, normalOffset, tangentOffset };
+    for (unsigned i = 0; i < 3; ++i)
     {
-        unsigned vertexIndex = *((unsigned*)srcData) - morphRangeStart;
-        srcData += sizeof(unsigned);
+        if (!(elementMask & elementMasks[i]))
+            continue;
 
-        if (elementMask & MASK_POSITION)
-        {
-            float* dest = (float*)(destData + vertexIndex * vertexSize);
-            float* src = (float*)srcData;
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
-            srcData += 3 * sizeof(float);
-        }
-        if (elementMask & MASK_NORMAL)
+        if (numRuns && runOffsets[numRuns - 1] + runSizes[numRuns - 1] * sizeof(float) == elementOffsets[i])
+            runSizes[numRuns - 1] += 3;
+        else
         {
-            float* dest = (float*)(destData + vertexIndex * vertexSize + normalOffset);
-            float* src = (float*)srcData;
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
-            srcData += 3 * sizeof(float);
+            runOffsets[numRuns] = elementOffsets[i];
+            runSizes[numRuns] = 3;
+            ++numRuns;
         }
-        if (elementMask & MASK_TANGENT)
+        srcSize += 3;
+    }
+
+    while (vertexCount--)
+    {
+        unsigned vertexIndex = *((unsigned*)srcData) - morphRangeStart;
+        const float* src = (const float*)(srcData + sizeof(unsigned));
+        unsigned char* dest = destData + vertexIndex * vertexSize;
+
+        for (unsigned i = 0; i < numRuns; ++i)
         {
-            float* dest = (float*)(destData + vertexIndex * vertexSize + tangentOffset);
-            float* src = (float*)srcData;
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
-            srcData += 3 * sizeof(float);
+            AccumulateMorph((float*)(dest + runOffsets[i]), src, runSizes[i], weight);
+            src += runSizes[i];
         }
+
+        srcData += sizeof(unsigned) + srcSize * sizeof(float);
     }
 }
 
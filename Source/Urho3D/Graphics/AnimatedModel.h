@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Graphics/Animation.h"
 #include "../Graphics/Model.h"
 #include "../Graphics/Skeleton.h"
 #include "../Graphics/StaticModel.h"
@@ -29,7 +30,7 @@
 namespace Urho3D
 {
 
-class Animation;
+class AnimationScheduler;
 class AnimationState;
 
 /// Animated model component.
@@ -37,6 +38,7 @@ class URHO3D_API AnimatedModel : public StaticModel
 {
     URHO3D_OBJECT(AnimatedModel, StaticModel);
 
+    friend class AnimationScheduler;
     friend class AnimationState;
 
 public:
@@ -61,10 +63,14 @@ public:
     virtual void UpdateBatches(const FrameInfo& frame);
     /// Prepare geometry for rendering. Called from a worker thread if possible (no GPU update.)
     virtual void UpdateGeometry(const FrameInfo& frame);
+    /// Upload vertex morphs applied in a worker thread.
+    virtual void FinishUpdateGeometry();
     /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
     virtual UpdateGeometryType GetUpdateGeometryType();
     /// Visualize the component as debug geometry.
     virtual void DrawDebugGeometry(DebugRenderer* debug, bool depthTest);
+    /// Return whether the binary attribute data can be read in a worker thread when loading a columnar scene. False, as Load() is overridden.
+    virtual bool IsLoadThreadSafe() const { return false; }
 
     /// Set model.
     void SetModel(Model* model, bool createBones = true);
@@ -86,6 +92,10 @@ public:
     void SetAnimationLodBias(float bias);
     /// Set whether to update animation and the bounding box when not visible. Recommended to enable for physically controlled models like ragdolls.
     void SetUpdateInvisible(bool enable);
+    /// Set whether to sample and blend animations into a pose buffer instead of the bone nodes. The bone nodes are then written only when they have child nodes or components attached, or when requested. Not recommended for physically controlled models like ragdolls.
+    void SetUsePoseBuffer(bool enable);
+    /// Write the pose buffer into all animated bone nodes. Call before reading the bone node transforms, for example from script logic, when the pose buffer is in use.
+    void ApplyPoseToBoneNodes();
     /// Set vertex morph weight by index.
     void SetMorphWeight(unsigned index, float weight);
     /// Set vertex morph weight by name.
@@ -119,6 +129,12 @@ public:
     /// Return whether to update animation when not visible.
     bool GetUpdateInvisible() const { return updateInvisible_; }
 
+    /// Return whether animations are applied to a pose buffer instead of the bone nodes.
+    bool GetUsePoseBuffer() const { return usePoseBuffer_; }
+
+    /// Return bone transforms relative to the model's scene node from the pose buffer. Empty or outdated if the pose buffer is not in use.
+    const PODVector<Matrix3x4>& GetBoneModelTransforms() const { return boneModelTransforms_; }
+
     /// Return all vertex morphs.
     const Vector<ModelMorph>& GetMorphs() const { return morphs_; }
 
@@ -164,6 +180,8 @@ public:
 protected:
     /// Handle node being assigned.
     virtual void OnNodeSet(Node* node);
+    /// Handle scene being assigned.
+    virtual void OnSceneSet(Scene* scene);
     /// Handle node transform being dirtied.
     virtual void OnMarkedDirty(Node* node);
     /// Recalculate the world-space bounding box.
@@ -190,12 +208,24 @@ private:
     void CopyMorphVertices(void* dest, void* src, unsigned vertexCount, VertexBuffer* clone, VertexBuffer* original);
     /// Recalculate animations. Called from Update().
     void UpdateAnimation(const FrameInfo& frame);
+    /// Reset the pose buffer, apply all animations to it and calculate the bone transforms. Called from UpdateAnimation().
+    void UpdatePose();
+    /// Store the bone transforms of the latest animation update for skinning interpolation. Called from UpdateAnimation().
+    void StoreBoneTransforms();
+    /// Calculate the parent-first bone order and the number of child bones for the pose buffer.
+    void UpdatePoseHierarchy();
+    /// Write the pose buffer into the animated bone nodes, either all or only those needed by attached nodes or components and their parents.
+    void WriteBoneNodes(bool all);
+    /// Return whether the skinning and bone bounding box should use the pose buffer.
+    bool IsPoseValid() const { return usePoseBuffer_ && isMaster_ && poseValid_; }
     /// Recalculate the bone bounding box.
     void UpdateBoneBoundingBox();
     /// Recalculate skinning.
     void UpdateSkinning();
-    /// Reapply all vertex morphs.
+    /// Reapply all vertex morphs to the morph vertex buffers' shadow data. Can be called from a worker thread.
     void UpdateMorphs();
+    /// Upload the morphed ranges of the morph vertex buffers.
+    void UploadMorphs();
     /// Apply a vertex morph.
     void ApplyMorph
         (VertexBuffer* buffer, void* destVertexData, unsigned morphRangeStart, const VertexBufferMorph& morph, float weight);
@@ -212,6 +242,24 @@ private:
     Vector<SharedPtr<AnimationState> > animationStates_;
     /// Skinning matrices.
     PODVector<Matrix3x4> skinMatrices_;
+    /// Pose buffer bone positions.
+    PODVector<Vector3> posePositions_;
+    /// Pose buffer bone rotations.
+    PODVector<Quaternion> poseRotations_;
+    /// Pose buffer bone scales.
+    PODVector<Vector3> poseScales_;
+    /// Pose buffer bone transforms relative to the model's scene node.
+    PODVector<Matrix3x4> boneModelTransforms_;
+    /// Bone indices in parent-first order for calculating the pose buffer transforms.
+    PODVector<unsigned> poseBoneOrder_;
+    /// Number of child bones for each bone, to detect other child nodes attached to the bone nodes.
+    PODVector<unsigned> poseChildBones_;
+    /// Bone node write flags for the pose buffer.
+    PODVector<unsigned char> poseWriteNodes_;
+    /// Bone transforms relative to the model's scene node on the previous animation update, for skinning interpolation.
+    PODVector<AnimationKeyFrame> previousBoneTransforms_;
+    /// Bone transforms relative to the model's scene node on the latest animation update, for skinning interpolation.
+    PODVector<AnimationKeyFrame> currentBoneTransforms_;
     /// Mapping of subgeometry bone indices, used if more bones than skinning shader can manage.
     Vector<PODVector<unsigned> > geometryBoneMappings_;
     /// Subgeometry skinning matrices, used if more bones than skinning shader can manage.
@@ -226,12 +274,18 @@ private:
     unsigned animationLodFrameNumber_;
     /// Morph vertex element mask.
     unsigned morphElementMask_;
+    /// The frame number the animation scheduler last decided the animation update on.
+    unsigned scheduleFrameNumber_;
+    /// Index in the animation scheduler, or M_MAX_UNSIGNED if not added.
+    unsigned schedulerIndex_;
     /// Animation LOD bias.
     float animationLodBias_;
     /// Animation LOD timer.
     float animationLodTimer_;
     /// Animation LOD distance, the minimum of all LOD view distances last frame.
     float animationLodDistance_;
+    /// Skinning interpolation factor from the previous to the latest animation update.
+    float skinningInterpolation_;
     /// Update animation when invisible flag.
     bool updateInvisible_;
     /// Animation dirty flag.
@@ -240,6 +294,8 @@ private:
     bool animationOrderDirty_;
     /// Vertex morphs dirty flag.
     bool morphsDirty_;
+    /// Vertex morphs applied but not yet uploaded flag.
+    bool morphsUploadPending_;
     /// Skinning dirty flag.
     bool skinningDirty_;
     /// Bone bounding box dirty flag.
@@ -252,6 +308,14 @@ private:
     bool assignBonesPending_;
     /// Force animation update after becoming visible flag.
     bool forceAnimationUpdate_;
+    /// Apply animations to the pose buffer flag.
+    bool usePoseBuffer_;
+    /// Pose buffer calculated for the current skeleton flag.
+    bool poseValid_;
+    /// Animation update granted by the animation scheduler flag.
+    bool scheduledUpdate_;
+    /// Interpolate skinning between animation updates flag.
+    bool interpolateSkinning_;
 };
 
 }
@@ -48,6 +48,225 @@ inline bool CompareKeyFrames(AnimationKeyFrame& lhs, AnimationKeyFrame& rhs)
     return lhs.time_ < rhs.time_;
 }
 
+/// Range of the three smallest quaternion components.
+static const float QUATERNION_COMPONENT_RANGE = 0.70710678f;
+
+static bool QuantizeVector3s(const PODVector<Vector3>& src, Vector3& min, Vector3& range, PODVector<unsigned short>& dest)
+{
+    Vector3 max = min = src[0];
+    for (unsigned i = 1; i < src.Size(); ++i)
+    {
+        const Vector3& value = src[i];
+        min = Vector3(Min(min.x_, value.x_), Min(min.y_, value.y_), Min(min.z_, value.z_));
+        max = Vector3(Max(max.x_, value.x_), Max(max.y_, value.y_), Max(max.z_, value.z_));
+    }
+
+    // Return true if constant, in which case only the minimum is needed
+    if (min.Equals(max))
+    {
+        range = Vector3::ZERO;
+        dest.Clear();
+        return true;
+    }
+
+    range = max - min;
+    dest.Resize(src.Size() * 3);
+    for (unsigned i = 0; i < src.Size(); ++i)
+    {
+        const Vector3& value = src[i];
+        dest[i * 3] = (unsigned short)(range.x_ > 0.0f ? (value.x_ - min.x_) / range.x_ * 65535.0f + 0.5f : 0.0f);
+        dest[i * 3 + 1] = (unsigned short)(range.y_ > 0.0f ? (value.y_ - min.y_) / range.y_ * 65535.0f + 0.5f : 0.0f);
+        dest[i * 3 + 2] = (unsigned short)(range.z_ > 0.0f ? (value.z_ - min.z_) / range.z_ * 65535.0f + 0.5f : 0.0f);
+    }
+
+    return false;
+}
+
+static Vector3 DequantizeVector3(const unsigned short* src, const Vector3& min, const Vector3& range)
+{
+    const float scale = 1.0f / 65535.0f;
+    return Vector3(min.x_ + src[0] * scale * range.x_, min.y_ + src[1] * scale * range.y_, min.z_ + src[2] * scale * range.z_);
+}
+
+static void QuantizeQuaternion(Quaternion rotation, unsigned short* dest)
+{
+    rotation.Normalize();
+    float components[4] = { rotation.w_, rotation.x_, rotation.y_, rotation.z_ };
+
+    // Leave out the largest component, which can be reconstructed from the others when its sign is known to be positive
+    unsigned largest = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (Abs(components[i]) > Abs(components[largest]))
+            largest = i;
+    }
+    float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+    // Pack the index of the largest component in 2 bits and the rest in 15 bits each
+    unsigned long long packed = largest;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+        float normalized = Clamp(components[i] * sign / QUATERNION_COMPONENT_RANGE * 0.5f + 0.5f, 0.0f, 1.0f);
+        packed = (packed << 15) | (unsigned)(normalized * 32767.0f + 0.5f);
+    }
+
+    dest[0] = (unsigned short)(packed >> 32);
+    dest[1] = (unsigned short)(packed >> 16);
+    dest[2] = (unsigned short)packed;
+}
+
+static Quaternion DequantizeQuaternion(const unsigned short* src)
+{
+    unsigned long long packed = ((unsigned long long)src[0] << 32) | ((unsigned long long)src[1] << 16) | src[2];
+    unsigned largest = (unsigned)(packed >> 45);
+
+    // The three smallest components are packed in order, highest bits first. Decode them without branching on the index
+    const float scale = 2.0f / 32767.0f * QUATERNION_COMPONENT_RANGE;
+    float a = ((unsigned)(packed >> 30) & 0x7fff) * scale - QUATERNION_COMPONENT_RANGE;
+    float b = ((unsigned)(packed >> 15) & 0x7fff) * scale - QUATERNION_COMPONENT_RANGE;
+    float c = ((unsigned)packed & 0x7fff) * scale - QUATERNION_COMPONENT_RANGE;
+    float d = sqrtf(Max(1.0f - a * a - b * b - c * c, 0.0f));
+
+    switch (largest)
+    {
+    case 0:
+        return Quaternion(d, a, b, c);
+    case 1:
+        return Quaternion(a, d, b, c);
+    case 2:
+        return Quaternion(a, b, d, c);
+    default:
+        return Quaternion(a, b, c, d);
+    }
+}
+
+static void SampleCompressedKeyFrames(const CompressedKeyFrames& compressed, unsigned char channelMask, unsigned frame,
+    unsigned nextFrame, float t, AnimationKeyFrame& dest)
+{
+    unsigned char constantMask = compressed.constantMask_;
+
+    if (channelMask & CHANNEL_POSITION)
+    {
+        if (constantMask & CHANNEL_POSITION)
+            dest.position_ = compressed.positionMin_;
+        else
+        {
+            const unsigned short* positions = &compressed.positions_[0];
+            dest.position_ = DequantizeVector3(positions + frame * 3, compressed.positionMin_, compressed.positionRange_);
+            if (nextFrame != frame)
+                dest.position_ = dest.position_.Lerp(DequantizeVector3(positions + nextFrame * 3, compressed.positionMin_,
+                    compressed.positionRange_), t);
+        }
+    }
+    if (channelMask & CHANNEL_ROTATION)
+    {
+        if (constantMask & CHANNEL_ROTATION)
+            dest.rotation_ = compressed.rotation_;
+        else
+        {
+            const unsigned short* rotations = &compressed.rotations_[0];
+            dest.rotation_ = DequantizeQuaternion(rotations + frame * 3);
+            if (nextFrame != frame)
+                dest.rotation_ = dest.rotation_.Slerp(DequantizeQuaternion(rotations + nextFrame * 3), t);
+        }
+    }
+    if (channelMask & CHANNEL_SCALE)
+    {
+        if (constantMask & CHANNEL_SCALE)
+            dest.scale_ = compressed.scaleMin_;
+        else
+        {
+            const unsigned short* scales = &compressed.scales_[0];
+            dest.scale_ = DequantizeVector3(scales + frame * 3, compressed.scaleMin_, compressed.scaleRange_);
+            if (nextFrame != frame)
+                dest.scale_ = dest.scale_.Lerp(DequantizeVector3(scales + nextFrame * 3, compressed.scaleMin_,
+                    compressed.scaleRange_), t);
+        }
+    }
+}
+
+static void ReadCompressedTrack(Deserializer& source, AnimationTrack& track)
+{
+    CompressedKeyFrames& compressed = track.compressedKeyFrames_;
+    compressed.constantMask_ = source.ReadUByte();
+    unsigned numSamples = source.ReadUInt();
+    compressed.sampleRate_ = source.ReadFloat();
+    if (!numSamples)
+        return;
+
+    if (track.channelMask_ & CHANNEL_POSITION)
+    {
+        compressed.positionMin_ = source.ReadVector3();
+        if (!(compressed.constantMask_ & CHANNEL_POSITION))
+        {
+            compressed.positionRange_ = source.ReadVector3();
+            compressed.positions_.Resize(numSamples * 3);
+            source.Read(&compressed.positions_[0], numSamples * 3 * sizeof(unsigned short));
+        }
+    }
+    if (track.channelMask_ & CHANNEL_ROTATION)
+    {
+        if (compressed.constantMask_ & CHANNEL_ROTATION)
+            compressed.rotation_ = source.ReadQuaternion();
+        else
+        {
+            compressed.rotations_.Resize(numSamples * 3);
+            source.Read(&compressed.rotations_[0], numSamples * 3 * sizeof(unsigned short));
+        }
+    }
+    if (track.channelMask_ & CHANNEL_SCALE)
+    {
+        compressed.scaleMin_ = source.ReadVector3();
+        if (!(compressed.constantMask_ & CHANNEL_SCALE))
+        {
+            compressed.scaleRange_ = source.ReadVector3();
+            compressed.scales_.Resize(numSamples * 3);
+            source.Read(&compressed.scales_[0], numSamples * 3 * sizeof(unsigned short));
+        }
+    }
+
+    compressed.numSamples_ = numSamples;
+}
+
+static void WriteCompressedTrack(Serializer& dest, const AnimationTrack& track)
+{
+    const CompressedKeyFrames& compressed = track.compressedKeyFrames_;
+    unsigned numSamples = compressed.numSamples_;
+    dest.WriteUByte(compressed.constantMask_);
+    dest.WriteUInt(numSamples);
+    dest.WriteFloat(compressed.sampleRate_);
+    if (!numSamples)
+        return;
+
+    if (track.channelMask_ & CHANNEL_POSITION)
+    {
+        dest.WriteVector3(compressed.positionMin_);
+        if (!(compressed.constantMask_ & CHANNEL_POSITION))
+        {
+            dest.WriteVector3(compressed.positionRange_);
+            dest.Write(&compressed.positions_[0], numSamples * 3 * sizeof(unsigned short));
+        }
+    }
+    if (track.channelMask_ & CHANNEL_ROTATION)
+    {
+        if (compressed.constantMask_ & CHANNEL_ROTATION)
+            dest.WriteQuaternion(compressed.rotation_);
+        else
+            dest.Write(&compressed.rotations_[0], numSamples * 3 * sizeof(unsigned short));
+    }
+    if (track.channelMask_ & CHANNEL_SCALE)
+    {
+        dest.WriteVector3(compressed.scaleMin_);
+        if (!(compressed.constantMask_ & CHANNEL_SCALE))
+        {
+            dest.WriteVector3(compressed.scaleRange_);
+            dest.Write(&compressed.scales_[0], numSamples * 3 * sizeof(unsigned short));
+        }
+    }
+}
+
 void AnimationTrack::SetKeyFrame(unsigned index, const AnimationKeyFrame& keyFrame)
 {
     if (index < keyFrames_.Size())
@@ -105,9 +324,156 @@ void AnimationTrack::GetKeyFrameIndex(float time, unsigned& index) const
         ++index;
 }
 
+bool AnimationTrack::Sample(float time, float animationLength, bool looped, unsigned& index, AnimationKeyFrame& dest) const
+{
+    if (IsCompressed())
+    {
+        // The samples are uniform, so the frame can be calculated directly. The last sample is at the end of the animation
+        const CompressedKeyFrames& compressed = compressedKeyFrames_;
+        unsigned lastFrame = compressed.numSamples_ - 1;
+        float position = Max(time, 0.0f) * compressed.sampleRate_;
+        if (position >= (float)lastFrame)
+        {
+            index = lastFrame;
+            SampleCompressedKeyFrames(compressed, channelMask_, lastFrame, lastFrame, 0.0f, dest);
+        }
+        else
+        {
+            index = (unsigned)position;
+            SampleCompressedKeyFrames(compressed, channelMask_, index, index + 1, position - (float)index, dest);
+        }
+
+        dest.time_ = time;
+        return true;
+    }
+
+    if (keyFrames_.Empty())
+        return false;
+
+    GetKeyFrameIndex(time, index);
+
+    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
+    unsigned nextFrame = index + 1;
+    if (nextFrame >= keyFrames_.Size())
+    {
+        if (!looped)
+        {
+            dest = keyFrames_[index];
+            return true;
+        }
+        else
+            nextFrame = 0;
+    }
+
+    const AnimationKeyFrame& keyFrame = keyFrames_[index];
+    const AnimationKeyFrame& nextKeyFrame = keyFrames_[nextFrame];
+    float timeInterval = nextKeyFrame.time_ - keyFrame.time_;
+    if (timeInterval < 0.0f)
+        timeInterval += animationLength;
+    float t = timeInterval > 0.0f ? (time - keyFrame.time_) / timeInterval : 1.0f;
+
+    dest.time_ = time;
+    if (channelMask_ & CHANNEL_POSITION)
+        dest.position_ = keyFrame.position_.Lerp(nextKeyFrame.position_, t);
+    if (channelMask_ & CHANNEL_ROTATION)
+        dest.rotation_ = keyFrame.rotation_.Slerp(nextKeyFrame.rotation_, t);
+    if (channelMask_ & CHANNEL_SCALE)
+        dest.scale_ = keyFrame.scale_.Lerp(nextKeyFrame.scale_, t);
+
+    return true;
+}
+
+void AnimationTrack::Compress(float animationLength, float sampleRate, bool looped)
+{
+    if (IsCompressed() || keyFrames_.Empty())
+        return;
+
+    // Resample uniformly so that the first sample is at the start and the last at the end of the animation. When looped,
+    // the samples after the last keyframe blend back to the first keyframe as in uncompressed looped playback
+    if (sampleRate <= 0.0f)
+        sampleRate = animationLength > 0.0f ? (float)(keyFrames_.Size() - 1) / animationLength : 0.0f;
+    unsigned numSamples = 1;
+    if (animationLength > 0.0f && sampleRate > 0.0f)
+        numSamples = (unsigned)(animationLength * sampleRate + 0.5f) + 1;
+    float interval = numSamples > 1 ? animationLength / (float)(numSamples - 1) : 0.0f;
+
+    PODVector<Vector3> positions(numSamples);
+    PODVector<Quaternion> rotations(numSamples);
+    PODVector<Vector3> scales(numSamples);
+    unsigned index = 0;
+    for (unsigned i = 0; i < numSamples; ++i)
+    {
+        AnimationKeyFrame keyFrame;
+        Sample(i * interval, animationLength, looped, index, keyFrame);
+        positions[i] = keyFrame.position_;
+        rotations[i] = keyFrame.rotation_;
+        scales[i] = keyFrame.scale_;
+    }
+
+    CompressedKeyFrames& compressed = compressedKeyFrames_;
+    compressed = CompressedKeyFrames();
+    compressed.sampleRate_ = numSamples > 1 ? (float)(numSamples - 1) / animationLength : 0.0f;
+
+    if ((channelMask_ & CHANNEL_POSITION) &&
+        QuantizeVector3s(positions, compressed.positionMin_, compressed.positionRange_, compressed.positions_))
+        compressed.constantMask_ |= CHANNEL_POSITION;
+
+    if (channelMask_ & CHANNEL_ROTATION)
+    {
+        bool constant = true;
+        for (unsigned i = 1; i < numSamples && constant; ++i)
+            constant = rotations[i].Equals(rotations[0]);
+
+        if (constant)
+        {
+            compressed.rotation_ = rotations[0];
+            compressed.constantMask_ |= CHANNEL_ROTATION;
+        }
+        else
+        {
+            compressed.rotations_.Resize(numSamples * 3);
+            for (unsigned i = 0; i < numSamples; ++i)
+                QuantizeQuaternion(rotations[i], &compressed.rotations_[i * 3]);
+        }
+    }
+
+    if ((channelMask_ & CHANNEL_SCALE) &&
+        QuantizeVector3s(scales, compressed.scaleMin_, compressed.scaleRange_, compressed.scales_))
+        compressed.constantMask_ |= CHANNEL_SCALE;
+
+    compressed.numSamples_ = numSamples;
+    keyFrames_.Clear();
+    keyFrames_.Compact();
+}
+
+void AnimationTrack::Decompress()
+{
+    if (!IsCompressed())
+        return;
+
+    const CompressedKeyFrames& compressed = compressedKeyFrames_;
+    keyFrames_.Resize(compressed.numSamples_);
+    for (unsigned i = 0; i < keyFrames_.Size(); ++i)
+    {
+        AnimationKeyFrame& keyFrame = keyFrames_[i];
+        keyFrame.time_ = compressed.sampleRate_ > 0.0f ? (float)i / compressed.sampleRate_ : 0.0f;
+        SampleCompressedKeyFrames(compressed, channelMask_, i, i, 0.0f, keyFrame);
+    }
+
+    compressedKeyFrames_ = CompressedKeyFrames();
+}
+
+unsigned AnimationTrack::GetKeyFrameMemoryUse() const
+{
+    const CompressedKeyFrames& compressed = compressedKeyFrames_;
+    return keyFrames_.Size() * sizeof(AnimationKeyFrame) + (compressed.positions_.Size() + compressed.rotations_.Size() +
+        compressed.scales_.Size()) * sizeof(unsigned short);
+}
+
 Animation::Animation(Context* context) :
     Resource(context),
-    length_(0.f)
+    length_(0.f),
+    compressLooped_(false)
 {
 }
 
@@ -125,7 +491,9 @@ bool Animation::BeginLoad(Deserializer& source)
     unsigned memoryUse = sizeof(Animation);
 
     // Check ID
-    if (source.ReadFileID() != "UANI")
+    String fileID = source.ReadFileID();
+    bool compressed = fileID == "UANC";
+    if (fileID != "UANI" && !compressed)
     {
         URHO3D_LOGERROR(source.GetName() + " is not a valid animation file");
         return false;
@@ -146,6 +514,13 @@ bool Animation::BeginLoad(Deserializer& source)
         AnimationTrack* newTrack = CreateTrack(source.ReadString());
         newTrack->channelMask_ = source.ReadUByte();
 
+        if (compressed)
+        {
+            ReadCompressedTrack(source, *newTrack);
+            memoryUse += newTrack->GetKeyFrameMemoryUse();
+            continue;
+        }
+
         unsigned keyFrames = source.ReadUInt();
         newTrack->keyFrames_.Resize(keyFrames);
         memoryUse += keyFrames * sizeof(AnimationKeyFrame);
@@ -192,8 +567,9 @@ bool Animation::BeginLoad(Deserializer& source)
 
 bool Animation::Save(Serializer& dest) const
 {
-    // Write ID, name and length
-    dest.WriteFileID("UANI");
+    // Write ID, name and length. Use the compressed format if any track is compressed
+    bool compressed = IsCompressed();
+    dest.WriteFileID(compressed ? "UANC" : "UANI");
     dest.WriteString(animationName_);
     dest.WriteFloat(length_);
 
@@ -204,6 +580,20 @@ bool Animation::Save(Serializer& dest) const
         const AnimationTrack& track = i->second_;
         dest.WriteString(track.name_);
         dest.WriteUByte(track.channelMask_);
+
+        if (compressed)
+        {
+            if (track.IsCompressed())
+                WriteCompressedTrack(dest, track);
+            else
+            {
+                AnimationTrack compressedTrack(track);
+                compressedTrack.Compress(length_, 0.0f, compressLooped_);
+                WriteCompressedTrack(dest, compressedTrack);
+            }
+            continue;
+        }
+
         dest.WriteUInt(track.keyFrames_.Size());
 
         // Write keyframes of the track
@@ -333,6 +723,36 @@ void Animation::SetNumTriggers(unsigned num)
     triggers_.Resize(num);
 }
 
+void Animation::Compress(float sampleRate, bool looped)
+{
+    compressLooped_ = looped;
+
+    unsigned oldMemoryUse = 0;
+    unsigned newMemoryUse = 0;
+    for (HashMap<StringHash, AnimationTrack>::Iterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        oldMemoryUse += i->second_.GetKeyFrameMemoryUse();
+        i->second_.Compress(length_, sampleRate, looped);
+        newMemoryUse += i->second_.GetKeyFrameMemoryUse();
+    }
+
+    SetMemoryUse(GetMemoryUse() + newMemoryUse - oldMemoryUse);
+}
+
+void Animation::Decompress()
+{
+    unsigned oldMemoryUse = 0;
+    unsigned newMemoryUse = 0;
+    for (HashMap<StringHash, AnimationTrack>::Iterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        oldMemoryUse += i->second_.GetKeyFrameMemoryUse();
+        i->second_.Decompress();
+        newMemoryUse += i->second_.GetKeyFrameMemoryUse();
+    }
+
+    SetMemoryUse(GetMemoryUse() + newMemoryUse - oldMemoryUse);
+}
+
 AnimationTrack* Animation::GetTrack(const String& name)
 {
     HashMap<StringHash, AnimationTrack>::Iterator i = tracks_.Find(StringHash(name));
@@ -350,4 +770,15 @@ AnimationTriggerPoint* Animation::GetTrigger(unsigned index)
     return index < triggers_.Size() ? &triggers_[index] : (AnimationTriggerPoint*)0;
 }
 
+bool Animation::IsCompressed() const
+{
+    for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        if (i->second_.IsCompressed())
+            return true;
+    }
+
+    return false;
+}
+
 }
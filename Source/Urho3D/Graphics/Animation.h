@@ -50,8 +50,44 @@ struct AnimationKeyFrame
     Vector3 scale_;
 };
 
+/// Quantized keyframes of a compressed skeletal animation track, sampled at a uniform rate.
+struct CompressedKeyFrames
+{
+    /// Construct.
+    CompressedKeyFrames() :
+        numSamples_(0),
+        sampleRate_(0.0f),
+        constantMask_(0),
+        scaleMin_(Vector3::ONE)
+    {
+    }
+
+    /// Number of samples. Zero if not compressed.
+    unsigned numSamples_;
+    /// Samples per second.
+    float sampleRate_;
+    /// Bitmask of channels that have the same value in all samples and are stored only once.
+    unsigned char constantMask_;
+    /// Position quantization minimum, or the position if constant.
+    Vector3 positionMin_;
+    /// Position quantization range.
+    Vector3 positionRange_;
+    /// Rotation if constant.
+    Quaternion rotation_;
+    /// Scale quantization minimum, or the scale if constant.
+    Vector3 scaleMin_;
+    /// Scale quantization range.
+    Vector3 scaleRange_;
+    /// Quantized positions, three values per sample.
+    PODVector<unsigned short> positions_;
+    /// Quantized rotations using the smallest three components, three values per sample.
+    PODVector<unsigned short> rotations_;
+    /// Quantized scales, three values per sample.
+    PODVector<unsigned short> scales_;
+};
+
 /// Skeletal animation track, stores keyframes of a single bone.
-struct AnimationTrack
+struct URHO3D_API AnimationTrack
 {
     /// Construct.
     AnimationTrack() :
@@ -76,6 +112,16 @@ struct AnimationTrack
     unsigned GetNumKeyFrames() const { return keyFrames_.Size(); }
     /// Return keyframe index based on time and previous index.
     void GetKeyFrameIndex(float time, unsigned& index) const;
+    /// Sample position, rotation and scale of the included channels at time. The keyframe index is used as a search hint for uncompressed keyframes and is updated. Return false if the track has no keyframes.
+    bool Sample(float time, float animationLength, bool looped, unsigned& index, AnimationKeyFrame& dest) const;
+    /// Resample the keyframes uniformly and quantize them. Channels with a constant value are stored only once. Sample rate zero uses the average keyframe rate. When looped, the time after the last keyframe blends back to the first keyframe. The keyframes are removed.
+    void Compress(float animationLength, float sampleRate = 0.0f, bool looped = false);
+    /// Convert the compressed samples back to keyframes, so that they can be edited.
+    void Decompress();
+    /// Return whether the keyframes are compressed.
+    bool IsCompressed() const { return compressedKeyFrames_.numSamples_ != 0; }
+    /// Return memory use of the keyframes in bytes.
+    unsigned GetKeyFrameMemoryUse() const;
 
     /// Bone or scene node name.
     String name_;
@@ -85,6 +131,8 @@ struct AnimationTrack
     unsigned char channelMask_;
     /// Keyframes.
     Vector<AnimationKeyFrame> keyFrames_;
+    /// Compressed keyframes. Used instead of the keyframes when present.
+    CompressedKeyFrames compressedKeyFrames_;
 };
 
 /// %Animation trigger point.
@@ -148,6 +196,10 @@ public:
     void RemoveAllTriggers();
     /// Resize trigger point vector.
     void SetNumTriggers(unsigned num);
+    /// Compress all tracks with quantized, uniformly sampled keyframes. Sample rate zero uses the average keyframe rate of each track. Looped resamples the time after the last keyframe the way a looping AnimationState plays it. The animation is then saved in the compressed format.
+    void Compress(float sampleRate = 0.0f, bool looped = false);
+    /// Decompress all tracks back to keyframes.
+    void Decompress();
 
     /// Return animation name.
     const String& GetAnimationName() const { return animationName_; }
@@ -178,6 +230,9 @@ public:
     /// Return a trigger point by index.
     AnimationTriggerPoint* GetTrigger(unsigned index);
 
+    /// Return whether any of the tracks is compressed.
+    bool IsCompressed() const;
+
 private:
     /// Animation name.
     String animationName_;
@@ -185,6 +240,8 @@ private:
     StringHash animationNameHash_;
     /// Animation length.
     float length_;
+    /// Whether the tracks were compressed for looped playback.
+    bool compressLooped_;
     /// Animation tracks.
     HashMap<StringHash, AnimationTrack> tracks_;
     /// Animation trigger points.
@@ -0,0 +1,227 @@
+//
+// Copyright (c) 2008-2015 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Profiler.h"
+#include "../Graphics/AnimatedModel.h"
+#include "../Graphics/AnimationScheduler.h"
+#include "../Scene/Node.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Fractional part of the golden ratio, used to spread the first updates of models evenly over the update interval.
+static const float GOLDEN_RATIO_FRACTION = 0.618034f;
+
+static bool CompareAnimationUpdateCandidates(const AnimationUpdateCandidate& lhs, const AnimationUpdateCandidate& rhs)
+{
+    return lhs.urgency_ > rhs.urgency_;
+}
+
+static bool IsOnlyAnimatedModel(AnimatedModel* model)
+{
+    // Non-master models in the same node skin from the bone nodes directly, so they can not follow an interpolated master
+    const Vector<SharedPtr<Component> >& components = model->GetNode()->GetComponents();
+    for (Vector<SharedPtr<Component> >::ConstIterator i = components.Begin(); i != components.End(); ++i)
+    {
+        if (*i != model && (*i)->GetType() == AnimatedModel::GetTypeStatic())
+            return false;
+    }
+
+    return true;
+}
+
+AnimationScheduler::AnimationScheduler(Context* context) :
+    Object(context),
+    boneBudget_(0),
+    numUpdatedModels_(0),
+    numDeferredModels_(0),
+    numInterpolatedModels_(0),
+    numUpdatedBones_(0),
+    nextPhase_(0.0f),
+    interpolation_(false)
+{
+}
+
+AnimationScheduler::~AnimationScheduler()
+{
+    for (PODVector<AnimatedModel*>::Iterator i = models_.Begin(); i != models_.End(); ++i)
+        (*i)->schedulerIndex_ = M_MAX_UNSIGNED;
+}
+
+void AnimationScheduler::SetBoneBudget(unsigned bones)
+{
+    boneBudget_ = bones;
+}
+
+void AnimationScheduler::SetInterpolation(bool enable)
+{
+    if (enable == interpolation_)
+        return;
+
+    interpolation_ = enable;
+
+    // Show the latest animation update again on all models
+    if (!interpolation_)
+    {
+        for (PODVector<AnimatedModel*>::Iterator i = models_.Begin(); i != models_.End(); ++i)
+            SetModelInterpolation(*i, 1.0f);
+    }
+}
+
+void AnimationScheduler::Update(const FrameInfo& frame)
+{
+    URHO3D_PROFILE(ScheduleAnimations);
+
+    numUpdatedModels_ = 0;
+    numDeferredModels_ = 0;
+    numInterpolatedModels_ = 0;
+    numUpdatedBones_ = 0;
+    candidates_.Clear();
+
+    for (PODVector<AnimatedModel*>::Iterator i = models_.Begin(); i != models_.End(); ++i)
+    {
+        AnimatedModel* model = *i;
+
+        // Only the master model evaluates the skeleton. Skip models that are not animating, or are invisible and will
+        // be force-updated once they come into view
+        if (!model->isMaster_ || !model->animationDirty_ || !model->IsEnabledEffective() ||
+            (!model->updateInvisible_ && abs((int)frame.frameNumber_ - (int)model->viewFrameNumber_) > 1))
+        {
+            SetModelInterpolation(model, 1.0f);
+            continue;
+        }
+
+        unsigned numBones = model->skeleton_.GetNumBones();
+
+        // Models without animation LOD are updated every frame, but use up the budget
+        if (model->animationLodBias_ <= 0.0f || model->animationLodDistance_ <= 0.0f)
+        {
+            SetModelInterpolation(model, 1.0f);
+            ++numUpdatedModels_;
+            numUpdatedBones_ += numBones;
+            continue;
+        }
+
+        model->scheduleFrameNumber_ = frame.frameNumber_;
+        model->scheduledUpdate_ = false;
+
+        // Perform the first update always. Start the LOD timer at a varying phase so that models which started animating
+        // on the same frame do not keep updating on the same frames
+        if (model->animationLodTimer_ < 0.0f)
+        {
+            model->animationLodTimer_ = nextPhase_ * model->animationLodDistance_;
+            nextPhase_ = fmodf(nextPhase_ + GOLDEN_RATIO_FRACTION, 1.0f);
+            GrantUpdate(model);
+            continue;
+        }
+
+        model->animationLodTimer_ += model->animationLodBias_ * frame.timeStep_ * ANIMATION_LOD_BASESCALE;
+        float urgency = model->animationLodTimer_ / model->animationLodDistance_;
+        if (urgency >= 1.0f)
+            candidates_.Push(AnimationUpdateCandidate(model, urgency));
+        else
+        {
+            SetModelInterpolation(model, urgency);
+            if (model->interpolateSkinning_)
+                ++numInterpolatedModels_;
+        }
+    }
+
+    // Update the most overdue models first. Always update at least one model so that no model is starved
+    Sort(candidates_.Begin(), candidates_.End(), CompareAnimationUpdateCandidates);
+    bool granted = false;
+    for (PODVector<AnimationUpdateCandidate>::Iterator i = candidates_.Begin(); i != candidates_.End(); ++i)
+    {
+        AnimatedModel* model = i->model_;
+        if (!boneBudget_ || !granted || numUpdatedBones_ + model->skeleton_.GetNumBones() <= boneBudget_)
+        {
+            model->animationLodTimer_ = fmodf(model->animationLodTimer_, model->animationLodDistance_);
+            GrantUpdate(model);
+            granted = true;
+        }
+        else
+        {
+            // Keep showing the latest update until the model fits in the budget
+            SetModelInterpolation(model, 1.0f);
+            ++numDeferredModels_;
+        }
+    }
+}
+
+void AnimationScheduler::AddModel(AnimatedModel* model)
+{
+    if (!model || model->schedulerIndex_ != M_MAX_UNSIGNED)
+        return;
+
+    model->schedulerIndex_ = models_.Size();
+    models_.Push(model);
+}
+
+void AnimationScheduler::RemoveModel(AnimatedModel* model)
+{
+    if (!model || model->schedulerIndex_ >= models_.Size() || models_[model->schedulerIndex_] != model)
+        return;
+
+    // Swap with the last model to avoid moving the rest
+    AnimatedModel* last = models_.Back();
+    models_[model->schedulerIndex_] = last;
+    last->schedulerIndex_ = model->schedulerIndex_;
+    models_.Pop();
+    model->schedulerIndex_ = M_MAX_UNSIGNED;
+}
+
+void AnimationScheduler::SetModelInterpolation(AnimatedModel* model, float factor)
+{
+    bool interpolate = interpolation_ && factor < 1.0f && IsOnlyAnimatedModel(model);
+    if (!interpolate)
+        factor = 1.0f;
+
+    // Discard the stored transforms when starting to interpolate, as they may be arbitrarily old
+    if (interpolate && !model->interpolateSkinning_)
+    {
+        model->previousBoneTransforms_.Clear();
+        model->currentBoneTransforms_.Clear();
+    }
+    model->interpolateSkinning_ = interpolate;
+
+    if (factor != model->skinningInterpolation_)
+    {
+        model->skinningInterpolation_ = factor;
+        model->skinningDirty_ = true;
+    }
+}
+
+void AnimationScheduler::GrantUpdate(AnimatedModel* model)
+{
+    model->scheduledUpdate_ = true;
+    ++numUpdatedModels_;
+    numUpdatedBones_ += model->skeleton_.GetNumBones();
+
+    // After the update the skinning starts from the previous update's pose
+    SetModelInterpolation(model, model->animationLodTimer_ / model->animationLodDistance_);
+}
+
+}
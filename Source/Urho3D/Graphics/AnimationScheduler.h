@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2008-2015 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Object.h"
+
+namespace Urho3D
+{
+
+class AnimatedModel;
+struct FrameInfo;
+
+/// Animation update candidate of the animation scheduler.
+struct AnimationUpdateCandidate
+{
+    /// Construct undefined.
+    AnimationUpdateCandidate()
+    {
+    }
+
+    /// Construct with values.
+    AnimationUpdateCandidate(AnimatedModel* model, float urgency) :
+        model_(model),
+        urgency_(urgency)
+    {
+    }
+
+    /// Model.
+    AnimatedModel* model_;
+    /// Animation LOD timer relative to the update interval. Higher values are updated first.
+    float urgency_;
+};
+
+/// %Animation scheduler subsystem. Decides once per frame which animated models using animation LOD are updated, within a global bone evaluation budget.
+class URHO3D_API AnimationScheduler : public Object
+{
+    URHO3D_OBJECT(AnimationScheduler, Object);
+
+public:
+    /// Construct.
+    AnimationScheduler(Context* context);
+    /// Destruct.
+    virtual ~AnimationScheduler();
+
+    /// Set maximum number of bones to evaluate per frame. 0 (default) is unlimited.
+    void SetBoneBudget(unsigned bones);
+    /// Set whether to interpolate skinning between the animation updates of models using animation LOD. Default false. The skin is shown up to one update interval late, while bone nodes and their attachments follow the latest update; the bounding box covers both poses.
+    void SetInterpolation(bool enable);
+    /// Schedule the animation updates of the frame. Called by Renderer before updating the octrees.
+    void Update(const FrameInfo& frame);
+    /// Add an animated model. Called by AnimatedModel.
+    void AddModel(AnimatedModel* model);
+    /// Remove an animated model. Called by AnimatedModel.
+    void RemoveModel(AnimatedModel* model);
+
+    /// Return maximum number of bones to evaluate per frame.
+    unsigned GetBoneBudget() const { return boneBudget_; }
+
+    /// Return whether skinning is interpolated between animation updates.
+    bool GetInterpolation() const { return interpolation_; }
+
+    /// Return number of animated models in scenes.
+    unsigned GetNumModels() const { return models_.Size(); }
+
+    /// Return number of models whose animation was updated on the last frame.
+    unsigned GetNumUpdatedModels() const { return numUpdatedModels_; }
+
+    /// Return number of models whose animation update was due but deferred by the bone budget on the last frame.
+    unsigned GetNumDeferredModels() const { return numDeferredModels_; }
+
+    /// Return number of models whose skinning was interpolated on the last frame.
+    unsigned GetNumInterpolatedModels() const { return numInterpolatedModels_; }
+
+    /// Return number of bones evaluated on the last frame.
+    unsigned GetNumUpdatedBones() const { return numUpdatedBones_; }
+
+private:
+    /// Set skinning interpolation factor of a model.
+    void SetModelInterpolation(AnimatedModel* model, float factor);
+    /// Grant an animation update to a model.
+    void GrantUpdate(AnimatedModel* model);
+
+    /// Animated models.
+    PODVector<AnimatedModel*> models_;
+    /// Update candidates of the current frame.
+    PODVector<AnimationUpdateCandidate> candidates_;
+    /// Maximum number of bones to evaluate per frame.
+    unsigned boneBudget_;
+    /// Number of models updated on the last frame.
+    unsigned numUpdatedModels_;
+    /// Number of models deferred on the last frame.
+    unsigned numDeferredModels_;
+    /// Number of models interpolated on the last frame.
+    unsigned numInterpolatedModels_;
+    /// Number of bones evaluated on the last frame.
+    unsigned numUpdatedBones_;
+    /// Phase for the next model's first update.
+    float nextPhase_;
+    /// Skinning interpolation flag.
+    bool interpolation_;
+};
+
+}
@@ -36,6 +36,7 @@ namespace Urho3D
 AnimationStateTrack::AnimationStateTrack() :
     track_(0),
     bone_(0),
+    boneIndex_(M_MAX_UNSIGNED),
     weight_(1.0f),
     keyFrame_(0)
 {
@@ -151,6 +152,7 @@ void AnimationState::SetStartBone(Bone* startBone)
         if (trackBone && trackBone->node_)
         {
             stateTrack.bone_ = trackBone;
+            stateTrack.boneIndex_ = (unsigned)(trackBone - skeleton.GetBone((unsigned)0));
             stateTrack.node_ = trackBone->node_;
             stateTracks_.Push(stateTrack);
         }
@@ -407,6 +409,12 @@ void AnimationState::Apply()
 
 void AnimationState::ApplyToModel()
 {
+    if (model_->GetUsePoseBuffer())
+    {
+        ApplyToPose();
+        return;
+    }
+
     for (Vector<AnimationStateTrack>::Iterator i = stateTracks_.Begin(); i != stateTracks_.End(); ++i)
     {
         AnimationStateTrack& stateTrack = *i;
@@ -423,6 +431,21 @@ void AnimationState::ApplyToModel()
     }
 }
 
+void AnimationState::ApplyToPose()
+{
+    for (Vector<AnimationStateTrack>::Iterator i = stateTracks_.Begin(); i != stateTracks_.End(); ++i)
+    {
+        AnimationStateTrack& stateTrack = *i;
+        float finalWeight = weight_ * stateTrack.weight_;
+
+        // Do not apply if zero effective weight or the bone has animation disabled
+        if (Equals(finalWeight, 0.0f) || !stateTrack.bone_->animated_)
+            continue;
+
+        ApplyTrackToPose(stateTrack, finalWeight);
+    }
+}
+
 void AnimationState::ApplyToNodes()
 {
     // When applying to a node hierarchy, can only use full weight (nothing to blend to)
@@ -435,55 +458,17 @@ void AnimationState::ApplyTrackFullWeight(AnimationStateTrack& stateTrack)
     const AnimationTrack* track = stateTrack.track_;
     Node* node = stateTrack.node_;
 
-    if (track->keyFrames_.Empty() || !node)
+    AnimationKeyFrame keyFrame;
+    if (!node || !track->Sample(time_, animation_->GetLength(), looped_, stateTrack.keyFrame_, keyFrame))
         return;
 
-    unsigned& frame = stateTrack.keyFrame_;
-    track->GetKeyFrameIndex(time_, frame);
-
-    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
-    unsigned nextFrame = frame + 1;
-    bool interpolate = true;
-    if (nextFrame >= track->keyFrames_.Size())
-    {
-        if (!looped_)
-        {
-            nextFrame = frame;
-            interpolate = false;
-        }
-        else
-            nextFrame = 0;
-    }
-
-    const AnimationKeyFrame* keyFrame = &track->keyFrames_[frame];
     unsigned char channelMask = track->channelMask_;
-
-    if (!interpolate)
-    {
-        // No interpolation, full weight
-        if (channelMask & CHANNEL_POSITION)
-            node->SetPosition(keyFrame->position_);
-        if (channelMask & CHANNEL_ROTATION)
-            node->SetRotation(keyFrame->rotation_);
-        if (channelMask & CHANNEL_SCALE)
-            node->SetScale(keyFrame->scale_);
-    }
-    else
-    {
-        const AnimationKeyFrame* nextKeyFrame = &track->keyFrames_[nextFrame];
-        float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
-        if (timeInterval < 0.0f)
-            timeInterval += animation_->GetLength();
-        float t = timeInterval > 0.0f ? (time_ - keyFrame->time_) / timeInterval : 1.0f;
-
-        // Interpolation, full weight
-        if (channelMask & CHANNEL_POSITION)
-            node->SetPosition(keyFrame->position_.Lerp(nextKeyFrame->position_, t));
-        if (channelMask & CHANNEL_ROTATION)
-            node->SetRotation(keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t));
-        if (channelMask & CHANNEL_SCALE)
-            node->SetScale(keyFrame->scale_.Lerp(nextKeyFrame->scale_, t));
-    }
+    if (channelMask & CHANNEL_POSITION)
+        node->SetPosition(keyFrame.position_);
+    if (channelMask & CHANNEL_ROTATION)
+        node->SetRotation(keyFrame.rotation_);
+    if (channelMask & CHANNEL_SCALE)
+        node->SetScale(keyFrame.scale_);
 }
 
 void AnimationState::ApplyTrackFullWeightSilent(AnimationStateTrack& stateTrack)
@@ -491,55 +476,17 @@ void AnimationState::ApplyTrackFullWeightSilent(AnimationStateTrack& stateTrack)
     const AnimationTrack* track = stateTrack.track_;
     Node* node = stateTrack.node_;
 
-    if (track->keyFrames_.Empty() || !node)
+    AnimationKeyFrame keyFrame;
+    if (!node || !track->Sample(time_, animation_->GetLength(), looped_, stateTrack.keyFrame_, keyFrame))
         return;
 
-    unsigned& frame = stateTrack.keyFrame_;
-    track->GetKeyFrameIndex(time_, frame);
-
-    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
-    unsigned nextFrame = frame + 1;
-    bool interpolate = true;
-    if (nextFrame >= track->keyFrames_.Size())
-    {
-        if (!looped_)
-        {
-            nextFrame = frame;
-            interpolate = false;
-        }
-        else
-            nextFrame = 0;
-    }
-
-    const AnimationKeyFrame* keyFrame = &track->keyFrames_[frame];
     unsigned char channelMask = track->channelMask_;
-
-    if (!interpolate)
-    {
-        // No interpolation, full weight
-        if (channelMask & CHANNEL_POSITION)
-            node->SetPositionSilent(keyFrame->position_);
-        if (channelMask & CHANNEL_ROTATION)
-            node->SetRotationSilent(keyFrame->rotation_);
-        if (channelMask & CHANNEL_SCALE)
-            node->SetScaleSilent(keyFrame->scale_);
-    }
-    else
-    {
-        const AnimationKeyFrame* nextKeyFrame = &track->keyFrames_[nextFrame];
-        float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
-        if (timeInterval < 0.0f)
-            timeInterval += animation_->GetLength();
-        float t = timeInterval > 0.0f ? (time_ - keyFrame->time_) / timeInterval : 1.0f;
-
-        // Interpolation, full weight
-        if (channelMask & CHANNEL_POSITION)
-            node->SetPositionSilent(keyFrame->position_.Lerp(nextKeyFrame->position_, t));
-        if (channelMask & CHANNEL_ROTATION)
-            node->SetRotationSilent(keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t));
-        if (channelMask & CHANNEL_SCALE)
-            node->SetScaleSilent(keyFrame->scale_.Lerp(nextKeyFrame->scale_, t));
-    }
+    if (channelMask & CHANNEL_POSITION)
+        node->SetPositionSilent(keyFrame.position_);
+    if (channelMask & CHANNEL_ROTATION)
+        node->SetRotationSilent(keyFrame.rotation_);
+    if (channelMask & CHANNEL_SCALE)
+        node->SetScaleSilent(keyFrame.scale_);
 }
 
 void AnimationState::ApplyTrackBlendedSilent(AnimationStateTrack& stateTrack, float weight)
@@ -547,63 +494,47 @@ void AnimationState::ApplyTrackBlendedSilent(AnimationStateTrack& stateTrack, fl
     const AnimationTrack* track = stateTrack.track_;
     Node* node = stateTrack.node_;
 
-    if (track->keyFrames_.Empty() || !node)
+    AnimationKeyFrame keyFrame;
+    if (!node || !track->Sample(time_, animation_->GetLength(), looped_, stateTrack.keyFrame_, keyFrame))
         return;
 
-    unsigned& frame = stateTrack.keyFrame_;
-    track->GetKeyFrameIndex(time_, frame);
+    // Blend between old transform & animation
+    unsigned char channelMask = track->channelMask_;
+    if (channelMask & CHANNEL_POSITION)
+        node->SetPositionSilent(node->GetPosition().Lerp(keyFrame.position_, weight));
+    if (channelMask & CHANNEL_ROTATION)
+        node->SetRotationSilent(node->GetRotation().Slerp(keyFrame.rotation_, weight));
+    if (channelMask & CHANNEL_SCALE)
+        node->SetScaleSilent(node->GetScale().Lerp(keyFrame.scale_, weight));
+}
 
-    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
-    unsigned nextFrame = frame + 1;
-    bool interpolate = true;
-    if (nextFrame >= track->keyFrames_.Size())
-    {
-        if (!looped_)
-        {
-            nextFrame = frame;
-            interpolate = false;
-        }
-        else
-            nextFrame = 0;
-    }
+void AnimationState::ApplyTrackToPose(AnimationStateTrack& stateTrack, float weight)
+{
+    const AnimationTrack* track = stateTrack.track_;
+    unsigned index = stateTrack.boneIndex_;
 
-    const AnimationKeyFrame* keyFrame = &track->keyFrames_[frame];
-    unsigned char channelMask = track->channelMask_;
+    AnimationKeyFrame keyFrame;
+    if (index >= model_->posePositions_.Size() ||
+        !track->Sample(time_, animation_->GetLength(), looped_, stateTrack.keyFrame_, keyFrame))
+        return;
 
-    if (!interpolate)
+    // Write to the pose buffer, blending with the earlier animations if not at full weight
+    unsigned char channelMask = track->channelMask_;
+    bool fullWeight = Equals(weight, 1.0f);
+    if (channelMask & CHANNEL_POSITION)
     {
-        // No interpolation, blend between old transform & animation
-        if (channelMask & CHANNEL_POSITION)
-            node->SetPositionSilent(node->GetPosition().Lerp(keyFrame->position_, weight));
-        if (channelMask & CHANNEL_ROTATION)
-            node->SetRotationSilent(node->GetRotation().Slerp(keyFrame->rotation_, weight));
-        if (channelMask & CHANNEL_SCALE)
-            node->SetScaleSilent(node->GetScale().Lerp(keyFrame->scale_, weight));
+        Vector3& dest = model_->posePositions_[index];
+        dest = fullWeight ? keyFrame.position_ : dest.Lerp(keyFrame.position_, weight);
     }
-    else
+    if (channelMask & CHANNEL_ROTATION)
     {
-        const AnimationKeyFrame* nextKeyFrame = &track->keyFrames_[nextFrame];
-        float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
-        if (timeInterval < 0.0f)
-            timeInterval += animation_->GetLength();
-        float t = timeInterval > 0.0f ? (time_ - keyFrame->time_) / timeInterval : 1.0f;
-
-        // Interpolation, blend between old transform & animation
-        if (channelMask & CHANNEL_POSITION)
-        {
-            node->SetPositionSilent(node->GetPosition().Lerp(
-                keyFrame->position_.Lerp(nextKeyFrame->position_, t), weight));
-        }
-        if (channelMask & CHANNEL_ROTATION)
-        {
-            node->SetRotationSilent(node->GetRotation().Slerp(
-                keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t), weight));
-        }
-        if (channelMask & CHANNEL_SCALE)
-        {
-            node->SetScaleSilent(node->GetScale().Lerp(
-                keyFrame->scale_.Lerp(nextKeyFrame->scale_, t), weight));
-        }
+        Quaternion& dest = model_->poseRotations_[index];
+        dest = fullWeight ? keyFrame.rotation_ : dest.Slerp(keyFrame.rotation_, weight);
+    }
+    if (channelMask & CHANNEL_SCALE)
+    {
+        Vector3& dest = model_->poseScales_[index];
+        dest = fullWeight ? keyFrame.scale_ : dest.Lerp(keyFrame.scale_, weight);
     }
 }
 
@@ -48,6 +48,8 @@ struct AnimationStateTrack
     const AnimationTrack* track_;
     /// Bone pointer.
     Bone* bone_;
+    /// Bone index in the skeleton.
+    unsigned boneIndex_;
     /// Scene node pointer.
     WeakPtr<Node> node_;
     /// Blending weight.
@@ -134,6 +136,8 @@ public:
 private:
     /// Apply animation to a skeleton. Transform changes are applied silently, so the model needs to dirty its root model afterward.
     void ApplyToModel();
+    /// Apply animation to the pose buffer of the animated model.
+    void ApplyToPose();
     /// Apply animation to a scene node hierarchy.
     void ApplyToNodes();
     /// Apply animation track to a scene node, full weight.
@@ -142,6 +146,8 @@ private:
     void ApplyTrackFullWeightSilent(AnimationStateTrack& stateTrack);
     /// Apply animation track to a scene node, blended with current node transform. Apply transform changes silently without marking the node dirty.
     void ApplyTrackBlendedSilent(AnimationStateTrack& stateTrack, float weight);
+    /// Apply animation track to the pose buffer of the animated model, blended with the current pose if weight is less than full.
+    void ApplyTrackToPose(AnimationStateTrack& stateTrack, float weight);
 
     /// Animated model (model mode.)
     WeakPtr<AnimatedModel> model_;
@@ -80,6 +80,43 @@ inline bool CompareBatchGroupOrder(BatchGroup* lhs, BatchGroup* rhs)
     return lhs->renderOrder_ < rhs->renderOrder_;
 }
 
+/// Sort an almost sorted vector of batches with insertion sort. Fall back to a full sort if the order has changed too much.
+template <class T, class U> void SortIncremental(PODVector<T*>& batches, U compare)
+{
+    unsigned maxMoves = batches.Size() * 8;
+    unsigned moves = 0;
+
+    for (unsigned i = 1; i < batches.Size(); ++i)
+    {
+        T* batch = batches[i];
+        unsigned j = i;
+        while (j > 0 && compare(batch, batches[j - 1]))
+        {
+            batches[j] = batches[j - 1];
+            --j;
+            if (++moves > maxMoves)
+            {
+                batches[j] = batch;
+                Sort(batches.Begin(), batches.End(), compare);
+                return;
+            }
+        }
+        batches[j] = batch;
+    }
+}
+
+/// Remove groups without instances from a vector of batch groups.
+static void RemoveEmptyBatchGroups(PODVector<BatchGroup*>& groups)
+{
+    unsigned index = 0;
+    for (unsigned i = 0; i < groups.Size(); ++i)
+    {
+        if (!groups[i]->instances_.Empty())
+            groups[index++] = groups[i];
+    }
+    groups.Resize(index);
+}
+
 void CalculateShadowMatrix(Matrix4& dest, LightBatchQueue* queue, unsigned split, Renderer* renderer, const Vector3& translation)
 {
     Camera* shadowCamera = queue->shadowSplits_[split].shadowCamera_;
@@ -683,12 +720,49 @@ unsigned BatchGroupKey::ToHash() const
                       (size_t)material_ / sizeof(Material) + (size_t)geometry_ / sizeof(Geometry)) + renderOrder_;
 }
 
-void BatchQueue::Clear(int maxSortedInstances)
+void BatchQueue::Clear(int maxSortedInstances, bool retainGroups)
 {
     batches_.Clear();
     sortedBatches_.Clear();
-    batchGroups_.Clear();
     maxSortedInstances_ = (unsigned)maxSortedInstances;
+
+    if (retainGroups && retainGroups_)
+    {
+        // Keep the groups and their sorted order, so that only added and removed groups need to be processed. The group
+        // state is refreshed when it receives its first instance, and groups left without instances are removed
+        for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+        {
+            i->second_.instances_.Clear();
+            i->second_.startIndex_ = M_MAX_UNSIGNED;
+        }
+    }
+    else
+    {
+        batchGroups_.Clear();
+        sortedBatchGroups_.Clear();
+        distanceSortedBatchGroups_.Clear();
+        newBatchGroups_.Clear();
+    }
+
+    retainGroups_ = retainGroups;
+}
+
+void BatchQueue::RemoveUnusedGroups()
+{
+    if (!retainGroups_)
+        return;
+
+    RemoveEmptyBatchGroups(sortedBatchGroups_);
+    RemoveEmptyBatchGroups(distanceSortedBatchGroups_);
+    RemoveEmptyBatchGroups(newBatchGroups_);
+
+    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End();)
+    {
+        if (i->second_.instances_.Empty())
+            i = batchGroups_.Erase(i);
+        else
+            ++i;
+    }
 }
 
 void BatchQueue::SortBackToFront()
@@ -700,6 +774,14 @@ void BatchQueue::SortBackToFront()
 
     Sort(sortedBatches_.Begin(), sortedBatches_.End(), CompareBatchesBackToFront);
 
+    if (retainGroups_)
+    {
+        sortedBatchGroups_.Push(newBatchGroups_);
+        newBatchGroups_.Clear();
+        SortIncremental(sortedBatchGroups_, CompareBatchGroupOrder);
+        return;
+    }
+
     sortedBatchGroups_.Resize(batchGroups_.Size());
     
     unsigned index = 0;
@@ -736,6 +818,25 @@ void BatchQueue::SortFrontToBack()
         }
     }
 
+    if (retainGroups_)
+    {
+        // Add the new groups to the previous order and update it incrementally, which is fast while the view changes little
+        sortedBatchGroups_.Push(newBatchGroups_);
+        distanceSortedBatchGroups_.Push(newBatchGroups_);
+        newBatchGroups_.Clear();
+
+        PODVector<Batch*>& sortedGroups = reinterpret_cast<PODVector<Batch*>& >(sortedBatchGroups_);
+#ifdef GL_ES_VERSION_2_0
+        SortIncremental(sortedGroups, CompareBatchesState);
+#else
+        PODVector<Batch*>& distanceSortedGroups = reinterpret_cast<PODVector<Batch*>& >(distanceSortedBatchGroups_);
+        SortIncremental(distanceSortedGroups, CompareBatchesFrontToBack);
+        RemapSortKeys(distanceSortedGroups);
+        SortIncremental(sortedGroups, CompareBatchesState);
+#endif
+        return;
+    }
+
     sortedBatchGroups_.Resize(batchGroups_.Size());
 
     unsigned index = 0;
@@ -754,7 +855,15 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
 #else
     // For desktop, first sort by distance and remap shader/material/geometry IDs in the sort key
     Sort(batches.Begin(), batches.End(), CompareBatchesFrontToBack);
+    RemapSortKeys(batches);
+
+    // Finally sort again with the rewritten ID's
+    Sort(batches.Begin(), batches.End(), CompareBatchesState);
+#endif
+}
 
+void BatchQueue::RemapSortKeys(PODVector<Batch*>& batches)
+{
     unsigned freeShaderID = 0;
     unsigned short freeMaterialID = 0;
     unsigned short freeGeometryID = 0;
@@ -799,10 +908,6 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
     shaderRemapping_.Clear();
     materialRemapping_.Clear();
     geometryRemapping_.Clear();
-
-    // Finally sort again with the rewritten ID's
-    Sort(batches.Begin(), batches.End(), CompareBatchesState);
-#endif
 }
 
 void BatchQueue::SetTransforms(void* lockedData, unsigned& freeIndex)
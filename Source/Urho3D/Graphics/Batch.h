@@ -228,14 +228,25 @@ struct BatchGroupKey
 struct BatchQueue
 {
 public:
-    /// Clear for new frame by clearing all groups and batches.
-    void Clear(int maxSortedInstances);
+    /// Construct.
+    BatchQueue() :
+        maxSortedInstances_(0),
+        retainGroups_(false)
+    {
+    }
+
+    /// Clear for new frame by clearing all groups and batches. When retaining groups, only the group instances are cleared.
+    void Clear(int maxSortedInstances, bool retainGroups = false);
+    /// Remove retained groups that received no instances this frame.
+    void RemoveUnusedGroups();
     /// Sort non-instanced draw calls back to front.
     void SortBackToFront();
     /// Sort instanced and non-instanced draw calls front to back.
     void SortFrontToBack();
     /// Sort batches front to back while also maintaining state sorting.
     void SortFrontToBack2Pass(PODVector<Batch*>& batches);
+    /// Remap shader, material and geometry IDs in the sort keys of batches sorted front to back.
+    void RemapSortKeys(PODVector<Batch*>& batches);
     /// Pre-set instance transforms of all groups. The vertex buffer must be big enough to hold all transforms.
     void SetTransforms(void* lockedData, unsigned& freeIndex);
     /// Draw.
@@ -261,8 +272,14 @@ public:
     PODVector<Batch*> sortedBatches_;
     /// Sorted instanced draw calls.
     PODVector<BatchGroup*> sortedBatchGroups_;
+    /// Instanced draw calls sorted by distance. Only used when retaining groups.
+    PODVector<BatchGroup*> distanceSortedBatchGroups_;
+    /// Instanced draw calls created since the last sort. Only used when retaining groups.
+    PODVector<BatchGroup*> newBatchGroups_;
     /// Maximum sorted instances.
     unsigned maxSortedInstances_;
+    /// Retain groups and their sorted order between frames flag.
+    bool retainGroups_;
 };
 
 /// Queue for shadow map draw calls
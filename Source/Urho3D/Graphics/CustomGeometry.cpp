@@ -330,6 +330,8 @@ void CustomGeometry::Commit()
 {
     URHO3D_PROFILE(CommitCustomGeometry);
 
+    MarkOcclusionDirty();
+
     unsigned totalVertices = 0;
     boundingBox_.Clear();
 
@@ -413,6 +415,7 @@ void CustomGeometry::SetMaterial(Material* material)
     for (unsigned i = 0; i < batches_.Size(); ++i)
         batches_[i].material_ = material;
 
+    MarkOcclusionDirty();
     MarkNetworkUpdate();
 }
 
@@ -425,6 +428,7 @@ bool CustomGeometry::SetMaterial(unsigned index, Material* material)
     }
 
     batches_[index].material_ = material;
+    MarkOcclusionDirty();
     MarkNetworkUpdate();
     return true;
 }
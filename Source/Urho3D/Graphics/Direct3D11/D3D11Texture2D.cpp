@@ -40,7 +40,11 @@ namespace Urho3D
 {
 
 Texture2D::Texture2D(Context* context) :
-    Texture(context)
+    Texture(context),
+    uploadLevel_(0),
+    uploadNumLevels_(0),
+    uploadMipsToSkip_(0),
+    uploadDecompress_(false)
 {
 }
 
@@ -98,6 +102,36 @@ bool Texture2D::EndLoad()
     return success;
 }
 
+bool Texture2D::EndLoadStep(bool& complete)
+{
+    // Upload the remaining mip levels one per step, largest first
+    if (uploadImage_)
+    {
+        complete = UploadImageLevels(1);
+        return true;
+    }
+
+    // In headless mode, or if there is no image, finish in a single step
+    if (!graphics_ || !loadImage_)
+    {
+        complete = true;
+        return EndLoad();
+    }
+
+    // If over the texture budget, see if materials can be freed to allow textures to be freed
+    CheckTextureBudget(GetTypeStatic());
+
+    // Convert the image and create the texture on the first step
+    SetParameters(loadParameters_);
+    bool success = PrepareImage(loadImage_);
+
+    loadImage_.Reset();
+    loadParameters_.Reset();
+
+    complete = !success;
+    return success;
+}
+
 void Texture2D::Release()
 {
     if (object_)
@@ -254,14 +288,23 @@ bool Texture2D::SetData(unsigned level, int x, int y, int width, int height, con
 
 bool Texture2D::SetData(SharedPtr<Image> image, bool useAlpha)
 {
+    if (!PrepareImage(image, useAlpha))
+        return false;
+
+    UploadImageLevels(M_MAX_UNSIGNED);
+    return true;
+}
+
+bool Texture2D::PrepareImage(SharedPtr<Image> image, bool useAlpha)
+{
+    uploadImage_.Reset();
+
     if (!image)
     {
         URHO3D_LOGERROR("Null image, can not load texture");
         return false;
     }
 
-    unsigned memoryUse = sizeof(Texture2D);
-
     int quality = QUALITY_HIGH;
     Renderer* renderer = GetSubsystem<Renderer>();
     if (renderer)
@@ -279,7 +322,6 @@ bool Texture2D::SetData(SharedPtr<Image> image, bool useAlpha)
             components = image->GetComponents();
         }
 
-        unsigned char* levelData = image->GetData();
         int levelWidth = image->GetWidth();
         int levelHeight = image->GetHeight();
         unsigned format = 0;
@@ -288,7 +330,6 @@ bool Texture2D::SetData(SharedPtr<Image> image, bool useAlpha)
         for (unsigned i = 0; i < mipsToSkip_[quality]; ++i)
         {
             image = image->GetNextLevel();
-            levelData = image->GetData();
             levelWidth = image->GetWidth();
             levelHeight = image->GetHeight();
         }
@@ -311,19 +352,10 @@ bool Texture2D::SetData(SharedPtr<Image> image, bool useAlpha)
             requestedLevels_ = 0;
         SetSize(levelWidth, levelHeight, format);
 
-        for (unsigned i = 0; i < levels_; ++i)
-        {
-            SetData(i, 0, 0, levelWidth, levelHeight, levelData);
-            memoryUse += levelWidth * levelHeight * components;
-
-            if (i < levels_ - 1)
-            {
-                image = image->GetNextLevel();
-                levelData = image->GetData();
-                levelWidth = image->GetWidth();
-                levelHeight = image->GetHeight();
-            }
-        }
+        uploadImage_ = image;
+        uploadNumLevels_ = levels_;
+        uploadMipsToSkip_ = 0;
+        uploadDecompress_ = false;
     }
     else
     {
@@ -350,26 +382,63 @@ bool Texture2D::SetData(SharedPtr<Image> image, bool useAlpha)
         SetNumLevels((unsigned)Max((int)(levels - mipsToSkip), 1));
         SetSize(width, height, format);
 
-        for (unsigned i = 0; i < levels_ && i < levels - mipsToSkip; ++i)
+        uploadImage_ = image;
+        uploadNumLevels_ = levels_ < levels - mipsToSkip ? levels_ : levels - mipsToSkip;
+        uploadMipsToSkip_ = mipsToSkip;
+        uploadDecompress_ = needDecompress;
+    }
+
+    uploadLevel_ = 0;
+    SetMemoryUse(sizeof(Texture2D));
+    return true;
+}
+
+bool Texture2D::UploadImageLevels(unsigned maxLevels)
+{
+    if (!uploadImage_)
+        return true;
+
+    unsigned memoryUse = GetMemoryUse();
+
+    for (; uploadLevel_ < uploadNumLevels_ && maxLevels; --maxLevels)
+    {
+        if (!uploadImage_->IsCompressed())
+        {
+            int levelWidth = uploadImage_->GetWidth();
+            int levelHeight = uploadImage_->GetHeight();
+            SetData(uploadLevel_, 0, 0, levelWidth, levelHeight, uploadImage_->GetData());
+            memoryUse += levelWidth * levelHeight * uploadImage_->GetComponents();
+
+            if (uploadLevel_ < uploadNumLevels_ - 1)
+                uploadImage_ = uploadImage_->GetNextLevel();
+        }
+        else
         {
-            CompressedLevel level = image->GetCompressedLevel(i + mipsToSkip);
-            if (!needDecompress)
+            CompressedLevel level = uploadImage_->GetCompressedLevel(uploadLevel_ + uploadMipsToSkip_);
+            if (!uploadDecompress_)
             {
-                SetData(i, 0, 0, level.width_, level.height_, level.data_);
+                SetData(uploadLevel_, 0, 0, level.width_, level.height_, level.data_);
                 memoryUse += level.rows_ * level.rowSize_;
             }
             else
             {
                 unsigned char* rgbaData = new unsigned char[level.width_ * level.height_ * 4];
                 level.Decompress(rgbaData);
-                SetData(i, 0, 0, level.width_, level.height_, rgbaData);
+                SetData(uploadLevel_, 0, 0, level.width_, level.height_, rgbaData);
                 memoryUse += level.width_ * level.height_ * 4;
                 delete[] rgbaData;
             }
         }
+
+        ++uploadLevel_;
     }
 
     SetMemoryUse(memoryUse);
+
+    if (uploadLevel_ < uploadNumLevels_)
+        return false;
+
+    uploadImage_.Reset();
     return true;
 }
 
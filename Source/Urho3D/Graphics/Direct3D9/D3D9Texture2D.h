@@ -49,6 +49,8 @@ public:
     virtual bool BeginLoad(Deserializer& source);
     /// Finish resource loading. Always called from the main thread. Return true if successful.
     virtual bool EndLoad();
+    /// Perform one step of finishing resource loading. The first step creates the texture and each following step uploads one mip level. Always called from the main thread. Return true if successful.
+    virtual bool EndLoadStep(bool& complete);
     /// Release default pool resources.
     virtual void OnDeviceLost();
     /// Recreate default pool resources.
@@ -72,6 +74,10 @@ public:
 private:
     /// Create texture.
     bool Create();
+    /// Set size and format from an image and prepare its mip levels for uploading. Return true if successful.
+    bool PrepareImage(SharedPtr<Image> image, bool useAlpha = false);
+    /// Upload at most the specified number of prepared mip levels. Return true when all levels have been uploaded.
+    bool UploadImageLevels(unsigned maxLevels);
     /// Handle render surface update event.
     void HandleRenderSurfaceUpdate(StringHash eventType, VariantMap& eventData);
 
@@ -81,6 +87,16 @@ private:
     SharedPtr<Image> loadImage_;
     /// Parameter file acquired during BeginLoad.
     SharedPtr<XMLFile> loadParameters_;
+    /// Image of the next mip level to upload, or the compressed image.
+    SharedPtr<Image> uploadImage_;
+    /// Next mip level to upload.
+    unsigned uploadLevel_;
+    /// Number of mip levels to upload.
+    unsigned uploadNumLevels_;
+    /// Number of compressed image levels skipped due to texture quality.
+    unsigned uploadMipsToSkip_;
+    /// Whether compressed levels need to be decompressed before uploading.
+    bool uploadDecompress_;
 };
 
 }
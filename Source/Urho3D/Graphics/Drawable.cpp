@@ -36,6 +36,8 @@
 #include "../IO/Log.h"
 #include "../Scene/Scene.h"
 
+#include <SDL/SDL_atomic.h>
+
 #include "../DebugNew.h"
 
 #ifdef _MSC_VER
@@ -47,6 +49,9 @@ namespace Urho3D
 
 const char* GEOMETRY_CATEGORY = "Geometry";
 
+/// Counter for unique occlusion data revisions.
+static SDL_atomic_t occlusionRevisionCounter;
+
 SourceBatch::SourceBatch() :
     distance_(0.0f),
     geometry_(0),
@@ -83,18 +88,22 @@ Drawable::Drawable(Context* context, unsigned char drawableFlags) :
     boundingBox_(0.0f, 0.0f),
     drawableFlags_(drawableFlags),
     worldBoundingBoxDirty_(true),
+    cameraDependentBoundingBox_(false),
     castShadows_(false),
     occluder_(false),
     occludee_(true),
     updateQueued_(false),
     zoneDirty_(false),
     octant_(0),
+    octantIndex_(0),
     zone_(0),
     viewMask_(DEFAULT_VIEWMASK),
     lightMask_(DEFAULT_LIGHTMASK),
     shadowMask_(DEFAULT_SHADOWMASK),
     zoneMask_(DEFAULT_ZONEMASK),
     viewFrameNumber_(0),
+    occlusionFrameNumber_(0),
+    occlusionRevision_(0),
     distance_(0.0f),
     lodDistance_(0.0f),
     drawDistance_(0.0f),
@@ -107,6 +116,7 @@ Drawable::Drawable(Context* context, unsigned char drawableFlags) :
     maxLights_(0),
     firstLight_(0)
 {
+    MarkOcclusionDirty();
 }
 
 Drawable::~Drawable()
@@ -123,6 +133,25 @@ void Drawable::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Zone Mask", GetZoneMask, SetZoneMask, unsigned, DEFAULT_ZONEMASK, AM_DEFAULT);
 }
 
+void Drawable::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
+{
+    Serializable::OnSetAttribute(attr, src);
+    // Masks, draw distance and shadowcasting can be set directly as attributes, so update the packed copy
+    UpdatePackedBounds();
+    // Any attribute may affect the occlusion geometry, for example the model or the occlusion LOD level
+    MarkOcclusionDirty();
+}
+
+bool Drawable::OnLoadAttribute(const AttributeInfo& attr, Deserializer& source)
+{
+    if (!LoadAttributeDirect(attr, source))
+        return false;
+
+    UpdatePackedBounds();
+    MarkOcclusionDirty();
+    return true;
+}
+
 void Drawable::OnSetEnabled()
 {
     bool enabled = IsEnabledEffective();
@@ -176,6 +205,10 @@ void Drawable::UpdateGeometry(const FrameInfo& frame)
 {
 }
 
+void Drawable::FinishUpdateGeometry()
+{
+}
+
 Geometry* Drawable::GetLodGeometry(unsigned batchIndex, unsigned level)
 {
     // By default return the visible batch geometry
@@ -199,6 +232,7 @@ void Drawable::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
 void Drawable::SetDrawDistance(float distance)
 {
     drawDistance_ = distance;
+    UpdatePackedBounds();
     MarkNetworkUpdate();
 }
 
@@ -217,6 +251,7 @@ void Drawable::SetLodBias(float bias)
 void Drawable::SetViewMask(unsigned mask)
 {
     viewMask_ = mask;
+    UpdatePackedBounds();
     MarkNetworkUpdate();
 }
 
@@ -249,12 +284,14 @@ void Drawable::SetMaxLights(unsigned num)
 void Drawable::SetCastShadows(bool enable)
 {
     castShadows_ = enable;
+    UpdatePackedBounds();
     MarkNetworkUpdate();
 }
 
 void Drawable::SetOccluder(bool enable)
 {
     occluder_ = enable;
+    MarkOcclusionDirty();
     MarkNetworkUpdate();
 }
 
@@ -345,6 +382,12 @@ void Drawable::MarkInView(unsigned frameNumber)
     }
 }
 
+void Drawable::MarkOcclusionDirty()
+{
+    // Take the revision from a global counter, as this may be called from worker threads
+    occlusionRevision_ = (unsigned)SDL_AtomicAdd(&occlusionRevisionCounter, 1) + 1;
+}
+
 void Drawable::LimitLights()
 {
     // Maximum lights value 0 means unlimited
@@ -402,12 +445,22 @@ void Drawable::OnMarkedDirty(Node* node)
     worldBoundingBoxDirty_ = true;
     if (!updateQueued_ && octant_)
         octant_->GetRoot()->QueueUpdate(this);
+    // Occluders may draw other nodes than their own, for example StaticModelGroup instances
+    if (occluder_)
+        MarkOcclusionDirty();
 
     // Mark zone assignment dirty when transform changes
     if (node == node_)
         zoneDirty_ = true;
 }
 
+void Drawable::UpdatePackedBounds()
+{
+    // The octree refreshes the packed copies of queued drawables in the main thread, so that culling queries in worker
+    // threads only read them
+    MarkForUpdate();
+}
+
 void Drawable::AddToOctree()
 {
     // Do not add to octree when disabled
@@ -108,6 +108,7 @@ class URHO3D_API Drawable : public Component
 
     friend class Octant;
     friend class Octree;
+    friend struct PackedDrawableBounds;
     friend void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex);
 
 public:
@@ -118,6 +119,12 @@ public:
     /// Register object attributes. Drawable must be registered first.
     static void RegisterObject(Context* context);
 
+    /// Handle attribute change.
+    virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
+    /// Handle attribute change from binary data.
+    virtual bool OnLoadAttribute(const AttributeInfo& attr, Deserializer& source);
+    /// Handle attribute read access to binary data.
+    virtual bool OnSaveAttribute(const AttributeInfo& attr, Serializer& dest) const { return SaveAttributeDirect(attr, dest); }
     /// Handle enabled/disabled state change.
     virtual void OnSetEnabled();
     /// Process octree raycast. May be called from a worker thread.
@@ -128,6 +135,8 @@ public:
     virtual void UpdateBatches(const FrameInfo& frame);
     /// Prepare geometry for rendering.
     virtual void UpdateGeometry(const FrameInfo& frame);
+    /// Finish a worker thread geometry update in the main thread, for example by uploading vertex data. Called after all worker thread geometry updates have completed.
+    virtual void FinishUpdateGeometry();
 
     /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
     virtual UpdateGeometryType GetUpdateGeometryType() { return UPDATE_NONE; }
@@ -142,6 +151,8 @@ public:
     virtual bool DrawOcclusion(OcclusionBuffer* buffer);
     /// Visualize the component as debug geometry.
     virtual void DrawDebugGeometry(DebugRenderer* debug, bool depthTest);
+    /// Return whether the binary attribute data can be read in a worker thread when loading a columnar scene.
+    virtual bool IsLoadThreadSafe() const { return true; }
 
     /// Set draw distance.
     void SetDrawDistance(float distance);
@@ -234,6 +245,8 @@ public:
     void MarkInView(const FrameInfo& frame);
     /// Mark in view without specifying a camera. Used for shadow casters.
     void MarkInView(unsigned frameNumber);
+    /// Mark passing the occlusion test. Used by temporal occlusion.
+    void MarkOcclusionVisible(unsigned frameNumber) { occlusionFrameNumber_ = frameNumber; }
     /// Sort and limit per-pixel lights to maximum allowed. Convert extra lights into vertex lights.
     void LimitLights();
     /// Sort and limit per-vertex lights to maximum allowed.
@@ -260,6 +273,13 @@ public:
     /// Return sorting value.
     float GetSortValue() const { return sortValue_; }
 
+    /// Return the frame number the occlusion test was last passed on, or 0 if never.
+    unsigned GetOcclusionFrameNumber() const { return occlusionFrameNumber_; }
+    /// Mark the data drawn into occlusion buffers (model, LOD levels, materials or geometry) changed. Used by temporal occlusion.
+    void MarkOcclusionDirty();
+    /// Return the occlusion data revision. Revisions are unique across all drawables, so a new drawable never has the revision of a destroyed one.
+    unsigned GetOcclusionRevision() const { return occlusionRevision_; }
+
     /// Return whether is in view on the current frame. Called by View.
     bool IsInView(const FrameInfo& frame, bool anyCamera = false) const;
 
@@ -319,6 +339,8 @@ protected:
 
     /// Move into another octree octant.
     void SetOctant(Octant* octant) { octant_ = octant; }
+    /// Queue the octant's packed copy of the bounding box, masks and draw distance to be refreshed after they have changed.
+    void UpdatePackedBounds();
 
     /// World-space bounding box.
     BoundingBox worldBoundingBox_;
@@ -330,6 +352,8 @@ protected:
     unsigned char drawableFlags_;
     /// Bounding box dirty flag.
     bool worldBoundingBoxDirty_;
+    /// Camera-dependent bounding box flag. The octant's packed copy of the bounding box is kept infinite, so that the actual bounding box is always tested.
+    bool cameraDependentBoundingBox_;
     /// Shadowcaster flag.
     bool castShadows_;
     /// Occluder flag.
@@ -342,6 +366,8 @@ protected:
     bool zoneDirty_;
     /// Octree octant.
     Octant* octant_;
+    /// Index in the octant's drawable list.
+    unsigned octantIndex_;
     /// Current zone.
     Zone* zone_;
     /// View mask.
@@ -354,6 +380,10 @@ protected:
     unsigned zoneMask_;
     /// Last visible frame number.
     unsigned viewFrameNumber_;
+    /// Last frame number the occlusion test was passed on.
+    unsigned occlusionFrameNumber_;
+    /// Occlusion data revision.
+    unsigned occlusionRevision_;
     /// Current distance to camera.
     float distance_;
     /// LOD scaled distance.
@@ -151,8 +151,12 @@ void Light::RegisterObject(Context* context)
 
 void Light::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
 {
-    Serializable::OnSetAttribute(attr, src);
+    Drawable::OnSetAttribute(attr, src);
+    ValidateAttribute(attr);
+}
 
+void Light::ValidateAttribute(const AttributeInfo& attr)
+{
     // Validate the bias, cascade & focus parameters
     if (attr.offset_ >= offsetof(Light, shadowBias_) && attr.offset_ < (offsetof(Light, shadowBias_) + sizeof(BiasParameters)))
         shadowBias_.Validate();
@@ -164,6 +168,15 @@ void Light::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
         shadowFocus_.Validate();
 }
 
+bool Light::OnLoadAttribute(const AttributeInfo& attr, Deserializer& source)
+{
+    if (!Drawable::OnLoadAttribute(attr, source))
+        return false;
+
+    ValidateAttribute(attr);
+    return true;
+}
+
 void Light::ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQueryResult>& results)
 {
     // Do not record a raycast result for a directional light, as it would block all other results
@@ -162,6 +162,8 @@ public:
 
     /// Handle attribute change.
     virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
+    /// Handle attribute change from binary data.
+    virtual bool OnLoadAttribute(const AttributeInfo& attr, Deserializer& source);
     /// Process octree raycast. May be called from a worker thread.
     virtual void ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQueryResult>& results);
     /// Calculate distance and prepare batches for rendering. May be called from worker thread(s), possibly re-entrantly.
@@ -306,6 +308,9 @@ protected:
     virtual void OnWorldBoundingBoxUpdate();
 
 private:
+    /// Validate the bias, cascade or focus parameters after a member attribute has changed.
+    void ValidateAttribute(const AttributeInfo& attr);
+
     /// Light type.
     LightType lightType_;
     /// Color.
@@ -40,6 +40,8 @@
 #include "../Scene/SceneEvents.h"
 #include "../Scene/ValueAnimation.h"
 
+#include <SDL/SDL_atomic.h>
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -91,6 +93,9 @@ static const char* fillModeNames[] =
     0
 };
 
+/// Revision of material occlusion and cull mode changes.
+static SDL_atomic_t occlusionRevision;
+
 TextureUnit ParseTextureUnitName(String name)
 {
     name = name.ToLower().Trimmed();
@@ -171,13 +176,13 @@ void ShaderParameterAnimationInfo::ApplyValue(const Variant& newValue)
 
 Material::Material(Context* context) :
     Resource(context),
-    auxViewFrameNumber_(0),
     shaderParameterHash_(0),
     occlusion_(true),
     specular_(false),
     subscribed_(false),
     batchedParameterUpdate_(false)
 {
+    SDL_AtomicSet(&auxViewFrameNumber_, 0);
     ResetToDefaults();
 }
 
@@ -621,7 +626,11 @@ void Material::SetUVTransform(const Vector2& offset, float rotation, float repea
 
 void Material::SetCullMode(CullMode mode)
 {
-    cullMode_ = mode;
+    if (mode != cullMode_)
+    {
+        cullMode_ = mode;
+        SDL_AtomicIncRef(&occlusionRevision);
+    }
 }
 
 void Material::SetShadowCullMode(CullMode mode)
@@ -702,7 +711,7 @@ void Material::SortTechniques()
 
 void Material::MarkForAuxView(unsigned frameNumber)
 {
-    auxViewFrameNumber_ = frameNumber;
+    SDL_AtomicSet(&auxViewFrameNumber_, (int)frameNumber);
 }
 
 const TechniqueEntry& Material::GetTechniqueEntry(unsigned index) const
@@ -770,8 +779,15 @@ Variant Material::ParseShaderParameterValue(const String& value)
         return ToVectorVariant(valueTrimmed);
 }
 
+unsigned Material::GetOcclusionRevision()
+{
+    return (unsigned)SDL_AtomicGet(&occlusionRevision);
+}
+
 void Material::CheckOcclusion()
 {
+    bool oldOcclusion = occlusion_;
+
     // Determine occlusion by checking the base pass of each technique
     occlusion_ = false;
     for (unsigned i = 0; i < techniques_.Size(); ++i)
@@ -784,6 +800,9 @@ void Material::CheckOcclusion()
                 occlusion_ = true;
         }
     }
+
+    if (occlusion_ != oldOcclusion)
+        SDL_AtomicIncRef(&occlusionRevision);
 }
 
 void Material::ResetToDefaults()
@@ -807,7 +826,7 @@ void Material::ResetToDefaults()
     SetShaderParameter("MatSpecColor", Vector4(0.0f, 0.0f, 0.0f, 1.0f));
     batchedParameterUpdate_ = false;
 
-    cullMode_ = CULL_CCW;
+    SetCullMode(CULL_CCW);
     shadowCullMode_ = CULL_CCW;
     fillMode_ = FILL_SOLID;
     depthBias_ = BiasParameters(0.0f, 0.0f);
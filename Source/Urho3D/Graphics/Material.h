@@ -28,6 +28,8 @@
 #include "../Resource/Resource.h"
 #include "../Scene/ValueAnimationInfo.h"
 
+#include <SDL/SDL_atomic.h>
+
 namespace Urho3D
 {
 
@@ -210,11 +212,13 @@ public:
     /// Return render order.
     unsigned char GetRenderOrder() const { return renderOrder_; }
     
-    /// Return last auxiliary view rendered frame number.
-    unsigned GetAuxViewFrameNumber() const { return auxViewFrameNumber_; }
+    /// Return last auxiliary view rendered frame number. Is thread-safe.
+    unsigned GetAuxViewFrameNumber() const { return (unsigned)SDL_AtomicGet(&auxViewFrameNumber_); }
 
     /// Return whether should render occlusion.
     bool GetOcclusion() const { return occlusion_; }
+    /// Return a revision number that changes whenever the occlusion or cull mode of any material changes. Used by temporal occlusion.
+    static unsigned GetOcclusionRevision();
 
     /// Return whether should render specular.
     bool GetSpecular() const { return specular_; }
@@ -264,8 +268,8 @@ private:
     BiasParameters depthBias_;
     /// Render order value.
     unsigned char renderOrder_;
-    /// Last auxiliary view rendered frame number.
-    unsigned auxViewFrameNumber_;
+    /// Last auxiliary view rendered frame number. Read from worker threads when collecting batches.
+    mutable SDL_atomic_t auxViewFrameNumber_;
     /// Shader parameter hash value.
     unsigned shaderParameterHash_;
     /// Render occlusion flag.
@@ -36,6 +36,9 @@
 namespace Urho3D
 {
 
+/// Maximum vertex and index data in bytes to upload per step when finishing an asynchronous load in several steps.
+static const unsigned MODEL_UPLOAD_STEP_SIZE = 1024 * 1024;
+
 unsigned LookupVertexBuffer(VertexBuffer* buffer, const Vector<SharedPtr<VertexBuffer> >& buffers)
 {
     for (unsigned i = 0; i < buffers.Size(); ++i)
@@ -57,7 +60,9 @@ unsigned LookupIndexBuffer(IndexBuffer* buffer, const Vector<SharedPtr<IndexBuff
 }
 
 Model::Model(Context* context) :
-    Resource(context)
+    Resource(context),
+    loadBufferIndex_(0),
+    loadBufferOffset_(0)
 {
 }
 
@@ -88,6 +93,8 @@ bool Model::BeginLoad(Deserializer& source)
 
     unsigned memoryUse = sizeof(Model);
     bool async = GetAsyncLoadState() == ASYNC_LOADING;
+    loadBufferIndex_ = 0;
+    loadBufferOffset_ = 0;
 
     // Read vertex buffers
     unsigned numVertexBuffers = source.ReadUInt();
@@ -290,48 +297,18 @@ bool Model::BeginLoad(Deserializer& source)
 
 bool Model::EndLoad()
 {
-    // Upload vertex buffer data
-    for (unsigned i = 0; i < vertexBuffers_.Size(); ++i)
-    {
-        VertexBuffer* buffer = vertexBuffers_[i];
-        VertexBufferDesc& desc = loadVBData_[i];
-        if (desc.data_)
-        {
-            buffer->SetShadowed(true);
-            buffer->SetSize(desc.vertexCount_, desc.elementMask_);
-            buffer->SetData(desc.data_.Get());
-        }
-    }
-
-    // Upload index buffer data
-    for (unsigned i = 0; i < indexBuffers_.Size(); ++i)
-    {
-        IndexBuffer* buffer = indexBuffers_[i];
-        IndexBufferDesc& desc = loadIBData_[i];
-        if (desc.data_)
-        {
-            buffer->SetShadowed(true);
-            buffer->SetSize(desc.indexCount_, desc.indexSize_ > sizeof(unsigned short));
-            buffer->SetData(desc.data_.Get());
-        }
-    }
-
-    // Set up geometries
-    for (unsigned i = 0; i < geometries_.Size(); ++i)
-    {
-        for (unsigned j = 0; j < geometries_[i].Size(); ++j)
-        {
-            Geometry* geometry = geometries_[i][j];
-            GeometryDesc& desc = loadGeometries_[i][j];
-            geometry->SetVertexBuffer(0, vertexBuffers_[desc.vbRef_]);
-            geometry->SetIndexBuffer(indexBuffers_[desc.ibRef_]);
-            geometry->SetDrawRange(desc.type_, desc.indexStart_, desc.indexCount_);
-        }
-    }
+    // Upload vertex & index buffer data, then set up geometries
+    UploadBufferData(M_MAX_UNSIGNED);
+    SetupGeometries();
+    return true;
+}
 
-    loadVBData_.Clear();
-    loadIBData_.Clear();
-    loadGeometries_.Clear();
+bool Model::EndLoadStep(bool& complete)
+{
+    // Upload a limited amount of buffer data per step, and set up geometries once all data is uploaded
+    complete = UploadBufferData(MODEL_UPLOAD_STEP_SIZE);
+    if (complete)
+        SetupGeometries();
     return true;
 }
 
@@ -724,4 +701,103 @@ unsigned Model::GetMorphRangeCount(unsigned bufferIndex) const
     return bufferIndex < vertexBuffers_.Size() ? morphRangeCounts_[bufferIndex] : 0;
 }
 
+
+bool Model::UploadBufferData(unsigned maxBytes)
+{
+    unsigned numVertexBuffers = loadVBData_.Size();
+    unsigned numBuffers = numVertexBuffers + loadIBData_.Size();
+
+    while (loadBufferIndex_ < numBuffers)
+    {
+        // Buffers without load data were already filled in BeginLoad()
+        const unsigned char* data;
+        unsigned count;
+        unsigned elementSize;
+        if (loadBufferIndex_ < numVertexBuffers)
+        {
+            VertexBufferDesc& desc = loadVBData_[loadBufferIndex_];
+            data = desc.data_.Get();
+            count = desc.vertexCount_;
+            elementSize = VertexBuffer::GetVertexSize(desc.elementMask_);
+        }
+        else
+        {
+            IndexBufferDesc& desc = loadIBData_[loadBufferIndex_ - numVertexBuffers];
+            data = desc.data_.Get();
+            count = desc.indexCount_;
+            elementSize = desc.indexSize_;
+        }
+
+        if (data && !maxBytes)
+            return false;
+
+        if (data)
+        {
+            // Always upload at least one element so that loading progresses
+            unsigned uploadCount = count - loadBufferOffset_;
+            if (elementSize && uploadCount > maxBytes / elementSize)
+                uploadCount = maxBytes / elementSize ? maxBytes / elementSize : 1;
+            unsigned uploadBytes = uploadCount * elementSize;
+            maxBytes = uploadBytes < maxBytes ? maxBytes - uploadBytes : 0;
+
+            if (loadBufferIndex_ < numVertexBuffers)
+            {
+                VertexBuffer* buffer = vertexBuffers_[loadBufferIndex_];
+                if (!loadBufferOffset_)
+                {
+                    buffer->SetShadowed(true);
+                    buffer->SetSize(count, loadVBData_[loadBufferIndex_].elementMask_);
+                }
+                if (uploadCount == count)
+                    buffer->SetData(data);
+                else if (uploadCount)
+                    buffer->SetDataRange(data + loadBufferOffset_ * elementSize, loadBufferOffset_, uploadCount);
+            }
+            else
+            {
+                IndexBuffer* buffer = indexBuffers_[loadBufferIndex_ - numVertexBuffers];
+                if (!loadBufferOffset_)
+                {
+                    buffer->SetShadowed(true);
+                    buffer->SetSize(count, elementSize > sizeof(unsigned short));
+                }
+                if (uploadCount == count)
+                    buffer->SetData(data);
+                else if (uploadCount)
+                    buffer->SetDataRange(data + loadBufferOffset_ * elementSize, loadBufferOffset_, uploadCount);
+            }
+
+            loadBufferOffset_ += uploadCount;
+            if (loadBufferOffset_ < count)
+                return false;
+        }
+
+        ++loadBufferIndex_;
+        loadBufferOffset_ = 0;
+    }
+
+    return true;
+}
+
+void Model::SetupGeometries()
+{
+    for (unsigned i = 0; i < geometries_.Size(); ++i)
+    {
+        for (unsigned j = 0; j < geometries_[i].Size(); ++j)
+        {
+            Geometry* geometry = geometries_[i][j];
+            GeometryDesc& desc = loadGeometries_[i][j];
+            geometry->SetVertexBuffer(0, vertexBuffers_[desc.vbRef_]);
+            geometry->SetIndexBuffer(indexBuffers_[desc.ibRef_]);
+            geometry->SetDrawRange(desc.type_, desc.indexStart_, desc.indexCount_);
+        }
+    }
+
+    loadVBData_.Clear();
+    loadIBData_.Clear();
+    loadGeometries_.Clear();
+    loadBufferIndex_ = 0;
+    loadBufferOffset_ = 0;
+}
+
 }
@@ -121,6 +121,8 @@ public:
     virtual bool BeginLoad(Deserializer& source);
     /// Finish resource loading. Always called from the main thread. Return true if successful.
     virtual bool EndLoad();
+    /// Perform one step of finishing resource loading. Each step uploads a limited amount of vertex and index data. Always called from the main thread. Return true if successful.
+    virtual bool EndLoadStep(bool& complete);
     /// Save resource. Return true if successful.
     virtual bool Save(Serializer& dest) const;
 
@@ -202,6 +204,11 @@ public:
     unsigned GetMorphRangeCount(unsigned bufferIndex) const;
 
 private:
+    /// Upload vertex and index buffer data for asynchronous loading, at most the specified amount of bytes. Return true when all data has been uploaded.
+    bool UploadBufferData(unsigned maxBytes);
+    /// Set up geometries after asynchronous loading and free the load data.
+    void SetupGeometries();
+
     /// Bounding box.
     BoundingBox boundingBox_;
     /// Skeleton.
@@ -228,6 +235,10 @@ private:
     Vector<IndexBufferDesc> loadIBData_;
     /// Geometry definitions for asynchronous loading.
     Vector<PODVector<GeometryDesc> > loadGeometries_;
+    /// Vertex or index buffer being uploaded. Vertex buffers come first.
+    unsigned loadBufferIndex_;
+    /// Vertices or indices of the current buffer already uploaded.
+    unsigned loadBufferOffset_;
 };
 
 }
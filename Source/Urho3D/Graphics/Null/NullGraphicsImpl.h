@@ -0,0 +1,80 @@
+//
+// Copyright (c) 2008-2015 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../../Graphics/GraphicsDefs.h"
+
+#include <SDL/SDL.h>
+
+namespace Urho3D
+{
+
+/// Texture formats of the null backend. Only used to calculate texture data sizes.
+enum NullTextureFormat
+{
+    NULLFMT_UNKNOWN = 0,
+    NULLFMT_A8,
+    NULLFMT_R8,
+    NULLFMT_RG8,
+    NULLFMT_RGBA8,
+    NULLFMT_RGBA8_SRGB,
+    NULLFMT_RGBA16,
+    NULLFMT_RGBA16F,
+    NULLFMT_RGBA32F,
+    NULLFMT_RG16,
+    NULLFMT_RG16F,
+    NULLFMT_RG32F,
+    NULLFMT_R16F,
+    NULLFMT_R32F,
+    NULLFMT_D16,
+    NULLFMT_D24S8,
+    NULLFMT_D32,
+    NULLFMT_DXT1,
+    NULLFMT_DXT1_SRGB,
+    NULLFMT_DXT3,
+    NULLFMT_DXT3_SRGB,
+    NULLFMT_DXT5,
+    NULLFMT_DXT5_SRGB
+};
+
+/// %Graphics implementation. The null backend has no API-specific objects; only tracks whether a screen mode has been set.
+class URHO3D_API GraphicsImpl
+{
+    friend class Graphics;
+
+public:
+    /// Construct.
+    GraphicsImpl();
+
+    /// Return window. Always null, as the null backend does not open a window.
+    SDL_Window* GetWindow() const { return 0; }
+
+    /// Return whether a screen mode has been set.
+    bool IsModeSet() const { return modeSet_; }
+
+private:
+    /// Screen mode set flag.
+    bool modeSet_;
+};
+
+}
@@ -28,6 +28,12 @@
 #include "../Graphics/OcclusionBuffer.h"
 #include "../IO/Log.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#elif defined(URHO3D_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -47,18 +53,27 @@ void DrawOcclusionBatchWork(const WorkItem* item, unsigned threadIndex)
     buffer->DrawBatch(batch, threadIndex);
 }
 
+void DrawOcclusionBandWork(const WorkItem* item, unsigned threadIndex)
+{
+    OcclusionBuffer* buffer = reinterpret_cast<OcclusionBuffer*>(item->aux_);
+    buffer->DrawBand((unsigned)reinterpret_cast<size_t>(item->start_));
+}
+
 OcclusionBuffer::OcclusionBuffer(Context* context) :
     Object(context),
     width_(0),
     height_(0),
     numTriangles_(0),
     maxTriangles_(OCCLUSION_DEFAULT_MAX_TRIANGLES),
+    numBands_(0),
+    threaded_(false),
     cullMode_(CULL_CCW),
     depthHierarchyDirty_(true),
     reverseCulling_(false),
     nearClip_(0.0f),
     farClip_(0.0f)
 {
+    buffer_.data_ = 0;
 }
 
 OcclusionBuffer::~OcclusionBuffer()
@@ -71,7 +86,10 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     if (height & 1)
         ++height;
 
-    if (width == width_ && height == height_)
+    // Threaded rasterization requires worker threads
+    threaded = threaded && GetSubsystem<WorkQueue>()->GetNumThreads() > 0;
+
+    if (width == width_ && height == height_ && threaded == threaded_)
         return true;
 
     if (width <= 0 || height <= 0)
@@ -86,17 +104,20 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     width_ = width;
     height_ = height;
 
-    // Build work buffers for threading
-    unsigned numThreadBuffers = threaded ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 1;
-    buffers_.Resize(numThreadBuffers);
-    for (unsigned i = 0; i < numThreadBuffers; ++i)
-    {
-        // Reserve extra memory in case 3D clipping is not exact
-        OcclusionBufferData& buffer = buffers_[i];
-        buffer.dataWithSafety_ = new int[width * (height + 2) + 2];
-        buffer.data_ = buffer.dataWithSafety_.Get() + width + 1;
-        buffer.used_ = false;
-    }
+    threaded_ = threaded;
+
+    // Reserve extra memory in case 3D clipping is not exact
+    buffer_.dataWithSafety_ = new int[width * (height + 2) + 2];
+    buffer_.data_ = buffer_.dataWithSafety_.Get() + width + 1;
+
+    // Build triangle bins for threading. Each thread bins its triangles to horizontal bands of the buffer, which are
+    // then rasterized in parallel without needing to merge
+    unsigned numThreadBuffers = threaded ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 0;
+    numBands_ = threaded ? (unsigned)(height + OCCLUSION_BAND_HEIGHT - 1) / OCCLUSION_BAND_HEIGHT : 0;
+    triangles_.Clear();
+    triangles_.Resize(numThreadBuffers);
+    bins_.Clear();
+    bins_.Resize(numThreadBuffers * numBands_);
 
     mipBuffers_.Clear();
 
@@ -113,7 +134,7 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     }
 
     URHO3D_LOGDEBUG("Set occlusion buffer size " + String(width_) + "x" + String(height_) + " with " +
-             String(mipBuffers_.Size()) + " mip levels and " + String(numThreadBuffers) + " thread buffers");
+             String(mipBuffers_.Size()) + " mip levels and " + String(numBands_) + " threaded bands");
 
     CalculateViewport();
     return true;
@@ -160,10 +181,7 @@ void OcclusionBuffer::Clear()
 {
     Reset();
 
-    // Only clear the main thread buffer. Rest are cleared on-demand when drawing the first batch
-    ClearBuffer(0);
-    for (unsigned i = 1; i < buffers_.Size(); ++i)
-        buffers_[i].used_ = false;
+    ClearBuffer();
 
     depthHierarchyDirty_ = true;
 }
@@ -206,7 +224,10 @@ bool OcclusionBuffer::AddTriangles(const Matrix3x4& model, const void* vertexDat
 
 void OcclusionBuffer::DrawTriangles()
 {
-    if (buffers_.Size() == 1)
+    if (!buffer_.data_)
+        return;
+
+    if (!threaded_)
     {
         // Not threaded
         for (Vector<OcclusionBatch>::Iterator i = batches_.Begin(); i != batches_.End(); ++i)
@@ -214,11 +235,16 @@ void OcclusionBuffer::DrawTriangles()
 
         depthHierarchyDirty_ = true;
     }
-    else if (buffers_.Size() > 1)
+    else
     {
-        // Threaded
+        // Threaded. First transform, clip and bin the triangles of each batch
         WorkQueue* queue = GetSubsystem<WorkQueue>();
 
+        for (unsigned i = 0; i < triangles_.Size(); ++i)
+            triangles_[i].Clear();
+        for (unsigned i = 0; i < bins_.Size(); ++i)
+            bins_[i].Clear();
+
         for (Vector<OcclusionBatch>::Iterator i = batches_.Begin(); i != batches_.End(); ++i)
         {
             SharedPtr<WorkItem> item = queue->GetFreeItem();
@@ -231,7 +257,25 @@ void OcclusionBuffer::DrawTriangles()
 
         queue->Complete(M_MAX_UNSIGNED);
 
-        MergeBuffers();
+        // Then rasterize each band that received triangles. The bands do not overlap, so no merging is needed
+        for (unsigned i = 0; i < numBands_; ++i)
+        {
+            bool hasTriangles = false;
+            for (unsigned j = 0; j < triangles_.Size() && !hasTriangles; ++j)
+                hasTriangles = !bins_[i * triangles_.Size() + j].Empty();
+            if (!hasTriangles)
+                continue;
+
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = DrawOcclusionBandWork;
+            item->aux_ = this;
+            item->start_ = reinterpret_cast<void*>((size_t)i);
+            queue->AddWorkItem(item);
+        }
+
+        queue->Complete(M_MAX_UNSIGNED);
+
         depthHierarchyDirty_ = true;
     }
 
@@ -240,7 +284,7 @@ void OcclusionBuffer::DrawTriangles()
 
 void OcclusionBuffer::BuildDepthHierarchy()
 {
-    if (buffers_.Empty() || !depthHierarchyDirty_)
+    if (!buffer_.data_ || !depthHierarchyDirty_)
         return;
 
     URHO3D_PROFILE(BuildDepthHierarchy);
@@ -252,7 +296,7 @@ void OcclusionBuffer::BuildDepthHierarchy()
     {
         for (int y = 0; y < height; ++y)
         {
-            int* src = buffers_[0].data_ + (y * 2) * width_;
+            int* src = buffer_.data_ + (y * 2) * width_;
             DepthValue* dest = mipBuffers_[0].Get() + y * width;
             DepthValue* end = dest + width;
 
@@ -342,7 +386,7 @@ void OcclusionBuffer::ResetUseTimer()
 
 bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
 {
-    if (buffers_.Empty())
+    if (!buffer_.data_)
         return true;
 
     // Transform corners to projection space
@@ -447,8 +491,8 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
     }
 
     // If no conclusive result, finally check the pixel-level data
-    int* row = buffers_[0].data_ + rect.top_ * width_;
-    int* endRow = buffers_[0].data_ + rect.bottom_ * width_;
+    int* row = buffer_.data_ + rect.top_ * width_;
+    int* endRow = buffer_.data_ + rect.bottom_ * width_;
     while (row <= endRow)
     {
         int* src = row + rect.left_;
@@ -473,13 +517,6 @@ unsigned OcclusionBuffer::GetUseTimer()
 
 void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadIndex)
 {
-    // If buffer not yet used, clear it
-    if (threadIndex > 0 && !buffers_[threadIndex].used_)
-    {
-        ClearBuffer(threadIndex);
-        buffers_[threadIndex].used_ = true;
-    }
-
     Matrix4 modelViewProj = viewProj_ * batch.model_;
 
     // Theoretical max. amount of vertices if each of the 6 clipping planes doubles the triangle count
@@ -643,7 +680,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
         bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
         if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
         {
-            DrawTriangle2D(projected, clockwise, threadIndex);
+            AddTriangle2D(projected, clockwise, threadIndex);
             drawOk = true;
         }
     }
@@ -681,7 +718,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
                 bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
                 if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
                 {
-                    DrawTriangle2D(projected, clockwise, threadIndex);
+                    AddTriangle2D(projected, clockwise, threadIndex);
                     drawOk = true;
                 }
             }
@@ -812,6 +849,13 @@ struct Edge
         invZStep_ = (int)(slope * gradients.dInvZdX_ + gradients.dInvZdY_ + 0.5f);
     }
 
+    /// Advance by a number of rows.
+    void Step(int rows)
+    {
+        x_ += xStep_ * rows;
+        invZ_ += invZStep_ * rows;
+    }
+
     /// X coordinate.
     int x_;
     /// X coordinate step.
@@ -822,7 +866,98 @@ struct Edge
     int invZStep_;
 };
 
-void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex)
+void OcclusionBuffer::AddTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex)
+{
+    if (!threaded_)
+    {
+        DrawTriangle2D(vertices, clockwise, 0, height_);
+        return;
+    }
+
+    // Bin the triangle to the horizontal bands it touches, to be rasterized after all batches have been processed
+    int topY = (int)Min(Min(vertices[0].y_, vertices[1].y_), vertices[2].y_);
+    int bottomY = (int)Max(Max(vertices[0].y_, vertices[1].y_), vertices[2].y_);
+    if (topY == bottomY || bottomY <= 0 || topY >= height_)
+        return;
+
+    PODVector<OcclusionTriangle>& triangles = triangles_[threadIndex];
+    unsigned index = triangles.Size();
+    triangles.Resize(index + 1);
+    OcclusionTriangle& triangle = triangles.Back();
+    triangle.vertices_[0] = vertices[0];
+    triangle.vertices_[1] = vertices[1];
+    triangle.vertices_[2] = vertices[2];
+    triangle.clockwise_ = clockwise;
+
+    unsigned firstBand = (unsigned)Max(topY, 0) / OCCLUSION_BAND_HEIGHT;
+    unsigned lastBand = (unsigned)Min(bottomY - 1, height_ - 1) / OCCLUSION_BAND_HEIGHT;
+    for (unsigned i = firstBand; i <= lastBand; ++i)
+        bins_[i * triangles_.Size() + threadIndex].Push(index);
+}
+
+void OcclusionBuffer::DrawBand(unsigned band)
+{
+    int startRow = band * OCCLUSION_BAND_HEIGHT;
+    int endRow = Min(startRow + OCCLUSION_BAND_HEIGHT, height_);
+
+    for (unsigned i = 0; i < triangles_.Size(); ++i)
+    {
+        const PODVector<OcclusionTriangle>& triangles = triangles_[i];
+        const PODVector<unsigned>& bin = bins_[band * triangles_.Size() + i];
+
+        for (PODVector<unsigned>::ConstIterator j = bin.Begin(); j != bin.End(); ++j)
+        {
+            const OcclusionTriangle& triangle = triangles[*j];
+            DrawTriangle2D(triangle.vertices_, triangle.clockwise_, startRow, endRow);
+        }
+    }
+}
+
+/// Write the closer of the existing and interpolated depth values to a horizontal span of pixels.
+static inline void DrawSpan(int* dest, int* end, int invZ, int dInvZdX)
+{
+#if defined(URHO3D_SSE) || defined(URHO3D_NEON)
+    if (end - dest >= 4)
+    {
+#ifdef URHO3D_SSE
+        __m128i z = _mm_setr_epi32(invZ, invZ + dInvZdX, invZ + 2 * dInvZdX, invZ + 3 * dInvZdX);
+        __m128i zStep = _mm_set1_epi32(4 * dInvZdX);
+        while (end - dest >= 4)
+        {
+            // SSE2 has no signed 32-bit minimum, so select using the comparison mask
+            __m128i depth = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest));
+            __m128i closer = _mm_cmplt_epi32(z, depth);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_or_si128(_mm_and_si128(closer, z),
+                _mm_andnot_si128(closer, depth)));
+            z = _mm_add_epi32(z, zStep);
+            dest += 4;
+        }
+        invZ = _mm_cvtsi128_si32(z);
+#else
+        int start[4] = { invZ, invZ + dInvZdX, invZ + 2 * dInvZdX, invZ + 3 * dInvZdX };
+        int32x4_t z = vld1q_s32(start);
+        int32x4_t zStep = vdupq_n_s32(4 * dInvZdX);
+        while (end - dest >= 4)
+        {
+            vst1q_s32(dest, vminq_s32(z, vld1q_s32(dest)));
+            z = vaddq_s32(z, zStep);
+            dest += 4;
+        }
+        invZ = vgetq_lane_s32(z, 0);
+#endif
+    }
+#endif
+
+    while (dest < end)
+    {
+        if (invZ < *dest)
+            *dest = invZ;
+        invZ += dInvZdX;
+        ++dest;
+    }
+}
+
+void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, int startRow, int endRow)
 {
     int top, middle, bottom;
     bool middleIsRight;
@@ -885,8 +1020,8 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
     int middleY = (int)vertices[middle].y_;
     int bottomY = (int)vertices[bottom].y_;
 
-    // Check for degenerate triangle
-    if (topY == bottomY)
+    // Check for degenerate triangle, or no rows within the range
+    if (topY == bottomY || bottomY <= startRow || topY >= endRow)
         return;
 
     // Reverse middleIsRight test if triangle is counterclockwise
@@ -898,132 +1033,57 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
     Edge topToBottom(gradients, vertices[top], vertices[bottom], topY);
     Edge middleToBottom(gradients, vertices[middle], vertices[bottom], middleY);
 
-    int* bufferData = buffers_[threadIndex].data_;
-
     if (middleIsRight)
     {
-        // Top half
-        int* row = bufferData + topY * width_;
-        int* endRow = bufferData + middleY * width_;
-        while (row < endRow)
-        {
-            int invZ = topToBottom.invZ_;
-            int* dest = row + (topToBottom.x_ >> 16);
-            int* end = row + (topToMiddle.x_ >> 16);
-            while (dest < end)
-            {
-                if (invZ < *dest)
-                    *dest = invZ;
-                invZ += gradients.dInvZdXInt_;
-                ++dest;
-            }
-
-            topToBottom.x_ += topToBottom.xStep_;
-            topToBottom.invZ_ += topToBottom.invZStep_;
-            topToMiddle.x_ += topToMiddle.xStep_;
-            row += width_;
-        }
-
-        // Bottom half
-        row = bufferData + middleY * width_;
-        endRow = bufferData + bottomY * width_;
-        while (row < endRow)
-        {
-            int invZ = topToBottom.invZ_;
-            int* dest = row + (topToBottom.x_ >> 16);
-            int* end = row + (middleToBottom.x_ >> 16);
-            while (dest < end)
-            {
-                if (invZ < *dest)
-                    *dest = invZ;
-                invZ += gradients.dInvZdXInt_;
-                ++dest;
-            }
-
-            topToBottom.x_ += topToBottom.xStep_;
-            topToBottom.invZ_ += topToBottom.invZStep_;
-            middleToBottom.x_ += middleToBottom.xStep_;
-            row += width_;
-        }
+        DrawTriangleRows(topToBottom, topToMiddle, gradients, topY, middleY, startRow, endRow);
+        DrawTriangleRows(topToBottom, middleToBottom, gradients, middleY, bottomY, startRow, endRow);
     }
     else
     {
-        // Top half
-        int* row = bufferData + topY * width_;
-        int* endRow = bufferData + middleY * width_;
-        while (row < endRow)
-        {
-            int invZ = topToMiddle.invZ_;
-            int* dest = row + (topToMiddle.x_ >> 16);
-            int* end = row + (topToBottom.x_ >> 16);
-            while (dest < end)
-            {
-                if (invZ < *dest)
-                    *dest = invZ;
-                invZ += gradients.dInvZdXInt_;
-                ++dest;
-            }
-
-            topToMiddle.x_ += topToMiddle.xStep_;
-            topToMiddle.invZ_ += topToMiddle.invZStep_;
-            topToBottom.x_ += topToBottom.xStep_;
-            row += width_;
-        }
-
-        // Bottom half
-        row = bufferData + middleY * width_;
-        endRow = bufferData + bottomY * width_;
-        while (row < endRow)
-        {
-            int invZ = middleToBottom.invZ_;
-            int* dest = row + (middleToBottom.x_ >> 16);
-            int* end = row + (topToBottom.x_ >> 16);
-            while (dest < end)
-            {
-                if (invZ < *dest)
-                    *dest = invZ;
-                invZ += gradients.dInvZdXInt_;
-                ++dest;
-            }
-
-            middleToBottom.x_ += middleToBottom.xStep_;
-            middleToBottom.invZ_ += middleToBottom.invZStep_;
-            topToBottom.x_ += topToBottom.xStep_;
-            row += width_;
-        }
+        DrawTriangleRows(topToMiddle, topToBottom, gradients, topY, middleY, startRow, endRow);
+        DrawTriangleRows(middleToBottom, topToBottom, gradients, middleY, bottomY, startRow, endRow);
     }
 }
 
-void OcclusionBuffer::MergeBuffers()
+void OcclusionBuffer::DrawTriangleRows(Edge& left, Edge& right, const Gradients& gradients, int topY, int bottomY,
+    int startRow, int endRow)
 {
-    URHO3D_PROFILE(MergeBuffers);
-
-    for (unsigned i = 1; i < buffers_.Size(); ++i)
-    {
-        if (!buffers_[i].used_)
-            continue;
+    int numRows = bottomY - topY;
+    if (numRows <= 0)
+        return;
 
-        int* src = buffers_[i].data_;
-        int* dest = buffers_[0].data_;
-        int count = width_ * height_;
+    // Rows outside the range are not drawn, but the edges must still be stepped past them
+    int skipRows = Clamp(startRow - topY, 0, numRows);
+    int drawRows = Clamp(endRow - topY, 0, numRows) - skipRows;
+    left.Step(skipRows);
+    right.Step(skipRows);
 
-        while (count--)
+    int* row = buffer_.data_ + (topY + skipRows) * width_;
+    for (int i = 0; i < drawRows; ++i)
+    {
+        int invZ = left.invZ_;
+        int startX = left.x_ >> 16;
+        int endX = Min(right.x_ >> 16, width_);
+        if (startX < 0)
         {
-            // If thread buffer's depth value is closer, overwrite the original
-            if (*src < *dest)
-                *dest = *src;
-            ++src;
-            ++dest;
+            invZ -= startX * gradients.dInvZdXInt_;
+            startX = 0;
         }
+
+        DrawSpan(row + startX, row + endX, invZ, gradients.dInvZdXInt_);
+
+        left.Step(1);
+        right.Step(1);
+        row += width_;
     }
+
+    left.Step(numRows - skipRows - drawRows);
+    right.Step(numRows - skipRows - drawRows);
 }
 
-void OcclusionBuffer::ClearBuffer(unsigned threadIndex)
+void OcclusionBuffer::ClearBuffer()
 {
-    if (threadIndex >= buffers_.Size())
-        return;
-
-    int* dest = buffers_[threadIndex].data_;
+    int* dest = buffer_.data_;
     int count = width_ * height_;
     int fillValue = (int)OCCLUSION_Z_SCALE;
 
@@ -48,15 +48,22 @@ struct DepthValue
     int max_;
 };
 
-/// Per-thread occlusion buffer data.
+/// Occlusion buffer data.
 struct OcclusionBufferData
 {
     /// Full buffer data with safety padding.
     SharedArrayPtr<int> dataWithSafety_;
     /// Buffer data.
     int* data_;
-    /// Use flag.
-    bool used_;
+};
+
+/// Screen space triangle binned for threaded rasterization.
+struct OcclusionTriangle
+{
+    /// Vertices.
+    Vector3 vertices_[3];
+    /// Clockwise flag.
+    bool clockwise_;
 };
 
 /// Stored occlusion render job.
@@ -84,6 +91,7 @@ static const float OCCLUSION_RELATIVE_BIAS = 0.00001f;
 static const int OCCLUSION_FIXED_BIAS = 16;
 static const float OCCLUSION_X_SCALE = 65536.0f;
 static const float OCCLUSION_Z_SCALE = 16777216.0f;
+static const int OCCLUSION_BAND_HEIGHT = 16;
 
 /// Software renderer for occlusion.
 class URHO3D_API OcclusionBuffer : public Object
@@ -96,7 +104,7 @@ public:
     /// Destruct.
     virtual ~OcclusionBuffer();
 
-    /// Set occlusion buffer size and whether to reserve multiple buffers for threading optimization.
+    /// Set occlusion buffer size and whether to rasterize in worker threads.
     bool SetSize(int width, int height, bool threaded);
     /// Set camera view to render from.
     void SetView(Camera* camera);
@@ -121,7 +129,7 @@ public:
     void ResetUseTimer();
 
     /// Return highest level depth values.
-    int* GetBuffer() const { return buffers_.Size() ? buffers_[0].data_ : (int*)0; }
+    int* GetBuffer() const { return buffer_.data_; }
 
     /// Return view transform matrix.
     const Matrix3x4& GetView() const { return view_; }
@@ -145,7 +153,7 @@ public:
     CullMode GetCullMode() const { return cullMode_; }
 
     /// Return whether is using threads to speed up rendering.
-    bool IsThreaded() const { return buffers_.Size() > 1; }
+    bool IsThreaded() const { return threaded_; }
 
     /// Test a bounding box for visibility. For best performance, build depth hierarchy first.
     bool IsVisible(const BoundingBox& worldSpaceBox) const;
@@ -154,6 +162,8 @@ public:
 
     /// Draw a batch. Called internally.
     void DrawBatch(const OcclusionBatch& batch, unsigned threadIndex);
+    /// Draw the triangles binned to a horizontal band of the buffer. Called internally.
+    void DrawBand(unsigned band);
 
 private:
     /// Apply modelview transform to vertex.
@@ -170,15 +180,21 @@ private:
     void DrawTriangle(Vector4* vertices, unsigned threadIndex);
     /// Clip vertices against a plane.
     void ClipVertices(const Vector4& plane, Vector4* vertices, bool* triangles, unsigned& numTriangles);
-    /// Draw a clipped triangle.
-    void DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
-    /// Clear a thread work buffer.
-    void ClearBuffer(unsigned threadIndex);
-    /// Merge thread work buffers into the first buffer.
-    void MergeBuffers();
-
-    /// Highest-level buffer data per thread.
-    Vector<OcclusionBufferData> buffers_;
+    /// Draw a clipped triangle, or bin it for drawing later if threaded.
+    void AddTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
+    /// Draw a clipped triangle limited to a range of rows.
+    void DrawTriangle2D(const Vector3* vertices, bool clockwise, int startRow, int endRow);
+    /// Draw the rows of a triangle half between two edges, limited to a range of rows.
+    void DrawTriangleRows(Edge& left, Edge& right, const Gradients& gradients, int topY, int bottomY, int startRow, int endRow);
+    /// Clear the buffer data.
+    void ClearBuffer();
+
+    /// Highest-level buffer data.
+    OcclusionBufferData buffer_;
+    /// Binned triangles per thread.
+    Vector<PODVector<OcclusionTriangle> > triangles_;
+    /// Binned triangle indices per band and thread.
+    Vector<PODVector<unsigned> > bins_;
     /// Reduced size depth buffers.
     Vector<SharedArrayPtr<DepthValue> > mipBuffers_;
     /// Submitted render jobs.
@@ -191,6 +207,10 @@ private:
     unsigned numTriangles_;
     /// Maximum number of triangles.
     unsigned maxTriangles_;
+    /// Number of horizontal bands for threaded rasterization.
+    unsigned numBands_;
+    /// Threaded rasterization flag.
+    bool threaded_;
     /// Culling mode.
     CullMode cullMode_;
     /// Depth hierarchy needs update flag.
@@ -34,6 +34,12 @@
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#elif defined(URHO3D_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "../DebugNew.h"
 
 #ifdef _MSC_VER
@@ -46,6 +52,8 @@ namespace Urho3D
 static const float DEFAULT_OCTREE_SIZE = 1000.0f;
 static const int DEFAULT_OCTREE_LEVELS = 8;
 static const int RAYCASTS_PER_WORK_ITEM = 4;
+static const unsigned MIN_THREADED_REINSERTIONS = 256;
+static const unsigned PACKED_CAST_SHADOWS = 0x100;
 
 extern const char* SUBSYSTEM_CATEGORY;
 
@@ -80,6 +88,46 @@ void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex)
     }
 }
 
+void ReinsertDrawablesWork(const WorkItem* item, unsigned threadIndex)
+{
+    Octree* octree = reinterpret_cast<Octree*>(item->aux_);
+    Drawable** start = reinterpret_cast<Drawable**>(item->start_);
+    Drawable** end = reinterpret_cast<Drawable**>(item->end_);
+
+    while (start != end)
+    {
+        octree->ReinsertDrawable(*start);
+        ++start;
+    }
+}
+
+inline bool TestPackedDrawable(const PackedDrawableBounds& bounds, unsigned index, const Frustum& frustum, bool inside,
+    unsigned flagsMask, unsigned requiredFlags, unsigned viewMask, const Plane* drawDistancePlane)
+{
+    unsigned flags = bounds.flags_[index];
+    if (!(flags & flagsMask) || (flags & requiredFlags) != requiredFlags || !(bounds.viewMasks_[index] & viewMask))
+        return false;
+
+    Vector3 center(bounds.centerX_[index], bounds.centerY_[index], bounds.centerZ_[index]);
+    Vector3 edge(bounds.edgeX_[index], bounds.edgeY_[index], bounds.edgeZ_[index]);
+
+    if (!inside)
+    {
+        for (unsigned i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+        {
+            const Plane& plane = frustum.planes_[i];
+            if (plane.normal_.DotProduct(center) + plane.d_ < -plane.absNormal_.DotProduct(edge))
+                return false;
+        }
+    }
+
+    if (drawDistancePlane && drawDistancePlane->normal_.DotProduct(center) + drawDistancePlane->d_ -
+        drawDistancePlane->absNormal_.DotProduct(edge) > bounds.drawDistances_[index])
+        return false;
+
+    return true;
+}
+
 inline bool CompareRayQueryResults(const RayQueryResult& lhs, const RayQueryResult& rhs)
 {
     return lhs.distance_ < rhs.distance_;
@@ -106,7 +154,9 @@ Octant::~Octant()
         for (PODVector<Drawable*>::Iterator i = drawables_.Begin(); i != drawables_.End(); ++i)
         {
             (*i)->SetOctant(root_);
+            (*i)->octantIndex_ = root_->drawables_.Size();
             root_->drawables_.Push(*i);
+            root_->packedBounds_.Push(*i);
             root_->QueueUpdate(*i);
         }
         drawables_.Clear();
@@ -169,10 +219,12 @@ void Octant::InsertDrawable(Drawable* drawable)
         Octant* oldOctant = drawable->octant_;
         if (oldOctant != this)
         {
-            // Add first, then remove, because drawable count going to zero deletes the octree branch in question
+            // Add first, then remove, because drawable count going to zero deletes the octree branch in question. Adding
+            // overwrites the drawable's index, so remove by the index it had in the old octant
+            unsigned oldIndex = drawable->octantIndex_;
             AddDrawable(drawable);
             if (oldOctant)
-                oldOctant->RemoveDrawable(drawable, false);
+                oldOctant->RemoveDrawableAt(drawable, oldIndex, false);
         }
     }
     else
@@ -210,6 +262,130 @@ bool Octant::CheckDrawableFit(const BoundingBox& box) const
     return false;
 }
 
+void Octant::CullDrawables(PODVector<Drawable*>& result, const Frustum& frustum, bool inside, unsigned char drawableFlags,
+    unsigned viewMask, bool shadowCastersOnly, const Plane* drawDistancePlane) const
+{
+    const PackedDrawableBounds& bounds = packedBounds_;
+    unsigned numDrawables = drawables_.Size();
+    unsigned requiredFlags = shadowCastersOnly ? PACKED_CAST_SHADOWS : 0;
+    unsigned i = 0;
+
+#if defined(URHO3D_SSE) || defined(URHO3D_NEON)
+    // Test four drawables at a time, then handle the remainder individually
+    for (; i + 4 <= numDrawables; i += 4)
+    {
+#ifdef URHO3D_SSE
+        __m128i flags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&bounds.flags_[i]));
+        __m128i viewMasks = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&bounds.viewMasks_[i]));
+        __m128i zero = _mm_setzero_si128();
+        __m128i required = _mm_set1_epi32((int)requiredFlags);
+        __m128i noFlags = _mm_cmpeq_epi32(_mm_and_si128(flags, _mm_set1_epi32(drawableFlags)), zero);
+        __m128i noViewMask = _mm_cmpeq_epi32(_mm_and_si128(viewMasks, _mm_set1_epi32((int)viewMask)), zero);
+        __m128i hasRequired = _mm_cmpeq_epi32(_mm_and_si128(flags, required), required);
+        __m128 pass = _mm_castsi128_ps(_mm_andnot_si128(_mm_or_si128(noFlags, noViewMask), hasRequired));
+        if (!_mm_movemask_ps(pass))
+            continue;
+
+        __m128 centerX = _mm_loadu_ps(&bounds.centerX_[i]);
+        __m128 centerY = _mm_loadu_ps(&bounds.centerY_[i]);
+        __m128 centerZ = _mm_loadu_ps(&bounds.centerZ_[i]);
+        __m128 edgeX = _mm_loadu_ps(&bounds.edgeX_[i]);
+        __m128 edgeY = _mm_loadu_ps(&bounds.edgeY_[i]);
+        __m128 edgeZ = _mm_loadu_ps(&bounds.edgeZ_[i]);
+
+        // Note: a dirty bounding box has infinite size and passes the plane tests, as the results are infinite or NaN
+        if (!inside)
+        {
+            for (unsigned j = 0; j < NUM_FRUSTUM_PLANES; ++j)
+            {
+                const Plane& plane = frustum.planes_[j];
+                __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(plane.normal_.x_)),
+                    _mm_mul_ps(centerY, _mm_set1_ps(plane.normal_.y_))), _mm_add_ps(_mm_mul_ps(centerZ,
+                    _mm_set1_ps(plane.normal_.z_)), _mm_set1_ps(plane.d_)));
+                __m128 absDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edgeX, _mm_set1_ps(plane.absNormal_.x_)),
+                    _mm_mul_ps(edgeY, _mm_set1_ps(plane.absNormal_.y_))), _mm_mul_ps(edgeZ, _mm_set1_ps(plane.absNormal_.z_)));
+                pass = _mm_andnot_ps(_mm_cmplt_ps(_mm_add_ps(dist, absDist), _mm_setzero_ps()), pass);
+            }
+        }
+
+        if (drawDistancePlane)
+        {
+            const Plane& plane = *drawDistancePlane;
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(plane.normal_.x_)),
+                _mm_mul_ps(centerY, _mm_set1_ps(plane.normal_.y_))), _mm_add_ps(_mm_mul_ps(centerZ,
+                _mm_set1_ps(plane.normal_.z_)), _mm_set1_ps(plane.d_)));
+            __m128 absDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edgeX, _mm_set1_ps(plane.absNormal_.x_)),
+                _mm_mul_ps(edgeY, _mm_set1_ps(plane.absNormal_.y_))), _mm_mul_ps(edgeZ, _mm_set1_ps(plane.absNormal_.z_)));
+            pass = _mm_andnot_ps(_mm_cmpgt_ps(_mm_sub_ps(dist, absDist), _mm_loadu_ps(&bounds.drawDistances_[i])), pass);
+        }
+
+        int passMask = _mm_movemask_ps(pass);
+#else
+        uint32x4_t flags = vld1q_u32(&bounds.flags_[i]);
+        uint32x4_t viewMasks = vld1q_u32(&bounds.viewMasks_[i]);
+        uint32x4_t required = vdupq_n_u32(requiredFlags);
+        uint32x4_t pass = vandq_u32(vandq_u32(vtstq_u32(flags, vdupq_n_u32(drawableFlags)),
+            vtstq_u32(viewMasks, vdupq_n_u32(viewMask))), vceqq_u32(vandq_u32(flags, required), required));
+
+        float32x4_t centerX = vld1q_f32(&bounds.centerX_[i]);
+        float32x4_t centerY = vld1q_f32(&bounds.centerY_[i]);
+        float32x4_t centerZ = vld1q_f32(&bounds.centerZ_[i]);
+        float32x4_t edgeX = vld1q_f32(&bounds.edgeX_[i]);
+        float32x4_t edgeY = vld1q_f32(&bounds.edgeY_[i]);
+        float32x4_t edgeZ = vld1q_f32(&bounds.edgeZ_[i]);
+
+        // Note: a dirty bounding box has infinite size and passes the plane tests, as the results are infinite or NaN
+        if (!inside)
+        {
+            for (unsigned j = 0; j < NUM_FRUSTUM_PLANES; ++j)
+            {
+                const Plane& plane = frustum.planes_[j];
+                float32x4_t dist = vaddq_f32(vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(centerX, plane.normal_.x_), centerY,
+                    plane.normal_.y_), centerZ, plane.normal_.z_), vdupq_n_f32(plane.d_));
+                float32x4_t absDist = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(edgeX, plane.absNormal_.x_), edgeY,
+                    plane.absNormal_.y_), edgeZ, plane.absNormal_.z_);
+                pass = vbicq_u32(pass, vcltq_f32(vaddq_f32(dist, absDist), vdupq_n_f32(0.0f)));
+            }
+        }
+
+        if (drawDistancePlane)
+        {
+            const Plane& plane = *drawDistancePlane;
+            float32x4_t dist = vaddq_f32(vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(centerX, plane.normal_.x_), centerY,
+                plane.normal_.y_), centerZ, plane.normal_.z_), vdupq_n_f32(plane.d_));
+            float32x4_t absDist = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(edgeX, plane.absNormal_.x_), edgeY,
+                plane.absNormal_.y_), edgeZ, plane.absNormal_.z_);
+            pass = vbicq_u32(pass, vcgtq_f32(vsubq_f32(dist, absDist), vld1q_f32(&bounds.drawDistances_[i])));
+        }
+
+        int passMask = (vgetq_lane_u32(pass, 0) & 1) | (vgetq_lane_u32(pass, 1) & 2) | (vgetq_lane_u32(pass, 2) & 4) |
+            (vgetq_lane_u32(pass, 3) & 8);
+#endif
+
+        for (unsigned j = 0; passMask; ++j, passMask >>= 1)
+        {
+            if (!(passMask & 1))
+                continue;
+
+            // If the bounding box is dirty, test the actual one
+            Drawable* drawable = drawables_[i + j];
+            if (bounds.edgeX_[i + j] != M_INFINITY || inside || frustum.IsInsideFast(drawable->GetWorldBoundingBox()))
+                result.Push(drawable);
+        }
+    }
+#endif
+
+    for (; i < numDrawables; ++i)
+    {
+        if (TestPackedDrawable(bounds, i, frustum, inside, drawableFlags, requiredFlags, viewMask, drawDistancePlane))
+        {
+            Drawable* drawable = drawables_[i];
+            if (bounds.edgeX_[i] != M_INFINITY || inside || frustum.IsInsideFast(drawable->GetWorldBoundingBox()))
+                result.Push(drawable);
+        }
+    }
+}
+
 void Octant::ResetRoot()
 {
     root_ = 0;
@@ -261,7 +437,7 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
         }
     }
 
-    if (drawables_.Size())
+    if (drawables_.Size() && !query.TestPackedDrawables(*this, inside))
     {
         Drawable** start = const_cast<Drawable**>(&drawables_[0]);
         Drawable** end = start + drawables_.Size();
@@ -329,6 +505,61 @@ void Octant::GetDrawablesOnlyInternal(RayOctreeQuery& query, PODVector<Drawable*
     }
 }
 
+void PackedDrawableBounds::Push(Drawable* drawable)
+{
+    centerX_.Push(0.0f);
+    centerY_.Push(0.0f);
+    centerZ_.Push(0.0f);
+    edgeX_.Push(0.0f);
+    edgeY_.Push(0.0f);
+    edgeZ_.Push(0.0f);
+    drawDistances_.Push(0.0f);
+    flags_.Push(0);
+    viewMasks_.Push(0);
+
+    Set(flags_.Size() - 1, drawable);
+}
+
+void PackedDrawableBounds::Erase(unsigned index)
+{
+    centerX_.Erase(index);
+    centerY_.Erase(index);
+    centerZ_.Erase(index);
+    edgeX_.Erase(index);
+    edgeY_.Erase(index);
+    edgeZ_.Erase(index);
+    drawDistances_.Erase(index);
+    flags_.Erase(index);
+    viewMasks_.Erase(index);
+}
+
+void PackedDrawableBounds::Set(unsigned index, Drawable* drawable)
+{
+    // Do not update a dirty bounding box here, as that would call into the drawable. Instead make it infinite, so that
+    // it passes the packed tests and is tested individually. Same for a bounding box that depends on the camera
+    if (!drawable->worldBoundingBoxDirty_ && !drawable->cameraDependentBoundingBox_)
+    {
+        const BoundingBox& box = drawable->worldBoundingBox_;
+        Vector3 center = box.Center();
+        Vector3 edge = box.max_ - center;
+        centerX_[index] = center.x_;
+        centerY_[index] = center.y_;
+        centerZ_[index] = center.z_;
+        edgeX_[index] = edge.x_;
+        edgeY_[index] = edge.y_;
+        edgeZ_[index] = edge.z_;
+    }
+    else
+    {
+        centerX_[index] = centerY_[index] = centerZ_[index] = 0.0f;
+        edgeX_[index] = edgeY_[index] = edgeZ_[index] = M_INFINITY;
+    }
+
+    drawDistances_[index] = drawable->drawDistance_ > 0.0f ? drawable->drawDistance_ : M_INFINITY;
+    flags_[index] = drawable->drawableFlags_ | (drawable->castShadows_ ? PACKED_CAST_SHADOWS : 0);
+    viewMasks_[index] = drawable->viewMask_;
+}
+
 Octree::Octree(Context* context) :
     Component(context),
     Octant(BoundingBox(-DEFAULT_OCTREE_SIZE, DEFAULT_OCTREE_SIZE), 0, 0, this),
@@ -349,6 +580,8 @@ Octree::~Octree()
     // Reset root pointer from all child octants now so that they do not move their drawables to root
     drawableUpdates_.Clear();
     drawableReinsertions_.Clear();
+    for (unsigned i = 0; i < NUM_OCTANTS; ++i)
+        octantReinsertions_[i].Clear();
     ResetRoot();
 }
 
@@ -371,6 +604,15 @@ void Octree::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
     SetSize(worldBoundingBox_, numLevels_);
 }
 
+bool Octree::OnLoadAttribute(const AttributeInfo& attr, Deserializer& source)
+{
+    if (!LoadAttributeDirect(attr, source))
+        return false;
+
+    SetSize(worldBoundingBox_, numLevels_);
+    return true;
+}
+
 void Octree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
 {
     if (debug)
@@ -452,6 +694,9 @@ void Octree::Update(const FrameInfo& frame)
     {
         URHO3D_PROFILE(ReinsertToOctree);
 
+        WorkQueue* queue = GetSubsystem<WorkQueue>();
+        bool threaded = queue->GetNumThreads() && drawableUpdates_.Size() >= MIN_THREADED_REINSERTIONS;
+
         for (PODVector<Drawable*>::Iterator i = drawableUpdates_.Begin(); i != drawableUpdates_.End(); ++i)
         {
             Drawable* drawable = *i;
@@ -466,20 +711,64 @@ void Octree::Update(const FrameInfo& frame)
             if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
                 continue;
 
-            InsertDrawable(drawable);
+            if (!threaded)
+                ReinsertDrawable(drawable);
+            else
+            {
+                // Sort by the first level child octant the reinsertion stays inside of, or the root if it has to start from there
+                Octant* start = GetReinsertionOctant(drawable);
+                if (start == this)
+                    drawableReinsertions_.Push(drawable);
+                else
+                {
+                    while (start->parent_ != this)
+                        start = start->parent_;
+                    octantReinsertions_[start->index_].Push(drawable);
+                }
+            }
+        }
 
-#ifdef _DEBUG
-            // Verify that the drawable will be culled correctly
-            octant = drawable->GetOctant();
-            if (octant != this && octant->GetCullingBox().IsInside(box) != INSIDE)
+        if (threaded)
+        {
+            // Reinsert inside each first level child octant in worker threads. The child octants are detached from the root
+            // meanwhile so that drawable count changes do not propagate to it. As the drawables are added to their new octant
+            // before removing from the old, the child octants can not become empty and be deleted
+            for (unsigned i = 0; i < NUM_OCTANTS; ++i)
             {
-                URHO3D_LOGERROR("Drawable is not fully inside its octant's culling bounds: drawable box " + box.ToString() +
-                         " octant box " + octant->GetCullingBox().ToString());
+                PODVector<Drawable*>& reinsertions = octantReinsertions_[i];
+                if (reinsertions.Empty())
+                    continue;
+
+                children_[i]->parent_ = 0;
+
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = ReinsertDrawablesWork;
+                item->aux_ = this;
+                item->start_ = &reinsertions.Front();
+                item->end_ = &reinsertions.Front() + reinsertions.Size();
+                queue->AddWorkItem(item);
             }
-#endif
+
+            queue->Complete(M_MAX_UNSIGNED);
+
+            for (unsigned i = 0; i < NUM_OCTANTS; ++i)
+            {
+                if (!octantReinsertions_[i].Empty())
+                {
+                    children_[i]->parent_ = this;
+                    octantReinsertions_[i].Clear();
+                }
+            }
+
+            // Finally reinsert the drawables which move between first level child octants or to / from the root
+            for (PODVector<Drawable*>::Iterator i = drawableReinsertions_.Begin(); i != drawableReinsertions_.End(); ++i)
+                ReinsertDrawable(*i);
+            drawableReinsertions_.Clear();
         }
     }
 
+    UpdateQueuedPackedBounds();
     drawableUpdates_.Clear();
 }
 
@@ -625,12 +914,53 @@ void Octree::CancelUpdate(Drawable* drawable)
     drawable->updateQueued_ = false;
 }
 
+void Octree::UpdateQueuedPackedBounds()
+{
+    for (PODVector<Drawable*>::Iterator i = drawableUpdates_.Begin(); i != drawableUpdates_.End(); ++i)
+    {
+        Drawable* drawable = *i;
+        Octant* octant = drawable->GetOctant();
+        if (octant && octant->GetRoot() == this)
+            octant->UpdatePackedBounds(drawable);
+    }
+}
+
 void Octree::DrawDebugGeometry(bool depthTest)
 {
     DebugRenderer* debug = GetComponent<DebugRenderer>();
     DrawDebugGeometry(debug, depthTest);
 }
 
+Octant* Octree::GetReinsertionOctant(Drawable* drawable)
+{
+    // Non-occludees are always inserted to the root octant
+    if (!drawable->IsOccludee())
+        return this;
+
+    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    Octant* octant = drawable->GetOctant();
+    while (octant != this && octant->GetCullingBox().IsInside(box) != INSIDE)
+        octant = octant->parent_;
+
+    return octant;
+}
+
+void Octree::ReinsertDrawable(Drawable* drawable)
+{
+    GetReinsertionOctant(drawable)->InsertDrawable(drawable);
+
+#ifdef _DEBUG
+    // Verify that the drawable will be culled correctly
+    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    Octant* octant = drawable->GetOctant();
+    if (octant != this && octant->GetCullingBox().IsInside(box) != INSIDE)
+    {
+        URHO3D_LOGERROR("Drawable is not fully inside its octant's culling bounds: drawable box " + box.ToString() +
+                 " octant box " + octant->GetCullingBox().ToString());
+    }
+#endif
+}
+
 void Octree::HandleRenderUpdate(StringHash eventType, VariantMap& eventData)
 {
     // When running in headless mode, update the Octree manually during the RenderUpdate event
@@ -35,9 +35,41 @@ class Octree;
 static const int NUM_OCTANTS = 8;
 static const unsigned ROOT_INDEX = M_MAX_UNSIGNED;
 
+/// Copy of an octant's drawable world bounding boxes, masks and draw distances in structure-of-arrays layout, for culling four drawables at a time.
+struct URHO3D_API PackedDrawableBounds
+{
+    /// Add a drawable.
+    void Push(Drawable* drawable);
+    /// Remove a drawable by index.
+    void Erase(unsigned index);
+    /// Update a drawable by index.
+    void Set(unsigned index, Drawable* drawable);
+
+    /// World bounding box center X coordinates.
+    PODVector<float> centerX_;
+    /// World bounding box center Y coordinates.
+    PODVector<float> centerY_;
+    /// World bounding box center Z coordinates.
+    PODVector<float> centerZ_;
+    /// World bounding box half size X coordinates. Infinite while the bounding box is dirty.
+    PODVector<float> edgeX_;
+    /// World bounding box half size Y coordinates.
+    PODVector<float> edgeY_;
+    /// World bounding box half size Z coordinates.
+    PODVector<float> edgeZ_;
+    /// Draw distances. Infinite if not limited.
+    PODVector<float> drawDistances_;
+    /// Drawable flags, with the cast shadows flag in the ninth bit.
+    PODVector<unsigned> flags_;
+    /// View masks.
+    PODVector<unsigned> viewMasks_;
+};
+
 /// %Octree octant
 class URHO3D_API Octant
 {
+    friend class Octree;
+
 public:
     /// Construct.
     Octant(const BoundingBox& box, unsigned level, Octant* parent, Octree* root, unsigned index = ROOT_INDEX);
@@ -57,20 +89,21 @@ public:
     void AddDrawable(Drawable* drawable)
     {
         drawable->SetOctant(this);
+        drawable->octantIndex_ = drawables_.Size();
         drawables_.Push(drawable);
+        packedBounds_.Push(drawable);
         IncDrawableCount();
     }
 
     /// Remove a drawable object from this octant.
-    void RemoveDrawable(Drawable* drawable, bool resetOctant = true)
-    {
-        if (drawables_.Remove(drawable))
-        {
-            if (resetOctant)
-                drawable->SetOctant(0);
-            DecDrawableCount();
-        }
-    }
+    void RemoveDrawable(Drawable* drawable, bool resetOctant = true) { RemoveDrawableAt(drawable, drawable->octantIndex_, resetOctant); }
+
+    /// Update a drawable object's packed bounding box, masks and draw distance after they have changed. Call only from the main thread outside threaded work.
+    void UpdatePackedBounds(Drawable* drawable) { packedBounds_.Set(drawable->octantIndex_, drawable); }
+
+    /// Return drawable objects that pass flags and view mask filtering, a frustum test and optionally shadowcaster and draw distance tests, testing four at a time using the packed bounds.
+    void CullDrawables(PODVector<Drawable*>& result, const Frustum& frustum, bool inside, unsigned char drawableFlags,
+        unsigned viewMask, bool shadowCastersOnly = false, const Plane* drawDistancePlane = 0) const;
 
     /// Return world-space bounding box.
     const BoundingBox& GetWorldBoundingBox() const { return worldBoundingBox_; }
@@ -116,6 +149,22 @@ protected:
             parent_->IncDrawableCount();
     }
 
+    /// Remove a drawable object from this octant by its index in this octant.
+    void RemoveDrawableAt(Drawable* drawable, unsigned index, bool resetOctant)
+    {
+        if (index < drawables_.Size() && drawables_[index] == drawable)
+        {
+            drawables_.Erase(index);
+            packedBounds_.Erase(index);
+            for (unsigned i = index; i < drawables_.Size(); ++i)
+                drawables_[i]->octantIndex_ = i;
+
+            if (resetOctant)
+                drawable->SetOctant(0);
+            DecDrawableCount();
+        }
+    }
+
     /// Decrease drawable object count recursively and remove octant if it becomes empty.
     void DecDrawableCount()
     {
@@ -138,6 +187,8 @@ protected:
     BoundingBox cullingBox_;
     /// Drawable objects.
     PODVector<Drawable*> drawables_;
+    /// Packed bounds of the drawable objects, in the same order.
+    PackedDrawableBounds packedBounds_;
     /// Child octants.
     Octant* children_[NUM_OCTANTS];
     /// World bounding box center.
@@ -160,6 +211,7 @@ protected:
 class URHO3D_API Octree : public Component, public Octant
 {
     friend void RaycastDrawablesWork(const WorkItem* item, unsigned threadIndex);
+    friend void ReinsertDrawablesWork(const WorkItem* item, unsigned threadIndex);
 
     URHO3D_OBJECT(Octree, Component);
 
@@ -173,6 +225,10 @@ public:
 
     /// Handle attribute change.
     virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
+    /// Handle attribute change from binary data.
+    virtual bool OnLoadAttribute(const AttributeInfo& attr, Deserializer& source);
+    /// Handle attribute read access to binary data.
+    virtual bool OnSaveAttribute(const AttributeInfo& attr, Serializer& dest) const { return SaveAttributeDirect(attr, dest); }
     /// Visualize the component as debug geometry.
     virtual void DrawDebugGeometry(DebugRenderer* debug, bool depthTest);
 
@@ -199,17 +255,25 @@ public:
     void QueueUpdate(Drawable* drawable);
     /// Cancel drawable object's update.
     void CancelUpdate(Drawable* drawable);
+    /// Refresh the octants' packed bounds of drawable objects queued for update. Called by Update() and before culling, as the packed bounds are only written in the main thread.
+    void UpdateQueuedPackedBounds();
     /// Visualize the component as debug geometry.
     void DrawDebugGeometry(bool depthTest);
 
 private:
     /// Handle render update in case of headless execution.
     void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
+    /// Return the closest octant upward from a moved drawable's current octant whose culling box still contains it.
+    Octant* GetReinsertionOctant(Drawable* drawable);
+    /// Reinsert a moved drawable object starting from its reinsertion octant.
+    void ReinsertDrawable(Drawable* drawable);
 
     /// Drawable objects that require update.
     PODVector<Drawable*> drawableUpdates_;
-    /// Drawable objects that require reinsertion.
+    /// Drawable objects that require reinsertion from the root octant.
     PODVector<Drawable*> drawableReinsertions_;
+    /// Drawable objects that require reinsertion inside a first level child octant.
+    PODVector<Drawable*> octantReinsertions_[NUM_OCTANTS];
     /// Mutex for octree reinsertions.
     Mutex octreeMutex_;
     /// Current threaded ray query.
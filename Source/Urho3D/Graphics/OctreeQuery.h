@@ -33,6 +33,7 @@ namespace Urho3D
 
 class Drawable;
 class Node;
+class Octant;
 
 /// Base class for octree queries.
 class URHO3D_API OctreeQuery
@@ -55,6 +56,8 @@ public:
     virtual Intersection TestOctant(const BoundingBox& box, bool inside) = 0;
     /// Intersection test for drawables.
     virtual void TestDrawables(Drawable** start, Drawable** end, bool inside) = 0;
+    /// Intersection test for an octant's drawables using their packed bounds. Return false to use TestDrawables() instead.
+    virtual bool TestPackedDrawables(const Octant& octant, bool inside) { return false; }
 
     /// Result vector reference.
     PODVector<Drawable*>& result_;
@@ -24,6 +24,7 @@
 
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Graphics/AnimationScheduler.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Geometry.h"
@@ -270,6 +271,7 @@ Renderer::Renderer(Context* context) :
     maxOccluderTriangles_(5000),
     occlusionBufferSize_(256),
     occluderSizeThreshold_(0.025f),
+    occlusionRetestFrames_(4),
     mobileShadowBiasMul_(2.0f),
     mobileShadowBiasAdd_(0.0001f),
     numOcclusionBuffers_(0),
@@ -279,8 +281,10 @@ Renderer::Renderer(Context* context) :
     specularLighting_(true),
     drawShadows_(true),
     reuseShadowMaps_(true),
+    retainBatchGroups_(false),
     dynamicInstancing_(true),
     threadedOcclusion_(false),
+    temporalOcclusion_(false),
     shadersDirty_(true),
     initialized_(false),
     resetViews_(false)
@@ -448,6 +452,11 @@ void Renderer::SetMaxSortedInstances(int instances)
     maxSortedInstances_ = Max(instances, 0);
 }
 
+void Renderer::SetRetainBatchGroups(bool enable)
+{
+    retainBatchGroups_ = enable;
+}
+
 void Renderer::SetMaxOccluderTriangles(int triangles)
 {
     maxOccluderTriangles_ = Max(triangles, 0);
@@ -483,6 +492,16 @@ void Renderer::SetThreadedOcclusion(bool enable)
     }
 }
 
+void Renderer::SetTemporalOcclusion(bool enable)
+{
+    temporalOcclusion_ = enable;
+}
+
+void Renderer::SetOcclusionRetestFrames(int frames)
+{
+    occlusionRetestFrames_ = Max(frames, 0);
+}
+
 void Renderer::ReloadShaders()
 {
     shadersDirty_ = true;
@@ -596,6 +615,11 @@ void Renderer::Update(float timeStep)
     if (shadersDirty_)
         LoadShaders();
 
+    // Decide the animation updates of the frame before the octree updates evaluate them
+    AnimationScheduler* animationScheduler = GetSubsystem<AnimationScheduler>();
+    if (animationScheduler)
+        animationScheduler->Update(frame_);
+
     // Queue update of the main viewports. Use reverse order, as rendering order is also reverse
     // to render auxiliary views before dependant main views
     for (unsigned i = viewports_.Size() - 1; i < viewports_.Size(); --i)
@@ -1107,14 +1131,9 @@ void Renderer::SetBatchShaders(Batch& batch, Technique* tech, bool allowShadows)
 {
     // Check if shaders are unloaded or need reloading
     Pass* pass = batch.pass_;
+    PreparePassShaders(pass);
     Vector<SharedPtr<ShaderVariation> >& vertexShaders = pass->GetVertexShaders();
     Vector<SharedPtr<ShaderVariation> >& pixelShaders = pass->GetPixelShaders();
-    if (!vertexShaders.Size() || !pixelShaders.Size() || pass->GetShadersLoadedFrameNumber() != shadersChangedFrameNumber_)
-    {
-        // First release all previous shaders, then load
-        pass->ReleaseShaders();
-        LoadPassShaders(pass);
-    }
 
     // Make sure shaders are loaded now
     if (vertexShaders.Size() && pixelShaders.Size())
@@ -1205,6 +1224,7 @@ void Renderer::SetBatchShaders(Batch& batch, Technique* tech, bool allowShadows)
     // Log error if shaders could not be assigned, but only once per technique
     if (!batch.vertexShader_ || !batch.pixelShader_)
     {
+        MutexLock lock(rendererMutex_);
         if (!shaderErrorDisplayed_.Contains(tech))
         {
             shaderErrorDisplayed_.Insert(tech);
@@ -1213,6 +1233,22 @@ void Renderer::SetBatchShaders(Batch& batch, Technique* tech, bool allowShadows)
     }
 }
 
+bool Renderer::HasPassShaders(Pass* pass) const
+{
+    return pass->GetVertexShaders().Size() && pass->GetPixelShaders().Size() &&
+        pass->GetShadersLoadedFrameNumber() == shadersChangedFrameNumber_;
+}
+
+void Renderer::PreparePassShaders(Pass* pass)
+{
+    if (!HasPassShaders(pass))
+    {
+        // First release all previous shaders, then load
+        pass->ReleaseShaders();
+        LoadPassShaders(pass);
+    }
+}
+
 void Renderer::SetLightVolumeBatchShaders(Batch& batch, Camera* camera, const String& vsName, const String& psName, const String& vsDefines,
     const String& psDefines)
 {
@@ -194,6 +194,8 @@ public:
     void SetMinInstances(int instances);
     /// Set maximum number of sorted instances per batch group. If exceeded, instances are rendered unsorted.
     void SetMaxSortedInstances(int instances);
+    /// Set whether to retain scene pass batch groups and their sorted order between frames. Default false.
+    void SetRetainBatchGroups(bool enable);
     /// Set maximum number of occluder triangles.
     void SetMaxOccluderTriangles(int triangles);
     /// Set occluder buffer width.
@@ -202,6 +204,10 @@ public:
     void SetOccluderSizeThreshold(float screenSize);
     /// Set whether to thread occluder rendering. Default false.
     void SetThreadedOcclusion(bool enable);
+    /// Set whether to reuse the occlusion buffer of the previous frame. Default false.
+    void SetTemporalOcclusion(bool enable);
+    /// Set number of frames an object found visible skips the occlusion test when using temporal occlusion. Default 4.
+    void SetOcclusionRetestFrames(int frames);
     /// Set shadow depth bias multiplier for mobile platforms (OpenGL ES.) No effect on desktops. Default 2.
     void SetMobileShadowBiasMul(float mul);
     /// Set shadow depth bias addition for mobile platforms (OpenGL ES.)  No effect on desktops. Default 0.0001.
@@ -259,6 +265,9 @@ public:
     /// Return maximum number of sorted instances per batch group.
     int GetMaxSortedInstances() const { return maxSortedInstances_; }
 
+    /// Return whether scene pass batch groups are retained between frames.
+    bool GetRetainBatchGroups() const { return retainBatchGroups_; }
+
     /// Return maximum number of occluder triangles.
     int GetMaxOccluderTriangles() const { return maxOccluderTriangles_; }
 
@@ -271,6 +280,12 @@ public:
     /// Return whether occlusion rendering is threaded.
     bool GetThreadedOcclusion() const { return threadedOcclusion_; }
 
+    /// Return whether the occlusion buffer of the previous frame is reused.
+    bool GetTemporalOcclusion() const { return temporalOcclusion_; }
+
+    /// Return number of frames an object found visible skips the occlusion test when using temporal occlusion.
+    int GetOcclusionRetestFrames() const { return occlusionRetestFrames_; }
+
     /// Return shadow depth bias multiplier for mobile platforms.
     float GetMobileShadowBiasMul() const { return mobileShadowBiasMul_; }
 
@@ -349,8 +364,12 @@ public:
     void StorePreparedView(View* view, Camera* cullCamera);
     /// Return a prepared view if exists for the specified camera. Used to avoid duplicate view preparation CPU work.
     View* GetPreparedView(Camera* cullCamera);
-    /// Choose shaders for a forward rendering batch.
+    /// Choose shaders for a forward rendering batch. Is thread-safe if the pass shaders have been prepared.
     void SetBatchShaders(Batch& batch, Technique* tech, bool allowShadows = true);
+    /// Return whether the shaders of a pass are loaded and up to date. Is thread-safe.
+    bool HasPassShaders(Pass* pass) const;
+    /// Load or reload the shaders of a pass if necessary.
+    void PreparePassShaders(Pass* pass);
     /// Choose shaders for a deferred light volume batch.
     void SetLightVolumeBatchShaders
         (Batch& batch, Camera* camera, const String& vsName, const String& psName, const String& vsDefines, const String& psDefines);
@@ -460,7 +479,7 @@ private:
     HashSet<Octree*> updatedOctrees_;
     /// Techniques for which missing shader error has been displayed.
     HashSet<Technique*> shaderErrorDisplayed_;
-    /// Mutex for shadow camera allocation.
+    /// Mutex for shadow camera allocation and the missing shader error.
     Mutex rendererMutex_;
     /// Current variation names for deferred light volume shaders.
     Vector<String> deferredLightPSVariations_;
@@ -490,6 +509,8 @@ private:
     int occlusionBufferSize_;
     /// Occluder screen size threshold.
     float occluderSizeThreshold_;
+    /// Number of frames an object found visible skips the occlusion test when using temporal occlusion.
+    int occlusionRetestFrames_;
     /// Mobile platform shadow depth bias multiplier.
     float mobileShadowBiasMul_;
     /// Mobile platform shadow depth bias addition.
@@ -514,10 +535,14 @@ private:
     bool drawShadows_;
     /// Shadow map reuse flag.
     bool reuseShadowMaps_;
+    /// Retain batch groups between frames flag.
+    bool retainBatchGroups_;
     /// Dynamic instancing flag.
     bool dynamicInstancing_;
     /// Threaded occlusion rendering flag.
     bool threadedOcclusion_;
+    /// Temporal occlusion flag.
+    bool temporalOcclusion_;
     /// Shaders need reloading flag.
     bool shadersDirty_;
     /// Initialized flag.
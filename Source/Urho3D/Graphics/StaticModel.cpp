@@ -273,6 +273,7 @@ void StaticModel::SetModel(Model* model)
         SetBoundingBox(BoundingBox());
     }
 
+    MarkOcclusionDirty();
     MarkNetworkUpdate();
 }
 
@@ -281,6 +282,7 @@ void StaticModel::SetMaterial(Material* material)
     for (unsigned i = 0; i < batches_.Size(); ++i)
         batches_[i].material_ = material;
 
+    MarkOcclusionDirty();
     MarkNetworkUpdate();
 }
 
@@ -293,6 +295,7 @@ bool StaticModel::SetMaterial(unsigned index, Material* material)
     }
 
     batches_[index].material_ = material;
+    MarkOcclusionDirty();
     MarkNetworkUpdate();
     return true;
 }
@@ -300,6 +303,7 @@ bool StaticModel::SetMaterial(unsigned index, Material* material)
 void StaticModel::SetOcclusionLodLevel(unsigned level)
 {
     occlusionLodLevel_ = level;
+    MarkOcclusionDirty();
     MarkNetworkUpdate();
 }
 
@@ -443,6 +447,8 @@ void StaticModel::CalculateLodLevels()
         {
             geometryData_[i].lodLevel_ = newLodLevel;
             batches_[i].geometry_ = batchGeometries[newLodLevel];
+            if (occluder_ && occlusionLodLevel_ == M_MAX_UNSIGNED)
+                MarkOcclusionDirty();
         }
     }
 }
@@ -149,6 +149,16 @@ void Terrain::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
         recreateTerrain_ = true;
 }
 
+bool Terrain::OnLoadAttribute(const AttributeInfo& attr, Deserializer& source)
+{
+    if (!LoadAttributeDirect(attr, source))
+        return false;
+
+    if (!attr.accessor_)
+        recreateTerrain_ = true;
+    return true;
+}
+
 void Terrain::ApplyAttributes()
 {
     if (recreateTerrain_)
@@ -493,6 +503,8 @@ void Terrain::CreatePatchGeometry(TerrainPatch* patch)
 {
     URHO3D_PROFILE(CreatePatchGeometry);
 
+    patch->MarkOcclusionDirty();
+
     unsigned row = (unsigned)(patchSize_ + 1);
     VertexBuffer* vertexBuffer = patch->GetVertexBuffer();
     Geometry* geometry = patch->GetGeometry();
@@ -48,6 +48,10 @@ public:
 
     /// Handle attribute write access.
     virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
+    /// Handle attribute write access from binary data.
+    virtual bool OnLoadAttribute(const AttributeInfo& attr, Deserializer& source);
+    /// Handle attribute read access to binary data.
+    virtual bool OnSaveAttribute(const AttributeInfo& attr, Serializer& dest) const { return SaveAttributeDirect(attr, dest); }
     /// Apply attribute changes that can not be applied immediately. Called after scene load or a network update.
     virtual void ApplyAttributes();
     /// Handle enabled/disabled state change.
@@ -229,6 +229,7 @@ void TerrainPatch::SetNeighbors(TerrainPatch* north, TerrainPatch* south, Terrai
 void TerrainPatch::SetMaterial(Material* material)
 {
     batches_[0].material_ = material;
+    MarkOcclusionDirty();
 }
 
 void TerrainPatch::SetBoundingBox(const BoundingBox& box)
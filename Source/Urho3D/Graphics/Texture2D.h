@@ -22,7 +22,9 @@
 
 #pragma once
 
-#if defined(URHO3D_OPENGL)
+#if defined(URHO3D_NULL_GRAPHICS)
+#include "Null/NullTexture2D.h"
+#elif defined(URHO3D_OPENGL)
 #include "OpenGL/OGLTexture2D.h"
 #elif defined(URHO3D_D3D11)
 #include "Direct3D11/D3D11Texture2D.h"
@@ -90,6 +90,13 @@ public:
             }
         }
     }
+
+    /// Intersection test for an octant's drawables using their packed bounds.
+    virtual bool TestPackedDrawables(const Octant& octant, bool inside)
+    {
+        octant.CullDrawables(result_, frustum_, inside, drawableFlags_, viewMask_, true);
+        return true;
+    }
 };
 
 /// %Frustum octree query for zones and occluders.
@@ -121,14 +128,48 @@ public:
     }
 };
 
-/// %Frustum octree query with occlusion.
-class OccludedFrustumOctreeQuery : public FrustumOctreeQuery
+/// %Frustum octree query for the visible drawables of a camera, which also rejects drawables beyond their draw distance.
+class VisibleOctreeQuery : public FrustumOctreeQuery
 {
 public:
-    /// Construct with frustum, occlusion buffer and query parameters.
-    OccludedFrustumOctreeQuery(PODVector<Drawable*>& result, const Frustum& frustum, OcclusionBuffer* buffer,
+    /// Construct with camera and query parameters.
+    VisibleOctreeQuery(PODVector<Drawable*>& result, Camera* camera, unsigned char drawableFlags = DRAWABLE_ANY,
+        unsigned viewMask = DEFAULT_VIEWMASK) :
+        FrustumOctreeQuery(result, camera->GetFrustum(), drawableFlags, viewMask),
+        useDrawDistance_(!camera->IsOrthographic())
+    {
+        // The distance to the camera plane is a lower bound for the distance to the camera position, so drawables whose
+        // bounding box is beyond their draw distance from the camera plane can be rejected early
+        if (useDrawDistance_)
+        {
+            const Matrix3x4& view = camera->GetView();
+            Vector4 plane(view.m20_, view.m21_, view.m22_, view.m23_);
+            drawDistancePlane_ = Plane(plane / Vector3(plane.x_, plane.y_, plane.z_).Length());
+        }
+    }
+
+    /// Intersection test for an octant's drawables using their packed bounds.
+    virtual bool TestPackedDrawables(const Octant& octant, bool inside)
+    {
+        octant.CullDrawables(result_, frustum_, inside, drawableFlags_, viewMask_, false,
+            useDrawDistance_ ? &drawDistancePlane_ : (const Plane*)0);
+        return true;
+    }
+
+    /// Camera plane for the draw distance test.
+    Plane drawDistancePlane_;
+    /// Draw distance test flag.
+    bool useDrawDistance_;
+};
+
+/// %Frustum octree query with occlusion. Note: drawable occlusion is performed later in worker threads.
+class OccludedFrustumOctreeQuery : public VisibleOctreeQuery
+{
+public:
+    /// Construct with camera, occlusion buffer and query parameters.
+    OccludedFrustumOctreeQuery(PODVector<Drawable*>& result, Camera* camera, OcclusionBuffer* buffer,
         unsigned char drawableFlags = DRAWABLE_ANY, unsigned viewMask = DEFAULT_VIEWMASK) :
-        FrustumOctreeQuery(result, frustum, drawableFlags, viewMask),
+        VisibleOctreeQuery(result, camera, drawableFlags, viewMask),
         buffer_(buffer)
     {
     }
@@ -147,21 +188,6 @@ public:
         }
     }
 
-    /// Intersection test for drawables. Note: drawable occlusion is performed later in worker threads.
-    virtual void TestDrawables(Drawable** start, Drawable** end, bool inside)
-    {
-        while (start != end)
-        {
-            Drawable* drawable = *start++;
-
-            if ((drawable->GetDrawableFlags() & drawableFlags_) && (drawable->GetViewMask() & viewMask_))
-            {
-                if (inside || frustum_.IsInsideFast(drawable->GetWorldBoundingBox()))
-                    result_.Push(drawable);
-            }
-        }
-    }
-
     /// Occlusion buffer.
     OcclusionBuffer* buffer_;
 };
@@ -172,6 +198,8 @@ void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
     Drawable** start = reinterpret_cast<Drawable**>(item->start_);
     Drawable** end = reinterpret_cast<Drawable**>(item->end_);
     OcclusionBuffer* buffer = view->occlusionBuffer_;
+    unsigned frameNumber = view->frame_.frameNumber_;
+    unsigned retestFrames = view->renderer_->GetTemporalOcclusion() ? (unsigned)view->renderer_->GetOcclusionRetestFrames() : 0;
     const Matrix3x4& viewMatrix = view->cullCamera_->GetView();
     Vector3 viewZ = Vector3(viewMatrix.m20_, viewMatrix.m21_, viewMatrix.m22_);
     Vector3 absViewZ = viewZ.Abs();
@@ -183,7 +211,22 @@ void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
     {
         Drawable* drawable = *start++;
 
-        if (!buffer || !drawable->IsOccludee() || buffer->IsVisible(drawable->GetWorldBoundingBox()))
+        bool visible = !buffer || !drawable->IsOccludee();
+        if (!visible)
+        {
+            // With temporal occlusion, skip the test if the drawable passed it recently
+            unsigned occlusionFrameNumber = drawable->GetOcclusionFrameNumber();
+            if (retestFrames && occlusionFrameNumber && frameNumber - occlusionFrameNumber <= retestFrames)
+                visible = true;
+            else if (buffer->IsVisible(drawable->GetWorldBoundingBox()))
+            {
+                visible = true;
+                if (retestFrames)
+                    drawable->MarkOcclusionVisible(frameNumber);
+            }
+        }
+
+        if (visible)
         {
             drawable->UpdateBatches(view->frame_);
             // If draw distance non-zero, update and check it
@@ -286,6 +329,44 @@ void SortShadowQueueWork(const WorkItem* item, unsigned threadIndex)
         start->shadowSplits_[i].shadowBatches_.SortFrontToBack();
 }
 
+void GetLightBatchesWork(const WorkItem* item, unsigned threadIndex)
+{
+    View* view = reinterpret_cast<View*>(item->aux_);
+    LightQueryResult* query = reinterpret_cast<LightQueryResult*>(item->start_);
+
+    view->CollectLightBatches(*query);
+}
+
+void GetBaseBatchesWork(const WorkItem* item, unsigned threadIndex)
+{
+    View* view = reinterpret_cast<View*>(item->aux_);
+    BaseBatchResult* result = reinterpret_cast<BaseBatchResult*>(item->start_);
+
+    view->CollectBaseBatches(*result);
+}
+
+void AddBaseBatchesWork(const WorkItem* item, unsigned threadIndex)
+{
+    View* view = reinterpret_cast<View*>(item->aux_);
+    ScenePassInfo* info = reinterpret_cast<ScenePassInfo*>(item->start_);
+    unsigned passIndex = (unsigned)(info - &view->scenePasses_[0]);
+
+    // Add in work item order to get the same batch order as when collected in one thread. Scene passes that share
+    // the batch queue were collected into the same list
+    for (Vector<BaseBatchResult>::Iterator i = view->baseBatchResults_.Begin(); i != view->baseBatchResults_.End(); ++i)
+        view->AddPendingBatches(i->batches_[passIndex]);
+}
+
+void AddPendingBatchesWork(const WorkItem* item, unsigned threadIndex)
+{
+    View* view = reinterpret_cast<View*>(item->aux_);
+    PODVector<PendingBatch>* start = reinterpret_cast<PODVector<PendingBatch>*>(item->start_);
+    PODVector<PendingBatch>* end = reinterpret_cast<PODVector<PendingBatch>*>(item->end_);
+
+    while (start != end)
+        view->AddPendingBatches(*start++);
+}
+
 View::View(Context* context) :
     Object(context),
     graphics_(GetSubsystem<Graphics>()),
@@ -299,7 +380,10 @@ View::View(Context* context) :
     farClipZone_(0),
     occlusionBuffer_(0),
     renderTarget_(0),
-    substituteRenderTarget_(0)
+    substituteRenderTarget_(0),
+    temporalMaterialRevision_(0),
+    temporalOcclusionFrameNumber_(0),
+    temporalActiveOccluders_(0)
 {
     // Create octree query and scene results vector for each thread
     unsigned numThreads = GetSubsystem<WorkQueue>()->GetNumThreads() + 1; // Worker threads + main thread
@@ -553,6 +637,7 @@ void View::Update(const FrameInfo& frame)
     renderer_->SendEvent(E_BEGINVIEWUPDATE, eventData);
 
     int maxSortedInstances = renderer_->GetMaxSortedInstances();
+    bool retainBatchGroups = renderer_->GetRetainBatchGroups();
 
     // Clear buffers, geometry, light, occluder & batch list
     renderTargets_.Clear();
@@ -563,7 +648,7 @@ void View::Update(const FrameInfo& frame)
     activeOccluders_ = 0;
     vertexLightQueues_.Clear();
     for (HashMap<unsigned, BatchQueue>::Iterator i = batchQueues_.Begin(); i != batchQueues_.End(); ++i)
-        i->second_.Clear(maxSortedInstances);
+        i->second_.Clear(maxSortedInstances, retainBatchGroups);
 
     if (hasScenePasses_ && (!cullCamera_ || !octree_))
     {
@@ -789,6 +874,9 @@ void View::GetDrawables()
 
     URHO3D_PROFILE(GetDrawables);
 
+    // Refresh the packed bounds of drawables that changed after the octree update, before the worker threads read them
+    octree_->UpdateQueuedPackedBounds();
+
     WorkQueue* queue = GetSubsystem<WorkQueue>();
     PODVector<Drawable*>& tempDrawables = tempDrawables_[0];
 
@@ -855,23 +943,38 @@ void View::GetDrawables()
         {
             URHO3D_PROFILE(DrawOcclusion);
 
-            occlusionBuffer_ = renderer_->GetOcclusionBuffer(cullCamera_);
-            DrawOccluders(occlusionBuffer_, occluders_);
+            if (renderer_->GetTemporalOcclusion())
+                DrawTemporalOccluders(occluders_);
+            else
+            {
+                occlusionBuffer_ = renderer_->GetOcclusionBuffer(cullCamera_);
+                DrawOccluders(occlusionBuffer_, occluders_);
+            }
         }
     }
     else
         occluders_.Clear();
 
+    // Release the view's own occlusion buffers if no longer used
+    if (!occlusionBuffer_ || !renderer_->GetTemporalOcclusion())
+    {
+        temporalOcclusionBuffers_[0].Reset();
+        temporalOcclusionBuffers_[1].Reset();
+        temporalOccluders_.Clear();
+        temporalOccluderTransforms_.Clear();
+        temporalOccluderRevisions_.Clear();
+    }
+
     // Get lights and geometries. Coarse occlusion for octants is used at this point
     if (occlusionBuffer_)
     {
         OccludedFrustumOctreeQuery query
-            (tempDrawables, cullCamera_->GetFrustum(), occlusionBuffer_, DRAWABLE_GEOMETRY | DRAWABLE_LIGHT, cullCamera_->GetViewMask());
+            (tempDrawables, cullCamera_, occlusionBuffer_, DRAWABLE_GEOMETRY | DRAWABLE_LIGHT, cullCamera_->GetViewMask());
         octree_->GetDrawables(query);
     }
     else
     {
-        FrustumOctreeQuery query(tempDrawables, cullCamera_->GetFrustum(), DRAWABLE_GEOMETRY | DRAWABLE_LIGHT, cullCamera_->GetViewMask());
+        VisibleOctreeQuery query(tempDrawables, cullCamera_, DRAWABLE_GEOMETRY | DRAWABLE_LIGHT, cullCamera_->GetViewMask());
         octree_->GetDrawables(query);
     }
 
@@ -961,10 +1064,14 @@ void View::GetBatches()
 
     nonThreadedGeometries_.Clear();
     threadedGeometries_.Clear();
+    unloadedPasses_.Clear();
 
     ProcessLights();
     GetLightBatches();
     GetBaseBatches();
+
+    for (HashMap<unsigned, BatchQueue>::Iterator i = batchQueues_.Begin(); i != batchQueues_.End(); ++i)
+        i->second_.RemoveUnusedGroups();
 }
 
 void View::ProcessLights()
@@ -972,6 +1079,9 @@ void View::ProcessLights()
     // Process lit geometries and shadow casters for each light
     URHO3D_PROFILE(ProcessLights);
 
+    // The shadow caster queries also read the packed bounds, so refresh drawables changed since getting the drawables
+    octree_->UpdateQueuedPackedBounds();
+
     WorkQueue* queue = GetSubsystem<WorkQueue>();
     lightQueryResults_.Resize(lights_.Size());
 
@@ -996,6 +1106,7 @@ void View::ProcessLights()
 void View::GetLightBatches()
 {
     BatchQueue* alphaQueue = batchQueues_.Contains(alphaPassIndex_) ? &batchQueues_[alphaPassIndex_] : (BatchQueue*)0;
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
 
     // Build light queues and lit batches
     {
@@ -1011,6 +1122,8 @@ void View::GetLightBatches()
         }
 
         lightQueues_.Resize(numLightQueues);
+        lightBatches_.Resize(numLightQueues);
+        lightAlphaBatches_.Resize(numLightQueues);
         maxLightsDrawables_.Clear();
         unsigned maxSortedInstances = (unsigned)renderer_->GetMaxSortedInstances();
 
@@ -1063,7 +1176,7 @@ void View::GetLightBatches()
                     shadowQueue.shadowViewport_ = GetShadowMapViewport(light, j, lightQueue.shadowMap_);
                     FinalizeShadowCamera(shadowCamera, light, shadowQueue.shadowViewport_, query.shadowCasterBox_[j]);
 
-                    // Loop through shadow casters
+                    // Loop through shadow casters. Their batches are collected later in worker threads
                     for (PODVector<Drawable*>::ConstIterator k = query.shadowCasters_.Begin() + query.shadowCasterBegin_[j];
                          k < query.shadowCasters_.Begin() + query.shadowCasterEnd_[j]; ++k)
                     {
@@ -1078,42 +1191,17 @@ void View::GetLightBatches()
                             else if (type == UPDATE_WORKER_THREAD)
                                 threadedGeometries_.Push(drawable);
                         }
-
-                        Zone* zone = GetZone(drawable);
-                        const Vector<SourceBatch>& batches = drawable->GetBatches();
-
-                        for (unsigned l = 0; l < batches.Size(); ++l)
-                        {
-                            const SourceBatch& srcBatch = batches[l];
-
-                            Technique* tech = GetTechnique(drawable, srcBatch.material_);
-                            if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
-                                continue;
-
-                            Pass* pass = tech->GetSupportedPass(Technique::shadowPassIndex);
-                            // Skip if material has no shadow pass
-                            if (!pass)
-                                continue;
-
-                            Batch destBatch(srcBatch);
-                            destBatch.pass_ = pass;
-                            destBatch.zone_ = zone;
-
-                            AddBatchToQueue(shadowQueue.shadowBatches_, destBatch, tech);
-                        }
                     }
                 }
 
-                // Process lit geometries
+                // Record the light to lit geometries. Their batches are collected later in worker threads
                 for (PODVector<Drawable*>::ConstIterator j = query.litGeometries_.Begin(); j != query.litGeometries_.End(); ++j)
                 {
                     Drawable* drawable = *j;
                     drawable->AddLight(light);
 
                     // If drawable limits maximum lights, only record the light, and check maximum count / build batches later
-                    if (!drawable->GetMaxLights())
-                        GetLitBatches(drawable, lightQueue, alphaQueue);
-                    else
+                    if (drawable->GetMaxLights())
                         maxLightsDrawables_.Insert(drawable);
                 }
 
@@ -1147,6 +1235,51 @@ void View::GetLightBatches()
                 }
             }
         }
+
+        // Collect the batches of each light queue in worker threads, once all lights have been recorded to the drawables
+        if (numLightQueues)
+        {
+            for (Vector<LightQueryResult>::Iterator i = lightQueryResults_.Begin(); i != lightQueryResults_.End(); ++i)
+            {
+                if (i->light_->GetPerVertex() || i->litGeometries_.Empty())
+                    continue;
+
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = GetLightBatchesWork;
+                item->aux_ = this;
+                item->start_ = &(*i);
+                queue->AddWorkItem(item);
+            }
+
+            queue->Complete(M_MAX_UNSIGNED);
+            PrepareUnloadedPassShaders();
+
+            // Add the batches to the light queues. Transparent batches of all lights go to the shared alpha queue in light order
+            for (unsigned i = 0; i < numLightQueues; ++i)
+            {
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = AddPendingBatchesWork;
+                item->aux_ = this;
+                item->start_ = &lightBatches_[i];
+                item->end_ = &lightBatches_[i] + 1;
+                queue->AddWorkItem(item);
+            }
+
+            if (alphaQueue)
+            {
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = AddPendingBatchesWork;
+                item->aux_ = this;
+                item->start_ = lightAlphaBatches_.Begin().ptr_;
+                item->end_ = lightAlphaBatches_.End().ptr_;
+                queue->AddWorkItem(item);
+            }
+
+            queue->Complete(M_MAX_UNSIGNED);
+        }
     }
 
     // Process drawables with limited per-pixel light count
@@ -1166,7 +1299,11 @@ void View::GetLightBatches()
                 // Find the correct light queue again
                 LightBatchQueue* queue = light->GetLightQueue();
                 if (queue)
-                    GetLitBatches(drawable, *queue, alphaQueue);
+                {
+                    maxLightsBatches_.Clear();
+                    GetLitBatches(drawable, *queue, alphaQueue, maxLightsBatches_, maxLightsBatches_);
+                    AddPendingBatches(maxLightsBatches_);
+                }
             }
         }
     }
@@ -1176,14 +1313,171 @@ void View::GetBaseBatches()
 {
     URHO3D_PROFILE(GetBaseBatches);
 
-    for (PODVector<Drawable*>::ConstIterator i = geometries_.Begin(); i != geometries_.End(); ++i)
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+
+    // Collect batches in worker threads. Each work item stores its results separately
+    {
+        unsigned numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
+        unsigned drawablesPerItem = geometries_.Size() / numWorkItems;
+        baseBatchResults_.Resize(numWorkItems);
+
+        unsigned start = 0;
+        for (unsigned i = 0; i < numWorkItems; ++i)
+        {
+            unsigned end = geometries_.Size();
+            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
+                end = start + drawablesPerItem;
+
+            BaseBatchResult& result = baseBatchResults_[i];
+            result.start_ = start;
+            result.end_ = end;
+            result.batches_.Resize(scenePasses_.Size());
+
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = GetBaseBatchesWork;
+            item->aux_ = this;
+            item->start_ = &result;
+            queue->AddWorkItem(item);
+
+            start = end;
+        }
+
+        queue->Complete(M_MAX_UNSIGNED);
+    }
+
+    // Combine geometry updates and find the vertex light queues in the main thread
+    for (Vector<BaseBatchResult>::Iterator i = baseBatchResults_.Begin(); i != baseBatchResults_.End(); ++i)
+    {
+        nonThreadedGeometries_.Push(i->nonThreadedGeometries_);
+        threadedGeometries_.Push(i->threadedGeometries_);
+
+        for (unsigned j = 0; j < scenePasses_.Size(); ++j)
+        {
+            PODVector<PendingBatch>& batches = i->batches_[j];
+            for (PODVector<PendingBatch>::Iterator k = batches.Begin(); k != batches.End(); ++k)
+            {
+                if (!k->vertexLights_)
+                    continue;
+
+                const PODVector<Light*>& drawableVertexLights = k->drawable_->GetVertexLights();
+                if (drawableVertexLights.Size())
+                {
+                    // Find a vertex light queue. If not found, create new
+                    unsigned long long hash = GetVertexLightQueueHash(drawableVertexLights);
+                    HashMap<unsigned long long, LightBatchQueue>::Iterator l = vertexLightQueues_.Find(hash);
+                    if (l == vertexLightQueues_.End())
+                    {
+                        l = vertexLightQueues_.Insert(MakePair(hash, LightBatchQueue()));
+                        l->second_.light_ = 0;
+                        l->second_.shadowMap_ = 0;
+                        l->second_.vertexLights_ = drawableVertexLights;
+                    }
+
+                    k->batch_.lightQueue_ = &(l->second_);
+                }
+            }
+        }
+    }
+
+    PrepareUnloadedPassShaders();
+
+    // Add the batches to the scene pass queues in worker threads, one work item per batch queue
+    for (unsigned i = 0; i < scenePasses_.Size(); ++i)
+    {
+        bool queueShared = false;
+        for (unsigned j = 0; j < i; ++j)
+        {
+            if (scenePasses_[j].batchQueue_ == scenePasses_[i].batchQueue_)
+            {
+                queueShared = true;
+                break;
+            }
+        }
+        if (queueShared)
+            continue;
+
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = AddBaseBatchesWork;
+        item->aux_ = this;
+        item->start_ = &scenePasses_[i];
+        queue->AddWorkItem(item);
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
+void View::CollectLightBatches(LightQueryResult& query)
+{
+    Light* light = query.light_;
+    LightBatchQueue& lightQueue = *light->GetLightQueue();
+    unsigned index = (unsigned)(&lightQueue - &lightQueues_[0]);
+    BatchQueue* alphaQueue = batchQueues_.Contains(alphaPassIndex_) ? &batchQueues_[alphaPassIndex_] : (BatchQueue*)0;
+
+    PODVector<PendingBatch>& batches = lightBatches_[index];
+    PODVector<PendingBatch>& alphaBatches = lightAlphaBatches_[index];
+    batches.Clear();
+    alphaBatches.Clear();
+
+    // Collect shadow batches
+    for (unsigned i = 0; i < lightQueue.shadowSplits_.Size(); ++i)
+    {
+        ShadowBatchQueue& shadowQueue = lightQueue.shadowSplits_[i];
+
+        for (PODVector<Drawable*>::ConstIterator j = query.shadowCasters_.Begin() + query.shadowCasterBegin_[i];
+             j < query.shadowCasters_.Begin() + query.shadowCasterEnd_[i]; ++j)
+        {
+            Drawable* drawable = *j;
+            Zone* zone = GetZone(drawable);
+            const Vector<SourceBatch>& sourceBatches = drawable->GetBatches();
+
+            for (unsigned k = 0; k < sourceBatches.Size(); ++k)
+            {
+                const SourceBatch& srcBatch = sourceBatches[k];
+
+                Technique* tech = GetTechnique(drawable, srcBatch.material_);
+                if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
+                    continue;
+
+                Pass* pass = tech->GetSupportedPass(Technique::shadowPassIndex);
+                // Skip if material has no shadow pass
+                if (!pass)
+                    continue;
+
+                Batch destBatch(srcBatch);
+                destBatch.pass_ = pass;
+                destBatch.zone_ = zone;
+
+                AddPendingBatch(batches, shadowQueue.shadowBatches_, destBatch, tech, drawable);
+            }
+        }
+    }
+
+    // Collect lit batches. Drawables that limit their maximum lights are processed later
+    for (PODVector<Drawable*>::ConstIterator i = query.litGeometries_.Begin(); i != query.litGeometries_.End(); ++i)
     {
         Drawable* drawable = *i;
+        if (!drawable->GetMaxLights())
+            GetLitBatches(drawable, lightQueue, alphaQueue, batches, alphaBatches);
+    }
+}
+
+void View::CollectBaseBatches(BaseBatchResult& result)
+{
+    result.nonThreadedGeometries_.Clear();
+    result.threadedGeometries_.Clear();
+    for (unsigned i = 0; i < result.batches_.Size(); ++i)
+        result.batches_[i].Clear();
+
+    for (unsigned i = result.start_; i < result.end_; ++i)
+    {
+        Drawable* drawable = geometries_[i];
         UpdateGeometryType type = drawable->GetUpdateGeometryType();
         if (type == UPDATE_MAIN_THREAD)
-            nonThreadedGeometries_.Push(drawable);
+            result.nonThreadedGeometries_.Push(drawable);
         else if (type == UPDATE_WORKER_THREAD)
-            threadedGeometries_.Push(drawable);
+            result.threadedGeometries_.Push(drawable);
 
         const Vector<SourceBatch>& batches = drawable->GetBatches();
         bool vertexLightsProcessed = false;
@@ -1195,7 +1489,12 @@ void View::GetBaseBatches()
             // Check here if the material refers to a rendertarget texture with camera(s) attached
             // Only check this for backbuffer views (null rendertarget)
             if (srcBatch.material_ && srcBatch.material_->GetAuxViewFrameNumber() != frame_.frameNumber_ && !renderTarget_)
-                CheckMaterialForAuxView(srcBatch.material_);
+            {
+                // The frame number is read atomically; recheck under the lock so that each material is checked only once
+                MutexLock lock(batchMutex_);
+                if (srcBatch.material_->GetAuxViewFrameNumber() != frame_.frameNumber_)
+                    CheckMaterialForAuxView(srcBatch.material_);
+            }
 
             Technique* tech = GetTechnique(drawable, srcBatch.material_);
             if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
@@ -1219,42 +1518,33 @@ void View::GetBaseBatches()
                 destBatch.isBase_ = true;
                 destBatch.lightMask_ = (unsigned char)GetLightMask(drawable);
 
-                if (info.vertexLights_)
+                // Limit vertex lights. If this is a deferred opaque batch, remove converted per-pixel lights,
+                // as they will be rendered as light volumes in any case, and drawing them also as vertex lights
+                // would result in double lighting. The vertex light queue is assigned later in the main thread
+                if (info.vertexLights_ && !vertexLightsProcessed && drawable->GetVertexLights().Size())
                 {
-                    const PODVector<Light*>& drawableVertexLights = drawable->GetVertexLights();
-                    if (drawableVertexLights.Size() && !vertexLightsProcessed)
-                    {
-                        // Limit vertex lights. If this is a deferred opaque batch, remove converted per-pixel lights,
-                        // as they will be rendered as light volumes in any case, and drawing them also as vertex lights
-                        // would result in double lighting
-                        drawable->LimitVertexLights(deferred_ && destBatch.pass_->GetBlendMode() == BLEND_REPLACE);
-                        vertexLightsProcessed = true;
-                    }
-
-                    if (drawableVertexLights.Size())
-                    {
-                        // Find a vertex light queue. If not found, create new
-                        unsigned long long hash = GetVertexLightQueueHash(drawableVertexLights);
-                        HashMap<unsigned long long, LightBatchQueue>::Iterator i = vertexLightQueues_.Find(hash);
-                        if (i == vertexLightQueues_.End())
-                        {
-                            i = vertexLightQueues_.Insert(MakePair(hash, LightBatchQueue()));
-                            i->second_.light_ = 0;
-                            i->second_.shadowMap_ = 0;
-                            i->second_.vertexLights_ = drawableVertexLights;
-                        }
-
-                        destBatch.lightQueue_ = &(i->second_);
-                    }
+                    drawable->LimitVertexLights(deferred_ && destBatch.pass_->GetBlendMode() == BLEND_REPLACE);
+                    vertexLightsProcessed = true;
                 }
-                else
-                    destBatch.lightQueue_ = 0;
 
                 bool allowInstancing = info.allowInstancing_;
                 if (allowInstancing && info.markToStencil_ && destBatch.lightMask_ != (destBatch.zone_->GetLightMask() & 0xff))
                     allowInstancing = false;
 
-                AddBatchToQueue(*info.batchQueue_, destBatch, tech, allowInstancing);
+                // Collect passes sharing a batch queue into one list to keep the order of adding to the queue
+                unsigned listIndex = k;
+                for (unsigned l = 0; l < k; ++l)
+                {
+                    if (scenePasses_[l].batchQueue_ == info.batchQueue_)
+                    {
+                        listIndex = l;
+                        break;
+                    }
+                }
+
+                PODVector<PendingBatch>& passBatches = result.batches_[listIndex];
+                AddPendingBatch(passBatches, *info.batchQueue_, destBatch, tech, drawable, allowInstancing);
+                passBatches.Back().vertexLights_ = info.vertexLights_;
             }
         }
     }
@@ -1354,24 +1644,32 @@ void View::UpdateGeometries()
             (*i)->UpdateGeometry(frame_);
     }
 
-    // Finally ensure all threaded work has completed
+    // Finally ensure all threaded work has completed, and let the threaded updates finish in the main thread
     queue->Complete(M_MAX_UNSIGNED);
+
+    for (PODVector<Drawable*>::ConstIterator i = threadedGeometries_.Begin(); i != threadedGeometries_.End(); ++i)
+    {
+        if (*i)
+            (*i)->FinishUpdateGeometry();
+    }
+
     geometriesUpdated_ = true;
 }
 
-void View::GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQueue* alphaQueue)
+void View::GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQueue* alphaQueue, PODVector<PendingBatch>& batches,
+    PODVector<PendingBatch>& alphaBatches)
 {
     Light* light = lightQueue.light_;
     Zone* zone = GetZone(drawable);
-    const Vector<SourceBatch>& batches = drawable->GetBatches();
+    const Vector<SourceBatch>& sourceBatches = drawable->GetBatches();
 
     bool allowLitBase =
         useLitBase_ && !lightQueue.negative_ && light == drawable->GetFirstLight() && drawable->GetVertexLights().Empty() &&
         !zone->GetAmbientGradient();
 
-    for (unsigned i = 0; i < batches.Size(); ++i)
+    for (unsigned i = 0; i < sourceBatches.Size(); ++i)
     {
-        const SourceBatch& srcBatch = batches[i];
+        const SourceBatch& srcBatch = sourceBatches[i];
 
         Technique* tech = GetTechnique(drawable, srcBatch.material_);
         if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
@@ -1417,15 +1715,15 @@ void View::GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQ
         if (!isLitAlpha)
         {
             if (destBatch.isBase_)
-                AddBatchToQueue(lightQueue.litBaseBatches_, destBatch, tech);
+                AddPendingBatch(batches, lightQueue.litBaseBatches_, destBatch, tech, drawable);
             else
-                AddBatchToQueue(lightQueue.litBatches_, destBatch, tech);
+                AddPendingBatch(batches, lightQueue.litBatches_, destBatch, tech, drawable);
         }
         else if (alphaQueue)
         {
             // Transparent batches can not be instanced, and shadows on transparencies can only be rendered if shadow maps are
             // not reused
-            AddBatchToQueue(*alphaQueue, destBatch, tech, false, !renderer_->GetReuseShadowMaps());
+            AddPendingBatch(alphaBatches, *alphaQueue, destBatch, tech, drawable, false, !renderer_->GetReuseShadowMaps());
         }
     }
 }
@@ -1695,7 +1993,7 @@ void View::SetRenderTargets(RenderPathCommand& command)
             {
                 useColorWrite = false;
                 useCustomDepth = true;
-#if !defined(URHO3D_OPENGL) && !defined(URHO3D_D3D11)
+#if !defined(URHO3D_OPENGL) && !defined(URHO3D_D3D11) && !defined(URHO3D_NULL_GRAPHICS)
                 // On D3D9 actual depth-only rendering is illegal, we need a color rendertarget
                 if (!depthOnlyDummyTexture_)
                 {
@@ -2151,7 +2449,7 @@ void View::UpdateOccluders(PODVector<Drawable*>& occluders, Camera* camera)
         Sort(occluders.Begin(), occluders.End(), CompareDrawables);
 }
 
-void View::DrawOccluders(OcclusionBuffer* buffer, const PODVector<Drawable*>& occluders)
+void View::DrawOccluders(OcclusionBuffer* buffer, const PODVector<Drawable*>& occluders, OcclusionBuffer* previousBuffer)
 {
     buffer->SetMaxTriangles((unsigned)maxOccluderTriangles_);
     buffer->Clear();
@@ -2162,6 +2460,9 @@ void View::DrawOccluders(OcclusionBuffer* buffer, const PODVector<Drawable*>& oc
         for (unsigned i = 0; i < occluders.Size(); ++i)
         {
             Drawable* occluder = occluders[i];
+            // Skip occluders that were hidden behind other occluders on the previous frame
+            if (previousBuffer && !previousBuffer->IsVisible(occluder->GetWorldBoundingBox()))
+                continue;
             if (i > 0)
             {
                 // For subsequent occluders, do a test against the pixel-level occlusion buffer to see if rendering is necessary
@@ -2183,6 +2484,10 @@ void View::DrawOccluders(OcclusionBuffer* buffer, const PODVector<Drawable*>& oc
         // In threaded mode submit all triangles first, then render (cannot test in this case)
         for (unsigned i = 0; i < occluders.Size(); ++i)
         {
+            // Testing against the previous frame's buffer is possible though, as it is already complete
+            if (previousBuffer && !previousBuffer->IsVisible(occluders[i]->GetWorldBoundingBox()))
+                continue;
+
             // Check for running out of triangles
             ++activeOccluders_;
             if (!occluders[i]->DrawOcclusion(buffer))
@@ -2196,6 +2501,65 @@ void View::DrawOccluders(OcclusionBuffer* buffer, const PODVector<Drawable*>& oc
     buffer->BuildDepthHierarchy();
 }
 
+void View::DrawTemporalOccluders(const PODVector<Drawable*>& occluders)
+{
+    int width = renderer_->GetOcclusionBufferSize();
+    int height = (int)((float)width / cullCamera_->GetAspectRatio() + 0.5f);
+    bool threaded = renderer_->GetThreadedOcclusion();
+    // Apply the same adjustments as OcclusionBuffer::SetSize() for comparing against the latest buffer
+    if (height & 1)
+        ++height;
+    threaded = threaded && GetSubsystem<WorkQueue>()->GetNumThreads() > 0;
+    OcclusionBuffer* latest = temporalOcclusionBuffers_[0];
+
+    // If the camera and the occluders are unchanged, the latest buffer would be drawn identically, so use it as is. The occlusion
+    // data revisions catch changes to the occluders' models, LOD levels, materials and geometry, and also a new drawable
+    // occupying the address of a destroyed one
+    unsigned materialRevision = Material::GetOcclusionRevision();
+    bool unchanged = latest && latest->GetWidth() == width && latest->GetHeight() == height && latest->IsThreaded() == threaded &&
+        latest->GetMaxTriangles() == (unsigned)maxOccluderTriangles_ && latest->GetView() == cullCamera_->GetView() &&
+        latest->GetProjection() == cullCamera_->GetProjection(false) && temporalOccluders_.Size() == occluders.Size() &&
+        temporalMaterialRevision_ == materialRevision;
+    for (unsigned i = 0; unchanged && i < occluders.Size(); ++i)
+    {
+        if (occluders[i] != temporalOccluders_[i] || occluders[i]->GetOcclusionRevision() != temporalOccluderRevisions_[i] ||
+            !(occluders[i]->GetNode()->GetWorldTransform() == temporalOccluderTransforms_[i]))
+            unchanged = false;
+    }
+
+    if (unchanged)
+    {
+        occlusionBuffer_ = latest;
+        activeOccluders_ = temporalActiveOccluders_;
+        temporalOcclusionFrameNumber_ = frame_.frameNumber_;
+        return;
+    }
+
+    // Otherwise draw into the other buffer. The latest buffer, if used on the previous frame, is used to skip occluders that
+    // were hidden then. This only reduces the occlusion, so the result stays conservative
+    Swap(temporalOcclusionBuffers_[0], temporalOcclusionBuffers_[1]);
+    if (!temporalOcclusionBuffers_[0])
+        temporalOcclusionBuffers_[0] = new OcclusionBuffer(context_);
+    OcclusionBuffer* previous = temporalOcclusionFrameNumber_ + 1 == frame_.frameNumber_ ? temporalOcclusionBuffers_[1].Get() : 0;
+
+    occlusionBuffer_ = temporalOcclusionBuffers_[0];
+    occlusionBuffer_->SetSize(width, height, threaded);
+    occlusionBuffer_->SetView(cullCamera_);
+    DrawOccluders(occlusionBuffer_, occluders, previous);
+
+    temporalOccluders_ = occluders;
+    temporalOccluderTransforms_.Resize(occluders.Size());
+    temporalOccluderRevisions_.Resize(occluders.Size());
+    for (unsigned i = 0; i < occluders.Size(); ++i)
+    {
+        temporalOccluderTransforms_[i] = occluders[i]->GetNode()->GetWorldTransform();
+        temporalOccluderRevisions_[i] = occluders[i]->GetOcclusionRevision();
+    }
+    temporalMaterialRevision_ = materialRevision;
+    temporalActiveOccluders_ = activeOccluders_;
+    temporalOcclusionFrameNumber_ = frame_.frameNumber_;
+}
+
 void View::ProcessLight(LightQueryResult& query, unsigned threadIndex)
 {
     Light* light = query.light_;
@@ -2809,6 +3173,17 @@ void View::AddBatchToQueue(BatchQueue& batchQueue, Batch& batch, Technique* tech
             renderer_->SetBatchShaders(newGroup, tech, allowShadows);
             newGroup.CalculateSortKey();
             i = batchQueue.batchGroups_.Insert(MakePair(key, newGroup));
+            if (batchQueue.retainGroups_)
+                batchQueue.newBatchGroups_.Push(&i->second_);
+        }
+        else if (i->second_.instances_.Empty())
+        {
+            // Group retained from an earlier frame, refresh its state from the batch
+            BatchGroup& group = i->second_;
+            static_cast<Batch&>(group) = batch;
+            group.geometryType_ = GEOM_STATIC;
+            renderer_->SetBatchShaders(group, tech, allowShadows);
+            group.CalculateSortKey();
         }
 
         int oldSize = i->second_.instances_.Size();
@@ -2843,6 +3218,42 @@ void View::AddBatchToQueue(BatchQueue& batchQueue, Batch& batch, Technique* tech
     }
 }
 
+void View::AddPendingBatch(PODVector<PendingBatch>& batches, BatchQueue& queue, const Batch& batch, Technique* tech,
+    Drawable* drawable, bool allowInstancing, bool allowShadows)
+{
+    // Shaders can only be loaded in the main thread, so record the pass if they are missing
+    if (!renderer_->HasPassShaders(batch.pass_))
+    {
+        MutexLock lock(batchMutex_);
+        if (!unloadedPasses_.Contains(batch.pass_))
+            unloadedPasses_.Push(batch.pass_);
+    }
+
+    PendingBatch pending;
+    pending.batch_ = batch;
+    pending.queue_ = &queue;
+    pending.tech_ = tech;
+    pending.drawable_ = drawable;
+    pending.allowInstancing_ = allowInstancing;
+    pending.allowShadows_ = allowShadows;
+    pending.vertexLights_ = false;
+    batches.Push(pending);
+}
+
+void View::AddPendingBatches(PODVector<PendingBatch>& batches)
+{
+    for (PODVector<PendingBatch>::Iterator i = batches.Begin(); i != batches.End(); ++i)
+        AddBatchToQueue(*i->queue_, i->batch_, i->tech_, i->allowInstancing_, i->allowShadows_);
+}
+
+void View::PrepareUnloadedPassShaders()
+{
+    for (PODVector<Pass*>::Iterator i = unloadedPasses_.Begin(); i != unloadedPasses_.End(); ++i)
+        renderer_->PreparePassShaders(*i);
+
+    unloadedPasses_.Clear();
+}
+
 void View::PrepareInstancingBuffer()
 {
     // Prepare instancing buffer from the source view
@@ -24,6 +24,7 @@
 
 #include "../Container/HashSet.h"
 #include "../Container/List.h"
+#include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../Graphics/Batch.h"
 #include "../Graphics/Light.h"
@@ -104,6 +105,40 @@ struct PerThreadSceneResult
     float maxZ_;
 };
 
+/// Batch collected in a worker thread, to be added to its batch queue afterward.
+struct PendingBatch
+{
+    /// Batch.
+    Batch batch_;
+    /// Batch queue to add to.
+    BatchQueue* queue_;
+    /// Technique.
+    Technique* tech_;
+    /// Source drawable.
+    Drawable* drawable_;
+    /// Allow instancing flag.
+    bool allowInstancing_;
+    /// Allow shadows flag.
+    bool allowShadows_;
+    /// Vertex lights flag of the scene pass. The vertex light queue is assigned later in the main thread.
+    bool vertexLights_;
+};
+
+/// Base batch collection result of one work item. Results are merged in work item order, so that the batch queues are the same as when built in one thread.
+struct BaseBatchResult
+{
+    /// Start index in the geometry objects.
+    unsigned start_;
+    /// End index in the geometry objects.
+    unsigned end_;
+    /// Batches for each scene pass. Scene passes that share a batch queue use the list of the first such pass.
+    Vector<PODVector<PendingBatch> > batches_;
+    /// Geometry objects that will be updated in the main thread.
+    PODVector<Drawable*> nonThreadedGeometries_;
+    /// Geometry objects that will be updated in worker threads.
+    PODVector<Drawable*> threadedGeometries_;
+};
+
 static const unsigned MAX_VIEWPORT_TEXTURES = 2;
 
 /// Internal structure for 3D rendering work. Created for each backbuffer and texture viewport, but not for shadow cameras.
@@ -111,6 +146,10 @@ class URHO3D_API View : public Object
 {
     friend void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex);
     friend void ProcessLightWork(const WorkItem* item, unsigned threadIndex);
+    friend void GetLightBatchesWork(const WorkItem* item, unsigned threadIndex);
+    friend void GetBaseBatchesWork(const WorkItem* item, unsigned threadIndex);
+    friend void AddBaseBatchesWork(const WorkItem* item, unsigned threadIndex);
+    friend void AddPendingBatchesWork(const WorkItem* item, unsigned threadIndex);
 
     URHO3D_OBJECT(View, Object);
 
@@ -194,8 +233,20 @@ private:
     void GetBaseBatches();
     /// Update geometries and sort batches.
     void UpdateGeometries();
-    /// Get pixel lit batches for a certain light and drawable.
-    void GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQueue* alphaQueue);
+    /// Collect shadow and lit batches of a per-pixel light. Called from a worker thread.
+    void CollectLightBatches(LightQueryResult& query);
+    /// Collect unlit batches from a range of geometry objects. Called from a worker thread.
+    void CollectBaseBatches(BaseBatchResult& result);
+    /// Get pixel lit batches for a certain light and drawable. Transparent batches are collected separately.
+    void GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQueue* alphaQueue, PODVector<PendingBatch>& batches,
+        PODVector<PendingBatch>& alphaBatches);
+    /// Collect a batch to be added to a batch queue later. Is thread-safe.
+    void AddPendingBatch(PODVector<PendingBatch>& batches, BatchQueue& queue, const Batch& batch, Technique* tech, Drawable* drawable,
+        bool allowInstancing = true, bool allowShadows = true);
+    /// Add collected batches to their batch queues. Is thread-safe if no other thread is adding to the same batch queues.
+    void AddPendingBatches(PODVector<PendingBatch>& batches);
+    /// Load the shaders of passes that were found unloaded while collecting batches.
+    void PrepareUnloadedPassShaders();
     /// Execute render commands.
     void ExecuteRenderPathCommands();
     /// Set rendertargets for current render command.
@@ -220,8 +271,10 @@ private:
     void DrawFullscreenQuad(bool nearQuad);
     /// Query for occluders as seen from a camera.
     void UpdateOccluders(PODVector<Drawable*>& occluders, Camera* camera);
-    /// Draw occluders to occlusion buffer.
-    void DrawOccluders(OcclusionBuffer* buffer, const PODVector<Drawable*>& occluders);
+    /// Draw occluders to occlusion buffer. Optionally skip occluders that were hidden in the previous frame's buffer.
+    void DrawOccluders(OcclusionBuffer* buffer, const PODVector<Drawable*>& occluders, OcclusionBuffer* previousBuffer = 0);
+    /// Draw occluders to the view's own occlusion buffer, or reuse the previous frame's buffer if the camera and occluders are unchanged.
+    void DrawTemporalOccluders(const PODVector<Drawable*>& occluders);
     /// Query for lit geometries and shadow casters for a light.
     void ProcessLight(LightQueryResult& query, unsigned threadIndex);
     /// Process shadow casters' visibilities and build their combined view- or projection-space bounding box.
@@ -384,9 +437,35 @@ private:
     PODVector<Light*> lights_;
     /// Number of active occluders.
     unsigned activeOccluders_;
+    /// Occlusion buffers owned by the view for temporal occlusion: the latest and the one before it.
+    SharedPtr<OcclusionBuffer> temporalOcclusionBuffers_[2];
+    /// Occluders drawn into the latest temporal occlusion buffer.
+    PODVector<Drawable*> temporalOccluders_;
+    /// World transforms of the occluders drawn into the latest temporal occlusion buffer.
+    PODVector<Matrix3x4> temporalOccluderTransforms_;
+    /// Occlusion data revisions of the occluders drawn into the latest temporal occlusion buffer.
+    PODVector<unsigned> temporalOccluderRevisions_;
+    /// Material occlusion revision when the latest temporal occlusion buffer was drawn.
+    unsigned temporalMaterialRevision_;
+    /// Frame number the latest temporal occlusion buffer was used on.
+    unsigned temporalOcclusionFrameNumber_;
+    /// Number of active occluders in the latest temporal occlusion buffer.
+    unsigned temporalActiveOccluders_;
 
     /// Drawables that limit their maximum light count.
     HashSet<Drawable*> maxLightsDrawables_;
+    /// Base batch collection results per work item.
+    Vector<BaseBatchResult> baseBatchResults_;
+    /// Collected shadow and lit batches per light queue.
+    Vector<PODVector<PendingBatch> > lightBatches_;
+    /// Collected lit transparent batches per light queue.
+    Vector<PODVector<PendingBatch> > lightAlphaBatches_;
+    /// Collected lit batches of drawables with limited per-pixel light count.
+    PODVector<PendingBatch> maxLightsBatches_;
+    /// Passes whose shaders need to be loaded in the main thread before adding batches.
+    PODVector<Pass*> unloadedPasses_;
+    /// Mutex for collecting batches in worker threads.
+    Mutex batchMutex_;
     /// Rendertargets defined by the renderpath.
     HashMap<StringHash, Texture*> renderTargets_;
     /// Intermediate light processing results.
@@ -94,7 +94,7 @@ void Zone::RegisterObject(Context* context)
 
 void Zone::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
 {
-    Serializable::OnSetAttribute(attr, src);
+    Drawable::OnSetAttribute(attr, src);
 
     // If bounding box or priority changes, dirty the drawable as applicable
     if ((attr.offset_ >= offsetof(Zone, boundingBox_) && attr.offset_ < (offsetof(Zone, boundingBox_) + sizeof(BoundingBox))) ||
@@ -102,6 +102,17 @@ void Zone::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
         OnMarkedDirty(node_);
 }
 
+bool Zone::OnLoadAttribute(const AttributeInfo& attr, Deserializer& source)
+{
+    if (!Drawable::OnLoadAttribute(attr, source))
+        return false;
+
+    if ((attr.offset_ >= offsetof(Zone, boundingBox_) && attr.offset_ < (offsetof(Zone, boundingBox_) + sizeof(BoundingBox))) ||
+        attr.offset_ == offsetof(Zone, priority_))
+        OnMarkedDirty(node_);
+    return true;
+}
+
 void Zone::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
 {
     if (debug && IsEnabledEffective())
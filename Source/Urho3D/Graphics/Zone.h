@@ -44,6 +44,8 @@ public:
 
     /// Handle attribute write access.
     virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
+    /// Handle attribute write access from binary data.
+    virtual bool OnLoadAttribute(const AttributeInfo& attr, Deserializer& source);
     /// Visualize the component as debug geometry.
     virtual void DrawDebugGeometry(DebugRenderer* debug, bool depthTest);
 
@@ -71,6 +71,10 @@ File::File(Context* context) :
     readBufferOffset_(0),
     readBufferSize_(0),
     offset_(0),
+    mappedData_(0),
+    mappedSize_(0),
+    blockSize_(0),
+    readBlock_(M_MAX_UNSIGNED),
     checksum_(0),
     compressed_(false),
     readSyncNeeded_(false),
@@ -88,6 +92,10 @@ File::File(Context* context, const String& fileName, FileMode mode) :
     readBufferOffset_(0),
     readBufferSize_(0),
     offset_(0),
+    mappedData_(0),
+    mappedSize_(0),
+    blockSize_(0),
+    readBlock_(M_MAX_UNSIGNED),
     checksum_(0),
     compressed_(false),
     readSyncNeeded_(false),
@@ -106,6 +114,10 @@ File::File(Context* context, PackageFile* package, const String& fileName) :
     readBufferOffset_(0),
     readBufferSize_(0),
     offset_(0),
+    mappedData_(0),
+    mappedSize_(0),
+    blockSize_(0),
+    readBlock_(M_MAX_UNSIGNED),
     checksum_(0),
     compressed_(false),
     readSyncNeeded_(false),
@@ -223,37 +235,52 @@ bool File::Open(PackageFile* package, const String& fileName)
     if (!entry)
         return false;
 
+    // Compressed files can be read from any position if the block offsets are known
+    compressed_ = package->IsCompressed();
+    if (compressed_)
+        package->GetBlockOffsets(*entry, blockOffsets_, blockSize_);
+
+    // Read directly from a memory-mapped package, unless the file is compressed and must be decompressed sequentially
+    if (package->IsMemoryMapped() && (!compressed_ || !blockOffsets_.Empty()))
+    {
+        mappedData_ = package->GetMappedData() + entry->offset_;
+        mappedSize_ = package->GetTotalSize() - entry->offset_;
+    }
+    else
+    {
 #ifdef _WIN32
-    handle_ = _wfopen(GetWideNativePath(package->GetName()).CString(), L"rb");
+        handle_ = _wfopen(GetWideNativePath(package->GetName()).CString(), L"rb");
 #else
-    handle_ = fopen(GetNativePath(package->GetName()).CString(), "rb");
+        handle_ = fopen(GetNativePath(package->GetName()).CString(), "rb");
 #endif
-    if (!handle_)
-    {
-        URHO3D_LOGERROR("Could not open package file " + fileName);
-        return false;
+        if (!handle_)
+        {
+            URHO3D_LOGERROR("Could not open package file " + fileName);
+            blockOffsets_.Clear();
+            return false;
+        }
+
+        fseek((FILE*)handle_, entry->offset_, SEEK_SET);
     }
 
+    package_ = package;
     fileName_ = fileName;
     mode_ = FILE_READ;
     offset_ = entry->offset_;
     checksum_ = entry->checksum_;
     position_ = 0;
     size_ = entry->size_;
-    compressed_ = package->IsCompressed();
     readSyncNeeded_ = false;
     writeSyncNeeded_ = false;
-
-    fseek((FILE*)handle_, offset_, SEEK_SET);
     return true;
 }
 
 unsigned File::Read(void* dest, unsigned size)
 {
 #ifdef ANDROID
-    if (!handle_ && !assetHandle_)
+    if (!handle_ && !mappedData_ && !assetHandle_)
 #else
-    if (!handle_)
+    if (!handle_ && !mappedData_)
 #endif
     {
         // Do not log the error further here to prevent spamming the stderr stream
@@ -297,6 +324,32 @@ unsigned File::Read(void* dest, unsigned size)
         return size;
     }
 #endif
+    if (compressed_ && !blockOffsets_.Empty())
+    {
+        unsigned sizeLeft = size;
+        unsigned char* destPtr = (unsigned char*)dest;
+
+        while (sizeLeft)
+        {
+            unsigned block = position_ / blockSize_;
+            readBufferOffset_ = position_ - block * blockSize_;
+            if ((block != readBlock_ && !ReadBlock(block)) || readBufferOffset_ >= readBufferSize_)
+            {
+                URHO3D_LOGERROR("Error while decompressing file " + GetName());
+                return size - sizeLeft;
+            }
+
+            unsigned copySize = readBufferSize_ - readBufferOffset_;
+            if (copySize > sizeLeft)
+                copySize = sizeLeft;
+            memcpy(destPtr, readBuffer_.Get() + readBufferOffset_, copySize);
+            destPtr += copySize;
+            sizeLeft -= copySize;
+            position_ += copySize;
+        }
+
+        return size;
+    }
     if (compressed_)
     {
         unsigned sizeLeft = size;
@@ -337,6 +390,12 @@ unsigned File::Read(void* dest, unsigned size)
 
         return size;
     }
+    if (mappedData_)
+    {
+        memcpy(dest, mappedData_ + position_, size);
+        position_ += size;
+        return size;
+    }
 
     // Need to reassign the position due to internal buffering when transitioning from writing to reading
     if (readSyncNeeded_)
@@ -362,9 +421,9 @@ unsigned File::Read(void* dest, unsigned size)
 unsigned File::Seek(unsigned position)
 {
 #ifdef ANDROID
-    if (!handle_ && !assetHandle_)
+    if (!handle_ && !mappedData_ && !assetHandle_)
 #else
-    if (!handle_)
+    if (!handle_ && !mappedData_)
 #endif
     {
         // Do not log the error further here to prevent spamming the stderr stream
@@ -385,25 +444,30 @@ unsigned File::Seek(unsigned position)
         return position_;
     }
 #endif
+    // With known block offsets, or when memory-mapped, the position can be set freely; blocks are decompressed on demand
+    if ((compressed_ && !blockOffsets_.Empty()) || mappedData_)
+    {
+        position_ = position;
+        return position_;
+    }
     if (compressed_)
     {
-        // Start over from the beginning
-        if (position == 0)
+        // Start over from the beginning, as the blocks can only be decompressed sequentially
+        if (position < position_)
         {
             position_ = 0;
             readBufferOffset_ = 0;
             readBufferSize_ = 0;
             fseek((FILE*)handle_, offset_, SEEK_SET);
         }
+
         // Skip bytes
-        else if (position >= position_)
+        unsigned char skipBuffer[SKIP_BUFFER_SIZE];
+        while (position > position_)
         {
-            unsigned char skipBuffer[SKIP_BUFFER_SIZE];
-            while (position > position_)
-                Read(skipBuffer, (unsigned)Min((int)position - position_, (int)SKIP_BUFFER_SIZE));
+            if (!Read(skipBuffer, (unsigned)Min((int)position - position_, (int)SKIP_BUFFER_SIZE)))
+                break;
         }
-        else
-            URHO3D_LOGERROR("Seeking backward in a compressed file is not supported");
 
         return position_;
     }
@@ -496,16 +560,25 @@ void File::Close()
 
     readBuffer_.Reset();
     inputBuffer_.Reset();
+    blockOffsets_.Clear();
+    readBlock_ = M_MAX_UNSIGNED;
 
-    if (handle_)
+    if (handle_ || mappedData_)
     {
-        fclose((FILE*)handle_);
-        handle_ = 0;
+        if (handle_)
+        {
+            fclose((FILE*)handle_);
+            handle_ = 0;
+        }
+        mappedData_ = 0;
+        mappedSize_ = 0;
         position_ = 0;
         size_ = 0;
         offset_ = 0;
         checksum_ = 0;
     }
+
+    package_.Reset();
 }
 
 void File::Flush()
@@ -522,10 +595,63 @@ void File::SetName(const String& name)
 bool File::IsOpen() const
 {
 #ifdef ANDROID
-        return handle_ != 0 || assetHandle_ != 0;
+        return handle_ != 0 || mappedData_ != 0 || assetHandle_ != 0;
 #else
-    return handle_ != 0;
+    return handle_ != 0 || mappedData_ != 0;
 #endif
 }
 
+bool File::ReadBlock(unsigned index)
+{
+    readBlock_ = M_MAX_UNSIGNED;
+
+    unsigned blockOffset = blockOffsets_[index];
+    unsigned char blockHeaderBytes[4];
+
+    if (mappedData_)
+    {
+        if (blockOffset + sizeof blockHeaderBytes > mappedSize_)
+            return false;
+        memcpy(blockHeaderBytes, mappedData_ + blockOffset, sizeof blockHeaderBytes);
+    }
+    else
+    {
+        fseek((FILE*)handle_, offset_ + blockOffset, SEEK_SET);
+        if (fread(blockHeaderBytes, sizeof blockHeaderBytes, 1, (FILE*)handle_) != 1)
+            return false;
+    }
+
+    MemoryBuffer blockHeader(&blockHeaderBytes[0], sizeof blockHeaderBytes);
+    unsigned unpackedSize = blockHeader.ReadUShort();
+    unsigned packedSize = blockHeader.ReadUShort();
+    if (unpackedSize > blockSize_ || (int)packedSize > LZ4_compressBound(blockSize_))
+        return false;
+
+    if (!readBuffer_)
+        readBuffer_ = new unsigned char[blockSize_];
+
+    const unsigned char* packedData;
+    if (mappedData_)
+    {
+        if (blockOffset + sizeof blockHeaderBytes + packedSize > mappedSize_)
+            return false;
+        packedData = mappedData_ + blockOffset + sizeof blockHeaderBytes;
+    }
+    else
+    {
+        if (!inputBuffer_)
+            inputBuffer_ = new unsigned char[LZ4_compressBound(blockSize_)];
+        if (fread(inputBuffer_.Get(), packedSize, 1, (FILE*)handle_) != 1)
+            return false;
+        packedData = inputBuffer_.Get();
+    }
+
+    if (LZ4_decompress_safe((const char*)packedData, (char*)readBuffer_.Get(), packedSize, unpackedSize) != (int)unpackedSize)
+        return false;
+
+    readBlock_ = index;
+    readBufferSize_ = unpackedSize;
+    return true;
+}
+
 }
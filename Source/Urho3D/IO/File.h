@@ -102,13 +102,16 @@ public:
     /// Return whether is open.
     bool IsOpen() const;
 
-    /// Return the file handle.
+    /// Return the file handle. Null for a file read from a memory-mapped package.
     void* GetHandle() const { return handle_; }
 
     /// Return whether the file originates from a package.
     bool IsPackaged() const { return offset_ != 0; }
 
 private:
+    /// Read and decompress a block of a compressed file using the block offsets. Return true if successful.
+    bool ReadBlock(unsigned index);
+
     /// File name.
     String fileName_;
     /// Open mode.
@@ -129,6 +132,18 @@ private:
     unsigned readBufferSize_;
     /// Start position within a package file, 0 for regular files.
     unsigned offset_;
+    /// Package file the file was opened from. Keeps a memory mapping alive.
+    SharedPtr<PackageFile> package_;
+    /// File data within a memory-mapped package file, null otherwise.
+    const unsigned char* mappedData_;
+    /// Mapped bytes available from the file start.
+    unsigned mappedSize_;
+    /// Compressed block offsets relative to the file start for random access, empty if not available.
+    PODVector<unsigned> blockOffsets_;
+    /// Unpacked size of the compressed blocks.
+    unsigned blockSize_;
+    /// Index of the compressed block currently in the read buffer, M_MAX_UNSIGNED if none.
+    unsigned readBlock_;
     /// Content checksum.
     unsigned checksum_;
     /// Compression flag.
@@ -22,17 +22,88 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/File.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../IO/PackageFile.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <LZ4/lz4.h>
+
 namespace Urho3D
 {
 
+static const unsigned BLOCKS_PER_WORK_ITEM = 8;
+
+/// Range of compressed blocks of a memory-mapped file to decompress on a work queue thread.
+struct PackageBlockRange
+{
+    /// Mapped data of the file.
+    const unsigned char* source_;
+    /// Mapped bytes available from the file start.
+    unsigned available_;
+    /// Block offsets relative to the file start.
+    const unsigned* offsets_;
+    /// Destination buffer for the whole file.
+    unsigned char* dest_;
+    /// Unpacked size of the whole file.
+    unsigned size_;
+    /// Unpacked block size.
+    unsigned blockSize_;
+    /// First block index.
+    unsigned first_;
+    /// Last block index (exclusive.)
+    unsigned last_;
+    /// Index of the file in the request.
+    unsigned fileIndex_;
+    /// Success flag.
+    bool success_;
+};
+
+static bool DecompressBlocks(PackageBlockRange& range)
+{
+    for (unsigned i = range.first_; i < range.last_; ++i)
+    {
+        unsigned offset = range.offsets_[i];
+        if (offset + 4 > range.available_)
+            return false;
+
+        const unsigned char* block = range.source_ + offset;
+        unsigned unpackedSize = (unsigned)block[0] | ((unsigned)block[1] << 8);
+        unsigned packedSize = (unsigned)block[2] | ((unsigned)block[3] << 8);
+        unsigned destOffset = i * range.blockSize_;
+        if (offset + 4 + packedSize > range.available_ || destOffset + unpackedSize > range.size_ ||
+            LZ4_decompress_safe((const char*)block + 4, (char*)range.dest_ + destOffset, packedSize, unpackedSize) !=
+            (int)unpackedSize)
+            return false;
+    }
+
+    return true;
+}
+
+void DecompressPackageBlocksWork(const WorkItem* item, unsigned threadIndex)
+{
+    PackageBlockRange* range = reinterpret_cast<PackageBlockRange*>(item->start_);
+    range->success_ = DecompressBlocks(*range);
+}
+
 PackageFile::PackageFile(Context* context) :
     Object(context),
     totalSize_(0),
     checksum_(0),
+    blockSize_(0),
+    mappedData_(0),
+    mappedSize_(0),
     compressed_(false)
 {
 }
@@ -41,6 +112,9 @@ PackageFile::PackageFile(Context* context, const String& fileName, unsigned star
     Object(context),
     totalSize_(0),
     checksum_(0),
+    blockSize_(0),
+    mappedData_(0),
+    mappedSize_(0),
     compressed_(false)
 {
     Open(fileName, startOffset);
@@ -48,6 +122,7 @@ PackageFile::PackageFile(Context* context, const String& fileName, unsigned star
 
 PackageFile::~PackageFile()
 {
+    UnmapFile();
 }
 
 bool PackageFile::Open(const String& fileName, unsigned startOffset)
@@ -60,6 +135,11 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
     }
 #endif
 
+    UnmapFile();
+    entries_.Clear();
+    blockIndex_.Clear();
+    blockSize_ = 0;
+
     SharedPtr<File> file(new File(context_, fileName));
     if (!file->IsOpen())
         return false;
@@ -99,6 +179,9 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
     unsigned numFiles = file->ReadUInt();
     checksum_ = file->ReadUInt();
 
+    Vector<String> entryNames;
+    unsigned numBlocks = 0;
+
     for (unsigned i = 0; i < numFiles; ++i)
     {
         String entryName = file->ReadString();
@@ -106,15 +189,61 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
         newEntry.offset_ = file->ReadUInt() + startOffset;
         newEntry.size_ = file->ReadUInt();
         newEntry.checksum_ = file->ReadUInt();
+        newEntry.blockIndexStart_ = M_MAX_UNSIGNED;
         if (!compressed_ && newEntry.offset_ + newEntry.size_ > totalSize_)
         {
             URHO3D_LOGERROR("File entry " + entryName + " outside package file");
             return false;
         }
         else
+        {
             entries_[entryName] = newEntry;
+            entryNames.Push(entryName);
+        }
+    }
+
+    // A compressed package may end with a block index for random access to the files, followed by the index ID, block size,
+    // index offset and package size
+    if (compressed_ && totalSize_ >= startOffset + 4 * sizeof(unsigned))
+    {
+        file->Seek(totalSize_ - 4 * sizeof(unsigned));
+        String indexID = file->ReadFileID();
+        unsigned blockSize = file->ReadUInt();
+        unsigned indexOffset = file->ReadUInt() + startOffset;
+        unsigned packageSize = file->ReadUInt();
+
+        if (indexID == "UBIX" && blockSize && startOffset + packageSize == totalSize_)
+        {
+            for (unsigned i = 0; i < entryNames.Size(); ++i)
+                numBlocks += (entries_[entryNames[i]].size_ + blockSize - 1) / blockSize;
+
+            if (indexOffset + numBlocks * sizeof(unsigned) + 4 * sizeof(unsigned) == totalSize_)
+            {
+                blockIndex_.Resize(numBlocks);
+                file->Seek(indexOffset);
+                if (!numBlocks || file->Read(&blockIndex_[0], numBlocks * sizeof(unsigned)) == numBlocks * sizeof(unsigned))
+                {
+                    blockSize_ = blockSize;
+                    unsigned blockIndexStart = 0;
+                    for (unsigned i = 0; i < entryNames.Size(); ++i)
+                    {
+                        PackageEntry& entry = entries_[entryNames[i]];
+                        entry.blockIndexStart_ = blockIndexStart;
+                        blockIndexStart += (entry.size_ + blockSize - 1) / blockSize;
+                    }
+                }
+                else
+                    blockIndex_.Clear();
+            }
+            else
+                URHO3D_LOGWARNING("Ignoring invalid block index in package file " + fileName);
+        }
     }
 
+    // Memory-map the package if possible so that files can be read, and decompressed from any position, without going
+    // through the C file API
+    MapFile(fileName);
+
     return true;
 }
 
@@ -161,4 +290,202 @@ const PackageEntry* PackageFile::GetEntry(const String& fileName) const
     return 0;
 }
 
+bool PackageFile::GetBlockOffsets(const PackageEntry& entry, PODVector<unsigned>& offsets, unsigned& blockSize) const
+{
+    offsets.Clear();
+    if (!compressed_)
+        return false;
+
+    if (entry.blockIndexStart_ != M_MAX_UNSIGNED)
+    {
+        unsigned numBlocks = (entry.size_ + blockSize_ - 1) / blockSize_;
+        offsets.Resize(numBlocks);
+        if (numBlocks)
+            memcpy(&offsets[0], &blockIndex_[entry.blockIndexStart_], numBlocks * sizeof(unsigned));
+        blockSize = blockSize_;
+        return true;
+    }
+
+    if (!mappedData_ || entry.offset_ >= mappedSize_)
+        return false;
+
+    // Walk the block headers. All blocks except the last must have the same unpacked size for the offsets to be usable
+    const unsigned char* data = mappedData_ + entry.offset_;
+    unsigned available = mappedSize_ - entry.offset_;
+    unsigned offset = 0;
+    unsigned unpackedTotal = 0;
+    blockSize = 0;
+
+    while (unpackedTotal < entry.size_)
+    {
+        if (offset + 4 > available)
+        {
+            offsets.Clear();
+            return false;
+        }
+
+        unsigned unpackedSize = (unsigned)data[offset] | ((unsigned)data[offset + 1] << 8);
+        unsigned packedSize = (unsigned)data[offset + 2] | ((unsigned)data[offset + 3] << 8);
+        if (!blockSize)
+            blockSize = unpackedSize;
+        if (!unpackedSize || (unpackedSize != blockSize && unpackedTotal + unpackedSize != entry.size_))
+        {
+            offsets.Clear();
+            return false;
+        }
+
+        offsets.Push(offset);
+        offset += 4 + packedSize;
+        unpackedTotal += unpackedSize;
+    }
+
+    if (unpackedTotal != entry.size_)
+    {
+        offsets.Clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool PackageFile::ReadFiles(const Vector<String>& fileNames, Vector<SharedArrayPtr<unsigned char> >& dest)
+{
+    URHO3D_PROFILE(ReadPackageFiles);
+
+    dest.Clear();
+    dest.Resize(fileNames.Size());
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    bool threaded = mappedData_ && compressed_ && queue && Thread::IsMainThread() && !queue->IsCompleting();
+    Vector<PODVector<unsigned> > blockOffsets(fileNames.Size());
+    PODVector<PackageBlockRange> ranges;
+    bool success = true;
+
+    for (unsigned i = 0; i < fileNames.Size(); ++i)
+    {
+        const PackageEntry* entry = GetEntry(fileNames[i]);
+        if (!entry)
+        {
+            URHO3D_LOGERROR("File " + fileNames[i] + " not found in package file " + fileName_);
+            success = false;
+            continue;
+        }
+
+        dest[i] = new unsigned char[entry->size_];
+        unsigned blockSize;
+
+        if (threaded && GetBlockOffsets(*entry, blockOffsets[i], blockSize))
+        {
+            // Split the blocks into work items; they are queued only after all ranges exist, as the vector may reallocate
+            for (unsigned j = 0; j < blockOffsets[i].Size(); j += BLOCKS_PER_WORK_ITEM)
+            {
+                PackageBlockRange range;
+                range.source_ = mappedData_ + entry->offset_;
+                range.available_ = mappedSize_ - entry->offset_;
+                range.offsets_ = &blockOffsets[i][0];
+                range.dest_ = dest[i].Get();
+                range.size_ = entry->size_;
+                range.blockSize_ = blockSize;
+                range.first_ = j;
+                range.last_ = (unsigned)Min((int)(j + BLOCKS_PER_WORK_ITEM), (int)blockOffsets[i].Size());
+                range.fileIndex_ = i;
+                range.success_ = false;
+                ranges.Push(range);
+            }
+        }
+        else if (mappedData_ && !compressed_)
+            memcpy(dest[i].Get(), mappedData_ + entry->offset_, entry->size_);
+        else
+        {
+            File file(context_, this, fileNames[i]);
+            if (file.Read(dest[i].Get(), entry->size_) != entry->size_)
+            {
+                URHO3D_LOGERROR("Could not read file " + fileNames[i] + " from package file " + fileName_);
+                dest[i].Reset();
+                success = false;
+            }
+        }
+    }
+
+    if (!ranges.Empty())
+    {
+        for (unsigned i = 0; i < ranges.Size(); ++i)
+        {
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = DecompressPackageBlocksWork;
+            item->start_ = &ranges[i];
+            item->end_ = &ranges[i] + 1;
+            queue->AddWorkItem(item);
+        }
+
+        queue->Complete(M_MAX_UNSIGNED);
+
+        for (unsigned i = 0; i < ranges.Size(); ++i)
+        {
+            unsigned fileIndex = ranges[i].fileIndex_;
+            if (!ranges[i].success_ && dest[fileIndex])
+            {
+                URHO3D_LOGERROR("Could not decompress file " + fileNames[fileIndex] + " from package file " + fileName_);
+                dest[fileIndex].Reset();
+                success = false;
+            }
+        }
+    }
+
+    return success;
+}
+
+bool PackageFile::MapFile(const String& fileName)
+{
+    if (!totalSize_)
+        return false;
+
+#if defined(__EMSCRIPTEN__)
+    return false;
+#else
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileW(GetWideNativePath(fileName).CString(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, 0);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+    // The view keeps the file and the mapping object referenced, so the handles can be closed right away
+    HANDLE mappingHandle = CreateFileMappingW(fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+    CloseHandle(fileHandle);
+    if (!mappingHandle)
+        return false;
+    void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mappingHandle);
+    if (!data)
+        return false;
+#else
+    int fd = open(GetNativePath(fileName).CString(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    void* data = mmap(0, totalSize_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+#endif
+
+    mappedData_ = (unsigned char*)data;
+    mappedSize_ = totalSize_;
+    return true;
+#endif
+}
+
+void PackageFile::UnmapFile()
+{
+    if (!mappedData_)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(mappedData_);
+#elif !defined(__EMSCRIPTEN__)
+    munmap(mappedData_, mappedSize_);
+#endif
+    mappedData_ = 0;
+    mappedSize_ = 0;
+}
+
 }
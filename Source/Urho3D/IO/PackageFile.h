@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/ArrayPtr.h"
 #include "../Core/Object.h"
 
 namespace Urho3D
@@ -36,6 +37,8 @@ struct PackageEntry
     unsigned size_;
     /// File checksum.
     unsigned checksum_;
+    /// Index of the first block offset in the package block index, or M_MAX_UNSIGNED if the package has no stored block index.
+    unsigned blockIndexStart_;
 };
 
 /// Stores files of a directory tree sequentially for convenient access.
@@ -57,6 +60,10 @@ public:
     bool Exists(const String& fileName) const;
     /// Return the file entry corresponding to the name, or null if not found. This will be case-insensitive on Windows and case-sensitive on other platforms.
     const PackageEntry* GetEntry(const String& fileName) const;
+    /// Return the offsets of an entry's compressed blocks relative to the entry start, and the unpacked size of the blocks. Uses the stored block index if the package has one, otherwise scans the block headers of a memory-mapped package. Return false if not available.
+    bool GetBlockOffsets(const PackageEntry& entry, PODVector<unsigned>& offsets, unsigned& blockSize) const;
+    /// Read the whole contents of several files. When the package is memory-mapped and compressed, the blocks are decompressed in parallel on the work queue threads if called from the main thread. Return true if all files were read successfully.
+    bool ReadFiles(const Vector<String>& fileNames, Vector<SharedArrayPtr<unsigned char> >& dest);
 
     /// Return all file entries.
     const HashMap<String, PackageEntry>& GetEntries() const { return entries_; }
@@ -79,10 +86,24 @@ public:
     /// Return whether the files are compressed.
     bool IsCompressed() const { return compressed_; }
 
+    /// Return whether the package has a stored block index for its compressed files.
+    bool HasBlockIndex() const { return blockSize_ != 0; }
+
+    /// Return whether the package file is memory-mapped.
+    bool IsMemoryMapped() const { return mappedData_ != 0; }
+
+    /// Return the memory-mapped package file data, or null if not mapped.
+    const unsigned char* GetMappedData() const { return mappedData_; }
+
     /// Return list of file names in the package.
     const Vector<String> GetEntryNames() const { return entries_.Keys(); }
 
 private:
+    /// Memory-map the package file for reading. Return true if successful.
+    bool MapFile(const String& fileName);
+    /// Release the memory mapping.
+    void UnmapFile();
+
     /// File entries.
     HashMap<String, PackageEntry> entries_;
     /// File name.
@@ -93,6 +114,14 @@ private:
     unsigned totalSize_;
     /// Package file checksum.
     unsigned checksum_;
+    /// Stored block index of the compressed files.
+    PODVector<unsigned> blockIndex_;
+    /// Unpacked size of the compressed blocks in the stored block index, 0 if no index.
+    unsigned blockSize_;
+    /// Memory-mapped package file data.
+    unsigned char* mappedData_;
+    /// Size of the memory mapping.
+    unsigned mappedSize_;
     /// Compressed flag.
     bool compressed_;
 };
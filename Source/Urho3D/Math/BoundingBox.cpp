@@ -154,6 +154,34 @@ BoundingBox BoundingBox::Transformed(const Matrix3x4& transform) const
     t2 = _mm_add_ps(_mm_unpacklo_ps(z, zero), _mm_unpackhi_ps(z, zero));
     __m128 newDir = _mm_add_ps(_mm_movelh_ps(t0, t2), _mm_movehl_ps(t2, t0));
     return BoundingBox(_mm_sub_ps(newCenter, newDir), _mm_add_ps(newCenter, newDir));
+#elif defined(URHO3D_NEON)
+    // The padding after min_ and max_ allows loading them as four floats
+    float32x4_t minPt = vsetq_lane_f32(1.0f, vld1q_f32(&min_.x_), 3);
+    float32x4_t maxPt = vsetq_lane_f32(1.0f, vld1q_f32(&max_.x_), 3);
+    float32x4_t centerPoint = vmulq_n_f32(vaddq_f32(minPt, maxPt), 0.5f);
+    float32x4_t halfSize = vsubq_f32(centerPoint, minPt);
+    float32x4_t m0 = vld1q_f32(&transform.m00_);
+    float32x4_t m1 = vld1q_f32(&transform.m10_);
+    float32x4_t m2 = vld1q_f32(&transform.m20_);
+    float32x4_t r0 = vmulq_f32(m0, centerPoint);
+    float32x4_t r1 = vmulq_f32(m1, centerPoint);
+    float32x4_t r2 = vmulq_f32(m2, centerPoint);
+    float32x2_t c01 = vpadd_f32(vadd_f32(vget_low_f32(r0), vget_high_f32(r0)), vadd_f32(vget_low_f32(r1), vget_high_f32(r1)));
+    float32x2_t c2 = vadd_f32(vget_low_f32(r2), vget_high_f32(r2));
+    c2 = vpadd_f32(c2, c2);
+    r0 = vabsq_f32(vmulq_f32(m0, halfSize));
+    r1 = vabsq_f32(vmulq_f32(m1, halfSize));
+    r2 = vabsq_f32(vmulq_f32(m2, halfSize));
+    float32x2_t e01 = vpadd_f32(vadd_f32(vget_low_f32(r0), vget_high_f32(r0)), vadd_f32(vget_low_f32(r1), vget_high_f32(r1)));
+    float32x2_t e2 = vadd_f32(vget_low_f32(r2), vget_high_f32(r2));
+    e2 = vpadd_f32(e2, e2);
+    float32x4_t newCenter = vcombine_f32(c01, c2);
+    float32x4_t newEdge = vcombine_f32(e01, e2);
+
+    BoundingBox ret;
+    vst1q_f32(&ret.min_.x_, vsubq_f32(newCenter, newEdge));
+    vst1q_f32(&ret.max_.x_, vaddq_f32(newCenter, newEdge));
+    return ret;
 #else
     Vector3 newCenter = transform * Center();
     Vector3 oldEdge = Size() * 0.5f;
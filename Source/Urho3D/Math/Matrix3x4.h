@@ -26,6 +26,8 @@
 
 #ifdef URHO3D_SSE
 #include <emmintrin.h>
+#elif defined(URHO3D_NEON)
+#include <arm_neon.h>
 #endif
 
 namespace Urho3D
@@ -313,6 +315,17 @@ public:
             _mm_cvtss_f32(vec),
             _mm_cvtss_f32(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(1, 1, 1, 1))),
             _mm_cvtss_f32(_mm_movehl_ps(vec, vec)));
+#elif defined(URHO3D_NEON)
+        const float data[4] = { rhs.x_, rhs.y_, rhs.z_, 1.0f };
+        float32x4_t vec = vld1q_f32(data);
+        float32x4_t r0 = vmulq_f32(vld1q_f32(&m00_), vec);
+        float32x4_t r1 = vmulq_f32(vld1q_f32(&m10_), vec);
+        float32x4_t r2 = vmulq_f32(vld1q_f32(&m20_), vec);
+        float32x2_t t01 = vpadd_f32(vadd_f32(vget_low_f32(r0), vget_high_f32(r0)), vadd_f32(vget_low_f32(r1), vget_high_f32(r1)));
+        float32x2_t t2 = vadd_f32(vget_low_f32(r2), vget_high_f32(r2));
+        t2 = vpadd_f32(t2, t2);
+
+        return Vector3(vget_lane_f32(t01, 0), vget_lane_f32(t01, 1), vget_lane_f32(t2, 0));
 #else
         return Vector3(
             (m00_ * rhs.x_ + m01_ * rhs.y_ + m02_ * rhs.z_ + m03_),
@@ -466,6 +479,34 @@ public:
         t3 = _mm_mul_ps(l, r3);
         _mm_storeu_ps(&out.m20_, _mm_add_ps(_mm_add_ps(t0, t1), _mm_add_ps(t2, t3)));
 
+        return out;
+#elif defined(URHO3D_NEON)
+        Matrix3x4 out;
+
+        static const float unitW[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        float32x4_t r0 = vld1q_f32(&rhs.m00_);
+        float32x4_t r1 = vld1q_f32(&rhs.m10_);
+        float32x4_t r2 = vld1q_f32(&rhs.m20_);
+        float32x4_t r3 = vld1q_f32(unitW);
+
+        float32x4_t l = vld1q_f32(&m00_);
+        float32x4_t t = vmulq_lane_f32(r0, vget_low_f32(l), 0);
+        t = vmlaq_lane_f32(t, r1, vget_low_f32(l), 1);
+        t = vmlaq_lane_f32(t, r2, vget_high_f32(l), 0);
+        vst1q_f32(&out.m00_, vmlaq_lane_f32(t, r3, vget_high_f32(l), 1));
+
+        l = vld1q_f32(&m10_);
+        t = vmulq_lane_f32(r0, vget_low_f32(l), 0);
+        t = vmlaq_lane_f32(t, r1, vget_low_f32(l), 1);
+        t = vmlaq_lane_f32(t, r2, vget_high_f32(l), 0);
+        vst1q_f32(&out.m10_, vmlaq_lane_f32(t, r3, vget_high_f32(l), 1));
+
+        l = vld1q_f32(&m20_);
+        t = vmulq_lane_f32(r0, vget_low_f32(l), 0);
+        t = vmlaq_lane_f32(t, r1, vget_low_f32(l), 1);
+        t = vmlaq_lane_f32(t, r2, vget_high_f32(l), 0);
+        vst1q_f32(&out.m20_, vmlaq_lane_f32(t, r3, vget_high_f32(l), 1));
+
         return out;
 #else
         return Matrix3x4(
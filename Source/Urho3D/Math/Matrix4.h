@@ -27,6 +27,8 @@
 
 #ifdef URHO3D_SSE
 #include <emmintrin.h>
+#elif defined(URHO3D_NEON)
+#include <arm_neon.h>
 #endif
 
 namespace Urho3D
@@ -306,6 +308,18 @@ public:
         Vector4 ret;
         _mm_storeu_ps(&ret.x_, vec);
         return ret;
+#elif defined(URHO3D_NEON)
+        float32x4_t vec = vld1q_f32(&rhs.x_);
+        float32x4_t r0 = vmulq_f32(vld1q_f32(&m00_), vec);
+        float32x4_t r1 = vmulq_f32(vld1q_f32(&m10_), vec);
+        float32x4_t r2 = vmulq_f32(vld1q_f32(&m20_), vec);
+        float32x4_t r3 = vmulq_f32(vld1q_f32(&m30_), vec);
+        float32x2_t t01 = vpadd_f32(vadd_f32(vget_low_f32(r0), vget_high_f32(r0)), vadd_f32(vget_low_f32(r1), vget_high_f32(r1)));
+        float32x2_t t23 = vpadd_f32(vadd_f32(vget_low_f32(r2), vget_high_f32(r2)), vadd_f32(vget_low_f32(r3), vget_high_f32(r3)));
+
+        Vector4 ret;
+        vst1q_f32(&ret.x_, vcombine_f32(t01, t23));
+        return ret;
 #else
         return Vector4(
             m00_ * rhs.x_ + m01_ * rhs.y_ + m02_ * rhs.z_ + m03_ * rhs.w_,
@@ -452,6 +466,39 @@ public:
         t3 = _mm_mul_ps(_mm_shuffle_ps(l, l, _MM_SHUFFLE(3, 3, 3, 3)), r3);
         _mm_storeu_ps(&out.m30_, _mm_add_ps(_mm_add_ps(t0, t1), _mm_add_ps(t2, t3)));
 
+        return out;
+#elif defined(URHO3D_NEON)
+        Matrix4 out;
+
+        float32x4_t r0 = vld1q_f32(&rhs.m00_);
+        float32x4_t r1 = vld1q_f32(&rhs.m10_);
+        float32x4_t r2 = vld1q_f32(&rhs.m20_);
+        float32x4_t r3 = vld1q_f32(&rhs.m30_);
+
+        float32x4_t l = vld1q_f32(&m00_);
+        float32x4_t t = vmulq_lane_f32(r0, vget_low_f32(l), 0);
+        t = vmlaq_lane_f32(t, r1, vget_low_f32(l), 1);
+        t = vmlaq_lane_f32(t, r2, vget_high_f32(l), 0);
+        vst1q_f32(&out.m00_, vmlaq_lane_f32(t, r3, vget_high_f32(l), 1));
+
+        l = vld1q_f32(&m10_);
+        t = vmulq_lane_f32(r0, vget_low_f32(l), 0);
+        t = vmlaq_lane_f32(t, r1, vget_low_f32(l), 1);
+        t = vmlaq_lane_f32(t, r2, vget_high_f32(l), 0);
+        vst1q_f32(&out.m10_, vmlaq_lane_f32(t, r3, vget_high_f32(l), 1));
+
+        l = vld1q_f32(&m20_);
+        t = vmulq_lane_f32(r0, vget_low_f32(l), 0);
+        t = vmlaq_lane_f32(t, r1, vget_low_f32(l), 1);
+        t = vmlaq_lane_f32(t, r2, vget_high_f32(l), 0);
+        vst1q_f32(&out.m20_, vmlaq_lane_f32(t, r3, vget_high_f32(l), 1));
+
+        l = vld1q_f32(&m30_);
+        t = vmulq_lane_f32(r0, vget_low_f32(l), 0);
+        t = vmlaq_lane_f32(t, r1, vget_low_f32(l), 1);
+        t = vmlaq_lane_f32(t, r2, vget_high_f32(l), 0);
+        vst1q_f32(&out.m30_, vmlaq_lane_f32(t, r3, vget_high_f32(l), 1));
+
         return out;
 #else
         return Matrix4(
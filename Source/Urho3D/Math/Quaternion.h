@@ -26,6 +26,8 @@
 
 #ifdef URHO3D_SSE
 #include <emmintrin.h>
+#elif defined(URHO3D_NEON)
+#include <arm_neon.h>
 #endif
 
 namespace Urho3D
@@ -247,6 +249,24 @@ public:
         out = _mm_add_ps(_mm_mul_ps(_mm_xor_ps(signz, _mm_shuffle_ps(q1, q1, _MM_SHUFFLE(3, 3, 3, 3))), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(2, 3, 0, 1))), out);
         out = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(q1, q1, _MM_SHUFFLE(0, 0, 0, 0)), q2), out);
         return Quaternion(_mm_shuffle_ps(out, out, _MM_SHUFFLE(2, 1, 0, 3)));
+#elif defined(URHO3D_NEON)
+        static const float signx[4] = { -1.0f, 1.0f, -1.0f, 1.0f };
+        static const float signy[4] = { -1.0f, 1.0f, 1.0f, -1.0f };
+        static const float signz[4] = { -1.0f, -1.0f, 1.0f, 1.0f };
+        float32x4_t q1 = vld1q_f32(&w_);
+        float32x4_t q2 = vld1q_f32(&rhs.w_);
+        // Permute rhs to (x, w, z, y), (y, z, w, x) and (z, y, x, w) for the lhs x, y and z terms
+        float32x4_t q2x = vrev64q_f32(q2);
+        float32x4_t q2y = vcombine_f32(vget_high_f32(q2), vget_low_f32(q2));
+        float32x4_t q2z = vrev64q_f32(q2y);
+        float32x4_t out = vmulq_lane_f32(q2, vget_low_f32(q1), 0);
+        out = vmlaq_lane_f32(out, vmulq_f32(q2x, vld1q_f32(signx)), vget_low_f32(q1), 1);
+        out = vmlaq_lane_f32(out, vmulq_f32(q2y, vld1q_f32(signy)), vget_high_f32(q1), 0);
+        out = vmlaq_lane_f32(out, vmulq_f32(q2z, vld1q_f32(signz)), vget_high_f32(q1), 1);
+
+        Quaternion ret;
+        vst1q_f32(&ret.w_, out);
+        return ret;
 #else
         return Quaternion(
             w_ * rhs.w_ - x_ * rhs.x_ - y_ * rhs.y_ - z_ * rhs.z_,
@@ -382,6 +402,11 @@ public:
         n = _mm_add_ps(n, _mm_shuffle_ps(n, n, _MM_SHUFFLE(2, 3, 0, 1)));
         n = _mm_add_ps(n, _mm_shuffle_ps(n, n, _MM_SHUFFLE(0, 1, 2, 3)));
         return _mm_cvtss_f32(n);
+#elif defined(URHO3D_NEON)
+        float32x4_t q = vld1q_f32(&w_);
+        float32x4_t n = vmulq_f32(q, q);
+        float32x2_t t = vadd_f32(vget_low_f32(n), vget_high_f32(n));
+        return vget_lane_f32(vpadd_f32(t, t), 0);
 #else
         return w_ * w_ + x_ * x_ + y_ * y_ + z_ * z_;
 #endif
@@ -397,6 +422,10 @@ public:
         n = _mm_add_ps(n, _mm_shuffle_ps(n, n, _MM_SHUFFLE(2, 3, 0, 1)));
         n = _mm_add_ps(n, _mm_shuffle_ps(n, n, _MM_SHUFFLE(0, 1, 2, 3)));
         return _mm_cvtss_f32(n);
+#elif defined(URHO3D_NEON)
+        float32x4_t n = vmulq_f32(vld1q_f32(&w_), vld1q_f32(&rhs.w_));
+        float32x2_t t = vadd_f32(vget_low_f32(n), vget_high_f32(n));
+        return vget_lane_f32(vpadd_f32(t, t), 0);
 #else
         return w_ * rhs.w_ + x_ * rhs.x_ + y_ * rhs.y_ + z_ * rhs.z_;
 #endif
@@ -73,6 +73,16 @@ void OffMeshConnection::OnSetAttribute(const AttributeInfo& attr, const Variant&
         endPointDirty_ = true;
 }
 
+bool OffMeshConnection::OnLoadAttribute(const AttributeInfo& attr, Deserializer& source)
+{
+    if (!LoadAttributeDirect(attr, source))
+        return false;
+
+    if (attr.offset_ == offsetof(OffMeshConnection, endPointID_))
+        endPointDirty_ = true;
+    return true;
+}
+
 void OffMeshConnection::ApplyAttributes()
 {
     if (endPointDirty_)
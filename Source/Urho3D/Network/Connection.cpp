@@ -29,6 +29,7 @@
 #include "../IO/MemoryBuffer.h"
 #include "../IO/PackageFile.h"
 #include "../Network/Connection.h"
+#include "../Network/InterestManager.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkEvents.h"
 #include "../Network/NetworkPriority.h"
@@ -64,11 +65,14 @@ Connection::Connection(Context* context, bool isClient, kNet::SharedPtr<kNet::Me
     Object(context),
     timeStamp_(0),
     connection_(connection),
+    deferredInterestManager_(0),
     sendMode_(OPSM_NONE),
     isClient_(isClient),
     connectPending_(false),
     sceneLoaded_(false),
-    logStatistics_(false)
+    logStatistics_(false),
+    deferServerUpdate_(false),
+    deferredInterestManagerChanged_(false)
 {
     sceneState_.connection_ = this;
 
@@ -107,6 +111,19 @@ void Connection::SendMessage(int msgID, bool reliable, bool inOrder, const unsig
         return;
     }
 
+    // When building the server update on a worker thread, store the message to be sent later from the main thread
+    if (deferServerUpdate_)
+    {
+        deferredMessages_.WriteInt(msgID);
+        deferredMessages_.WriteBool(reliable);
+        deferredMessages_.WriteBool(inOrder);
+        deferredMessages_.WriteUInt(contentID);
+        deferredMessages_.WriteVLE(numBytes);
+        if (numBytes)
+            deferredMessages_.Write(data, numBytes);
+        return;
+    }
+
     kNet::NetworkMessage* msg = connection_->StartNewMessage((unsigned long)msgID, numBytes);
     if (!msg)
     {
@@ -178,6 +195,7 @@ void Connection::SetScene(Scene* newScene)
     if (isClient_)
     {
         sceneState_.Clear();
+        relevantNodes_.Clear();
 
         // When scene is assigned on the server, instruct the client to load it. This may require downloading packages
         const Vector<SharedPtr<PackageFile> >& packages = scene_->GetRequiredPackageFiles();
@@ -246,14 +264,118 @@ void Connection::SendServerUpdate()
     if (!scene_ || !sceneLoaded_)
         return;
 
+    ProcessServerUpdate();
+}
+
+void Connection::BuildServerUpdate()
+{
+    if (!scene_ || !sceneLoaded_)
+        return;
+
+    deferServerUpdate_ = true;
+    ProcessServerUpdate();
+    deferServerUpdate_ = false;
+}
+
+void Connection::SendDeferredServerUpdate()
+{
+    // Apply the replication state changes first, as they refer to states that may be erased below
+    for (PODVector<ReplicationStateChange>::ConstIterator i = deferredStateChanges_.Begin(); i != deferredStateChanges_.End(); ++i)
+    {
+        if (i->node_)
+        {
+            NodeReplicationState* nodeState = static_cast<NodeReplicationState*>(i->state_);
+            if (i->add_)
+            {
+                nodeState->node_ = i->node_;
+                i->node_->AddReplicationState(nodeState);
+            }
+            else
+                i->node_->RemoveReplicationState(nodeState);
+        }
+        else
+        {
+            ComponentReplicationState* componentState = static_cast<ComponentReplicationState*>(i->state_);
+            if (i->add_)
+            {
+                componentState->component_ = i->component_;
+                i->component_->AddReplicationState(componentState);
+            }
+            else
+                i->component_->RemoveReplicationState(componentState);
+        }
+    }
+
+    for (PODVector<Pair<unsigned, unsigned> >::ConstIterator i = deferredComponentRemovals_.Begin();
+         i != deferredComponentRemovals_.End(); ++i)
+    {
+        HashMap<unsigned, NodeReplicationState>::Iterator j = sceneState_.nodeStates_.Find(i->first_);
+        if (j != sceneState_.nodeStates_.End())
+            j->second_.componentStates_.Erase(i->second_);
+    }
+
+    for (PODVector<unsigned>::ConstIterator i = deferredNodeRemovals_.Begin(); i != deferredNodeRemovals_.End(); ++i)
+        sceneState_.nodeStates_.Erase(*i);
+
+    if (deferredInterestManagerChanged_)
+        interestManager_ = deferredInterestManager_;
+
+    deferredStateChanges_.Clear();
+    deferredComponentRemovals_.Clear();
+    deferredNodeRemovals_.Clear();
+    deferredInterestManager_ = 0;
+    deferredInterestManagerChanged_ = false;
+
+    // Then send the messages in the order they were built
+    MemoryBuffer messages(deferredMessages_.GetData(), deferredMessages_.GetSize());
+    while (!messages.IsEof())
+    {
+        int msgID = messages.ReadInt();
+        bool reliable = messages.ReadBool();
+        bool inOrder = messages.ReadBool();
+        unsigned contentID = messages.ReadUInt();
+        unsigned numBytes = messages.ReadVLE();
+        SendMessage(msgID, reliable, inOrder, messages.GetData() + messages.GetPosition(), numBytes, contentID);
+        messages.Seek(messages.GetPosition() + numBytes);
+    }
+
+    deferredMessages_.Clear();
+}
+
+void Connection::ProcessServerUpdate()
+{
     // Always check the root node (scene) first so that the scene-wide components get sent first,
     // and all other replicated nodes get added to the dirty set for sending the initial state
     unsigned sceneID = scene_->GetID();
     nodesToProcess_.Insert(sceneID);
     ProcessNode(sceneID);
 
-    // Then go through all dirtied nodes
-    nodesToProcess_.Insert(sceneState_.dirtyNodes_);
+    Network* network = GetSubsystem<Network>();
+    InterestManager* interestManager = network ? network->GetInterestManager() : 0;
+    if (interestManager)
+        UpdateRelevantNodes(interestManager);
+    else
+    {
+        // If interest management was in use, the client is missing the nodes that were outside its interest
+        if (interestManager_)
+        {
+            PODVector<Node*> nodes;
+            scene_->GetChildren(nodes, true);
+            for (PODVector<Node*>::ConstIterator i = nodes.Begin(); i != nodes.End(); ++i)
+            {
+                unsigned nodeID = (*i)->GetID();
+                if (nodeID < FIRST_LOCAL_ID && !sceneState_.nodeStates_.Contains(nodeID))
+                    sceneState_.dirtyNodes_.Insert(nodeID);
+            }
+
+            SetUsedInterestManager(0);
+            relevantNodes_.Clear();
+        }
+
+        // Then go through all dirtied nodes
+        nodesToProcess_.Insert(sceneState_.dirtyNodes_);
+    }
+
     nodesToProcess_.Erase(sceneID); // Do not process the root node twice
 
     while (nodesToProcess_.Size())
@@ -1101,6 +1223,156 @@ void Connection::HandleAsyncLoadFinished(StringHash eventType, VariantMap& event
     SendMessage(MSG_SCENELOADED, true, true, msg_);
 }
 
+void Connection::UpdateRelevantNodes(InterestManager* interestManager)
+{
+    URHO3D_PROFILE(UpdateRelevantNodes);
+
+    unsigned sceneID = scene_->GetID();
+
+    // When the interest manager changes, the nodes known by the client form the previous relevant set
+    if (interestManager != interestManager_)
+    {
+        SetUsedInterestManager(interestManager);
+        relevantNodes_.Clear();
+        for (HashMap<unsigned, NodeReplicationState>::ConstIterator i = sceneState_.nodeStates_.Begin();
+             i != sceneState_.nodeStates_.End(); ++i)
+            relevantNodes_.Insert(i->first_);
+        relevantNodes_.Erase(sceneID);
+    }
+
+    newRelevantNodes_.Clear();
+    interestManager->GetRelevantNodes(this, newRelevantNodes_);
+    newRelevantNodes_.Erase(sceneID);
+
+    // Remove nodes that left the interest
+    for (HashSet<unsigned>::ConstIterator i = relevantNodes_.Begin(); i != relevantNodes_.End(); ++i)
+    {
+        if (!newRelevantNodes_.Contains(*i))
+            RemoveIrrelevantNode(*i);
+    }
+
+    // Entering nodes are created on the client with their full state. They are also marked dirty so that dependency
+    // ordering works for them
+    for (HashSet<unsigned>::ConstIterator i = newRelevantNodes_.Begin(); i != newRelevantNodes_.End(); ++i)
+    {
+        if (!relevantNodes_.Contains(*i))
+        {
+            sceneState_.dirtyNodes_.Insert(*i);
+            nodesToProcess_.Insert(*i);
+        }
+    }
+
+    // Process the dirty relevant nodes. Irrelevant dirty nodes are dropped without serializing anything; they will be
+    // sent in full if they enter the interest
+    for (HashSet<unsigned>::Iterator i = sceneState_.dirtyNodes_.Begin(); i != sceneState_.dirtyNodes_.End();)
+    {
+        unsigned nodeID = *i;
+        if (nodeID == sceneID || newRelevantNodes_.Contains(nodeID))
+        {
+            nodesToProcess_.Insert(nodeID);
+            ++i;
+        }
+        else if (sceneState_.nodeStates_.Contains(nodeID))
+        {
+            // A node known by the client, which was not relevant even before: either removed from the scene, or the
+            // interest manager was just taken into use
+            ++i;
+            RemoveIrrelevantNode(nodeID);
+        }
+        else
+            i = sceneState_.dirtyNodes_.Erase(i);
+    }
+
+    relevantNodes_.Swap(newRelevantNodes_);
+}
+
+void Connection::ChangeReplicationState(Node* node, Component* component, ReplicationState* state, bool add)
+{
+    // Attaching and detaching modify the scene objects and their reference counts, which is not safe from several
+    // connections' worker threads at once
+    if (deferServerUpdate_)
+    {
+        ReplicationStateChange change;
+        change.node_ = node;
+        change.component_ = component;
+        change.state_ = state;
+        change.add_ = add;
+        deferredStateChanges_.Push(change);
+        return;
+    }
+
+    if (node)
+    {
+        NodeReplicationState* nodeState = static_cast<NodeReplicationState*>(state);
+        if (add)
+        {
+            nodeState->node_ = node;
+            node->AddReplicationState(nodeState);
+        }
+        else
+            node->RemoveReplicationState(nodeState);
+    }
+    else
+    {
+        ComponentReplicationState* componentState = static_cast<ComponentReplicationState*>(state);
+        if (add)
+        {
+            componentState->component_ = component;
+            component->AddReplicationState(componentState);
+        }
+        else
+            component->RemoveReplicationState(componentState);
+    }
+}
+
+void Connection::RemoveNodeState(unsigned nodeID)
+{
+    // The state may still have a deferred detach pending, so erase it only after the changes have been applied
+    if (deferServerUpdate_)
+        deferredNodeRemovals_.Push(nodeID);
+    else
+        sceneState_.nodeStates_.Erase(nodeID);
+}
+
+void Connection::SetUsedInterestManager(InterestManager* interestManager)
+{
+    if (deferServerUpdate_)
+    {
+        deferredInterestManager_ = interestManager;
+        deferredInterestManagerChanged_ = true;
+    }
+    else
+        interestManager_ = interestManager;
+}
+
+void Connection::RemoveIrrelevantNode(unsigned nodeID)
+{
+    HashMap<unsigned, NodeReplicationState>::Iterator i = sceneState_.nodeStates_.Find(nodeID);
+    if (i != sceneState_.nodeStates_.End())
+    {
+        NodeReplicationState& nodeState = i->second_;
+        Node* node = nodeState.node_;
+        if (node)
+        {
+            ChangeReplicationState(node, 0, &nodeState, false);
+            for (HashMap<unsigned, ComponentReplicationState>::Iterator j = nodeState.componentStates_.Begin();
+                 j != nodeState.componentStates_.End(); ++j)
+            {
+                Component* component = j->second_.component_;
+                if (component)
+                    ChangeReplicationState(0, component, &j->second_, false);
+            }
+        }
+
+        msg_.Clear();
+        msg_.WriteNetID(nodeID);
+        SendMessage(MSG_REMOVENODE, true, true, msg_);
+        RemoveNodeState(nodeID);
+    }
+
+    sceneState_.dirtyNodes_.Erase(nodeID);
+}
+
 void Connection::ProcessNode(unsigned nodeID)
 {
     // Check that we have not already processed this due to dependency recursion
@@ -1122,7 +1394,7 @@ void Connection::ProcessNode(unsigned nodeID)
             // would be enough. However, this may be better due to the client not possibly having updated parenting
             // information at the time of receiving this message
             SendMessage(MSG_REMOVENODE, true, true, msg_);
-            sceneState_.nodeStates_.Erase(nodeID);
+            RemoveNodeState(nodeID);
         }
         else
             ProcessExistingNode(node, i->second_);
@@ -1158,8 +1430,7 @@ void Connection::ProcessNewNode(Node* node)
     NodeReplicationState& nodeState = sceneState_.nodeStates_[node->GetID()];
     nodeState.connection_ = this;
     nodeState.sceneState_ = &sceneState_;
-    nodeState.node_ = node;
-    node->AddReplicationState(&nodeState);
+    ChangeReplicationState(node, 0, &nodeState, true);
 
     // Write node's attributes
     node->WriteInitialDeltaUpdate(msg_, timeStamp_);
@@ -1186,8 +1457,7 @@ void Connection::ProcessNewNode(Node* node)
         ComponentReplicationState& componentState = nodeState.componentStates_[component->GetID()];
         componentState.connection_ = this;
         componentState.nodeState_ = &nodeState;
-        componentState.component_ = component;
-        component->AddReplicationState(&componentState);
+        ChangeReplicationState(0, component, &componentState, true);
 
         msg_.WriteStringHash(component->GetType());
         msg_.WriteNetID(component->GetID());
@@ -1214,7 +1484,9 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     // Check from the interest management component, if exists, whether should update
     /// \todo Searching for the component is a potential CPU hotspot. It should be cached
     NetworkPriority* priority = node->GetComponent<NetworkPriority>();
-    if (priority && (!priority->GetAlwaysUpdateOwner() || node->GetOwner() != this))
+    // A dirty world transform would be updated by the check, which is not safe on a worker thread, so the node is then
+    // always updated
+    if (priority && (!priority->GetAlwaysUpdateOwner() || node->GetOwner() != this) && !(deferServerUpdate_ && node->IsDirty()))
     {
         float distance = (node->GetWorldPosition() - position_).Length();
         if (!priority->CheckUpdate(distance, nodeState.priorityAcc_))
@@ -1282,6 +1554,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     }
 
     // Check for removed or changed components
+    unsigned numRemovedComponents = 0;
     for (HashMap<unsigned, ComponentReplicationState>::Iterator i = nodeState.componentStates_.Begin();
          i != nodeState.componentStates_.End();)
     {
@@ -1295,7 +1568,13 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             msg_.WriteNetID(current->first_);
 
             SendMessage(MSG_REMOVECOMPONENT, true, true, msg_);
-            nodeState.componentStates_.Erase(current);
+            if (!deferServerUpdate_)
+                nodeState.componentStates_.Erase(current);
+            else
+            {
+                deferredComponentRemovals_.Push(MakePair(node->GetID(), current->first_));
+                ++numRemovedComponents;
+            }
         }
         else
         {
@@ -1341,7 +1620,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     }
 
     // Check for new components
-    if (nodeState.componentStates_.Size() != node->GetNumNetworkComponents())
+    if (nodeState.componentStates_.Size() - numRemovedComponents != node->GetNumNetworkComponents())
     {
         const Vector<SharedPtr<Component> >& components = node->GetComponents();
         for (unsigned i = 0; i < components.Size(); ++i)
@@ -1358,8 +1637,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 ComponentReplicationState& componentState = nodeState.componentStates_[component->GetID()];
                 componentState.connection_ = this;
                 componentState.nodeState_ = &nodeState;
-                componentState.component_ = component;
-                component->AddReplicationState(&componentState);
+                ChangeReplicationState(0, component, &componentState, true);
 
                 msg_.Clear();
                 msg_.WriteNetID(node->GetID());
@@ -39,7 +39,9 @@
 namespace Urho3D
 {
 
+class Component;
 class File;
+class InterestManager;
 class MemoryBuffer;
 class Node;
 class Scene;
@@ -59,6 +61,19 @@ struct RemoteEvent
     bool inOrder_;
 };
 
+/// Replication state attach or detach deferred from a parallel server update build.
+struct ReplicationStateChange
+{
+    /// Node, or null for a component state.
+    Node* node_;
+    /// Component, or null for a node state.
+    Component* component_;
+    /// Replication state.
+    ReplicationState* state_;
+    /// Attach flag. False to detach.
+    bool add_;
+};
+
 /// Package file receive transfer.
 struct PackageDownload
 {
@@ -138,6 +153,10 @@ public:
     void Disconnect(int waitMSec = 0);
     /// Send scene update messages. Called by Network.
     void SendServerUpdate();
+    /// Build scene update messages without sending them or touching the scene objects' replication states. Safe to call for several connections in parallel on worker threads. Called by Network.
+    void BuildServerUpdate();
+    /// Send the scene update messages built by BuildServerUpdate() and apply the deferred replication state changes. Called by Network.
+    void SendDeferredServerUpdate();
     /// Send latest controls from the client. Called by Network.
     void SendClientUpdate();
     /// Send queued remote events. Called by Network.
@@ -182,6 +201,9 @@ public:
     /// Return whether the scene is loaded and ready to receive server updates.
     bool IsSceneLoaded() const { return sceneLoaded_; }
 
+    /// Return whether a node was relevant to this connection on the last interest management update.
+    bool IsNodeRelevant(unsigned nodeID) const { return relevantNodes_.Contains(nodeID); }
+
     /// Return whether to log data in/out statistics.
     bool GetLogStatistics() const { return logStatistics_; }
 
@@ -249,6 +271,18 @@ private:
     void ProcessSceneLoaded(int msgID, MemoryBuffer& msg);
     /// Process a remote event message from the client or server. Called by Network.
     void ProcessRemoteEvent(int msgID, MemoryBuffer& msg);
+    /// Process the scene for sending a network update, either directly or deferred.
+    void ProcessServerUpdate();
+    /// Attach or detach a node or component replication state, or defer it if building the update on a worker thread.
+    void ChangeReplicationState(Node* node, Component* component, ReplicationState* state, bool add);
+    /// Stop tracking a node's replication state, or defer it if building the update on a worker thread.
+    void RemoveNodeState(unsigned nodeID);
+    /// Remember the interest manager used on the update, or defer it if building the update on a worker thread.
+    void SetUsedInterestManager(InterestManager* interestManager);
+    /// Query relevant nodes from the interest manager, remove nodes that left the interest from the client and queue dirty or entering relevant nodes for processing.
+    void UpdateRelevantNodes(InterestManager* interestManager);
+    /// Remove a node that is no longer relevant from the client and stop tracking its replication state.
+    void RemoveIrrelevantNode(unsigned nodeID);
     /// Process a node for sending a network update. Recurses to process depended on node(s) first.
     void ProcessNode(unsigned nodeID);
     /// Process a node that the client has not yet received.
@@ -286,8 +320,24 @@ private:
     HashMap<unsigned, PODVector<unsigned char> > componentLatestData_;
     /// Node ID's to process during a replication update.
     HashSet<unsigned> nodesToProcess_;
+    /// Node ID's relevant to the connection on the last interest management update.
+    HashSet<unsigned> relevantNodes_;
+    /// Node ID's relevant to the connection on the current interest management update.
+    HashSet<unsigned> newRelevantNodes_;
+    /// Interest manager used on the last server update.
+    WeakPtr<InterestManager> interestManager_;
     /// Reusable message buffer.
     VectorBuffer msg_;
+    /// Scene update messages built on a worker thread, waiting to be sent.
+    VectorBuffer deferredMessages_;
+    /// Replication state changes waiting to be applied after a parallel update build.
+    PODVector<ReplicationStateChange> deferredStateChanges_;
+    /// Node ID's whose replication state to erase after a parallel update build.
+    PODVector<unsigned> deferredNodeRemovals_;
+    /// Node and component ID's of component replication states to erase after a parallel update build.
+    PODVector<Pair<unsigned, unsigned> > deferredComponentRemovals_;
+    /// Interest manager to remember after a parallel update build.
+    InterestManager* deferredInterestManager_;
     /// Queued remote events.
     Vector<RemoteEvent> remoteEvents_;
     /// Scene file to load once all packages (if any) have been downloaded.
@@ -312,6 +362,10 @@ private:
     bool sceneLoaded_;
     /// Show statistics flag.
     bool logStatistics_;
+    /// Defer sending messages and replication state changes while building the server update flag.
+    bool deferServerUpdate_;
+    /// Interest manager changed during a parallel update build flag.
+    bool deferredInterestManagerChanged_;
 };
 
 }
@@ -0,0 +1,195 @@
+//
+// Copyright (c) 2008-2015 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Profiler.h"
+#include "../Network/Connection.h"
+#include "../Network/GridInterestManager.h"
+#include "../Network/NetworkPriority.h"
+#include "../Scene/Scene.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const float DEFAULT_CELL_SIZE = 50.0f;
+static const float DEFAULT_INTEREST_DISTANCE = 250.0f;
+static const float DEFAULT_LEAVE_MARGIN = 25.0f;
+
+GridInterestManager::GridInterestManager(Context* context) :
+    InterestManager(context),
+    cellSize_(DEFAULT_CELL_SIZE),
+    interestDistance_(DEFAULT_INTEREST_DISTANCE),
+    leaveMargin_(DEFAULT_LEAVE_MARGIN)
+{
+}
+
+GridInterestManager::~GridInterestManager()
+{
+}
+
+void GridInterestManager::Update(const HashSet<Scene*>& scenes)
+{
+    URHO3D_PROFILE(UpdateInterestGrid);
+
+    // Forget scenes that are no longer networked
+    for (HashMap<Scene*, InterestGrid>::Iterator i = grids_.Begin(); i != grids_.End();)
+    {
+        if (!scenes.Contains(i->first_))
+            i = grids_.Erase(i);
+        else
+            ++i;
+    }
+
+    float invCellSize = 1.0f / cellSize_;
+
+    for (HashSet<Scene*>::ConstIterator i = scenes.Begin(); i != scenes.End(); ++i)
+    {
+        Scene* scene = *i;
+        InterestGrid& grid = grids_[scene];
+
+        // Clear instead of erasing the cells to reuse their memory
+        for (HashMap<unsigned, PODVector<InterestGridNode> >::Iterator j = grid.cells_.Begin(); j != grid.cells_.End(); ++j)
+            j->second_.Clear();
+        grid.alwaysRelevantNodes_.Clear();
+        grid.ownedNodes_.Clear();
+
+        // Only the top-level nodes are stored, their children follow them in relevance
+        const Vector<SharedPtr<Node> >& children = scene->GetChildren();
+        for (Vector<SharedPtr<Node> >::ConstIterator j = children.Begin(); j != children.End(); ++j)
+        {
+            Node* node = *j;
+            NetworkPriority* priority = node->GetComponent<NetworkPriority>();
+            if (priority && priority->GetAlwaysRelevant())
+            {
+                grid.alwaysRelevantNodes_.Push(node);
+                continue;
+            }
+
+            if (node->GetOwner())
+                grid.ownedNodes_.Push(node);
+
+            InterestGridNode gridNode;
+            gridNode.node_ = node;
+            gridNode.position_ = node->GetWorldPosition();
+            int x = (int)floorf(gridNode.position_.x_ * invCellSize);
+            int z = (int)floorf(gridNode.position_.z_ * invCellSize);
+            grid.cells_[GetCellKey(x, z)].Push(gridNode);
+        }
+    }
+}
+
+void GridInterestManager::GetRelevantNodes(Connection* connection, HashSet<unsigned>& dest)
+{
+    HashMap<Scene*, InterestGrid>::ConstIterator i = grids_.Find(connection->GetScene());
+    if (i == grids_.End())
+        return;
+
+    const InterestGrid& grid = i->second_;
+    const Vector3& observer = connection->GetPosition();
+    float leaveDistance = interestDistance_ + leaveMargin_;
+    float enterDistanceSquared = interestDistance_ * interestDistance_;
+    float leaveDistanceSquared = leaveDistance * leaveDistance;
+    float invCellSize = 1.0f / cellSize_;
+
+    int minX = (int)floorf((observer.x_ - leaveDistance) * invCellSize);
+    int maxX = (int)floorf((observer.x_ + leaveDistance) * invCellSize);
+    int minZ = (int)floorf((observer.z_ - leaveDistance) * invCellSize);
+    int maxZ = (int)floorf((observer.z_ + leaveDistance) * invCellSize);
+    float numCoveredCells = (float)(maxX - minX + 1) * (float)(maxZ - minZ + 1);
+
+    // Visit the cells covered by the leave distance, or all cells if there are fewer of them. A node that was relevant
+    // stays so until it is beyond the leave distance
+    if (numCoveredCells <= (float)grid.cells_.Size())
+    {
+        for (int z = minZ; z <= maxZ; ++z)
+        {
+            for (int x = minX; x <= maxX; ++x)
+            {
+                HashMap<unsigned, PODVector<InterestGridNode> >::ConstIterator j = grid.cells_.Find(GetCellKey(x, z));
+                if (j == grid.cells_.End())
+                    continue;
+
+                AddRelevantNodes(j->second_, connection, enterDistanceSquared, leaveDistanceSquared, dest);
+            }
+        }
+    }
+    else
+    {
+        for (HashMap<unsigned, PODVector<InterestGridNode> >::ConstIterator j = grid.cells_.Begin(); j != grid.cells_.End(); ++j)
+            AddRelevantNodes(j->second_, connection, enterDistanceSquared, leaveDistanceSquared, dest);
+    }
+
+    for (PODVector<Node*>::ConstIterator j = grid.ownedNodes_.Begin(); j != grid.ownedNodes_.End(); ++j)
+    {
+        if ((*j)->GetOwner() == connection)
+            AddRelevantNode(*j, dest);
+    }
+
+    for (PODVector<Node*>::ConstIterator j = grid.alwaysRelevantNodes_.Begin(); j != grid.alwaysRelevantNodes_.End(); ++j)
+        AddRelevantNode(*j, dest);
+}
+
+void GridInterestManager::SetCellSize(float size)
+{
+    cellSize_ = Max(size, M_EPSILON);
+}
+
+void GridInterestManager::SetInterestDistance(float distance)
+{
+    interestDistance_ = Max(distance, 0.0f);
+}
+
+void GridInterestManager::SetLeaveMargin(float margin)
+{
+    leaveMargin_ = Max(margin, 0.0f);
+}
+
+void GridInterestManager::AddRelevantNodes(const PODVector<InterestGridNode>& nodes, Connection* connection,
+    float enterDistanceSquared, float leaveDistanceSquared, HashSet<unsigned>& dest) const
+{
+    const Vector3& observer = connection->GetPosition();
+
+    for (PODVector<InterestGridNode>::ConstIterator i = nodes.Begin(); i != nodes.End(); ++i)
+    {
+        float distanceSquared = (i->position_ - observer).LengthSquared();
+        if (distanceSquared <= enterDistanceSquared || (distanceSquared <= leaveDistanceSquared &&
+            connection->IsNodeRelevant(i->node_->GetID())))
+            AddRelevantNode(i->node_, dest);
+    }
+}
+
+void GridInterestManager::AddRelevantNode(Node* node, HashSet<unsigned>& dest) const
+{
+    // Local nodes are not replicated, but may have replicated children
+    if (node->GetID() < FIRST_LOCAL_ID)
+        dest.Insert(node->GetID());
+
+    const Vector<SharedPtr<Node> >& children = node->GetChildren();
+    for (Vector<SharedPtr<Node> >::ConstIterator i = children.Begin(); i != children.End(); ++i)
+        AddRelevantNode(*i, dest);
+}
+
+}
@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2008-2015 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Math/Vector3.h"
+#include "../Network/InterestManager.h"
+
+namespace Urho3D
+{
+
+class Node;
+
+/// Replicated node stored in an interest management grid cell.
+struct InterestGridNode
+{
+    /// Node.
+    Node* node_;
+    /// World position at the time of the grid update.
+    Vector3 position_;
+};
+
+/// Interest management grid of one scene.
+struct InterestGrid
+{
+    /// Nodes by grid cell.
+    HashMap<unsigned, PODVector<InterestGridNode> > cells_;
+    /// Nodes that are relevant to all connections.
+    PODVector<Node*> alwaysRelevantNodes_;
+    /// Nodes that are relevant to their owner connection regardless of distance.
+    PODVector<Node*> ownedNodes_;
+};
+
+/// %Network interest management using a uniform grid on the XZ plane. A top-level replicated node and its replicated children are relevant to a connection when the node is within the interest distance of the connection's observer position, when the connection owns the node, or when the node's NetworkPriority component has it set always relevant.
+class URHO3D_API GridInterestManager : public InterestManager
+{
+    URHO3D_OBJECT(GridInterestManager, InterestManager);
+
+public:
+    /// Construct.
+    GridInterestManager(Context* context);
+    /// Destruct.
+    virtual ~GridInterestManager();
+
+    /// Rebuild the grids of the networked scenes. Called by Network on each server update.
+    virtual void Update(const HashSet<Scene*>& scenes);
+    /// Fill the IDs of the replicated nodes relevant to a client connection. Called by Connection.
+    virtual void GetRelevantNodes(Connection* connection, HashSet<unsigned>& dest);
+
+    /// Set grid cell size. Default 50.
+    void SetCellSize(float size);
+    /// Set distance from the observer position within which nodes enter the interest. Default 250.
+    void SetInterestDistance(float distance);
+    /// Set additional distance a node must move beyond the interest distance to leave the interest, to avoid repeated removal and recreation at the border. Default 25.
+    void SetLeaveMargin(float margin);
+
+    /// Return grid cell size.
+    float GetCellSize() const { return cellSize_; }
+
+    /// Return interest distance.
+    float GetInterestDistance() const { return interestDistance_; }
+
+    /// Return leave margin.
+    float GetLeaveMargin() const { return leaveMargin_; }
+
+private:
+    /// Add the nodes of a grid cell that are within range of a connection's observer position to the relevant set.
+    void AddRelevantNodes(const PODVector<InterestGridNode>& nodes, Connection* connection, float enterDistanceSquared,
+        float leaveDistanceSquared, HashSet<unsigned>& dest) const;
+    /// Add a node and its replicated children to the relevant set.
+    void AddRelevantNode(Node* node, HashSet<unsigned>& dest) const;
+    /// Return grid cell key for a position.
+    unsigned GetCellKey(int x, int z) const { return ((unsigned)(x & 0xffff) << 16) | (unsigned)(z & 0xffff); }
+
+    /// Grids by scene.
+    HashMap<Scene*, InterestGrid> grids_;
+    /// Grid cell size.
+    float cellSize_;
+    /// Interest distance.
+    float interestDistance_;
+    /// Leave margin.
+    float leaveMargin_;
+};
+
+}
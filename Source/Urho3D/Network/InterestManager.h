@@ -0,0 +1,52 @@
+//
+// Copyright (c) 2008-2015 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/HashSet.h"
+#include "../Core/Object.h"
+
+namespace Urho3D
+{
+
+class Connection;
+class Scene;
+
+/// Base class for network interest management. Decides which replicated scene nodes are relevant to each client connection. Nodes outside a connection's interest are not serialized for it, and are removed from the client when they leave the interest.
+class URHO3D_API InterestManager : public Object
+{
+    URHO3D_OBJECT(InterestManager, Object);
+
+public:
+    /// Construct.
+    InterestManager(Context* context);
+    /// Destruct.
+    virtual ~InterestManager();
+
+    /// Update relevance data for the networked scenes before the client connections are processed. Called by Network on each server update.
+    virtual void Update(const HashSet<Scene*>& scenes);
+    /// Fill the IDs of the replicated nodes relevant to a client connection. The scene itself is always relevant. Called by Connection.
+    virtual void GetRelevantNodes(Connection* connection, HashSet<unsigned>& dest) = 0;
+};
+
+}
@@ -25,12 +25,14 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/FileSystem.h"
 #include "../Input/InputEvents.h"
 #include "../IO/IOEvents.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
+#include "../Network/GridInterestManager.h"
 #include "../Network/HttpRequest.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkEvents.h"
@@ -47,6 +49,12 @@ namespace Urho3D
 
 static const int DEFAULT_UPDATE_FPS = 30;
 
+void BuildServerUpdateWork(const WorkItem* item, unsigned threadIndex)
+{
+    Connection* connection = reinterpret_cast<Connection*>(item->aux_);
+    connection->BuildServerUpdate();
+}
+
 Network::Network(Context* context) :
     Object(context),
     updateFps_(DEFAULT_UPDATE_FPS),
@@ -375,6 +383,11 @@ void Network::UnregisterAllRemoteEvents()
     allowedRemoteEvents_.Clear();
 }
 
+void Network::SetInterestManager(InterestManager* manager)
+{
+    interestManager_ = manager;
+}
+
 void Network::SetPackageCacheDir(const String& path)
 {
     packageCacheDir_ = AddTrailingSlash(path);
@@ -512,16 +525,40 @@ void Network::PostUpdate(float timeStep)
 
                 for (HashSet<Scene*>::ConstIterator i = networkScenes_.Begin(); i != networkScenes_.End(); ++i)
                     (*i)->PrepareNetworkUpdate();
+
+                if (interestManager_)
+                    interestManager_->Update(networkScenes_);
             }
 
             {
                 URHO3D_PROFILE(SendServerUpdate);
 
-                // Then send server updates for each client connection
+                // Then send server updates for each client connection. With several clients, build the updates in parallel
+                // first; the attribute data serialized for one connection is cached and reused by the others
+                WorkQueue* queue = GetSubsystem<WorkQueue>();
+                bool threaded = queue && queue->GetNumThreads() && clientConnections_.Size() > 1;
+                if (threaded)
+                {
+                    for (HashMap<kNet::MessageConnection*, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+                         i != clientConnections_.End(); ++i)
+                    {
+                        SharedPtr<WorkItem> item = queue->GetFreeItem();
+                        item->priority_ = M_MAX_UNSIGNED;
+                        item->workFunction_ = BuildServerUpdateWork;
+                        item->aux_ = i->second_.Get();
+                        queue->AddWorkItem(item);
+                    }
+
+                    queue->Complete(M_MAX_UNSIGNED);
+                }
+
                 for (HashMap<kNet::MessageConnection*, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
                      i != clientConnections_.End(); ++i)
                 {
-                    i->second_->SendServerUpdate();
+                    if (threaded)
+                        i->second_->SendDeferredServerUpdate();
+                    else
+                        i->second_->SendServerUpdate();
                     i->second_->SendRemoteEvents();
                     i->second_->SendPackages();
                 }
@@ -599,6 +636,7 @@ void Network::ConfigureNetworkSimulator()
 void RegisterNetworkLibrary(Context* context)
 {
     NetworkPriority::RegisterObject(context);
+    context->RegisterFactory<GridInterestManager>();
 }
 
 }
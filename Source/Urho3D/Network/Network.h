@@ -34,6 +34,7 @@ namespace Urho3D
 {
 
 class HttpRequest;
+class InterestManager;
 class MemoryBuffer;
 class Scene;
 
@@ -97,6 +98,8 @@ public:
     void UnregisterRemoteEvent(StringHash eventType);
     /// Unregister all remote events.
     void UnregisterAllRemoteEvents();
+    /// Set the interest manager that decides which replicated nodes are sent to each client connection. Null (default) sends all nodes to all connections.
+    void SetInterestManager(InterestManager* manager);
     /// Set the package download cache directory.
     void SetPackageCacheDir(const String& path);
     /// Trigger all client connections in the specified scene to download a package file from the server. Can be used to download additional resource packages when clients are already joined in the scene. The package must have been added as a requirement to the scene, or else the eventual download will fail.
@@ -129,6 +132,9 @@ public:
     /// Return the package download cache directory.
     const String& GetPackageCacheDir() const { return packageCacheDir_; }
 
+    /// Return the interest manager.
+    InterestManager* GetInterestManager() const { return interestManager_; }
+
     /// Process incoming messages from connections. Called by HandleBeginFrame.
     void Update(float timeStep);
     /// Send outgoing messages after frame logic. Called by HandleRenderUpdate.
@@ -158,6 +164,8 @@ private:
     HashSet<StringHash> blacklistedRemoteEvents_;
     /// Networked scenes.
     HashSet<Scene*> networkScenes_;
+    /// Interest manager.
+    SharedPtr<InterestManager> interestManager_;
     /// Update FPS.
     int updateFps_;
     /// Simulated latency (send delay) in milliseconds.
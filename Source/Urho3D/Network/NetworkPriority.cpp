@@ -42,7 +42,8 @@ NetworkPriority::NetworkPriority(Context* context) :
     basePriority_(DEFAULT_BASE_PRIORITY),
     distanceFactor_(DEFAULT_DISTANCE_FACTOR),
     minPriority_(DEFAULT_MIN_PRIORITY),
-    alwaysUpdateOwner_(true)
+    alwaysUpdateOwner_(true),
+    alwaysRelevant_(false)
 {
 }
 
@@ -58,6 +59,7 @@ void NetworkPriority::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Distance Factor", float, distanceFactor_, DEFAULT_DISTANCE_FACTOR, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Minimum Priority", float, minPriority_, DEFAULT_MIN_PRIORITY, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Always Update Owner", bool, alwaysUpdateOwner_, true, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Always Relevant", bool, alwaysRelevant_, false, AM_DEFAULT);
 }
 
 void NetworkPriority::SetBasePriority(float priority)
@@ -84,6 +86,12 @@ void NetworkPriority::SetAlwaysUpdateOwner(bool enable)
     MarkNetworkUpdate();
 }
 
+void NetworkPriority::SetAlwaysRelevant(bool enable)
+{
+    alwaysRelevant_ = enable;
+    MarkNetworkUpdate();
+}
+
 bool NetworkPriority::CheckUpdate(float distance, float& accumulator)
 {
     float currentPriority = Max(basePriority_ - distanceFactor_ * distance, minPriority_);
@@ -48,6 +48,8 @@ public:
     void SetMinPriority(float priority);
     /// Set whether updates to owner should be sent always at full rate. Default true.
     void SetAlwaysUpdateOwner(bool enable);
+    /// Set whether the node is relevant to all connections regardless of distance when an interest manager is in use. Only has effect on top-level nodes. Default false.
+    void SetAlwaysRelevant(bool enable);
 
     /// Return base priority.
     float GetBasePriority() const { return basePriority_; }
@@ -61,6 +63,9 @@ public:
     /// Return whether updates to owner should be sent always at full rate.
     bool GetAlwaysUpdateOwner() const { return alwaysUpdateOwner_; }
 
+    /// Return whether the node is relevant to all connections.
+    bool GetAlwaysRelevant() const { return alwaysRelevant_; }
+
     /// Increment and check priority accumulator. Return true if should update. Called by Connection.
     bool CheckUpdate(float distance, float& accumulator);
 
@@ -73,6 +78,8 @@ private:
     float minPriority_;
     /// Update owner at full rate flag.
     bool alwaysUpdateOwner_;
+    /// Always relevant flag.
+    bool alwaysRelevant_;
 };
 
 }
@@ -456,6 +456,16 @@ void CollisionShape::OnSetAttribute(const AttributeInfo& attr, const Variant& sr
         recreateShape_ = true;
 }
 
+bool CollisionShape::OnLoadAttribute(const AttributeInfo& attr, Deserializer& source)
+{
+    if (!LoadAttributeDirect(attr, source))
+        return false;
+
+    if (!attr.accessor_)
+        recreateShape_ = true;
+    return true;
+}
+
 void CollisionShape::ApplyAttributes()
 {
     if (recreateShape_)
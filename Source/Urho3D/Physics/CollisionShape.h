@@ -140,12 +140,18 @@ public:
 
     /// Handle attribute write access.
     virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
+    /// Handle attribute write access from binary data.
+    virtual bool OnLoadAttribute(const AttributeInfo& attr, Deserializer& source);
+    /// Handle attribute read access to binary data.
+    virtual bool OnSaveAttribute(const AttributeInfo& attr, Serializer& dest) const { return SaveAttributeDirect(attr, dest); }
     /// Apply attribute changes that can not be applied immediately. Called after scene load or a network update.
     virtual void ApplyAttributes();
     /// Handle enabled/disabled state change.
     virtual void OnSetEnabled();
     /// Visualize the component as debug geometry.
     virtual void DrawDebugGeometry(DebugRenderer* debug, bool depthTest);
+    /// Return whether the binary attribute data can be read in a worker thread when loading a columnar scene.
+    virtual bool IsLoadThreadSafe() const { return true; }
 
     /// Set as a box.
     void SetBox(const Vector3& size, const Vector3& position = Vector3::ZERO, const Quaternion& rotation = Quaternion::IDENTITY);
@@ -103,24 +103,17 @@ void Constraint::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
     Serializable::OnSetAttribute(attr, src);
 
     if (!attr.accessor_)
-    {
-        // Convenience for editing static constraints: if not connected to another body, adjust world position to match local
-        // (when deserializing, the proper other body position will be read after own position, so this calculation is safely
-        // overridden and does not accumulate constraint error
-        if (attr.offset_ == offsetof(Constraint, position_) && constraint_ && !otherBody_)
-        {
-            btTransform ownBody = constraint_->getRigidBodyA().getWorldTransform();
-            btVector3 worldPos = ownBody * ToBtVector3(position_ * cachedWorldScale_ - ownBody_->GetCenterOfMass());
-            otherPosition_ = ToVector3(worldPos);
-        }
+        MarkAttributeDirty(attr);
+}
 
-        // Certain attribute changes require recreation of the constraint
-        if (attr.offset_ == offsetof(Constraint, constraintType_) || attr.offset_ == offsetof(Constraint, otherBodyNodeID_) ||
-            attr.offset_ == offsetof(Constraint, disableCollision_))
-            recreateConstraint_ = true;
-        else
-            framesDirty_ = true;
-    }
+bool Constraint::OnLoadAttribute(const AttributeInfo& attr, Deserializer& source)
+{
+    if (!LoadAttributeDirect(attr, source))
+        return false;
+
+    if (!attr.accessor_)
+        MarkAttributeDirty(attr);
+    return true;
 }
 
 void Constraint::ApplyAttributes()
@@ -604,4 +597,24 @@ void Constraint::ApplyLimits()
         constraint_->setParam(BT_CONSTRAINT_STOP_CFM, cfm_);
 }
 
+void Constraint::MarkAttributeDirty(const AttributeInfo& attr)
+{
+    // Convenience for editing static constraints: if not connected to another body, adjust world position to match local
+    // (when deserializing, the proper other body position will be read after own position, so this calculation is safely
+    // overridden and does not accumulate constraint error
+    if (attr.offset_ == offsetof(Constraint, position_) && constraint_ && !otherBody_)
+    {
+        btTransform ownBody = constraint_->getRigidBodyA().getWorldTransform();
+        btVector3 worldPos = ownBody * ToBtVector3(position_ * cachedWorldScale_ - ownBody_->GetCenterOfMass());
+        otherPosition_ = ToVector3(worldPos);
+    }
+
+    // Certain attribute changes require recreation of the constraint
+    if (attr.offset_ == offsetof(Constraint, constraintType_) || attr.offset_ == offsetof(Constraint, otherBodyNodeID_) ||
+        attr.offset_ == offsetof(Constraint, disableCollision_))
+        recreateConstraint_ = true;
+    else
+        framesDirty_ = true;
+}
+
 }
@@ -59,6 +59,10 @@ public:
 
     /// Handle attribute write access.
     virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
+    /// Handle attribute write access from binary data.
+    virtual bool OnLoadAttribute(const AttributeInfo& attr, Deserializer& source);
+    /// Handle attribute read access to binary data.
+    virtual bool OnSaveAttribute(const AttributeInfo& attr, Serializer& dest) const { return SaveAttributeDirect(attr, dest); }
     /// Apply attribute changes that can not be applied immediately. Called after scene load or a network update.
     virtual void ApplyAttributes();
     /// Handle enabled/disabled state change.
@@ -67,6 +71,8 @@ public:
     virtual void GetDependencyNodes(PODVector<Node*>& dest);
     /// Visualize the component as debug geometry.
     virtual void DrawDebugGeometry(DebugRenderer* debug, bool depthTest);
+    /// Return whether the binary attribute data can be read in a worker thread when loading a columnar scene.
+    virtual bool IsLoadThreadSafe() const { return true; }
 
     /// Set constraint type and recreate the constraint.
     void SetConstraintType(ConstraintType type);
@@ -160,6 +166,8 @@ private:
     void CreateConstraint();
     /// Apply high and low constraint limits.
     void ApplyLimits();
+    /// Mark the constraint for recreation or frame update after a member attribute has changed.
+    void MarkAttributeDirty(const AttributeInfo& attr);
 
     /// Physics world.
     WeakPtr<PhysicsWorld> physicsWorld_;
@@ -721,6 +721,11 @@ void PhysicsWorld::PreStep(float timeStep)
     eventData[P_TIMESTEP] = timeStep;
     SendEvent(E_PHYSICSPRESTEP, eventData);
 
+    // Then update logic components with the fixed timestep
+    Scene* scene = GetScene();
+    if (scene)
+        scene->UpdateLogicComponents(LUP_FIXEDUPDATE, timeStep);
+
     // Start profiling block for the actual simulation step
 #ifdef URHO3D_PROFILING
     Profiler* profiler = GetSubsystem<Profiler>();
@@ -746,6 +751,10 @@ void PhysicsWorld::PostStep(float timeStep)
     eventData[P_WORLD] = this;
     eventData[P_TIMESTEP] = timeStep;
     SendEvent(E_PHYSICSPOSTSTEP, eventData);
+
+    Scene* scene = GetScene();
+    if (scene)
+        scene->UpdateLogicComponents(LUP_FIXEDPOSTUPDATE, timeStep);
 }
 
 void PhysicsWorld::SendCollisionEvents()
@@ -144,6 +144,16 @@ void RigidBody::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
         readdBody_ = true;
 }
 
+bool RigidBody::OnLoadAttribute(const AttributeInfo& attr, Deserializer& source)
+{
+    if (!LoadAttributeDirect(attr, source))
+        return false;
+
+    if (!attr.accessor_)
+        readdBody_ = true;
+    return true;
+}
+
 void RigidBody::ApplyAttributes()
 {
     if (readdBody_)
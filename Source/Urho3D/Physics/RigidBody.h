@@ -61,6 +61,10 @@ public:
 
     /// Handle attribute write access.
     virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
+    /// Handle attribute write access from binary data.
+    virtual bool OnLoadAttribute(const AttributeInfo& attr, Deserializer& source);
+    /// Handle attribute read access to binary data.
+    virtual bool OnSaveAttribute(const AttributeInfo& attr, Serializer& dest) const { return SaveAttributeDirect(attr, dest); }
     /// Apply attribute changes that can not be applied immediately. Called after scene load or a network update.
     virtual void ApplyAttributes();
     /// Handle enabled/disabled state change.
@@ -71,6 +75,8 @@ public:
     virtual void setWorldTransform(const btTransform& worldTrans);
     /// Visualize the component as debug geometry.
     virtual void DrawDebugGeometry(DebugRenderer* debug, bool depthTest);
+    /// Return whether the binary attribute data can be read in a worker thread when loading a columnar scene.
+    virtual bool IsLoadThreadSafe() const { return true; }
 
     /// Set mass. Zero mass makes the body static.
     void SetMass(float mass);
@@ -25,6 +25,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
 #include "../IO/Log.h"
 #include "../Resource/BackgroundLoader.h"
@@ -36,129 +37,188 @@
 namespace Urho3D
 {
 
+/// Weight of the latest sample in the smoothed latency.
+static const float LATENCY_SMOOTHING = 0.1f;
+/// Weight of a finishing step that took longer than estimated. Estimates rise fast to avoid repeated frame spikes.
+static const float FINISH_COST_RISE = 0.5f;
+/// Weight of a finishing step that took less than estimated.
+static const float FINISH_COST_DECAY = 0.1f;
+
+/// Background loader thread.
+class BackgroundLoaderThread : public Thread, public RefCounted
+{
+public:
+    /// Construct.
+    BackgroundLoaderThread(BackgroundLoader* owner) :
+        owner_(owner)
+    {
+    }
+
+    /// Load resources until stopped.
+    virtual void ThreadFunction()
+    {
+        owner_->ProcessResources();
+    }
+
+private:
+    /// Background loader.
+    BackgroundLoader* owner_;
+};
+
+static inline bool CompareBackgroundLoadRequests(const BackgroundLoadRequest& lhs, const BackgroundLoadRequest& rhs)
+{
+    // Return true if lhs should be loaded after rhs
+    if (lhs.priority_ != rhs.priority_)
+        return lhs.priority_ < rhs.priority_;
+    else
+        return lhs.order_ > rhs.order_;
+}
+
 BackgroundLoader::BackgroundLoader(ResourceCache* owner) :
-    owner_(owner)
+    owner_(owner),
+    numThreads_((unsigned)Clamp((int)GetNumPhysicalCPUs() / 2, 1, 4)),
+    nextOrder_(0),
+    latency_(0.0f),
+    stopThreads_(false)
+{
+}
+
+BackgroundLoader::~BackgroundLoader()
 {
+    StopThreads();
 }
 
-void BackgroundLoader::ThreadFunction()
+void BackgroundLoader::ProcessResources()
 {
-    while (shouldRun_)
+    while (!stopThreads_)
     {
         backgroundLoadMutex_.Acquire();
+        BackgroundLoadItem* item = TakeRequest();
+        bool moreRequests = !requests_.Empty();
+        backgroundLoadMutex_.Release();
 
-        // Search for a queued resource that has not been loaded yet
-        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
-        while (i != backgroundLoadQueue_.End())
+        if (!item)
         {
-            if (i->second_.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
-                break;
-            else
-                ++i;
+            // Sleep until a request is queued or the threads are stopped
+            requestCondition_.Wait();
+            continue;
         }
 
-        if (i == backgroundLoadQueue_.End())
-        {
-            // No resources to load found
-            backgroundLoadMutex_.Release();
-            Time::Sleep(5);
-        }
-        else
-        {
-            BackgroundLoadItem& item = i->second_;
-            Resource* resource = item.resource_;
-            // We can be sure that the item is not removed from the queue as long as it is in the
-            // "queued" or "loading" state
-            backgroundLoadMutex_.Release();
-
-            bool success = false;
-            SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
-            if (file)
-            {
-                resource->SetAsyncLoadState(ASYNC_LOADING);
-                success = resource->BeginLoad(*file);
-            }
+        // The condition wakes up only one thread, so pass the wakeup on if there is more to load
+        if (moreRequests)
+            requestCondition_.Set();
 
-            // Process dependencies now
-            // Need to lock the queue again when manipulating other entries
-            Pair<StringHash, StringHash> key = MakePair(resource->GetType(), resource->GetNameHash());
-            backgroundLoadMutex_.Acquire();
-            if (item.dependents_.Size())
-            {
-                for (HashSet<Pair<StringHash, StringHash> >::Iterator i = item.dependents_.Begin();
-                     i != item.dependents_.End(); ++i)
-                {
-                    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
-                    if (j != backgroundLoadQueue_.End())
-                        j->second_.dependencies_.Erase(key);
-                }
+        LoadResource(*item);
+    }
 
-                item.dependents_.Clear();
-            }
+    // Pass the wakeup on so that the other threads also see the stop flag
+    requestCondition_.Set();
+}
 
-            resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
-            backgroundLoadMutex_.Release();
-        }
-    }
+void BackgroundLoader::SetNumThreads(unsigned num)
+{
+    if (!num)
+        num = 1;
+    if (num == numThreads_)
+        return;
+
+    // Items being loaded are completed before the threads exit, and the queue is kept
+    StopThreads();
+    numThreads_ = num;
+
+    MutexLock lock(backgroundLoadMutex_);
+    if (!requests_.Empty())
+        StartThreads();
 }
 
-bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller)
+bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller,
+    unsigned priority)
 {
     StringHash nameHash(name);
     Pair<StringHash, StringHash> key = MakePair(type, nameHash);
 
-    MutexLock lock(backgroundLoadMutex_);
+    {
+        MutexLock lock(backgroundLoadMutex_);
 
-    // Check if already exists in the queue
-    if (backgroundLoadQueue_.Find(key) != backgroundLoadQueue_.End())
-        return false;
+        // Check if already exists in the queue
+        if (backgroundLoadQueue_.Find(key) != backgroundLoadQueue_.End())
+            return false;
 
-    BackgroundLoadItem& item = backgroundLoadQueue_[key];
-    item.sendEventOnFailure_ = sendEventOnFailure;
+        BackgroundLoadItem& item = backgroundLoadQueue_[key];
+        item.sendEventOnFailure_ = sendEventOnFailure;
 
-    // Make sure the pointer is non-null and is a Resource subclass
-    item.resource_ = DynamicCast<Resource>(owner_->GetContext()->CreateObject(type));
-    if (!item.resource_)
-    {
-        URHO3D_LOGERROR("Could not load unknown resource type " + String(type));
-
-        if (sendEventOnFailure && Thread::IsMainThread())
+        // Make sure the pointer is non-null and is a Resource subclass
+        item.resource_ = DynamicCast<Resource>(owner_->GetContext()->CreateObject(type));
+        if (!item.resource_)
         {
-            using namespace UnknownResourceType;
+            URHO3D_LOGERROR("Could not load unknown resource type " + String(type));
 
-            VariantMap& eventData = owner_->GetEventDataMap();
-            eventData[P_RESOURCETYPE] = type;
-            owner_->SendEvent(E_UNKNOWNRESOURCETYPE, eventData);
-        }
+            if (sendEventOnFailure && Thread::IsMainThread())
+            {
+                using namespace UnknownResourceType;
 
-        backgroundLoadQueue_.Erase(key);
-        return false;
-    }
+                VariantMap& eventData = owner_->GetEventDataMap();
+                eventData[P_RESOURCETYPE] = type;
+                owner_->SendEvent(E_UNKNOWNRESOURCETYPE, eventData);
+            }
 
-    URHO3D_LOGDEBUG("Background loading resource " + name);
+            backgroundLoadQueue_.Erase(key);
+            return false;
+        }
 
-    item.resource_->SetName(name);
-    item.resource_->SetAsyncLoadState(ASYNC_QUEUED);
+        URHO3D_LOGDEBUG("Background loading resource " + name);
 
-    // If this is a resource calling for the background load of more resources, mark the dependency as necessary
-    if (caller)
-    {
-        Pair<StringHash, StringHash> callerKey = MakePair(caller->GetType(), caller->GetNameHash());
-        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(callerKey);
-        if (j != backgroundLoadQueue_.End())
+        item.resource_->SetName(name);
+        item.resource_->SetAsyncLoadState(ASYNC_QUEUED);
+        item.queueTime_ = timer_.GetUSec(false);
+        item.finishSteps_ = 0;
+
+        // If this is a resource calling for the background load of more resources, mark the dependency as necessary
+        if (caller)
         {
-            BackgroundLoadItem& callerItem = j->second_;
-            item.dependents_.Insert(callerKey);
-            callerItem.dependencies_.Insert(key);
+            Pair<StringHash, StringHash> callerKey = MakePair(caller->GetType(), caller->GetNameHash());
+            HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(callerKey);
+            if (j != backgroundLoadQueue_.End())
+            {
+                BackgroundLoadItem& callerItem = j->second_;
+                item.dependents_.Insert(callerKey);
+                callerItem.dependencies_.Insert(key);
+                // Load at least at the caller's priority, as the caller can not finish before this
+                if (callerItem.priority_ > priority)
+                    priority = callerItem.priority_;
+            }
+            else
+                URHO3D_LOGWARNING("Resource " + caller->GetName() +
+                           " requested for a background loaded resource but was not in the background load queue");
         }
-        else
-            URHO3D_LOGWARNING("Resource " + caller->GetName() +
-                       " requested for a background loaded resource but was not in the background load queue");
+
+        item.priority_ = priority;
+        PushRequest(key, priority);
+
+        // Start the background loader threads now
+        if (threads_.Empty())
+            StartThreads();
     }
 
-    // Start the background loader thread now
-    if (!IsStarted())
-        Run();
+    requestCondition_.Set();
+    return true;
+}
+
+bool BackgroundLoader::SetPriority(StringHash type, StringHash nameHash, unsigned priority)
+{
+    MutexLock lock(backgroundLoadMutex_);
+
+    Pair<StringHash, StringHash> key = MakePair(type, nameHash);
+    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(key);
+    if (i == backgroundLoadQueue_.End() || i->second_.resource_->GetAsyncLoadState() != ASYNC_QUEUED)
+        return false;
+
+    // The old request is left in the priority queue and skipped when taken, as its priority no longer matches
+    if (i->second_.priority_ != priority)
+    {
+        i->second_.priority_ = priority;
+        PushRequest(key, priority);
+    }
 
     return true;
 }
@@ -172,33 +232,60 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
     HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(key);
     if (i != backgroundLoadQueue_.End())
     {
-        backgroundLoadMutex_.Release();
+        BackgroundLoadItem& item = i->second_;
+        Resource* resource = item.resource_;
+        HiresTimer waitTimer;
+        bool didWait = false;
 
+        for (;;)
         {
-            Resource* resource = i->second_.resource_;
-            HiresTimer waitTimer;
-            bool didWait = false;
+            AsyncLoadState state = resource->GetAsyncLoadState();
+            BackgroundLoadItem* loadItem = 0;
 
-            for (;;)
+            // Rather than wait for the loader threads to get to the resource or its dependencies, load them here
+            if (state == ASYNC_QUEUED)
+                loadItem = &item;
+            else
             {
-                unsigned numDeps = i->second_.dependencies_.Size();
-                AsyncLoadState state = resource->GetAsyncLoadState();
-                if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
+                for (HashSet<Pair<StringHash, StringHash> >::Iterator j = item.dependencies_.Begin();
+                     j != item.dependencies_.End(); ++j)
                 {
-                    didWait = true;
-                    Time::Sleep(1);
+                    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator k = backgroundLoadQueue_.Find(*j);
+                    if (k != backgroundLoadQueue_.End() && k->second_.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
+                    {
+                        loadItem = &k->second_;
+                        break;
+                    }
                 }
-                else
-                    break;
             }
 
-            if (didWait)
-                URHO3D_LOGDEBUG("Waited " + String(waitTimer.GetUSec(false) / 1000) + " ms for background loaded resource " +
-                         resource->GetName());
+            if (loadItem)
+            {
+                loadItem->resource_->SetAsyncLoadState(ASYNC_LOADING);
+                backgroundLoadMutex_.Release();
+                LoadResource(*loadItem);
+                backgroundLoadMutex_.Acquire();
+            }
+            else if (item.dependencies_.Size() || state == ASYNC_LOADING)
+            {
+                // Loading in a loader thread, wait until it signals completion
+                didWait = true;
+                backgroundLoadMutex_.Release();
+                loadedCondition_.Wait();
+                backgroundLoadMutex_.Acquire();
+            }
+            else
+                break;
         }
 
+        backgroundLoadMutex_.Release();
+
+        if (didWait)
+            URHO3D_LOGDEBUG("Waited " + String(waitTimer.GetUSec(false) / 1000) + " ms for background loaded resource " +
+                     resource->GetName());
+
         // This may take a long time and may potentially wait on other resources, so it is important we do not hold the mutex during this
-        FinishBackgroundLoading(i->second_);
+        FinishBackgroundLoading(item);
 
         backgroundLoadMutex_.Acquire();
         backgroundLoadQueue_.Erase(i);
@@ -210,37 +297,63 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 
 void BackgroundLoader::FinishResources(int maxMs)
 {
-    if (IsStarted())
-    {
-        HiresTimer timer;
+    HiresTimer timer;
+    long long maxUSec = maxMs * 1000LL;
+    bool finishedStep = false;
 
-        backgroundLoadMutex_.Acquire();
+    backgroundLoadMutex_.Acquire();
 
-        for (HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
-             i != backgroundLoadQueue_.End();)
+    // Only resources that have become ready are visited, so the rest of the queue is not scanned. New ready resources
+    // are only added to the end of the list, so the iterator stays valid while the mutex is released
+    List<Pair<StringHash, StringHash> >::Iterator i = readyResources_.Begin();
+    while (i != readyResources_.End())
+    {
+        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
+
+        // The resource may have been finished already by WaitForResource(), and its key even requeued since
+        if (j == backgroundLoadQueue_.End())
         {
-            Resource* resource = i->second_.resource_;
-            unsigned numDeps = i->second_.dependencies_.Size();
-            AsyncLoadState state = resource->GetAsyncLoadState();
-            if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
-                ++i;
-            else
-            {
-                // Finishing a resource may need it to wait for other resources to load, in which case we can not
-                // hold on to the mutex
-                backgroundLoadMutex_.Release();
-                FinishBackgroundLoading(i->second_);
-                backgroundLoadMutex_.Acquire();
-                i = backgroundLoadQueue_.Erase(i);
-            }
+            i = readyResources_.Erase(i);
+            continue;
+        }
+        Resource* resource = j->second_.resource_;
+        AsyncLoadState state = resource->GetAsyncLoadState();
+        if (j->second_.dependencies_.Size() || (state != ASYNC_SUCCESS && state != ASYNC_FAIL))
+        {
+            i = readyResources_.Erase(i);
+            continue;
+        }
 
-            // Break when the time limit passed so that we keep sufficient FPS
-            if (timer.GetUSec(false) >= maxMs * 1000)
-                break;
+        // Break when the time limit passed so that we keep sufficient FPS
+        long long elapsed = timer.GetUSec(false);
+        if (finishedStep && elapsed >= maxUSec)
+            break;
+
+        // If the next step is estimated to overrun the remaining time, leave the resource to a later frame and look
+        // for a cheaper one. The first step of each frame is always performed so that costly resources still progress
+        if (finishedStep && state == ASYNC_SUCCESS &&
+            elapsed + (long long)(GetFinishCost(resource->GetType()) * 1000.0f) > maxUSec)
+        {
+            ++i;
+            continue;
         }
 
+        // Finishing a resource may need it to wait for other resources to load, in which case we can not
+        // hold on to the mutex
         backgroundLoadMutex_.Release();
+        bool finished = FinishBackgroundLoading(j->second_, true);
+        backgroundLoadMutex_.Acquire();
+        finishedStep = true;
+
+        // A resource finished in several steps keeps its place and continues while there is time left
+        if (finished)
+        {
+            backgroundLoadQueue_.Erase(j);
+            i = readyResources_.Erase(i);
+        }
     }
+
+    backgroundLoadMutex_.Release();
 }
 
 unsigned BackgroundLoader::GetNumQueuedResources() const
@@ -249,7 +362,157 @@ unsigned BackgroundLoader::GetNumQueuedResources() const
     return backgroundLoadQueue_.Size();
 }
 
-void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
+float BackgroundLoader::GetLatency() const
+{
+    MutexLock lock(backgroundLoadMutex_);
+    return latency_;
+}
+
+float BackgroundLoader::GetFinishCost(StringHash type) const
+{
+    HashMap<StringHash, float>::ConstIterator i = finishCosts_.Find(type);
+    return i != finishCosts_.End() ? i->second_ : 0.0f;
+}
+
+void BackgroundLoader::StartThreads()
+{
+    stopThreads_ = false;
+    for (unsigned i = 0; i < numThreads_; ++i)
+    {
+        SharedPtr<BackgroundLoaderThread> thread(new BackgroundLoaderThread(this));
+        thread->Run();
+        threads_.Push(thread);
+    }
+}
+
+void BackgroundLoader::StopThreads()
+{
+    if (threads_.Empty())
+        return;
+
+    stopThreads_ = true;
+    requestCondition_.Set();
+    for (unsigned i = 0; i < threads_.Size(); ++i)
+        threads_[i]->Stop();
+
+    MutexLock lock(backgroundLoadMutex_);
+    threads_.Clear();
+    stopThreads_ = false;
+}
+
+void BackgroundLoader::PushRequest(const Pair<StringHash, StringHash>& key, unsigned priority)
+{
+    BackgroundLoadRequest request;
+    request.key_ = key;
+    request.priority_ = priority;
+    request.order_ = nextOrder_++;
+
+    // Sift up in the binary heap
+    unsigned index = requests_.Size();
+    requests_.Push(request);
+    while (index > 0)
+    {
+        unsigned parent = (index - 1) / 2;
+        if (!CompareBackgroundLoadRequests(requests_[parent], request))
+            break;
+        requests_[index] = requests_[parent];
+        index = parent;
+    }
+    requests_[index] = request;
+}
+
+BackgroundLoadItem* BackgroundLoader::TakeRequest()
+{
+    while (!requests_.Empty())
+    {
+        BackgroundLoadRequest request = requests_.Front();
+
+        // Move the last request to the top and sift down in the binary heap
+        BackgroundLoadRequest last = requests_.Back();
+        requests_.Pop();
+        unsigned size = requests_.Size();
+        if (size)
+        {
+            unsigned index = 0;
+            for (;;)
+            {
+                unsigned child = index * 2 + 1;
+                if (child >= size)
+                    break;
+                if (child + 1 < size && CompareBackgroundLoadRequests(requests_[child], requests_[child + 1]))
+                    ++child;
+                if (!CompareBackgroundLoadRequests(last, requests_[child]))
+                    break;
+                requests_[index] = requests_[child];
+                index = child;
+            }
+            requests_[index] = last;
+        }
+
+        // Skip requests whose resource was already taken, finished, or given a different priority
+        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(request.key_);
+        if (i == backgroundLoadQueue_.End() || i->second_.priority_ != request.priority_ ||
+            i->second_.resource_->GetAsyncLoadState() != ASYNC_QUEUED)
+            continue;
+
+        // We can be sure that the item is not removed from the queue as long as it is in the "loading" state
+        i->second_.resource_->SetAsyncLoadState(ASYNC_LOADING);
+        return &i->second_;
+    }
+
+    return 0;
+}
+
+void BackgroundLoader::LoadResource(BackgroundLoadItem& item)
+{
+    Resource* resource = item.resource_;
+    bool success = false;
+
+    {
+#ifdef URHO3D_PROFILING
+        AutoProfileBlock profileBlock(owner_->GetSubsystem<Profiler>(), "BackgroundLoadResource");
+#endif
+        SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
+        if (file)
+            success = resource->BeginLoad(*file);
+    }
+
+    // Process dependencies now
+    // Need to lock the queue again when manipulating other entries
+    Pair<StringHash, StringHash> key = MakePair(resource->GetType(), resource->GetNameHash());
+    backgroundLoadMutex_.Acquire();
+    if (item.dependents_.Size())
+    {
+        for (HashSet<Pair<StringHash, StringHash> >::Iterator i = item.dependents_.Begin(); i != item.dependents_.End(); ++i)
+        {
+            HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
+            if (j != backgroundLoadQueue_.End())
+            {
+                BackgroundLoadItem& dependent = j->second_;
+                dependent.dependencies_.Erase(key);
+
+                // If the dependent was only waiting for its dependencies, it is now ready to finish
+                AsyncLoadState state = dependent.resource_->GetAsyncLoadState();
+                if (dependent.dependencies_.Empty() && (state == ASYNC_SUCCESS || state == ASYNC_FAIL))
+                    readyResources_.Push(*i);
+            }
+        }
+
+        item.dependents_.Clear();
+    }
+
+    resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
+    if (item.dependencies_.Empty())
+        readyResources_.Push(key);
+
+    float latency = (float)(timer_.GetUSec(false) - item.queueTime_) * 0.001f;
+    latency_ = Lerp(latency_, latency, LATENCY_SMOOTHING);
+    backgroundLoadMutex_.Release();
+
+    loadedCondition_.Set();
+}
+
+bool BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item, bool incremental)
 {
     Resource* resource = item.resource_;
 
@@ -264,13 +527,36 @@ void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
         if (profiler)
             profiler->BeginBlock(profileBlockName.CString());
 #endif
-        URHO3D_LOGDEBUG("Finishing background loaded resource " + resource->GetName());
-        success = resource->EndLoad();
+        if (!item.finishSteps_)
+            URHO3D_LOGDEBUG("Finishing background loaded resource " + resource->GetName());
+
+        bool complete = true;
+        if (incremental)
+        {
+            HiresTimer stepTimer;
+            success = resource->EndLoadStep(complete);
+            UpdateFinishCost(resource->GetType(), (float)stepTimer.GetUSec(false) * 0.001f);
+        }
+        else if (item.finishSteps_)
+        {
+            // Finishing was already started in steps, so complete the remaining steps
+            do
+                success = resource->EndLoadStep(complete);
+            while (success && !complete);
+        }
+        else
+            success = resource->EndLoad();
 
 #ifdef URHO3D_PROFILING
         if (profiler)
             profiler->EndBlock();
 #endif
+
+        if (success && !complete)
+        {
+            ++item.finishSteps_;
+            return false;
+        }
     }
     resource->SetAsyncLoadState(ASYNC_DONE);
 
@@ -297,6 +583,17 @@ void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
     // Store to the cache; use same mechanism as for manual resources
     if (success || owner_->GetReturnFailedResources())
         owner_->AddManualResource(resource);
+
+    return true;
+}
+
+void BackgroundLoader::UpdateFinishCost(StringHash type, float ms)
+{
+    HashMap<StringHash, float>::Iterator i = finishCosts_.Find(type);
+    if (i == finishCosts_.End())
+        finishCosts_[type] = ms;
+    else
+        i->second_ = Lerp(i->second_, ms, ms > i->second_ ? FINISH_COST_RISE : FINISH_COST_DECAY);
 }
 
 }
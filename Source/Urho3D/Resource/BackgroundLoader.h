@@ -24,15 +24,19 @@
 
 #include "../Container/HashMap.h"
 #include "../Container/HashSet.h"
+#include "../Container/List.h"
+#include "../Core/Condition.h"
 #include "../Core/Mutex.h"
 #include "../Container/Ptr.h"
 #include "../Container/RefCounted.h"
 #include "../Core/Thread.h"
+#include "../Core/Timer.h"
 #include "../Math/StringHash.h"
 
 namespace Urho3D
 {
 
+class BackgroundLoaderThread;
 class Resource;
 class ResourceCache;
 
@@ -45,33 +49,74 @@ struct BackgroundLoadItem
     HashSet<Pair<StringHash, StringHash> > dependencies_;
     /// Resources that depend on this resource's loading.
     HashSet<Pair<StringHash, StringHash> > dependents_;
+    /// Time of queueing in microseconds.
+    long long queueTime_;
+    /// Load priority. Higher priority resources are loaded first.
+    unsigned priority_;
+    /// Number of finishing steps performed so far.
+    unsigned finishSteps_;
     /// Whether to send failure event.
     bool sendEventOnFailure_;
 };
 
+/// Entry of the background load priority queue.
+struct BackgroundLoadRequest
+{
+    /// Resource type and name hash.
+    Pair<StringHash, StringHash> key_;
+    /// Load priority at the time of queueing. If the item's priority has changed since, the entry is stale.
+    unsigned priority_;
+    /// Queueing order, to load resources of equal priority in the order they were requested.
+    unsigned order_;
+};
+
 /// Background loader of resources. Owned by the ResourceCache.
-class BackgroundLoader : public RefCounted, public Thread
+class BackgroundLoader : public RefCounted
 {
 public:
     /// Construct.
     BackgroundLoader(ResourceCache* owner);
+    /// Destruct. Stop the loader threads.
+    ~BackgroundLoader();
 
-    /// Resource background loading loop.
-    virtual void ThreadFunction();
+    /// Resource background loading loop. Called by the loader threads.
+    void ProcessResources();
 
+    /// Set number of loader threads. Running threads are stopped and restarted on the next background request.
+    void SetNumThreads(unsigned num);
     /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type).
-    bool QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller);
+    bool QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller, unsigned priority);
+    /// Change the priority of a queued resource. Return true if the resource is still waiting to be loaded.
+    bool SetPriority(StringHash type, StringHash nameHash, unsigned priority);
     /// Wait and finish possible loading of a resource when being requested from the cache.
     void WaitForResource(StringHash type, StringHash nameHash);
-    /// Process resources that are ready to finish.
+    /// Finish resources that are ready, packing finishing steps into the time budget by their estimated cost.
     void FinishResources(int maxMs);
 
     /// Return amount of resources in the load queue.
     unsigned GetNumQueuedResources() const;
+    /// Return number of loader threads.
+    unsigned GetNumThreads() const { return numThreads_; }
+    /// Return smoothed time in milliseconds from queueing a resource to its loading in a loader thread being complete.
+    float GetLatency() const;
+    /// Return estimated time in milliseconds of one finishing step of a resource type, learned from previous steps. Return zero if not known yet.
+    float GetFinishCost(StringHash type) const;
 
 private:
-    /// Finish one background loaded resource.
-    void FinishBackgroundLoading(BackgroundLoadItem& item);
+    /// Start the loader threads.
+    void StartThreads();
+    /// Stop the loader threads.
+    void StopThreads();
+    /// Add a request to the priority queue. Must be called with the mutex held.
+    void PushRequest(const Pair<StringHash, StringHash>& key, unsigned priority);
+    /// Take the highest priority resource that is still waiting to be loaded and mark it loading. Must be called with the mutex held. Return null if none.
+    BackgroundLoadItem* TakeRequest();
+    /// Load a resource that has been marked loading, then resolve its dependents.
+    void LoadResource(BackgroundLoadItem& item);
+    /// Finish one background loaded resource, either completely or by performing one finishing step. Return true if finished.
+    bool FinishBackgroundLoading(BackgroundLoadItem& item, bool incremental = false);
+    /// Update the finishing cost estimate of a resource type with a measured step.
+    void UpdateFinishCost(StringHash type, float ms);
 
     /// Resource cache.
     ResourceCache* owner_;
@@ -79,6 +124,28 @@ private:
     mutable Mutex backgroundLoadMutex_;
     /// Resources that are queued for background loading.
     HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem> backgroundLoadQueue_;
+    /// Priority queue of resources waiting to be loaded, as a binary heap.
+    PODVector<BackgroundLoadRequest> requests_;
+    /// Resources whose loading and dependencies are complete, in completion order.
+    List<Pair<StringHash, StringHash> > readyResources_;
+    /// Estimated time in milliseconds of one finishing step per resource type. Accessed only from the main thread.
+    HashMap<StringHash, float> finishCosts_;
+    /// Loader threads.
+    Vector<SharedPtr<BackgroundLoaderThread> > threads_;
+    /// Condition for waking up the loader threads when requests are queued.
+    Condition requestCondition_;
+    /// Condition for waking up the main thread when a resource has been loaded.
+    Condition loadedCondition_;
+    /// Timer for queueing times.
+    HiresTimer timer_;
+    /// Number of loader threads.
+    unsigned numThreads_;
+    /// Queueing order of the next request.
+    unsigned nextOrder_;
+    /// Smoothed latency in milliseconds.
+    float latency_;
+    /// Stop flag for the loader threads.
+    volatile bool stopThreads_;
 };
 
 }
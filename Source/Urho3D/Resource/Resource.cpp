@@ -76,6 +76,12 @@ bool Resource::EndLoad()
     return true;
 }
 
+bool Resource::EndLoadStep(bool& complete)
+{
+    complete = true;
+    return EndLoad();
+}
+
 bool Resource::Save(Serializer& dest) const
 {
     URHO3D_LOGERROR("Save not supported for " + GetTypeName());
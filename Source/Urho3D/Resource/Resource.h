@@ -61,6 +61,8 @@ public:
     virtual bool BeginLoad(Deserializer& source);
     /// Finish resource loading. Always called from the main thread. Return true if successful.
     virtual bool EndLoad();
+    /// Perform one step of finishing resource loading, for resources that can spread a costly finish over several frames. Set complete to true after the last step. Always called from the main thread. Return true if successful. The default implementation calls EndLoad() in a single step.
+    virtual bool EndLoadStep(bool& complete);
     /// Save resource. Return true if successful.
     virtual bool Save(Serializer& dest) const;
 
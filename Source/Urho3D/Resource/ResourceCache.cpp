@@ -635,7 +635,8 @@ Resource* ResourceCache::GetResource(StringHash type, const String& nameIn, bool
     return resource;
 }
 
-bool ResourceCache::BackgroundLoadResource(StringHash type, const String& nameIn, bool sendEventOnFailure, Resource* caller)
+bool ResourceCache::BackgroundLoadResource(StringHash type, const String& nameIn, bool sendEventOnFailure, Resource* caller,
+    unsigned priority)
 {
 #ifdef URHO3D_THREADING
     // If empty name, fail immediately
@@ -648,13 +649,29 @@ bool ResourceCache::BackgroundLoadResource(StringHash type, const String& nameIn
     if (FindResource(type, nameHash) != noResource)
         return false;
 
-    return backgroundLoader_->QueueResource(type, name, sendEventOnFailure, caller);
+    return backgroundLoader_->QueueResource(type, name, sendEventOnFailure, caller, priority);
 #else
     // When threading not supported, fall back to synchronous loading
     return GetResource(type, nameIn, sendEventOnFailure);
 #endif
 }
 
+bool ResourceCache::SetBackgroundLoadPriority(StringHash type, const String& name, unsigned priority)
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->SetPriority(type, StringHash(SanitateResourceName(name)), priority);
+#else
+    return false;
+#endif
+}
+
+void ResourceCache::SetNumBackgroundLoadThreads(unsigned num)
+{
+#ifdef URHO3D_THREADING
+    backgroundLoader_->SetNumThreads(num);
+#endif
+}
+
 SharedPtr<Resource> ResourceCache::GetTempResource(StringHash type, const String& nameIn, bool sendEventOnFailure)
 {
     String name = SanitateResourceName(nameIn);
@@ -717,6 +734,33 @@ unsigned ResourceCache::GetNumBackgroundLoadResources() const
 #endif
 }
 
+unsigned ResourceCache::GetNumBackgroundLoadThreads() const
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->GetNumThreads();
+#else
+    return 0;
+#endif
+}
+
+float ResourceCache::GetBackgroundLoadLatency() const
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->GetLatency();
+#else
+    return 0.0f;
+#endif
+}
+
+float ResourceCache::GetBackgroundFinishCost(StringHash type) const
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->GetFinishCost(type);
+#else
+    return 0.0f;
+#endif
+}
+
 void ResourceCache::GetResources(PODVector<Resource*>& result, StringHash type) const
 {
     result.Clear();
@@ -126,8 +126,10 @@ public:
     /// Define whether when getting resources should check package files or directories first. True for packages, false for directories.
     void SetSearchPackagesFirst(bool value) { searchPackagesFirst_ = value; }
 
-    /// Set how many milliseconds maximum per frame to spend on finishing background loaded resources.
+    /// Set how many milliseconds maximum per frame to spend on finishing background loaded resources. Finishing steps are packed into this time by their estimated cost, and resources that support it are finished over several frames.
     void SetFinishBackgroundResourcesMs(int ms) { finishBackgroundResourcesMs_ = Max(ms, 1); }
+    /// Set number of background loader threads. Default is half the physical CPU cores, between 1 and 4.
+    void SetNumBackgroundLoadThreads(unsigned num);
 
     /// Add a resource router object. By default there is none, so the routing process is skipped.
     void AddResourceRouter(ResourceRouter* router, bool addAsFirst = false);
@@ -140,10 +142,19 @@ public:
     Resource* GetResource(StringHash type, const String& name, bool sendEventOnFailure = true);
     /// Load a resource without storing it in the resource cache. Return null if not found or if fails. Can be called from outside the main thread if the resource itself is safe to load completely (it does not possess for example GPU data.)
     SharedPtr<Resource> GetTempResource(StringHash type, const String& name, bool sendEventOnFailure = true);
-    /// Background load a resource. An event will be sent when complete. Return true if successfully stored to the load queue, false if eg. already exists. Can be called from outside the main thread.
-    bool BackgroundLoadResource(StringHash type, const String& name, bool sendEventOnFailure = true, Resource* caller = 0);
+    /// Background load a resource. Resources with higher priority, for example closer to the camera, are loaded first. An event will be sent when complete. Return true if successfully stored to the load queue, false if eg. already exists. Can be called from outside the main thread.
+    bool BackgroundLoadResource(StringHash type, const String& name, bool sendEventOnFailure = true, Resource* caller = 0,
+        unsigned priority = 0);
+    /// Change the priority of a background load request. Return true if the resource is still waiting to be loaded. Can be called from outside the main thread.
+    bool SetBackgroundLoadPriority(StringHash type, const String& name, unsigned priority);
     /// Return number of pending background-loaded resources.
     unsigned GetNumBackgroundLoadResources() const;
+    /// Return number of background loader threads.
+    unsigned GetNumBackgroundLoadThreads() const;
+    /// Return smoothed time in milliseconds from requesting a background load to the resource being ready to finish.
+    float GetBackgroundLoadLatency() const;
+    /// Return estimated main thread time in milliseconds of one finishing step of a background loaded resource type, learned from previous loads. Return zero if not known yet.
+    float GetBackgroundFinishCost(StringHash type) const;
     /// Return all loaded resources of a specific type.
     void GetResources(PODVector<Resource*>& result, StringHash type) const;
     /// Return an already loaded resource of specific type & name, or null if not found. Will not load if does not exist.
@@ -165,7 +176,8 @@ public:
     /// Template version of loading a resource without storing it to the cache.
     template <class T> SharedPtr<T> GetTempResource(const String& name, bool sendEventOnFailure = true);
     /// Template version of queueing a resource background load.
-    template <class T> bool BackgroundLoadResource(const String& name, bool sendEventOnFailure = true, Resource* caller = 0);
+    template <class T> bool BackgroundLoadResource(const String& name, bool sendEventOnFailure = true, Resource* caller = 0,
+        unsigned priority = 0);
     /// Template version of returning loaded resources of a specific type.
     template <class T> void GetResources(PODVector<T*>& result) const;
     /// Return whether a file exists by name.
@@ -270,10 +282,11 @@ template <class T> SharedPtr<T> ResourceCache::GetTempResource(const String& nam
     return StaticCast<T>(GetTempResource(type, name, sendEventOnFailure));
 }
 
-template <class T> bool ResourceCache::BackgroundLoadResource(const String& name, bool sendEventOnFailure, Resource* caller)
+template <class T> bool ResourceCache::BackgroundLoadResource(const String& name, bool sendEventOnFailure, Resource* caller,
+    unsigned priority)
 {
     StringHash type = T::GetTypeStatic();
-    return BackgroundLoadResource(type, name, sendEventOnFailure, caller);
+    return BackgroundLoadResource(type, name, sendEventOnFailure, caller, priority);
 }
 
 template <class T> void ResourceCache::GetResources(PODVector<T*>& result) const
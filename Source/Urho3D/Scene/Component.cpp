@@ -138,6 +138,12 @@ void Component::AddReplicationState(ComponentReplicationState* state)
     networkState_->replicationStates_.Push(state);
 }
 
+void Component::RemoveReplicationState(ComponentReplicationState* state)
+{
+    if (networkState_)
+        networkState_->replicationStates_.Remove(state);
+}
+
 void Component::PrepareNetworkUpdate()
 {
     if (!networkState_)
@@ -157,6 +163,8 @@ void Component::PrepareNetworkUpdate()
         // Copy the default attribute values to the previous state as a starting point
         for (unsigned i = 0; i < numAttributes; ++i)
             networkState_->previousValues_[i] = attributes->At(i).defaultValue_;
+
+        networkState_->ClearUpdateCaches();
     }
 
     // Check for attribute changes
@@ -172,6 +180,7 @@ void Component::PrepareNetworkUpdate()
         if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
         {
             networkState_->previousValues_[i] = networkState_->currentValues_[i];
+            networkState_->ClearUpdateCaches();
 
             // Mark the attribute dirty in all replication states that are tracking this component
             for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
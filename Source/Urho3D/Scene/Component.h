@@ -60,6 +60,8 @@ public:
     virtual void GetDependencyNodes(PODVector<Node*>& dest);
     /// Visualize the component as debug geometry.
     virtual void DrawDebugGeometry(DebugRenderer* debug, bool depthTest);
+    /// Return whether the binary attribute data of this component type can be read in a worker thread when loading a columnar scene. The values are then applied in the main thread through OnSetAttribute(), so should return false if Load() is overridden. Should return the same value for all instances of a type.
+    virtual bool IsLoadThreadSafe() const { return false; }
 
     /// Set enabled/disabled state.
     void SetEnabled(bool enable);
@@ -91,6 +93,8 @@ public:
 
     /// Add a replication state that is tracking this component.
     void AddReplicationState(ComponentReplicationState* state);
+    /// Remove a replication state that is tracking this component.
+    void RemoveReplicationState(ComponentReplicationState* state);
     /// Prepare network update by comparing attributes and marking replication states dirty as necessary.
     void PrepareNetworkUpdate();
     /// Clean up all references to a network connection that is about to be removed.
@@ -23,13 +23,8 @@
 #include "../Precompiled.h"
 
 #include "../IO/Log.h"
-#ifdef URHO3D_PHYSICS
-#include "../Physics/PhysicsEvents.h"
-#include "../Physics/PhysicsWorld.h"
-#endif
 #include "../Scene/LogicComponent.h"
 #include "../Scene/Scene.h"
-#include "../Scene/SceneEvents.h"
 
 namespace Urho3D
 {
@@ -38,8 +33,11 @@ LogicComponent::LogicComponent(Context* context) :
     Component(context),
     updateEventMask_(USE_UPDATE | USE_POSTUPDATE | USE_FIXEDUPDATE | USE_FIXEDPOSTUPDATE),
     currentEventMask_(0),
+    updateScene_(0),
     delayedStartCalled_(false)
 {
+    for (unsigned i = 0; i < MAX_LOGIC_UPDATE_PHASES; ++i)
+        updateIndices_[i] = M_MAX_UNSIGNED;
 }
 
 LogicComponent::~LogicComponent()
@@ -94,15 +92,13 @@ void LogicComponent::OnSceneSet(Scene* scene)
 {
     if (scene)
         UpdateEventSubscription();
-    else
+    else if (updateScene_)
     {
-        UnsubscribeFromEvent(E_SCENEUPDATE);
-        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
-#ifdef URHO3D_PHYSICS
-        UnsubscribeFromEvent(E_PHYSICSPRESTEP);
-        UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
-#endif
-        currentEventMask_ = 0;
+        SetUpdatePhase(updateScene_, LUP_UPDATE, USE_UPDATE, false);
+        SetUpdatePhase(updateScene_, LUP_POSTUPDATE, USE_POSTUPDATE, false);
+        SetUpdatePhase(updateScene_, LUP_FIXEDUPDATE, USE_FIXEDUPDATE, false);
+        SetUpdatePhase(updateScene_, LUP_FIXEDPOSTUPDATE, USE_FIXEDPOSTUPDATE, false);
+        updateScene_ = 0;
     }
 }
 
@@ -115,109 +111,43 @@ void LogicComponent::UpdateEventSubscription()
     bool enabled = IsEnabledEffective();
 
     bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_);
-    if (needUpdate && !(currentEventMask_ & USE_UPDATE))
-    {
-        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(LogicComponent, HandleSceneUpdate));
-        currentEventMask_ |= USE_UPDATE;
-    }
-    else if (!needUpdate && (currentEventMask_ & USE_UPDATE))
-    {
-        UnsubscribeFromEvent(scene, E_SCENEUPDATE);
-        currentEventMask_ &= ~USE_UPDATE;
-    }
+    SetUpdatePhase(scene, LUP_UPDATE, USE_UPDATE, needUpdate);
 
     bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE);
-    if (needPostUpdate && !(currentEventMask_ & USE_POSTUPDATE))
-    {
-        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(LogicComponent, HandleScenePostUpdate));
-        currentEventMask_ |= USE_POSTUPDATE;
-    }
-    else if (!needUpdate && (currentEventMask_ & USE_POSTUPDATE))
-    {
-        UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
-        currentEventMask_ &= ~USE_POSTUPDATE;
-    }
+    SetUpdatePhase(scene, LUP_POSTUPDATE, USE_POSTUPDATE, needPostUpdate);
 
 #ifdef URHO3D_PHYSICS
-    PhysicsWorld* world = scene->GetComponent<PhysicsWorld>();
-    if (!world)
-        return;
-
     bool needFixedUpdate = enabled && (updateEventMask_ & USE_FIXEDUPDATE);
-    if (needFixedUpdate && !(currentEventMask_ & USE_FIXEDUPDATE))
-    {
-        SubscribeToEvent(world, E_PHYSICSPRESTEP, URHO3D_HANDLER(LogicComponent, HandlePhysicsPreStep));
-        currentEventMask_ |= USE_FIXEDUPDATE;
-    }
-    else if (!needFixedUpdate && (currentEventMask_ & USE_FIXEDUPDATE))
-    {
-        UnsubscribeFromEvent(world, E_PHYSICSPRESTEP);
-        currentEventMask_ &= ~USE_FIXEDUPDATE;
-    }
+    SetUpdatePhase(scene, LUP_FIXEDUPDATE, USE_FIXEDUPDATE, needFixedUpdate);
 
     bool needFixedPostUpdate = enabled && (updateEventMask_ & USE_FIXEDPOSTUPDATE);
-    if (needFixedPostUpdate && !(currentEventMask_ & USE_FIXEDPOSTUPDATE))
-    {
-        SubscribeToEvent(world, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(LogicComponent, HandlePhysicsPostStep));
-        currentEventMask_ |= USE_FIXEDPOSTUPDATE;
-    }
-    else if (!needFixedPostUpdate && (currentEventMask_ & USE_FIXEDPOSTUPDATE))
-    {
-        UnsubscribeFromEvent(world, E_PHYSICSPOSTSTEP);
-        currentEventMask_ &= ~USE_FIXEDPOSTUPDATE;
-    }
+    SetUpdatePhase(scene, LUP_FIXEDPOSTUPDATE, USE_FIXEDPOSTUPDATE, needFixedPostUpdate);
 #endif
 }
 
-void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::SetUpdatePhase(Scene* scene, LogicUpdatePhase phase, unsigned char bit, bool enable)
 {
-    using namespace SceneUpdate;
-
-    // Execute user-defined delayed start function before first update
-    if (!delayedStartCalled_)
+    if (enable && !(currentEventMask_ & bit))
     {
-        DelayedStart();
-        delayedStartCalled_ = true;
-
-        // If did not need actual update events, unsubscribe now
-        if (!(updateEventMask_ & USE_UPDATE))
-        {
-            UnsubscribeFromEvent(GetScene(), E_SCENEUPDATE);
-            currentEventMask_ &= ~USE_UPDATE;
-            return;
-        }
+        scene->AddLogicComponent(this, phase);
+        updateScene_ = scene;
+        currentEventMask_ |= bit;
+    }
+    else if (!enable && (currentEventMask_ & bit))
+    {
+        scene->RemoveLogicComponent(this, phase);
+        currentEventMask_ &= ~bit;
     }
-
-    // Then execute user-defined update function
-    Update(eventData[P_TIMESTEP].GetFloat());
-}
-
-void LogicComponent::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
-{
-    using namespace ScenePostUpdate;
-
-    // Execute user-defined post-update function
-    PostUpdate(eventData[P_TIMESTEP].GetFloat());
-}
-
-#ifdef URHO3D_PHYSICS
-
-void LogicComponent::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
-{
-    using namespace PhysicsPreStep;
-
-    // Execute user-defined fixed update function
-    FixedUpdate(eventData[P_TIMESTEP].GetFloat());
 }
 
-void LogicComponent::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+void LogicComponent::PerformDelayedStart()
 {
-    using namespace PhysicsPostStep;
+    DelayedStart();
+    delayedStartCalled_ = true;
 
-    // Execute user-defined fixed post-update function
-    FixedPostUpdate(eventData[P_TIMESTEP].GetFloat());
+    // If did not need actual update events, stop updates now
+    if (!(updateEventMask_ & USE_UPDATE) && updateScene_)
+        SetUpdatePhase(updateScene_, LUP_UPDATE, USE_UPDATE, false);
 }
 
-#endif
-
 }
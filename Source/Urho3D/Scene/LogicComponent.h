@@ -36,11 +36,23 @@ static const unsigned char USE_FIXEDUPDATE = 0x4;
 /// Bitmask for using the physics post-update event.
 static const unsigned char USE_FIXEDPOSTUPDATE = 0x8;
 
-/// Helper base class for user-defined game logic components that hooks up to update events and forwards them to virtual functions similar to ScriptInstance class.
+/// Logic component update phase.
+enum LogicUpdatePhase
+{
+    LUP_UPDATE = 0,
+    LUP_POSTUPDATE,
+    LUP_FIXEDUPDATE,
+    LUP_FIXEDPOSTUPDATE,
+    MAX_LOGIC_UPDATE_PHASES
+};
+
+/// Helper base class for user-defined game logic components that receives scene and physics updates through virtual functions similar to ScriptInstance class. The scene updates logic components of the same type together, after sending the corresponding update event.
 class URHO3D_API LogicComponent : public Component
 {
     URHO3D_OBJECT(LogicComponent, Component);
 
+    friend class Scene;
+
     /// Construct.
     LogicComponent(Context* context);
     /// Destruct.
@@ -67,6 +79,9 @@ class URHO3D_API LogicComponent : public Component
     /// Called on physics post-update, fixed timestep.
     virtual void FixedPostUpdate(float timeStep);
 
+    /// Return whether the update functions of this component type can be called from worker threads, in parallel with other components of the same type. Should return the same value for all instances of a type. If true, the update functions must not send events, create or remove nodes or components, or access other objects without synchronization. DelayedStart() is always called from the main thread.
+    virtual bool IsUpdateThreadSafe() const { return false; }
+
     /// Set what update events should be subscribed to. Use this for optimization: by default all are in use. Note that this is not an attribute and is not saved or network-serialized, therefore it should always be called eg. in the subclass constructor.
     void SetUpdateEventMask(unsigned char mask);
 
@@ -83,24 +98,41 @@ protected:
     virtual void OnSceneSet(Scene* scene);
 
 private:
-    /// Subscribe/unsubscribe to update events based on current enabled state and update event mask.
+    /// Add to or remove from the scene's update lists based on current enabled state and update event mask.
     void UpdateEventSubscription();
-    /// Handle scene update event.
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
-    /// Handle scene post-update event.
-    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
-#ifdef URHO3D_PHYSICS
-    /// Handle physics pre-step event.
-    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
-    /// Handle physics post-step event.
-    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
-#endif
+    /// Add to or remove from the scene's update list of a phase.
+    void SetUpdatePhase(Scene* scene, LogicUpdatePhase phase, unsigned char bit, bool enable);
+    /// Call DelayedStart() and stop updates if they were needed only for it. Called by Scene.
+    void PerformDelayedStart();
+
     /// Requested event subscription mask.
     unsigned char updateEventMask_;
     /// Current event subscription mask.
     unsigned char currentEventMask_;
+    /// Indices in the scene's update lists.
+    unsigned updateIndices_[MAX_LOGIC_UPDATE_PHASES];
+    /// Scene the component is added to for updates.
+    Scene* updateScene_;
     /// Flag for delayed start.
     bool delayedStartCalled_;
 };
 
+/// Logic components of one type that use an update phase.
+struct LogicComponentGroup
+{
+    /// Construct.
+    LogicComponentGroup() :
+        numHoles_(0),
+        threadSafe_(false)
+    {
+    }
+
+    /// Components in the order they were added. Removed components leave null holes until the next update.
+    PODVector<LogicComponent*> components_;
+    /// Number of null holes.
+    unsigned numHoles_;
+    /// Whether the components can be updated in worker threads.
+    bool threadSafe_;
+};
+
 }
@@ -232,6 +232,12 @@ void Node::AddReplicationState(NodeReplicationState* state)
     networkState_->replicationStates_.Push(state);
 }
 
+void Node::RemoveReplicationState(NodeReplicationState* state)
+{
+    if (networkState_)
+        networkState_->replicationStates_.Remove(state);
+}
+
 bool Node::SaveXML(Serializer& dest, const String& indentation) const
 {
     SharedPtr<XMLFile> xml(new XMLFile(context_));
@@ -1377,6 +1383,10 @@ void Node::PrepareNetworkUpdate()
             component->GetDependencyNodes(dependencyNodes_);
     }
 
+    // Update the world transform now, as the connections may read it from worker threads for the priority check
+    if (dirty_)
+        UpdateWorldTransform();
+
     // Then check for node attribute changes
     if (!networkState_)
         AllocateNetworkState();
@@ -1392,6 +1402,8 @@ void Node::PrepareNetworkUpdate()
         // Copy the default attribute values to the previous state as a starting point
         for (unsigned i = 0; i < numAttributes; ++i)
             networkState_->previousValues_[i] = attributes->At(i).defaultValue_;
+
+        networkState_->ClearUpdateCaches();
     }
 
     // Check for attribute changes
@@ -1407,6 +1419,7 @@ void Node::PrepareNetworkUpdate()
         if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
         {
             networkState_->previousValues_[i] = networkState_->currentValues_[i];
+            networkState_->ClearUpdateCaches();
 
             // Mark the attribute dirty in all replication states that are tracking this node
             for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
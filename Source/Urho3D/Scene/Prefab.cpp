@@ -0,0 +1,322 @@
+//
+// Copyright (c) 2008-2015 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../IO/VectorBuffer.h"
+#include "../Resource/XMLFile.h"
+#include "../Scene/Node.h"
+#include "../Scene/Prefab.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+Prefab::Prefab(Context* context) :
+    Resource(context)
+{
+}
+
+Prefab::~Prefab()
+{
+}
+
+void Prefab::RegisterObject(Context* context)
+{
+    context->RegisterFactory<Prefab>();
+}
+
+bool Prefab::BeginLoad(Deserializer& source)
+{
+    if (GetExtension(source.GetName()) == ".xml")
+    {
+        XMLFile xmlFile(context_);
+        if (!xmlFile.Load(source))
+            return false;
+
+        return LoadNodeXML(xmlFile.GetRoot());
+    }
+    else
+        return LoadNode(source);
+}
+
+bool Prefab::LoadNode(Deserializer& source)
+{
+    Clear();
+
+    bool success = ReadNode(source, 0);
+    if (!success)
+        Clear();
+
+    UpdateMemoryUse();
+    return success;
+}
+
+bool Prefab::LoadNodeXML(const XMLElement& source)
+{
+    Clear();
+
+    bool success = ReadNodeXML(source, 0);
+    if (!success)
+        Clear();
+
+    UpdateMemoryUse();
+    return success;
+}
+
+bool Prefab::ReadNode(Deserializer& source, unsigned parent)
+{
+    PrefabObject node;
+    node.type_ = Node::GetTypeStatic();
+    node.id_ = source.ReadUInt();
+    node.parent_ = parent;
+
+    // The node attributes are not preceded by their size, so read through them to copy the data
+    const Vector<AttributeInfo>* attributes = context_->GetAttributes(Node::GetTypeStatic());
+    VectorBuffer attrBuffer;
+    if (attributes)
+    {
+        for (unsigned i = 0; i < attributes->Size(); ++i)
+        {
+            const AttributeInfo& attr = attributes->At(i);
+            if (!(attr.mode_ & AM_FILE))
+                continue;
+
+            if (source.IsEof())
+            {
+                URHO3D_LOGERROR("Could not load prefab " + GetName() + ", stream not open or at end");
+                return false;
+            }
+            attrBuffer.WriteVariantData(source.ReadVariant(attr.type_));
+        }
+    }
+
+    AddData(node, attrBuffer.GetData(), attrBuffer.GetSize());
+    unsigned index = nodes_.Size();
+    nodes_.Push(node);
+
+    // The component data is preceded by its size, so it can be copied as is after the type and ID
+    unsigned numComponents = source.ReadVLE();
+    for (unsigned i = 0; i < numComponents; ++i)
+    {
+        VectorBuffer compBuffer(source, source.ReadVLE());
+        PrefabObject component;
+        component.type_ = compBuffer.ReadStringHash();
+        component.id_ = compBuffer.ReadUInt();
+        component.parent_ = index;
+
+        unsigned dataStart = compBuffer.GetPosition();
+        AddData(component, compBuffer.GetData() + dataStart, compBuffer.GetSize() - dataStart);
+        components_.Push(component);
+    }
+
+    unsigned numChildren = source.ReadVLE();
+    for (unsigned i = 0; i < numChildren; ++i)
+    {
+        if (!ReadNode(source, index))
+            return false;
+    }
+
+    return true;
+}
+
+bool Prefab::ReadNodeXML(const XMLElement& source, unsigned parent)
+{
+    PrefabObject node;
+    node.type_ = Node::GetTypeStatic();
+    node.id_ = source.GetUInt("id");
+    node.parent_ = parent;
+    if (!ReadAttributesXML(source, node))
+        return false;
+
+    unsigned index = nodes_.Size();
+    nodes_.Push(node);
+
+    XMLElement compElem = source.GetChild("component");
+    while (compElem)
+    {
+        String typeName = compElem.GetAttribute("type");
+        PrefabObject component;
+        component.type_ = StringHash(typeName);
+        component.id_ = compElem.GetUInt("id");
+        component.parent_ = index;
+
+        // Unknown components can only hold binary data, so skip them
+        if (context_->GetTypeName(component.type_).Empty())
+            URHO3D_LOGWARNING("Component type " + typeName + " not known, skipping in prefab " + GetName());
+        else
+        {
+            if (!ReadAttributesXML(compElem, component))
+                return false;
+            components_.Push(component);
+        }
+
+        compElem = compElem.GetNext("component");
+    }
+
+    XMLElement childElem = source.GetChild("node");
+    while (childElem)
+    {
+        if (!ReadNodeXML(childElem, index))
+            return false;
+
+        childElem = childElem.GetNext("node");
+    }
+
+    return true;
+}
+
+bool Prefab::ReadAttributesXML(const XMLElement& source, PrefabObject& object)
+{
+    if (source.HasChild("objectanimation") || source.HasChild("attributeanimation"))
+        URHO3D_LOGWARNING("Inline attribute animations are not supported in prefab " + GetName() + ", skipping");
+
+    const Vector<AttributeInfo>* attributes = context_->GetAttributes(object.type_);
+    if (!attributes)
+    {
+        AddData(object, 0, 0);
+        return true;
+    }
+
+    // The binary data contains all file attributes, so start from the default values
+    Vector<Variant> values(attributes->Size());
+    for (unsigned i = 0; i < attributes->Size(); ++i)
+    {
+        const AttributeInfo& attr = attributes->At(i);
+        if (!(attr.mode_ & AM_FILE))
+            continue;
+
+        if (attr.defaultValue_.GetType() == attr.type_)
+            values[i] = attr.defaultValue_;
+        else
+            values[i] = Variant(attr.type_, attr.defaultValue_.ToString());
+    }
+
+    // Match the attribute elements by name in the same way as Serializable::LoadXML()
+    XMLElement attrElem = source.GetChild("attribute");
+    unsigned startIndex = 0;
+
+    while (attrElem)
+    {
+        String name = attrElem.GetAttribute("name");
+        unsigned i = startIndex;
+        unsigned attempts = attributes->Size();
+
+        while (attempts)
+        {
+            const AttributeInfo& attr = attributes->At(i);
+            if ((attr.mode_ & AM_FILE) && !attr.name_.Compare(name, true))
+            {
+                Variant varValue;
+
+                // If enums specified, do enum lookup and int assignment. Otherwise assign the variant directly
+                if (attr.enumNames_)
+                {
+                    String value = attrElem.GetAttribute("value");
+                    bool enumFound = false;
+                    int enumValue = 0;
+                    const char** enumPtr = attr.enumNames_;
+                    while (*enumPtr)
+                    {
+                        if (!value.Compare(*enumPtr, false))
+                        {
+                            enumFound = true;
+                            break;
+                        }
+                        ++enumPtr;
+                        ++enumValue;
+                    }
+                    if (enumFound)
+                        varValue = enumValue;
+                    else
+                        URHO3D_LOGWARNING("Unknown enum value " + value + " in attribute " + attr.name_);
+                }
+                else
+                    varValue = attrElem.GetVariantValue(attr.type_);
+
+                if (!varValue.IsEmpty())
+                    values[i] = varValue;
+
+                startIndex = (i + 1) % attributes->Size();
+                break;
+            }
+            else
+            {
+                i = (i + 1) % attributes->Size();
+                --attempts;
+            }
+        }
+
+        if (!attempts)
+            URHO3D_LOGWARNING("Unknown attribute " + name + " in XML data");
+
+        attrElem = attrElem.GetNext("attribute");
+    }
+
+    VectorBuffer attrBuffer;
+    for (unsigned i = 0; i < attributes->Size(); ++i)
+    {
+        const AttributeInfo& attr = attributes->At(i);
+        if (!(attr.mode_ & AM_FILE))
+            continue;
+
+        if (values[i].GetType() != attr.type_)
+        {
+            URHO3D_LOGERROR("Could not load prefab " + GetName() + ", value of attribute " + attr.name_ + " has wrong type");
+            return false;
+        }
+        attrBuffer.WriteVariantData(values[i]);
+    }
+
+    AddData(object, attrBuffer.GetData(), attrBuffer.GetSize());
+    return true;
+}
+
+void Prefab::AddData(PrefabObject& object, const void* data, unsigned size)
+{
+    object.dataOffset_ = data_.Size();
+    object.dataSize_ = size;
+    if (size)
+    {
+        data_.Resize(object.dataOffset_ + size);
+        memcpy(&data_[object.dataOffset_], data, size);
+    }
+}
+
+void Prefab::Clear()
+{
+    nodes_.Clear();
+    components_.Clear();
+    data_.Clear();
+}
+
+void Prefab::UpdateMemoryUse()
+{
+    SetMemoryUse(sizeof(Prefab) + (nodes_.Size() + components_.Size()) * sizeof(PrefabObject) + data_.Size());
+}
+
+}
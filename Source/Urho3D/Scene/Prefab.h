@@ -0,0 +1,102 @@
+//
+// Copyright (c) 2008-2015 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Resource/Resource.h"
+
+namespace Urho3D
+{
+
+class XMLElement;
+
+/// Node or component in a prefab.
+struct PrefabObject
+{
+    /// Object type.
+    StringHash type_;
+    /// Original ID, used for resolving references between the instantiated objects.
+    unsigned id_;
+    /// Index of the parent node for a node, or the owner node for a component. Not used for the root node.
+    unsigned parent_;
+    /// Offset of the binary attribute data in the prefab data.
+    unsigned dataOffset_;
+    /// Size of the binary attribute data.
+    unsigned dataSize_;
+};
+
+/// %Object prefab resource. Parses binary or XML node data once into a node hierarchy with the attributes converted to binary, so that instantiating it only needs to create the nodes and components and read their attributes. See Scene::Instantiate().
+class URHO3D_API Prefab : public Resource
+{
+    URHO3D_OBJECT(Prefab, Resource);
+
+public:
+    /// Construct.
+    Prefab(Context* context);
+    /// Destruct.
+    virtual ~Prefab();
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Load resource from stream. May be called from a worker thread. Return true if successful.
+    virtual bool BeginLoad(Deserializer& source);
+
+    /// Load from binary node data, as saved by Node::Save(). Return true if successful.
+    bool LoadNode(Deserializer& source);
+    /// Load from XML node data, as saved by Node::SaveXML(). Inline attribute animations are not supported. Return true if successful.
+    bool LoadNodeXML(const XMLElement& source);
+
+    /// Return nodes in hierarchy order. The first node is the root node.
+    const PODVector<PrefabObject>& GetNodes() const { return nodes_; }
+    /// Return components in hierarchy order.
+    const PODVector<PrefabObject>& GetComponents() const { return components_; }
+    /// Return binary attribute data of a node or component.
+    const unsigned char* GetData(const PrefabObject& object) const { return object.dataSize_ ? &data_[object.dataOffset_] : 0; }
+    /// Return number of nodes.
+    unsigned GetNumNodes() const { return nodes_.Size(); }
+    /// Return number of components.
+    unsigned GetNumComponents() const { return components_.Size(); }
+
+private:
+    /// Read a node with its components and child nodes from binary data.
+    bool ReadNode(Deserializer& source, unsigned parent);
+    /// Read a node with its components and child nodes from XML data.
+    bool ReadNodeXML(const XMLElement& source, unsigned parent);
+    /// Convert the attributes of a node or component from XML to binary data.
+    bool ReadAttributesXML(const XMLElement& source, PrefabObject& object);
+    /// Append binary attribute data of a node or component.
+    void AddData(PrefabObject& object, const void* data, unsigned size);
+    /// Clear all content.
+    void Clear();
+    /// Recalculate memory use.
+    void UpdateMemoryUse();
+
+    /// Nodes in hierarchy order.
+    PODVector<PrefabObject> nodes_;
+    /// Components in hierarchy order.
+    PODVector<PrefabObject> components_;
+    /// Binary attribute data of all nodes and components.
+    PODVector<unsigned char> data_;
+};
+
+}
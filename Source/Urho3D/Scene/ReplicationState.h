@@ -34,6 +34,7 @@ namespace Urho3D
 {
 
 static const unsigned MAX_NETWORK_ATTRIBUTES = 64;
+static const unsigned MAX_CACHED_DELTA_UPDATES = 4;
 
 class Component;
 class Connection;
@@ -99,6 +100,9 @@ struct URHO3D_API DirtyBits
         count_ = 0;
     }
 
+    /// Test for equality with another set of bits.
+    bool operator ==(const DirtyBits& rhs) const { return count_ == rhs.count_ && !memcmp(data_, rhs.data_, MAX_NETWORK_ATTRIBUTES / 8); }
+
     /// Return if bit is set.
     bool IsSet(unsigned index) const
     {
@@ -126,8 +130,20 @@ struct URHO3D_API NetworkState
 {
     /// Construct with defaults.
     NetworkState() :
-        interceptMask_(0)
+        interceptMask_(0),
+        initialDeltaUpdateCached_(false),
+        latestDataUpdateCached_(false),
+        updateCacheLock_(0)
+    {
+    }
+
+    /// Clear the cached serialized updates. Called when the attribute values change.
+    void ClearUpdateCaches()
     {
+        initialDeltaUpdateCached_ = false;
+        latestDataUpdateCached_ = false;
+        deltaUpdateCacheBits_.Clear();
+        deltaUpdateCaches_.Clear();
     }
 
     /// Cached network attribute infos.
@@ -142,6 +158,20 @@ struct URHO3D_API NetworkState
     VariantMap previousVars_;
     /// Bitmask for intercepting network messages. Used on the client only.
     unsigned long long interceptMask_;
+    /// Serialized initial delta update without the timestamp, shared by all connections until the attribute values change.
+    PODVector<unsigned char> initialDeltaUpdateCache_;
+    /// Serialized latest data update without the timestamp.
+    PODVector<unsigned char> latestDataUpdateCache_;
+    /// Dirty attribute bits of the serialized delta updates.
+    Vector<DirtyBits> deltaUpdateCacheBits_;
+    /// Serialized delta updates without the timestamp, one for each set of dirty attribute bits.
+    Vector<PODVector<unsigned char> > deltaUpdateCaches_;
+    /// Initial delta update cached flag.
+    bool initialDeltaUpdateCached_;
+    /// Latest data update cached flag.
+    bool latestDataUpdateCached_;
+    /// Spinlock for accessing the cached updates when connections are updated in parallel.
+    int updateCacheLock_;
 };
 
 /// Base class for per-user network replication states.
@@ -28,12 +28,14 @@
 #include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../IO/PackageFile.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 #include "../Resource/XMLFile.h"
 #include "../Scene/Component.h"
 #include "../Scene/ObjectAnimation.h"
+#include "../Scene/Prefab.h"
 #include "../Scene/ReplicationState.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
@@ -47,6 +49,92 @@
 namespace Urho3D
 {
 
+/// Logic update parameters for worker threads.
+struct LogicUpdateParams
+{
+    /// Update phase.
+    LogicUpdatePhase phase_;
+    /// Timestep.
+    float timeStep_;
+};
+
+/// Component attribute data of a columnar scene, read in advance in a worker thread if the component type allows.
+struct ColumnarComponentData
+{
+    /// Component, or null if it could not be created.
+    Component* component_;
+    /// Attribute data.
+    const unsigned char* data_;
+    /// Attribute data size.
+    unsigned size_;
+    /// Whether the attribute values are read in a worker thread.
+    bool readAhead_;
+    /// Whether the attribute values were read successfully.
+    bool success_;
+    /// Attribute values read in advance.
+    Vector<Variant> values_;
+};
+
+void ReadComponentAttributesWork(const WorkItem* item, unsigned threadIndex)
+{
+    ColumnarComponentData* start = reinterpret_cast<ColumnarComponentData*>(item->start_);
+    ColumnarComponentData* end = reinterpret_cast<ColumnarComponentData*>(item->end_);
+
+    for (; start != end; ++start)
+    {
+        if (start->readAhead_)
+        {
+            MemoryBuffer buffer(start->data_, start->size_);
+            start->success_ = start->component_->ReadAttributeValues(buffer, start->values_);
+        }
+    }
+}
+
+void UpdateLogicComponentsWork(const WorkItem* item, unsigned threadIndex)
+{
+    const LogicUpdateParams& params = *(reinterpret_cast<LogicUpdateParams*>(item->aux_));
+    LogicComponent** start = reinterpret_cast<LogicComponent**>(item->start_);
+    LogicComponent** end = reinterpret_cast<LogicComponent**>(item->end_);
+
+    switch (params.phase_)
+    {
+    case LUP_UPDATE:
+        for (; start != end; ++start)
+        {
+            if (*start)
+                (*start)->Update(params.timeStep_);
+        }
+        break;
+
+    case LUP_POSTUPDATE:
+        for (; start != end; ++start)
+        {
+            if (*start)
+                (*start)->PostUpdate(params.timeStep_);
+        }
+        break;
+
+    case LUP_FIXEDUPDATE:
+        for (; start != end; ++start)
+        {
+            if (*start)
+                (*start)->FixedUpdate(params.timeStep_);
+        }
+        break;
+
+    case LUP_FIXEDPOSTUPDATE:
+        for (; start != end; ++start)
+        {
+            if (*start)
+                (*start)->FixedPostUpdate(params.timeStep_);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
 const char* SCENE_CATEGORY = "Scene";
 const char* LOGIC_CATEGORY = "Logic";
 const char* SUBSYSTEM_CATEGORY = "Subsystem";
@@ -61,6 +149,7 @@ Scene::Scene(Context* context) :
     localNodeID_(FIRST_LOCAL_ID),
     localComponentID_(FIRST_LOCAL_ID),
     checksum_(0),
+    logicUpdatePhases_(0),
     asyncLoadingMs_(5),
     timeScale_(1.0f),
     elapsedTime_(0),
@@ -86,9 +175,9 @@ Scene::~Scene()
     RemoveAllChildren();
 
     // Remove scene reference and owner from all nodes that still exist
-    for (HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+    for (FlatHashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
         i->second_->ResetScene();
-    for (HashMap<unsigned, Node*>::Iterator i = localNodes_.Begin(); i != localNodes_.End(); ++i)
+    for (FlatHashMap<unsigned, Node*>::Iterator i = localNodes_.Begin(); i != localNodes_.End(); ++i)
         i->second_->ResetScene();
 }
 
@@ -117,7 +206,8 @@ bool Scene::Load(Deserializer& source, bool setInstanceDefault)
     StopAsyncLoading();
 
     // Check ID
-    if (source.ReadFileID() != "USCN")
+    String fileID = source.ReadFileID();
+    if (fileID != "USCN" && fileID != "USCC")
     {
         URHO3D_LOGERROR(source.GetName() + " is not a valid scene file");
         return false;
@@ -127,6 +217,25 @@ bool Scene::Load(Deserializer& source, bool setInstanceDefault)
 
     Clear();
 
+    // Columnar scene: read the rest of the data into memory at once and load from there
+    if (fileID == "USCC")
+    {
+        PODVector<unsigned char> data(source.GetSize() - source.GetPosition());
+        if (data.Size() && source.Read(&data[0], data.Size()) != data.Size())
+        {
+            URHO3D_LOGERROR("Could not read scene data from " + source.GetName());
+            return false;
+        }
+
+        if (LoadColumnarContent(data.Size() ? &data[0] : 0, data.Size()))
+        {
+            FinishLoading(&source);
+            return true;
+        }
+        else
+            return false;
+    }
+
     // Load the whole scene, then perform post-load if successfully loaded
     if (Node::Load(source, setInstanceDefault))
     {
@@ -192,7 +301,7 @@ void Scene::AddReplicationState(NodeReplicationState* state)
     Node::AddReplicationState(state);
 
     // This is the first update for a new connection. Mark all replicated nodes dirty
-    for (HashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+    for (FlatHashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
         state->sceneState_->dirtyNodes_.Insert(i->first_);
 }
 
@@ -241,6 +350,203 @@ bool Scene::SaveXML(Serializer& dest, const String& indentation) const
         return false;
 }
 
+bool Scene::SaveColumnar(Serializer& dest) const
+{
+    URHO3D_PROFILE(SaveSceneColumnar);
+
+    // Write ID first
+    if (!dest.WriteFileID("USCC"))
+    {
+        URHO3D_LOGERROR("Could not save scene, writing to stream failed");
+        return false;
+    }
+
+    Deserializer* ptr = dynamic_cast<Deserializer*>(&dest);
+    if (ptr)
+        URHO3D_LOGINFO("Saving scene to " + ptr->GetName());
+
+    // Collect the persistent nodes breadth-first, so that parents precede their children. Index 0 is the scene itself
+    PODVector<const Node*> nodes;
+    PODVector<unsigned> parentIndices;
+    nodes.Push(this);
+    parentIndices.Push(0);
+    for (unsigned i = 0; i < nodes.Size(); ++i)
+    {
+        const Vector<SharedPtr<Node> >& children = nodes[i]->GetChildren();
+        for (unsigned j = 0; j < children.Size(); ++j)
+        {
+            if (children[j]->IsTemporary())
+                continue;
+            nodes.Push(children[j]);
+            parentIndices.Push(i);
+        }
+    }
+
+    // Collect the persistent components in their original order, grouped by type, and the resources they refer to
+    PODVector<StringHash> types;
+    HashMap<StringHash, unsigned> typeIndices;
+    Vector<PODVector<Component*> > typeComponents;
+    PODVector<unsigned> componentTypes;
+    PODVector<unsigned> componentNodes;
+    PODVector<Component*> components;
+    Vector<ResourceRef> resources;
+    HashSet<StringHash> resourceNames;
+
+    for (unsigned i = 0; i < nodes.Size(); ++i)
+    {
+        const Vector<SharedPtr<Component> >& nodeComponents = nodes[i]->GetComponents();
+        for (unsigned j = 0; j < nodeComponents.Size(); ++j)
+        {
+            Component* component = nodeComponents[j];
+            if (component->IsTemporary())
+                continue;
+
+            StringHash type = component->GetType();
+            HashMap<StringHash, unsigned>::ConstIterator k = typeIndices.Find(type);
+            unsigned typeIndex;
+            if (k != typeIndices.End())
+                typeIndex = k->second_;
+            else
+            {
+                typeIndex = types.Size();
+                typeIndices[type] = typeIndex;
+                types.Push(type);
+                typeComponents.Resize(types.Size());
+            }
+
+            typeComponents[typeIndex].Push(component);
+            componentTypes.Push(typeIndex);
+            componentNodes.Push(i);
+            components.Push(component);
+
+            const Vector<AttributeInfo>* attributes = component->GetAttributes();
+            if (!attributes)
+                continue;
+            for (unsigned k = 0; k < attributes->Size(); ++k)
+            {
+                const AttributeInfo& attr = attributes->At(k);
+                if (!(attr.mode_ & AM_FILE))
+                    continue;
+
+                if (attr.type_ == VAR_RESOURCEREF)
+                {
+                    ResourceRef ref = component->GetAttribute(k).GetResourceRef();
+                    if (!ref.name_.Empty() && !resourceNames.Contains(StringHash(ref.name_)))
+                    {
+                        resourceNames.Insert(StringHash(ref.name_));
+                        resources.Push(ref);
+                    }
+                }
+                else if (attr.type_ == VAR_RESOURCEREFLIST)
+                {
+                    ResourceRefList refList = component->GetAttribute(k).GetResourceRefList();
+                    for (unsigned l = 0; l < refList.names_.Size(); ++l)
+                    {
+                        const String& name = refList.names_[l];
+                        if (!name.Empty() && !resourceNames.Contains(StringHash(name)))
+                        {
+                            resourceNames.Insert(StringHash(name));
+                            resources.Push(ResourceRef(refList.type_, name));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Write own ID and the resource table
+    dest.WriteUInt(GetID());
+    dest.WriteVLE(resources.Size());
+    for (unsigned i = 0; i < resources.Size(); ++i)
+    {
+        dest.WriteStringHash(resources[i].type_);
+        dest.WriteString(resources[i].name_);
+    }
+
+    // Write own attributes, the node table and the node attributes
+    if (!Animatable::Save(dest))
+        return false;
+    dest.WriteVLE(nodes.Size() - 1);
+    for (unsigned i = 1; i < nodes.Size(); ++i)
+    {
+        dest.WriteUInt(nodes[i]->GetID());
+        dest.WriteVLE(parentIndices[i]);
+    }
+    for (unsigned i = 1; i < nodes.Size(); ++i)
+    {
+        if (!nodes[i]->Animatable::Save(dest))
+            return false;
+    }
+
+    // Write the component type table and the component table
+    dest.WriteVLE(types.Size());
+    for (unsigned i = 0; i < types.Size(); ++i)
+        dest.WriteStringHash(types[i]);
+    dest.WriteVLE(components.Size());
+    for (unsigned i = 0; i < components.Size(); ++i)
+    {
+        dest.WriteVLE(componentTypes[i]);
+        dest.WriteVLE(componentNodes[i]);
+        dest.WriteUInt(components[i]->GetID());
+    }
+
+    // Write the component attributes as one column per type. The type and ID written by Component::Save() are already
+    // in the component table, so leave them out
+    VectorBuffer column;
+    VectorBuffer compBuffer;
+    for (unsigned i = 0; i < types.Size(); ++i)
+    {
+        column.Clear();
+        const PODVector<Component*>& columnComponents = typeComponents[i];
+        for (unsigned j = 0; j < columnComponents.Size(); ++j)
+        {
+            compBuffer.Clear();
+            if (!columnComponents[j]->Save(compBuffer))
+                return false;
+            unsigned headerSize = sizeof(unsigned) * 2;
+            unsigned dataSize = compBuffer.GetSize() - headerSize;
+            column.WriteVLE(dataSize);
+            column.Write(compBuffer.GetData() + headerSize, dataSize);
+        }
+
+        dest.WriteVLE(column.GetSize());
+        if (dest.Write(column.GetData(), column.GetSize()) != column.GetSize())
+        {
+            URHO3D_LOGERROR("Could not save scene, writing to stream failed");
+            return false;
+        }
+    }
+
+    FinishSaving(&dest);
+    return true;
+}
+
+bool Scene::LoadColumnar(const void* data, unsigned size)
+{
+    URHO3D_PROFILE(LoadSceneColumnar);
+
+    StopAsyncLoading();
+
+    // Check ID
+    MemoryBuffer source(data, size);
+    if (source.ReadFileID() != "USCC")
+    {
+        URHO3D_LOGERROR("Not valid columnar scene data");
+        return false;
+    }
+
+    Clear();
+
+    unsigned offset = source.GetPosition();
+    if (LoadColumnarContent((const unsigned char*)data + offset, size - offset))
+    {
+        FinishLoading(0);
+        return true;
+    }
+    else
+        return false;
+}
+
 bool Scene::LoadAsync(File* file, LoadMode mode)
 {
     if (!file)
@@ -448,6 +754,35 @@ Node* Scene::InstantiateXML(Deserializer& source, const Vector3& position, const
     return InstantiateXML(xml->GetRoot(), position, rotation, mode);
 }
 
+Node* Scene::Instantiate(Prefab* prefab, const Vector3& position, const Quaternion& rotation, CreateMode mode)
+{
+    URHO3D_PROFILE(InstantiatePrefab);
+
+    SceneResolver resolver;
+    PODVector<Node*> nodes;
+    return InstantiatePrefab(prefab, position, rotation, mode, resolver, nodes);
+}
+
+void Scene::Instantiate(Prefab* prefab, const PODVector<Vector3>& positions, const PODVector<Quaternion>& rotations,
+    PODVector<Node*>& dest, CreateMode mode)
+{
+    URHO3D_PROFILE(InstantiatePrefabs);
+
+    dest.Clear();
+    dest.Reserve(positions.Size());
+
+    SceneResolver resolver;
+    PODVector<Node*> nodes;
+    for (unsigned i = 0; i < positions.Size(); ++i)
+    {
+        Node* node = InstantiatePrefab(prefab, positions[i], i < rotations.Size() ? rotations[i] : Quaternion::IDENTITY, mode,
+            resolver, nodes);
+        if (!node)
+            break;
+        dest.Push(node);
+    }
+}
+
 void Scene::Clear(bool clearReplicated, bool clearLocal)
 {
     StopAsyncLoading();
@@ -543,12 +878,12 @@ Node* Scene::GetNode(unsigned id) const
 {
     if (id < FIRST_LOCAL_ID)
     {
-        HashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Find(id);
+        FlatHashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Find(id);
         return i != replicatedNodes_.End() ? i->second_ : 0;
     }
     else
     {
-        HashMap<unsigned, Node*>::ConstIterator i = localNodes_.Find(id);
+        FlatHashMap<unsigned, Node*>::ConstIterator i = localNodes_.Find(id);
         return i != localNodes_.End() ? i->second_ : 0;
     }
 }
@@ -557,12 +892,12 @@ Component* Scene::GetComponent(unsigned id) const
 {
     if (id < FIRST_LOCAL_ID)
     {
-        HashMap<unsigned, Component*>::ConstIterator i = replicatedComponents_.Find(id);
+        FlatHashMap<unsigned, Component*>::ConstIterator i = replicatedComponents_.Find(id);
         return i != replicatedComponents_.End() ? i->second_ : 0;
     }
     else
     {
-        HashMap<unsigned, Component*>::ConstIterator i = localComponents_.Find(id);
+        FlatHashMap<unsigned, Component*>::ConstIterator i = localComponents_.Find(id);
         return i != localComponents_.End() ? i->second_ : 0;
     }
 }
@@ -602,6 +937,7 @@ void Scene::Update(float timeStep)
 
     // Update variable timestep logic
     SendEvent(E_SCENEUPDATE, eventData);
+    UpdateLogicComponents(LUP_UPDATE, timeStep);
 
     // Update scene attribute animation.
     SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
@@ -625,6 +961,7 @@ void Scene::Update(float timeStep)
 
     // Post-update variable timestep logic
     SendEvent(E_SCENEPOSTUPDATE, eventData);
+    UpdateLogicComponents(LUP_POSTUPDATE, timeStep);
 
     // Note: using a float for elapsed time accumulation is inherently inaccurate. The purpose of this value is
     // primarily to update material animation effects, as it is available to shaders. It can be reset by calling
@@ -662,6 +999,173 @@ void Scene::DelayedMarkedDirty(Component* component)
     delayedDirtyComponents_.Push(component);
 }
 
+void Scene::AddLogicComponent(LogicComponent* component, LogicUpdatePhase phase)
+{
+    if (!component || phase >= MAX_LOGIC_UPDATE_PHASES)
+        return;
+
+    StringHash type = component->GetType();
+    unsigned groupIndex;
+    HashMap<StringHash, unsigned>::ConstIterator i = logicGroupIndices_.Find(type);
+    if (i != logicGroupIndices_.End())
+        groupIndex = i->second_;
+    else
+    {
+        // Create the group for the new type in all phases
+        groupIndex = logicGroups_[0].Size();
+        logicGroupIndices_[type] = groupIndex;
+        bool threadSafe = component->IsUpdateThreadSafe();
+        for (unsigned j = 0; j < MAX_LOGIC_UPDATE_PHASES; ++j)
+        {
+            logicGroups_[j].Resize(groupIndex + 1);
+            logicGroups_[j][groupIndex].threadSafe_ = threadSafe;
+        }
+    }
+
+    PODVector<LogicComponent*>& components = logicGroups_[phase][groupIndex].components_;
+    component->updateIndices_[phase] = components.Size();
+    components.Push(component);
+}
+
+void Scene::RemoveLogicComponent(LogicComponent* component, LogicUpdatePhase phase)
+{
+    if (!component || phase >= MAX_LOGIC_UPDATE_PHASES)
+        return;
+
+    HashMap<StringHash, unsigned>::ConstIterator i = logicGroupIndices_.Find(component->GetType());
+    if (i == logicGroupIndices_.End())
+        return;
+
+    // Leave a hole so that an update in progress is not disturbed. The holes are removed at the start of the next update,
+    // or immediately if they make up over half of the list and the phase is not being updated, as some phases may not be
+    // updated at all (fixed update without a physics world, or scene update disabled)
+    LogicComponentGroup& group = logicGroups_[phase][i->second_];
+    unsigned index = component->updateIndices_[phase];
+    if (index < group.components_.Size() && group.components_[index] == component)
+    {
+        group.components_[index] = 0;
+        ++group.numHoles_;
+        if (group.numHoles_ > group.components_.Size() / 2 && !(logicUpdatePhases_ & (1 << phase)))
+            CompactLogicComponents(group, phase);
+    }
+    component->updateIndices_[phase] = M_MAX_UNSIGNED;
+}
+
+void Scene::UpdateLogicComponents(LogicUpdatePhase phase, float timeStep)
+{
+    if (phase >= MAX_LOGIC_UPDATE_PHASES)
+        return;
+
+    Vector<LogicComponentGroup>& groups = logicGroups_[phase];
+    if (groups.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdateLogicComponents);
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    logicUpdatePhases_ |= 1 << phase;
+
+    // Note: components may be added and groups created during the update, so the groups and components are always accessed
+    // by index. Components added during the update are not updated until the next time
+    for (unsigned i = 0; i < groups.Size(); ++i)
+    {
+        if (groups[i].numHoles_)
+            CompactLogicComponents(groups[i], phase);
+
+        unsigned numComponents = groups[i].components_.Size();
+        if (!numComponents)
+            continue;
+
+        if (groups[i].threadSafe_ && numComponents > 1 && queue->GetNumThreads())
+        {
+            // Call DelayedStart() for new components in the main thread first
+            if (phase == LUP_UPDATE)
+            {
+                for (unsigned j = 0; j < numComponents; ++j)
+                {
+                    LogicComponent* component = groups[i].components_[j];
+                    if (component && !component->delayedStartCalled_)
+                        component->PerformDelayedStart();
+                }
+            }
+
+            // Components can not be added from worker threads, so the component array stays in place during the update
+            LogicUpdateParams params;
+            params.phase_ = phase;
+            params.timeStep_ = timeStep;
+
+            BeginThreadedUpdate();
+
+            int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
+            int componentsPerItem = Max((int)(numComponents / numWorkItems), 1);
+
+            PODVector<LogicComponent*>::Iterator start = groups[i].components_.Begin();
+            PODVector<LogicComponent*>::Iterator end = start + numComponents;
+            for (int j = 0; j < numWorkItems && start != end; ++j)
+            {
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = UpdateLogicComponentsWork;
+                item->aux_ = &params;
+
+                PODVector<LogicComponent*>::Iterator itemEnd = end;
+                if (j < numWorkItems - 1 && itemEnd - start > componentsPerItem)
+                    itemEnd = start + componentsPerItem;
+
+                item->start_ = &(*start);
+                item->end_ = &(*itemEnd);
+                queue->AddWorkItem(item);
+
+                start = itemEnd;
+            }
+
+            queue->Complete(M_MAX_UNSIGNED);
+            EndThreadedUpdate();
+        }
+        else
+        {
+            for (unsigned j = 0; j < numComponents; ++j)
+            {
+                LogicComponent* component = groups[i].components_[j];
+                if (!component)
+                    continue;
+
+                switch (phase)
+                {
+                case LUP_UPDATE:
+                    // Execute user-defined delayed start function before first update
+                    if (!component->delayedStartCalled_)
+                    {
+                        component->PerformDelayedStart();
+                        // The component may have been removed from updates as a result
+                        if (groups[i].components_[j] != component)
+                            break;
+                    }
+                    component->Update(timeStep);
+                    break;
+
+                case LUP_POSTUPDATE:
+                    component->PostUpdate(timeStep);
+                    break;
+
+                case LUP_FIXEDUPDATE:
+                    component->FixedUpdate(timeStep);
+                    break;
+
+                case LUP_FIXEDPOSTUPDATE:
+                    component->FixedPostUpdate(timeStep);
+                    break;
+
+                default:
+                    break;
+                }
+            }
+        }
+    }
+
+    logicUpdatePhases_ &= ~(1 << phase);
+}
+
 unsigned Scene::GetFreeNodeID(CreateMode mode)
 {
     if (mode == REPLICATED)
@@ -749,7 +1253,7 @@ void Scene::NodeAdded(Node* node)
     // If node with same ID exists, remove the scene reference from it and overwrite with the new node
     if (id < FIRST_LOCAL_ID)
     {
-        HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Find(id);
+        FlatHashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Find(id);
         if (i != replicatedNodes_.End() && i->second_ != node)
         {
             URHO3D_LOGWARNING("Overwriting node with ID " + String(id));
@@ -763,7 +1267,7 @@ void Scene::NodeAdded(Node* node)
     }
     else
     {
-        HashMap<unsigned, Node*>::Iterator i = localNodes_.Find(id);
+        FlatHashMap<unsigned, Node*>::Iterator i = localNodes_.Find(id);
         if (i != localNodes_.End() && i->second_ != node)
         {
             URHO3D_LOGWARNING("Overwriting node with ID " + String(id));
@@ -822,7 +1326,7 @@ void Scene::ComponentAdded(Component* component)
 
     if (id < FIRST_LOCAL_ID)
     {
-        HashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Find(id);
+        FlatHashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Find(id);
         if (i != replicatedComponents_.End() && i->second_ != component)
         {
             URHO3D_LOGWARNING("Overwriting component with ID " + String(id));
@@ -833,7 +1337,7 @@ void Scene::ComponentAdded(Component* component)
     }
     else
     {
-        HashMap<unsigned, Component*>::Iterator i = localComponents_.Find(id);
+        FlatHashMap<unsigned, Component*>::Iterator i = localComponents_.Find(id);
         if (i != localComponents_.End() && i->second_ != component)
         {
             URHO3D_LOGWARNING("Overwriting component with ID " + String(id));
@@ -909,10 +1413,10 @@ void Scene::CleanupConnection(Connection* connection)
 {
     Node::CleanupConnection(connection);
 
-    for (HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+    for (FlatHashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
         i->second_->CleanupConnection(connection);
 
-    for (HashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Begin(); i != replicatedComponents_.End(); ++i)
+    for (FlatHashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Begin(); i != replicatedComponents_.End(); ++i)
         i->second_->CleanupConnection(connection);
 }
 
@@ -1075,6 +1579,231 @@ void Scene::FinishSaving(Serializer* dest) const
     }
 }
 
+Node* Scene::InstantiatePrefab(Prefab* prefab, const Vector3& position, const Quaternion& rotation, CreateMode mode,
+    SceneResolver& resolver, PODVector<Node*>& nodes)
+{
+    if (!prefab || !prefab->GetNumNodes())
+    {
+        URHO3D_LOGERROR("Null or empty prefab for instantiation");
+        return 0;
+    }
+
+    const PODVector<PrefabObject>& prefabNodes = prefab->GetNodes();
+    const PODVector<PrefabObject>& prefabComponents = prefab->GetComponents();
+    resolver.Reset();
+    nodes.Resize(prefabNodes.Size());
+
+    // Create the nodes and components in the same order as Node::Load() would, rewriting IDs
+    unsigned componentIndex = 0;
+    for (unsigned i = 0; i < prefabNodes.Size(); ++i)
+    {
+        const PrefabObject& prefabNode = prefabNodes[i];
+        Node* node = i ? nodes[prefabNode.parent_]->CreateChild(0, (mode == REPLICATED && prefabNode.id_ < FIRST_LOCAL_ID) ?
+            REPLICATED : LOCAL) : CreateChild(0, mode);
+        nodes[i] = node;
+        resolver.AddNode(prefabNode.id_, node);
+
+        MemoryBuffer nodeBuffer(prefab->GetData(prefabNode), prefabNode.dataSize_);
+        if (!node->Animatable::Load(nodeBuffer))
+        {
+            nodes[0]->Remove();
+            return 0;
+        }
+
+        while (componentIndex < prefabComponents.Size() && prefabComponents[componentIndex].parent_ == i)
+        {
+            const PrefabObject& prefabComponent = prefabComponents[componentIndex++];
+            Component* newComponent = node->SafeCreateComponent(String::EMPTY, prefabComponent.type_,
+                (mode == REPLICATED && prefabComponent.id_ < FIRST_LOCAL_ID) ? REPLICATED : LOCAL, 0);
+            if (newComponent)
+            {
+                resolver.AddComponent(prefabComponent.id_, newComponent);
+                // Do not abort if component fails to load, as its data is separate
+                MemoryBuffer compBuffer(prefab->GetData(prefabComponent), prefabComponent.dataSize_);
+                newComponent->Load(compBuffer);
+            }
+        }
+    }
+
+    Node* node = nodes[0];
+    resolver.Resolve();
+    node->ApplyAttributes();
+    node->SetTransform(position, rotation);
+    return node;
+}
+
+bool Scene::LoadColumnarContent(const unsigned char* data, unsigned size)
+{
+    MemoryBuffer source(data, size);
+
+    // Read own ID (not needed, as all IDs are stored already resolved)
+    /*unsigned nodeID = */source.ReadUInt();
+
+    // Queue the listed resources for background loading first, so that they load in the worker threads while the scene
+    // content is being created. Attributes that request a resource still being loaded will wait for it to finish
+#ifdef URHO3D_THREADING
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+#endif
+    unsigned numResources = source.ReadVLE();
+    for (unsigned i = 0; i < numResources; ++i)
+    {
+        StringHash type = source.ReadStringHash();
+        String name = source.ReadString();
+#ifdef URHO3D_THREADING
+        if (cache)
+            cache->BackgroundLoadResource(type, cache->SanitateResourceName(name));
+#endif
+    }
+
+    // Read own attributes
+    if (!Animatable::Load(source))
+        return false;
+
+    // Create the child nodes from the node table. Parents precede their children, and index 0 refers to the scene
+    unsigned numNodes = source.ReadVLE();
+    PODVector<Node*> nodes(numNodes + 1);
+    nodes[0] = this;
+    for (unsigned i = 1; i <= numNodes; ++i)
+    {
+        unsigned nodeID = source.ReadUInt();
+        unsigned parentIndex = source.ReadVLE();
+        if (parentIndex >= i)
+        {
+            URHO3D_LOGERROR("Invalid parent node index in scene data");
+            return false;
+        }
+
+        nodes[i] = nodes[parentIndex]->CreateChild(nodeID, nodeID < FIRST_LOCAL_ID ? REPLICATED : LOCAL);
+    }
+
+    // Read the node attributes
+    for (unsigned i = 1; i <= numNodes; ++i)
+    {
+        if (!nodes[i]->Animatable::Load(source))
+            return false;
+    }
+
+    // Create the components in their original order, collecting them by type for reading the attribute columns
+    unsigned numTypes = source.ReadVLE();
+    PODVector<StringHash> types(numTypes);
+    for (unsigned i = 0; i < numTypes; ++i)
+        types[i] = source.ReadStringHash();
+
+    Vector<PODVector<Component*> > typeComponents(numTypes);
+    unsigned numComponents = source.ReadVLE();
+    for (unsigned i = 0; i < numComponents; ++i)
+    {
+        unsigned typeIndex = source.ReadVLE();
+        unsigned nodeIndex = source.ReadVLE();
+        unsigned compID = source.ReadUInt();
+        if (typeIndex >= numTypes || nodeIndex > numNodes)
+        {
+            URHO3D_LOGERROR("Invalid component table entry in scene data");
+            return false;
+        }
+
+        typeComponents[typeIndex].Push(nodes[nodeIndex]->SafeCreateComponent(String::EMPTY, types[typeIndex],
+            compID < FIRST_LOCAL_ID ? REPLICATED : LOCAL, compID));
+    }
+
+    // Locate the attribute data of each component in the attribute columns. Reading the values in advance only pays off
+    // when there are worker threads to share the work, otherwise each component loads directly from its data
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    bool readAhead = queue && queue->GetNumThreads();
+    Vector<ColumnarComponentData> componentData(numComponents);
+    unsigned numReadAhead = 0;
+    unsigned index = 0;
+    for (unsigned i = 0; i < numTypes; ++i)
+    {
+        unsigned columnSize = source.ReadVLE();
+        unsigned columnEnd = source.GetPosition() + columnSize;
+        if (columnEnd > size)
+        {
+            URHO3D_LOGERROR("Truncated component data in scene data");
+            return false;
+        }
+
+        const PODVector<Component*>& columnComponents = typeComponents[i];
+        for (unsigned j = 0; j < columnComponents.Size(); ++j)
+        {
+            unsigned dataSize = source.ReadVLE();
+            unsigned dataStart = source.GetPosition();
+            if (dataStart + dataSize > columnEnd)
+            {
+                URHO3D_LOGERROR("Truncated component data in scene data");
+                return false;
+            }
+
+            ColumnarComponentData& compData = componentData[index++];
+            compData.component_ = columnComponents[j];
+            compData.data_ = data + dataStart;
+            compData.size_ = dataSize;
+            compData.readAhead_ = readAhead && compData.component_ && compData.component_->IsLoadThreadSafe();
+            compData.success_ = false;
+            if (compData.readAhead_)
+                ++numReadAhead;
+
+            source.Seek(dataStart + dataSize);
+        }
+
+        source.Seek(columnEnd);
+    }
+
+    // Read the attribute values of the component types that allow it in worker threads. Creating the components and
+    // applying the values stays in the main thread
+    if (numReadAhead)
+    {
+        URHO3D_PROFILE(ReadComponentAttributes);
+
+        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
+        int componentsPerItem = Max((int)(index / numWorkItems), 1);
+
+        Vector<ColumnarComponentData>::Iterator start = componentData.Begin();
+        Vector<ColumnarComponentData>::Iterator end = start + index;
+        for (int i = 0; i < numWorkItems && start != end; ++i)
+        {
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = ReadComponentAttributesWork;
+
+            Vector<ColumnarComponentData>::Iterator itemEnd = end;
+            if (i < numWorkItems - 1 && itemEnd - start > componentsPerItem)
+                itemEnd = start + componentsPerItem;
+
+            item->start_ = &(*start);
+            item->end_ = &(*itemEnd);
+            queue->AddWorkItem(item);
+
+            start = itemEnd;
+        }
+
+        queue->Complete(M_MAX_UNSIGNED);
+    }
+
+    // Apply the attributes in the original order. As the data sizes are known, do not abort if a component fails to load
+    for (unsigned i = 0; i < index; ++i)
+    {
+        ColumnarComponentData& compData = componentData[i];
+        if (!compData.component_)
+            continue;
+
+        if (compData.readAhead_)
+        {
+            compData.component_->LoadAttributeValues(compData.values_);
+            if (!compData.success_)
+                URHO3D_LOGERROR("Could not load " + compData.component_->GetTypeName() + ", stream not open or at end");
+        }
+        else
+        {
+            MemoryBuffer compBuffer(compData.data_, compData.size_);
+            compData.component_->Load(compBuffer);
+        }
+    }
+
+    ApplyAttributes();
+    return true;
+}
+
 void Scene::PreloadResources(File* file, bool isSceneFile)
 {
     // If not threaded, can not background load resources, so rather load synchronously later when needed
@@ -1231,11 +1960,29 @@ void Scene::PreloadResourcesXML(const XMLElement& element)
 #endif
 }
 
+void Scene::CompactLogicComponents(LogicComponentGroup& group, LogicUpdatePhase phase)
+{
+    PODVector<LogicComponent*>& components = group.components_;
+    unsigned dest = 0;
+    for (unsigned i = 0; i < components.Size(); ++i)
+    {
+        LogicComponent* component = components[i];
+        if (component)
+        {
+            component->updateIndices_[phase] = dest;
+            components[dest++] = component;
+        }
+    }
+    components.Resize(dest);
+    group.numHoles_ = 0;
+}
+
 void RegisterSceneLibrary(Context* context)
 {
     ValueAnimation::RegisterObject(context);
     ObjectAnimation::RegisterObject(context);
     Node::RegisterObject(context);
+    Prefab::RegisterObject(context);
     Scene::RegisterObject(context);
     SmoothedTransform::RegisterObject(context);
     UnknownComponent::RegisterObject(context);
@@ -22,9 +22,11 @@
 
 #pragma once
 
+#include "../Container/FlatHashMap.h"
 #include "../Container/HashSet.h"
 #include "../Core/Mutex.h"
 #include "../Resource/XMLElement.h"
+#include "../Scene/LogicComponent.h"
 #include "../Scene/Node.h"
 #include "../Scene/SceneResolver.h"
 
@@ -33,6 +35,7 @@ namespace Urho3D
 
 class File;
 class PackageFile;
+class Prefab;
 
 static const unsigned FIRST_REPLICATED_ID = 0x1;
 static const unsigned LAST_REPLICATED_ID = 0xffffff;
@@ -104,6 +107,10 @@ public:
     bool LoadXML(Deserializer& source);
     /// Save to an XML file. Return true if successful.
     bool SaveXML(Serializer& dest, const String& indentation = "\t") const;
+    /// Save to the columnar binary format, which stores nodes and components in tables with the component attributes grouped by type, and lists the used resources up front. Can be loaded with Load(). Return true if successful.
+    bool SaveColumnar(Serializer& dest) const;
+    /// Load from columnar binary data in memory, for example a memory-mapped file. Removes all existing child nodes and components first. Return true if successful.
+    bool LoadColumnar(const void* data, unsigned size);
     /// Load from a binary file asynchronously. Return true if started successfully. The LOAD_RESOURCES_ONLY mode can also be used to preload resources from object prefab files.
     bool LoadAsync(File* file, LoadMode mode = LOAD_SCENE_AND_RESOURCES);
     /// Load from an XML file asynchronously. Return true if started successfully. The LOAD_RESOURCES_ONLY mode can also be used to preload resources from object prefab files.
@@ -117,6 +124,11 @@ public:
         (const XMLElement& source, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED);
     /// Instantiate scene content from XML data. Return root node if successful.
     Node* InstantiateXML(Deserializer& source, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED);
+    /// Instantiate scene content from a prefab. Return root node if successful.
+    Node* Instantiate(Prefab* prefab, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED);
+    /// Instantiate scene content from a prefab once for each position, reusing the working buffers between instances. Rotations not specified default to identity. Return the root nodes of the successful instances.
+    void Instantiate(Prefab* prefab, const PODVector<Vector3>& positions, const PODVector<Quaternion>& rotations,
+        PODVector<Node*>& dest, CreateMode mode = REPLICATED);
     /// Clear scene completely of either replicated, local or all nodes and components.
     void Clear(bool clearReplicated = true, bool clearLocal = true);
     /// Enable or disable scene update.
@@ -194,6 +206,12 @@ public:
     void EndThreadedUpdate();
     /// Add a component to the delayed dirty notify queue. Is thread-safe.
     void DelayedMarkedDirty(Component* component);
+    /// Add a logic component to the update list of a phase. Called by LogicComponent.
+    void AddLogicComponent(LogicComponent* component, LogicUpdatePhase phase);
+    /// Remove a logic component from the update list of a phase. Called by LogicComponent.
+    void RemoveLogicComponent(LogicComponent* component, LogicUpdatePhase phase);
+    /// Call the update function of a phase for all logic components, grouped by type. Thread-safe types are updated in worker threads. Called by Update and PhysicsWorld.
+    void UpdateLogicComponents(LogicUpdatePhase phase, float timeStep);
 
     /// Return threaded update flag.
     bool IsThreadedUpdate() const { return threadedUpdate_; }
@@ -238,19 +256,26 @@ private:
     void FinishLoading(Deserializer* source);
     /// Finish saving. Sets the scene filename and checksum.
     void FinishSaving(Serializer* dest) const;
+    /// Instantiate a prefab using the given ID resolver and node buffer.
+    Node* InstantiatePrefab(Prefab* prefab, const Vector3& position, const Quaternion& rotation, CreateMode mode,
+        SceneResolver& resolver, PODVector<Node*>& nodes);
+    /// Load columnar binary scene content following the file identifier.
+    bool LoadColumnarContent(const unsigned char* data, unsigned size);
     /// Preload resources from a binary scene or object prefab file.
     void PreloadResources(File* file, bool isSceneFile);
     /// Preload resources from an XML scene or object prefab file.
     void PreloadResourcesXML(const XMLElement& element);
+    /// Remove the null holes left by removed components from a logic component group.
+    void CompactLogicComponents(LogicComponentGroup& group, LogicUpdatePhase phase);
 
     /// Replicated scene nodes by ID.
-    HashMap<unsigned, Node*> replicatedNodes_;
+    FlatHashMap<unsigned, Node*> replicatedNodes_;
     /// Local scene nodes by ID.
-    HashMap<unsigned, Node*> localNodes_;
+    FlatHashMap<unsigned, Node*> localNodes_;
     /// Replicated components by ID.
-    HashMap<unsigned, Component*> replicatedComponents_;
+    FlatHashMap<unsigned, Component*> replicatedComponents_;
     /// Local components by ID.
-    HashMap<unsigned, Component*> localComponents_;
+    FlatHashMap<unsigned, Component*> localComponents_;
     /// Asynchronous loading progress.
     AsyncProgress asyncProgress_;
     /// Node and component ID resolver for asynchronous loading.
@@ -267,6 +292,10 @@ private:
     HashSet<unsigned> networkUpdateComponents_;
     /// Delayed dirty notification queue for components.
     PODVector<Component*> delayedDirtyComponents_;
+    /// Logic components grouped by type for each update phase. The group index of a type is the same in each phase.
+    Vector<LogicComponentGroup> logicGroups_[MAX_LOGIC_UPDATE_PHASES];
+    /// Logic component group indices by type.
+    HashMap<StringHash, unsigned> logicGroupIndices_;
     /// Mutex for the delayed dirty notification queue.
     Mutex sceneMutex_;
     /// Preallocated event data map for smoothing update events.
@@ -281,6 +310,8 @@ private:
     unsigned localComponentID_;
     /// Scene source file checksum.
     mutable unsigned checksum_;
+    /// Bitmask of logic update phases currently in progress.
+    unsigned logicUpdatePhases_;
     /// Maximum milliseconds per frame to spend on async scene loading.
     int asyncLoadingMs_;
     /// Scene update time scale.
@@ -26,11 +26,14 @@
 #include "../IO/Deserializer.h"
 #include "../IO/Log.h"
 #include "../IO/Serializer.h"
+#include "../IO/VectorBuffer.h"
 #include "../Resource/XMLElement.h"
 #include "../Scene/ReplicationState.h"
 #include "../Scene/SceneEvents.h"
 #include "../Scene/Serializable.h"
 
+#include <SDL/SDL_atomic.h>
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -266,6 +269,178 @@ void Serializable::OnGetAttribute(const AttributeInfo& attr, Variant& dest) cons
     }
 }
 
+bool Serializable::LoadAttributeDirect(const AttributeInfo& attr, Deserializer& source)
+{
+    // Check for accessor function mode
+    if (attr.accessor_)
+        return attr.accessor_->Read(this, source);
+
+    // Calculate the destination address
+    void* dest = attr.ptr_ ? attr.ptr_ : reinterpret_cast<unsigned char*>(this) + attr.offset_;
+
+    switch (attr.type_)
+    {
+    case VAR_INT:
+        // If enum type, use the low 8 bits only
+        if (attr.enumNames_)
+            *(reinterpret_cast<unsigned char*>(dest)) = source.ReadInt();
+        else
+            ReadAttributeValue(source, *(reinterpret_cast<int*>(dest)));
+        break;
+
+    case VAR_BOOL:
+        ReadAttributeValue(source, *(reinterpret_cast<bool*>(dest)));
+        break;
+
+    case VAR_FLOAT:
+        ReadAttributeValue(source, *(reinterpret_cast<float*>(dest)));
+        break;
+
+    case VAR_VECTOR2:
+        ReadAttributeValue(source, *(reinterpret_cast<Vector2*>(dest)));
+        break;
+
+    case VAR_VECTOR3:
+        ReadAttributeValue(source, *(reinterpret_cast<Vector3*>(dest)));
+        break;
+
+    case VAR_VECTOR4:
+        ReadAttributeValue(source, *(reinterpret_cast<Vector4*>(dest)));
+        break;
+
+    case VAR_QUATERNION:
+        ReadAttributeValue(source, *(reinterpret_cast<Quaternion*>(dest)));
+        break;
+
+    case VAR_COLOR:
+        ReadAttributeValue(source, *(reinterpret_cast<Color*>(dest)));
+        break;
+
+    case VAR_STRING:
+        ReadAttributeValue(source, *(reinterpret_cast<String*>(dest)));
+        break;
+
+    case VAR_BUFFER:
+        ReadAttributeValue(source, *(reinterpret_cast<PODVector<unsigned char>*>(dest)));
+        break;
+
+    case VAR_RESOURCEREF:
+        ReadAttributeValue(source, *(reinterpret_cast<ResourceRef*>(dest)));
+        break;
+
+    case VAR_RESOURCEREFLIST:
+        ReadAttributeValue(source, *(reinterpret_cast<ResourceRefList*>(dest)));
+        break;
+
+    case VAR_VARIANTVECTOR:
+        ReadAttributeValue(source, *(reinterpret_cast<VariantVector*>(dest)));
+        break;
+
+    case VAR_STRINGVECTOR:
+        ReadAttributeValue(source, *(reinterpret_cast<StringVector*>(dest)));
+        break;
+
+    case VAR_VARIANTMAP:
+        ReadAttributeValue(source, *(reinterpret_cast<VariantMap*>(dest)));
+        break;
+
+    case VAR_INTRECT:
+        ReadAttributeValue(source, *(reinterpret_cast<IntRect*>(dest)));
+        break;
+
+    case VAR_INTVECTOR2:
+        ReadAttributeValue(source, *(reinterpret_cast<IntVector2*>(dest)));
+        break;
+
+    case VAR_DOUBLE:
+        ReadAttributeValue(source, *(reinterpret_cast<double*>(dest)));
+        break;
+
+    default:
+        return false;
+    }
+
+    // If it is a network attribute then mark it for next network update
+    if (attr.mode_ & AM_NET)
+        MarkNetworkUpdate();
+
+    return true;
+}
+
+bool Serializable::SaveAttributeDirect(const AttributeInfo& attr, Serializer& dest) const
+{
+    // Check for accessor function mode
+    if (attr.accessor_)
+        return attr.accessor_->Write(this, dest);
+
+    // Calculate the source address
+    const void* src = attr.ptr_ ? attr.ptr_ : reinterpret_cast<const unsigned char*>(this) + attr.offset_;
+
+    switch (attr.type_)
+    {
+    case VAR_INT:
+        // If enum type, use the low 8 bits only
+        if (attr.enumNames_)
+            return dest.WriteInt(*(reinterpret_cast<const unsigned char*>(src)));
+        else
+            return WriteAttributeValue(dest, *(reinterpret_cast<const int*>(src)));
+
+    case VAR_BOOL:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const bool*>(src)));
+
+    case VAR_FLOAT:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const float*>(src)));
+
+    case VAR_VECTOR2:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const Vector2*>(src)));
+
+    case VAR_VECTOR3:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const Vector3*>(src)));
+
+    case VAR_VECTOR4:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const Vector4*>(src)));
+
+    case VAR_QUATERNION:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const Quaternion*>(src)));
+
+    case VAR_COLOR:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const Color*>(src)));
+
+    case VAR_STRING:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const String*>(src)));
+
+    case VAR_BUFFER:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const PODVector<unsigned char>*>(src)));
+
+    case VAR_RESOURCEREF:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const ResourceRef*>(src)));
+
+    case VAR_RESOURCEREFLIST:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const ResourceRefList*>(src)));
+
+    case VAR_VARIANTVECTOR:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const VariantVector*>(src)));
+
+    case VAR_STRINGVECTOR:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const StringVector*>(src)));
+
+    case VAR_VARIANTMAP:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const VariantMap*>(src)));
+
+    case VAR_INTRECT:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const IntRect*>(src)));
+
+    case VAR_INTVECTOR2:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const IntVector2*>(src)));
+
+    case VAR_DOUBLE:
+        return WriteAttributeValue(dest, *(reinterpret_cast<const double*>(src)));
+
+    default:
+        return false;
+    }
+}
+
 const Vector<AttributeInfo>* Serializable::GetAttributes() const
 {
     return context_->GetAttributes(GetType());
@@ -294,6 +469,10 @@ bool Serializable::Load(Deserializer& source, bool setInstanceDefault)
             return false;
         }
 
+        // Read the value directly without an intermediate Variant if possible, unless it needs to be stored as the default
+        if (!setInstanceDefault && OnLoadAttribute(attr, source))
+            continue;
+
         Variant varValue = source.ReadVariant(attr.type_);
         OnSetAttribute(attr, varValue);
 
@@ -304,6 +483,57 @@ bool Serializable::Load(Deserializer& source, bool setInstanceDefault)
     return true;
 }
 
+bool Serializable::ReadAttributeValues(Deserializer& source, Vector<Variant>& dest) const
+{
+    dest.Clear();
+
+    const Vector<AttributeInfo>* attributes = GetAttributes();
+    if (!attributes)
+        return true;
+
+    // Reserve for all attributes up front, as the vector would otherwise copy the already read values when growing
+    dest.Reserve(attributes->Size());
+
+    for (unsigned i = 0; i < attributes->Size(); ++i)
+    {
+        const AttributeInfo& attr = attributes->At(i);
+        if (!(attr.mode_ & AM_FILE))
+            continue;
+
+        if (source.IsEof())
+            return false;
+
+        dest.Push(source.ReadVariant(attr.type_));
+    }
+
+    return true;
+}
+
+bool Serializable::LoadAttributeValues(const Vector<Variant>& values)
+{
+    const Vector<AttributeInfo>* attributes = GetAttributes();
+    if (!attributes)
+        return true;
+
+    unsigned index = 0;
+    for (unsigned i = 0; i < attributes->Size(); ++i)
+    {
+        const AttributeInfo& attr = attributes->At(i);
+        if (!(attr.mode_ & AM_FILE))
+            continue;
+
+        if (index >= values.Size())
+        {
+            URHO3D_LOGERROR("Could not load " + GetTypeName() + ", stream not open or at end");
+            return false;
+        }
+
+        OnSetAttribute(attr, values[index++]);
+    }
+
+    return true;
+}
+
 bool Serializable::Save(Serializer& dest) const
 {
     const Vector<AttributeInfo>* attributes = GetAttributes();
@@ -318,6 +548,10 @@ bool Serializable::Save(Serializer& dest) const
         if (!(attr.mode_ & AM_FILE))
             continue;
 
+        // Write the value directly without an intermediate Variant if possible
+        if (OnSaveAttribute(attr, dest))
+            continue;
+
         OnGetAttribute(attr, value);
 
         if (!dest.WriteVariantData(value))
@@ -600,25 +834,42 @@ void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeS
         return;
 
     unsigned numAttributes = attributes->Size();
-    DirtyBits attributeBits;
 
-    // Compare against defaults
-    for (unsigned i = 0; i < numAttributes; ++i)
+    // The attribute data is the same for all connections until the values change, so serialize it only once
+    SDL_AtomicLock(&networkState_->updateCacheLock_);
+
+    if (!networkState_->initialDeltaUpdateCached_)
     {
-        const AttributeInfo& attr = attributes->At(i);
-        if (networkState_->currentValues_[i] != attr.defaultValue_)
-            attributeBits.Set(i);
+        DirtyBits attributeBits;
+
+        // Compare against defaults
+        for (unsigned i = 0; i < numAttributes; ++i)
+        {
+            const AttributeInfo& attr = attributes->At(i);
+            if (networkState_->currentValues_[i] != attr.defaultValue_)
+                attributeBits.Set(i);
+        }
+
+        // First write the change bitfield, then attribute data for non-default attributes
+        VectorBuffer buffer;
+        buffer.Write(attributeBits.data_, (numAttributes + 7) >> 3);
+
+        for (unsigned i = 0; i < numAttributes; ++i)
+        {
+            if (attributeBits.IsSet(i))
+                buffer.WriteVariantData(networkState_->currentValues_[i]);
+        }
+
+        networkState_->initialDeltaUpdateCache_ = buffer.GetBuffer();
+        networkState_->initialDeltaUpdateCached_ = true;
     }
 
-    // First write the change bitfield, then attribute data for non-default attributes
+    const PODVector<unsigned char>& data = networkState_->initialDeltaUpdateCache_;
     dest.WriteUByte(timeStamp);
-    dest.Write(attributeBits.data_, (numAttributes + 7) >> 3);
+    if (data.Size())
+        dest.Write(&data[0], data.Size());
 
-    for (unsigned i = 0; i < numAttributes; ++i)
-    {
-        if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
-    }
+    SDL_AtomicUnlock(&networkState_->updateCacheLock_);
 }
 
 void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp)
@@ -635,16 +886,45 @@ void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attribute
 
     unsigned numAttributes = attributes->Size();
 
-    // First write the change bitfield, then attribute data for changed attributes
-    // Note: the attribute bits should not contain LATESTDATA attributes
-    dest.WriteUByte(timeStamp);
-    dest.Write(attributeBits.data_, (numAttributes + 7) >> 3);
+    // Connections with the same dirty bits receive the same data, so serialize it only once for each set of bits
+    SDL_AtomicLock(&networkState_->updateCacheLock_);
+
+    Vector<DirtyBits>& cacheBits = networkState_->deltaUpdateCacheBits_;
+    Vector<PODVector<unsigned char> >& caches = networkState_->deltaUpdateCaches_;
+    unsigned index = 0;
+    while (index < cacheBits.Size() && !(cacheBits[index] == attributeBits))
+        ++index;
 
-    for (unsigned i = 0; i < numAttributes; ++i)
+    if (index == cacheBits.Size())
     {
-        if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+        // First write the change bitfield, then attribute data for changed attributes
+        // Note: the attribute bits should not contain LATESTDATA attributes
+        VectorBuffer buffer;
+        buffer.Write(attributeBits.data_, (numAttributes + 7) >> 3);
+
+        for (unsigned i = 0; i < numAttributes; ++i)
+        {
+            if (attributeBits.IsSet(i))
+                buffer.WriteVariantData(networkState_->currentValues_[i]);
+        }
+
+        if (cacheBits.Size() >= MAX_CACHED_DELTA_UPDATES)
+        {
+            cacheBits.Erase(0);
+            caches.Erase(0);
+        }
+
+        cacheBits.Push(attributeBits);
+        caches.Push(buffer.GetBuffer());
+        index = cacheBits.Size() - 1;
     }
+
+    const PODVector<unsigned char>& data = caches[index];
+    dest.WriteUByte(timeStamp);
+    if (data.Size())
+        dest.Write(&data[0], data.Size());
+
+    SDL_AtomicUnlock(&networkState_->updateCacheLock_);
 }
 
 void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp)
@@ -661,13 +941,28 @@ void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeSta
 
     unsigned numAttributes = attributes->Size();
 
-    dest.WriteUByte(timeStamp);
+    SDL_AtomicLock(&networkState_->updateCacheLock_);
 
-    for (unsigned i = 0; i < numAttributes; ++i)
+    if (!networkState_->latestDataUpdateCached_)
     {
-        if (attributes->At(i).mode_ & AM_LATESTDATA)
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+        VectorBuffer buffer;
+
+        for (unsigned i = 0; i < numAttributes; ++i)
+        {
+            if (attributes->At(i).mode_ & AM_LATESTDATA)
+                buffer.WriteVariantData(networkState_->currentValues_[i]);
+        }
+
+        networkState_->latestDataUpdateCache_ = buffer.GetBuffer();
+        networkState_->latestDataUpdateCached_ = true;
     }
+
+    const PODVector<unsigned char>& data = networkState_->latestDataUpdateCache_;
+    dest.WriteUByte(timeStamp);
+    if (data.Size())
+        dest.Write(&data[0], data.Size());
+
+    SDL_AtomicUnlock(&networkState_->updateCacheLock_);
 }
 
 bool Serializable::ReadDeltaUpdate(Deserializer& source)
@@ -24,6 +24,8 @@
 
 #include "../Core/Attribute.h"
 #include "../Core/Object.h"
+#include "../IO/Deserializer.h"
+#include "../IO/Serializer.h"
 
 #include <cstddef>
 
@@ -31,8 +33,6 @@ namespace Urho3D
 {
 
 class Connection;
-class Deserializer;
-class Serializer;
 class XMLElement;
 
 struct DirtyBits;
@@ -54,6 +54,10 @@ public:
     virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
     /// Handle attribute read access. Default implementation reads the variable at offset, or invokes the get accessor.
     virtual void OnGetAttribute(const AttributeInfo& attr, Variant& dest) const;
+    /// Handle attribute write access from binary data without an intermediate Variant. Return false if not supported, in which case the value is read as a Variant and OnSetAttribute() is called instead. Default implementation returns false; subclasses opt in by calling LoadAttributeDirect().
+    virtual bool OnLoadAttribute(const AttributeInfo& attr, Deserializer& source) { return false; }
+    /// Handle attribute read access to binary data without an intermediate Variant. Return false if not supported, in which case OnGetAttribute() is called and the Variant is written instead. Default implementation returns false; subclasses opt in by calling SaveAttributeDirect().
+    virtual bool OnSaveAttribute(const AttributeInfo& attr, Serializer& dest) const { return false; }
     /// Return attribute descriptions, or null if none defined.
     virtual const Vector<AttributeInfo>* GetAttributes() const;
     /// Return network replication attribute descriptions, or null if none defined.
@@ -66,6 +70,10 @@ public:
     virtual bool LoadXML(const XMLElement& source, bool setInstanceDefault = false);
     /// Save as XML data. Return true if successful.
     virtual bool SaveXML(XMLElement& dest) const;
+    /// Read the file attribute values from binary data without applying them. Does not modify the object, so can be called from a worker thread. Return true if successful.
+    bool ReadAttributeValues(Deserializer& source, Vector<Variant>& dest) const;
+    /// Apply file attribute values read with ReadAttributeValues(). Return true if successful.
+    bool LoadAttributeValues(const Vector<Variant>& values);
 
     /// Apply attribute changes that can not be applied immediately. Called after scene load or a network update.
     virtual void ApplyAttributes() { }
@@ -124,6 +132,11 @@ public:
     NetworkState* GetNetworkState() const { return networkState_; }
 
 protected:
+    /// Read attribute from binary data directly to the variable at offset, or through the accessor's direct read. Return false if not supported.
+    bool LoadAttributeDirect(const AttributeInfo& attr, Deserializer& source);
+    /// Write attribute to binary data directly from the variable at offset, or through the accessor's direct write. Return false if not supported or if writing failed.
+    bool SaveAttributeDirect(const AttributeInfo& attr, Serializer& dest) const;
+
     /// Network attribute state.
     NetworkState* networkState_;
 
@@ -139,6 +152,250 @@ private:
     bool temporary_;
 };
 
+/// Read an attribute value directly from binary data, in the same format as Deserializer::ReadVariant(). Specialized for all attribute types.
+template <typename T> void ReadAttributeValue(Deserializer& source, T& value);
+/// Write an attribute value directly as binary data, in the same format as Serializer::WriteVariantData(). Specialized for all attribute types. Return true if successful.
+template <typename T> bool WriteAttributeValue(Serializer& dest, const T& value);
+
+template <> inline void ReadAttributeValue<int>(Deserializer& source, int& value)
+{
+    value = source.ReadInt();
+}
+
+template <> inline void ReadAttributeValue<unsigned>(Deserializer& source, unsigned& value)
+{
+    value = (unsigned)source.ReadInt();
+}
+
+template <> inline void ReadAttributeValue<bool>(Deserializer& source, bool& value)
+{
+    value = source.ReadBool();
+}
+
+template <> inline void ReadAttributeValue<float>(Deserializer& source, float& value)
+{
+    value = source.ReadFloat();
+}
+
+template <> inline void ReadAttributeValue<double>(Deserializer& source, double& value)
+{
+    value = source.ReadDouble();
+}
+
+template <> inline void ReadAttributeValue<Vector2>(Deserializer& source, Vector2& value)
+{
+    value = source.ReadVector2();
+}
+
+template <> inline void ReadAttributeValue<Vector3>(Deserializer& source, Vector3& value)
+{
+    value = source.ReadVector3();
+}
+
+template <> inline void ReadAttributeValue<Vector4>(Deserializer& source, Vector4& value)
+{
+    value = source.ReadVector4();
+}
+
+template <> inline void ReadAttributeValue<Quaternion>(Deserializer& source, Quaternion& value)
+{
+    value = source.ReadQuaternion();
+}
+
+template <> inline void ReadAttributeValue<Color>(Deserializer& source, Color& value)
+{
+    value = source.ReadColor();
+}
+
+template <> inline void ReadAttributeValue<String>(Deserializer& source, String& value)
+{
+    String str(source.ReadString());
+    value.Swap(str);
+}
+
+template <> inline void ReadAttributeValue<StringHash>(Deserializer& source, StringHash& value)
+{
+    value = StringHash((unsigned)source.ReadInt());
+}
+
+template <> inline void ReadAttributeValue<PODVector<unsigned char> >(Deserializer& source, PODVector<unsigned char>& value)
+{
+    PODVector<unsigned char> buffer(source.ReadBuffer());
+    value.Swap(buffer);
+}
+
+template <> inline void ReadAttributeValue<ResourceRef>(Deserializer& source, ResourceRef& value)
+{
+    ResourceRef ref(source.ReadResourceRef());
+    value.type_ = ref.type_;
+    value.name_.Swap(ref.name_);
+}
+
+template <> inline void ReadAttributeValue<ResourceRefList>(Deserializer& source, ResourceRefList& value)
+{
+    ResourceRefList refs(source.ReadResourceRefList());
+    value.type_ = refs.type_;
+    value.names_.Swap(refs.names_);
+}
+
+template <> inline void ReadAttributeValue<VariantVector>(Deserializer& source, VariantVector& value)
+{
+    VariantVector vector(source.ReadVariantVector());
+    value.Swap(vector);
+}
+
+template <> inline void ReadAttributeValue<StringVector>(Deserializer& source, StringVector& value)
+{
+    StringVector vector(source.ReadStringVector());
+    value.Swap(vector);
+}
+
+template <> inline void ReadAttributeValue<VariantMap>(Deserializer& source, VariantMap& value)
+{
+    VariantMap map(source.ReadVariantMap());
+    value.Swap(map);
+}
+
+template <> inline void ReadAttributeValue<IntRect>(Deserializer& source, IntRect& value)
+{
+    value = source.ReadIntRect();
+}
+
+template <> inline void ReadAttributeValue<IntVector2>(Deserializer& source, IntVector2& value)
+{
+    value = source.ReadIntVector2();
+}
+
+template <> inline void ReadAttributeValue<Matrix3>(Deserializer& source, Matrix3& value)
+{
+    value = source.ReadMatrix3();
+}
+
+template <> inline void ReadAttributeValue<Matrix3x4>(Deserializer& source, Matrix3x4& value)
+{
+    value = source.ReadMatrix3x4();
+}
+
+template <> inline void ReadAttributeValue<Matrix4>(Deserializer& source, Matrix4& value)
+{
+    value = source.ReadMatrix4();
+}
+
+template <> inline bool WriteAttributeValue<int>(Serializer& dest, const int& value)
+{
+    return dest.WriteInt(value);
+}
+
+template <> inline bool WriteAttributeValue<unsigned>(Serializer& dest, const unsigned& value)
+{
+    return dest.WriteInt((int)value);
+}
+
+template <> inline bool WriteAttributeValue<bool>(Serializer& dest, const bool& value)
+{
+    return dest.WriteBool(value);
+}
+
+template <> inline bool WriteAttributeValue<float>(Serializer& dest, const float& value)
+{
+    return dest.WriteFloat(value);
+}
+
+template <> inline bool WriteAttributeValue<double>(Serializer& dest, const double& value)
+{
+    return dest.WriteDouble(value);
+}
+
+template <> inline bool WriteAttributeValue<Vector2>(Serializer& dest, const Vector2& value)
+{
+    return dest.WriteVector2(value);
+}
+
+template <> inline bool WriteAttributeValue<Vector3>(Serializer& dest, const Vector3& value)
+{
+    return dest.WriteVector3(value);
+}
+
+template <> inline bool WriteAttributeValue<Vector4>(Serializer& dest, const Vector4& value)
+{
+    return dest.WriteVector4(value);
+}
+
+template <> inline bool WriteAttributeValue<Quaternion>(Serializer& dest, const Quaternion& value)
+{
+    return dest.WriteQuaternion(value);
+}
+
+template <> inline bool WriteAttributeValue<Color>(Serializer& dest, const Color& value)
+{
+    return dest.WriteColor(value);
+}
+
+template <> inline bool WriteAttributeValue<String>(Serializer& dest, const String& value)
+{
+    return dest.WriteString(value);
+}
+
+template <> inline bool WriteAttributeValue<StringHash>(Serializer& dest, const StringHash& value)
+{
+    return dest.WriteInt((int)value.Value());
+}
+
+template <> inline bool WriteAttributeValue<PODVector<unsigned char> >(Serializer& dest, const PODVector<unsigned char>& value)
+{
+    return dest.WriteBuffer(value);
+}
+
+template <> inline bool WriteAttributeValue<ResourceRef>(Serializer& dest, const ResourceRef& value)
+{
+    return dest.WriteResourceRef(value);
+}
+
+template <> inline bool WriteAttributeValue<ResourceRefList>(Serializer& dest, const ResourceRefList& value)
+{
+    return dest.WriteResourceRefList(value);
+}
+
+template <> inline bool WriteAttributeValue<VariantVector>(Serializer& dest, const VariantVector& value)
+{
+    return dest.WriteVariantVector(value);
+}
+
+template <> inline bool WriteAttributeValue<StringVector>(Serializer& dest, const StringVector& value)
+{
+    return dest.WriteStringVector(value);
+}
+
+template <> inline bool WriteAttributeValue<VariantMap>(Serializer& dest, const VariantMap& value)
+{
+    return dest.WriteVariantMap(value);
+}
+
+template <> inline bool WriteAttributeValue<IntRect>(Serializer& dest, const IntRect& value)
+{
+    return dest.WriteIntRect(value);
+}
+
+template <> inline bool WriteAttributeValue<IntVector2>(Serializer& dest, const IntVector2& value)
+{
+    return dest.WriteIntVector2(value);
+}
+
+template <> inline bool WriteAttributeValue<Matrix3>(Serializer& dest, const Matrix3& value)
+{
+    return dest.WriteMatrix3(value);
+}
+
+template <> inline bool WriteAttributeValue<Matrix3x4>(Serializer& dest, const Matrix3x4& value)
+{
+    return dest.WriteMatrix3x4(value);
+}
+
+template <> inline bool WriteAttributeValue<Matrix4>(Serializer& dest, const Matrix4& value)
+{
+    return dest.WriteMatrix4(value);
+}
+
 /// Template implementation of the enum attribute accessor invoke helper class.
 template <typename T, typename U> class EnumAttributeAccessorImpl : public AttributeAccessor
 {
@@ -171,6 +428,23 @@ public:
         (classPtr->*setFunction_)((U)value.GetInt());
     }
 
+    /// Invoke setter function with a value read directly from binary data.
+    virtual bool Read(Serializable* ptr, Deserializer& source)
+    {
+        assert(ptr);
+        T* classPtr = static_cast<T*>(ptr);
+        (classPtr->*setFunction_)((U)source.ReadInt());
+        return true;
+    }
+
+    /// Invoke getter function and write the value directly as binary data.
+    virtual bool Write(const Serializable* ptr, Serializer& dest) const
+    {
+        assert(ptr);
+        const T* classPtr = static_cast<const T*>(ptr);
+        return dest.WriteInt((int)(classPtr->*getFunction_)());
+    }
+
     /// Class-specific pointer to getter function.
     GetFunctionPtr getFunction_;
     /// Class-specific pointer to setter function.
@@ -253,6 +527,25 @@ public:
         (classPtr->*setFunction_)(value.Get < U > ());
     }
 
+    /// Invoke setter function with a value read directly from binary data.
+    virtual bool Read(Serializable* ptr, Deserializer& source)
+    {
+        assert(ptr);
+        T* classPtr = static_cast<T*>(ptr);
+        U value;
+        ReadAttributeValue(source, value);
+        (classPtr->*setFunction_)(value);
+        return true;
+    }
+
+    /// Invoke getter function and write the value directly as binary data.
+    virtual bool Write(const Serializable* ptr, Serializer& dest) const
+    {
+        assert(ptr);
+        const T* classPtr = static_cast<const T*>(ptr);
+        return WriteAttributeValue<U>(dest, (classPtr->*getFunction_)());
+    }
+
     /// Class-specific pointer to getter function.
     GetFunctionPtr getFunction_;
     /// Class-specific pointer to setter function.
@@ -344,6 +344,7 @@ void Renderer2D::HandleBeginViewUpdate(StringHash eventType, VariantMap& eventDa
         frustum_ = 0;
     }
     viewMask_ = camera->GetViewMask();
+    UpdatePackedBounds();
 
     // Check visibility
     {